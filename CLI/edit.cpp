@@ -28,6 +28,9 @@
 
 #include "edit.h"
 #include <boost/regex.hpp>
+#include <iostream>
+#include <stdexcept>
+#include <kernel/core/kernel_functions.h>
 
 namespace OpenPSTD
 {
@@ -122,6 +125,24 @@ namespace OpenPSTD
             }
         }
 
+        void validate(boost::any &v, const std::vector<std::string> &values, CLIDomainRefinement *, int)
+        {
+            static regex r("\\(([^,]*),([^,]*)\\)");
+
+            validators::check_first_occurrence(v);
+            const std::string &s = validators::get_single_string(values);
+
+            smatch match;
+            if (regex_match(s, match, r))
+            {
+                v = any(CLIDomainRefinement(lexical_cast<int>(match[1]), lexical_cast<int>(match[2])));
+            }
+            else
+            {
+                throw validation_error(validation_error::invalid_option_value);
+            }
+        }
+
         void validate(boost::any &v, const std::vector<std::string> &values, CLISpeakerReceiverAdd *, int)
         {
             static regex r("\\[([^,]*),([^,]*)\\]");
@@ -209,6 +230,38 @@ namespace OpenPSTD
             }
         }
 
+        void ChangeDomainRefinementEditCommandPart::AddOptions(options_description_easy_init add_option)
+        {
+            add_option("domain-refinement",
+                       value<std::vector<CLIDomainRefinement>>(),
+                       "Refine the grid of a domain, the number of cells per cell of the grid spacing in both "
+                       "directions, --domain-refinement (id,refinement), eg --domain-refinement (1,2)");
+        }
+
+        void ChangeDomainRefinementEditCommandPart::Execute(std::shared_ptr<Kernel::PSTDConfiguration> model,
+                                                            variables_map input)
+        {
+            if (input.count("domain-refinement") == 0)
+                return;
+
+            std::vector<CLIDomainRefinement> refinements =
+                    input["domain-refinement"].as<std::vector<CLIDomainRefinement>>();
+
+            for (int i = 0; i < (int) refinements.size(); ++i)
+            {
+                if (refinements[i].id < 0 || refinements[i].id >= (int) model->Domains.size())
+                {
+                    throw std::invalid_argument("there is no domain with id " +
+                                                lexical_cast<std::string>(refinements[i].id));
+                }
+                if (refinements[i].refinement < 1)
+                {
+                    throw std::invalid_argument("the refinement of a domain has to be at least 1");
+                }
+                model->Domains[refinements[i].id].Refinement = refinements[i].refinement;
+            }
+        }
+
         void ChangeEdgeAbsorptionEditCommandPart::AddOptions(options_description_easy_init add_option)
         {
             add_option("edge-absorption,a",
@@ -351,6 +404,16 @@ namespace OpenPSTD
                     ("wave-length", value<float>(), "help")
                     ("time-step", value<float>(), "help")
                     ("rk-coefficients", value<std::vector<float>>()->multitoken(), "help")
+                    ("low-storage-rk", value<bool>(), "use the low-storage RK scheme (less memory)")
+                    ("points-per-wavelength", value<float>(), "minimal grid points per wave length (at least 2)")
+                    ("activity-threshold", value<float>(),
+                     "relative amplitude at which silent domains become active (0 computes all domains)")
+                    ("stop-decay", value<float>(), "stop when the energy decayed this many dB below its peak (0 never stops)")
+                    ("stop-decay-frames", value<int>(), "number of frames the energy has to stay below the stop decay")
+                    ("auto-grid-spacing", bool_switch(),
+                     "choose the largest grid spacing for the max frequency that keeps the domain edges on the grid")
+                    ("symmetry", value<std::string>(),
+                     "mirror plane of the scene, only half of it is simulated: none, detect, x=<position> or y=<position>")
                 //todo fix these arguments
                 //("window", value<Eigen::ArrayXf>(), "help")
                     ;
@@ -379,6 +442,63 @@ namespace OpenPSTD
             //if(input.count("time-step") > 0) model->Settings.SetTimeStep(input["time-step"].as<float>());
             if (input.count("rk-coefficients") > 0)
                 model->Settings.SetRKCoefficients(input["rk-coefficients"].as<std::vector<float>>());
+            if (input.count("low-storage-rk") > 0) model->Settings.SetLowStorageRK(input["low-storage-rk"].as<bool>());
+            if (input.count("points-per-wavelength") > 0)
+                model->Settings.SetPointsPerWavelength(input["points-per-wavelength"].as<float>());
+            if (input.count("activity-threshold") > 0)
+                model->Settings.SetActivityThreshold(input["activity-threshold"].as<float>());
+            if (input.count("stop-decay") > 0) model->Settings.SetStopDecay(input["stop-decay"].as<float>());
+            if (input.count("stop-decay-frames") > 0)
+                model->Settings.SetStopDecayFrames(input["stop-decay-frames"].as<int>());
+            if (input.count("auto-grid-spacing") > 0 && input["auto-grid-spacing"].as<bool>())
+            {
+                float old_spacing = model->Settings.GetGridSpacing();
+                float new_spacing = Kernel::get_grid_spacing(*model);
+                model->Settings.SetGridSpacing(new_spacing);
+                std::cout << "Grid spacing: " << old_spacing << " -> " << new_spacing << std::endl;
+                if (old_spacing > 0)
+                {
+                    long old_cells = Kernel::get_number_of_cells(*model, old_spacing);
+                    long new_cells = Kernel::get_number_of_cells(*model, new_spacing);
+                    std::cout << "Number of cells: " << old_cells << " -> " << new_cells << " ("
+                    << 100.0 * (old_cells - new_cells) / std::max(old_cells, 1L) << "% fewer)" << std::endl;
+                }
+            }
+            if (input.count("symmetry") > 0)
+            {
+                std::string symmetry = input["symmetry"].as<std::string>();
+                if (symmetry == "none")
+                {
+                    model->Symmetry = Kernel::PSTD_SYMMETRY::NONE;
+                }
+                else if (symmetry == "detect")
+                {
+                    if (model->DetectSymmetry())
+                    {
+                        std::cout << "Mirror plane: " << (model->Symmetry == Kernel::PSTD_SYMMETRY::X ? "x" : "y")
+                        << " = " << model->SymmetryPlane << std::endl;
+                    }
+                    else
+                    {
+                        std::cout << "The scene is not symmetric" << std::endl;
+                    }
+                }
+                else if (symmetry.size() > 2 && (symmetry[0] == 'x' || symmetry[0] == 'y') && symmetry[1] == '=')
+                {
+                    Kernel::PSTD_SYMMETRY axis = symmetry[0] == 'x' ? Kernel::PSTD_SYMMETRY::X : Kernel::PSTD_SYMMETRY::Y;
+                    float plane = std::stof(symmetry.substr(2));
+                    if (!model->IsSymmetric(axis, plane))
+                    {
+                        throw std::invalid_argument("the scene is not symmetric about " + symmetry);
+                    }
+                    model->Symmetry = axis;
+                    model->SymmetryPlane = plane;
+                }
+                else
+                {
+                    throw std::invalid_argument("symmetry must be none, detect, x=<position> or y=<position>");
+                }
+            }
             //if(input.count("window") > 0) model->Settings.SetWindow(input["window"].as<Eigen::ArrayXf>());
         }
     }
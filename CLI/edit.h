@@ -101,6 +101,21 @@ namespace OpenPSTD
             { }
         };
 
+        struct CLIDomainRefinement
+        {
+        public:
+            int id;
+            int refinement;
+
+            CLIDomainRefinement()
+                    : id(-1), refinement(1)
+            {  }
+
+            CLIDomainRefinement(int id, int refinement)
+                    : id(id), refinement(refinement)
+            { }
+        };
+
         struct CLISpeakerReceiverAdd
         {
         public:
@@ -146,6 +161,13 @@ namespace OpenPSTD
             virtual void Execute(std::shared_ptr<Kernel::PSTDConfiguration> model, po::variables_map input);
         };
 
+        class ChangeDomainRefinementEditCommandPart: public EditCommandPart
+        {
+        public:
+            virtual void AddOptions(po::options_description_easy_init add_option);
+            virtual void Execute(std::shared_ptr<Kernel::PSTDConfiguration> model, po::variables_map input);
+        };
+
         class ChangeEdgeAbsorptionEditCommandPart: public EditCommandPart
         {
         public:
@@ -20,12 +20,17 @@
 #include <string>
 #include <fstream>
 #include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
 
 #include <boost/program_options.hpp>
 #include <boost/regex.hpp>
+#include <boost/thread.hpp>
 
 #include <kernel/PSTDKernel.h>
 #include <kernel/MockKernel.h>
+#include <kernel/Checkpoint.h>
 #include <kernel/DG/DG2D.h>
 #include <kernel/DG/LEE2D.h>
 #include <kernel/DG/DG2DBuilders.h>
@@ -45,6 +50,39 @@ namespace OpenPSTD
         using namespace boost;
         using namespace boost::program_options;
 
+        /**
+         * Parse the name of an FFT length policy as used on the command line
+         * @return false if the name is unknown
+         */
+        static bool ParseFFTLengthPolicy(const std::string &name, Kernel::FFTLengthPolicy &policy)
+        {
+            if (name == "smooth")
+            {
+                policy = Kernel::FFTLengthPolicy::SMOOTH;
+                return true;
+            }
+            if (name == "pow2")
+            {
+                policy = Kernel::FFTLengthPolicy::POWER_OF_TWO;
+                return true;
+            }
+            return false;
+        }
+
+        /**
+         * Organizes the frames of all the domains of the files as time series
+         */
+        static void UpdateTimeSeries(const std::vector<std::shared_ptr<Shared::PSTDFile>> &files)
+        {
+            for (auto file : files)
+            {
+                for (int d = 0; d < file->GetResultsDomainCount(); d++)
+                {
+                    file->UpdateResultsTimeSeries(d);
+                }
+            }
+        }
+
 
         std::string CreateCommand::GetName()
         {
@@ -197,6 +235,7 @@ namespace OpenPSTD
             std::cout << "  Attenuation of PML cells: " << SceneConf->Settings.GetAttenuationOfPMLCells() << std::endl;
             std::cout << "  Density of air: " << SceneConf->Settings.GetDensityOfAir() << std::endl;
             std::cout << "  Max frequency: " << SceneConf->Settings.GetMaxFrequency() << std::endl;
+            std::cout << "  Points per wave length: " << SceneConf->Settings.GetPointsPerWavelength() << std::endl;
             std::cout << "  Sound speed: " << SceneConf->Settings.GetSoundSpeed() << std::endl;
             std::cout << "  FactRK: " << SceneConf->Settings.GetFactRK() << std::endl;
             std::cout << "  Save Nth: " << SceneConf->Settings.GetSaveNth() << std::endl;
@@ -211,6 +250,10 @@ namespace OpenPSTD
                 std::cout << coef[i] << " ";
             }
             std::cout << std::endl;
+            std::cout << "  Low-storage RK: " << SceneConf->Settings.GetLowStorageRK() << std::endl;
+            std::cout << "  Activity threshold: " << SceneConf->Settings.GetActivityThreshold() << std::endl;
+            std::cout << "  Stop decay: " << SceneConf->Settings.GetStopDecay() << " dB for "
+                      << SceneConf->Settings.GetStopDecayFrames() << " frames" << std::endl;
 
             std::cout << std::endl;
             std::cout << "Speakers: " << std::endl;
@@ -281,6 +324,8 @@ namespace OpenPSTD
             commands.push_back(std::unique_ptr<AddDomainEditCommandPart>(new AddDomainEditCommandPart()));
             commands.push_back(std::unique_ptr<RemoveDomainEditCommandPart>(new RemoveDomainEditCommandPart()));
             commands.push_back(std::unique_ptr<ChangeDomainEditCommandPart>(new ChangeDomainEditCommandPart()));
+            commands.push_back(
+                    std::unique_ptr<ChangeDomainRefinementEditCommandPart>(new ChangeDomainRefinementEditCommandPart()));
             commands.push_back(
                     std::unique_ptr<ChangeEdgeAbsorptionEditCommandPart>(new ChangeEdgeAbsorptionEditCommandPart()));
             commands.push_back(std::unique_ptr<ChangeEdgeLREditCommandPart>(new ChangeEdgeLREditCommandPart()));
@@ -375,6 +420,34 @@ namespace OpenPSTD
                         ("multithreaded,m", "Use the multi-threaded solver")
                         ("gpu-accelerated,g", "Use the gpu for the calculations")
                         ("mock,M", "Use the mock kernel(only useful for development)")
+                        ("precision,p", po::value<std::string>()->default_value("float"),
+                         "Scalar type of the kernel: float (fast) or double (for validating results)")
+                        ("fft-length", po::value<std::string>()->default_value("smooth"),
+                         "Rounding of the FFT lengths: smooth (2^a*3^b*5^c*7^d) or pow2 (power of two)")
+                        ("receivers-only", "Only computes and stores the receivers, no pressure frames")
+                        ("receivers", po::value<std::vector<int>>()->multitoken(),
+                         "Indices of the receivers to compute (default: all receivers)")
+                        ("reductions", "Also stores the peak pressure, RMS pressure and arrival time per cell")
+                        ("arrival-threshold", po::value<float>()->default_value(0.01f),
+                         "Pressure of the arrival time, relative to the peak amplitude of the initial field")
+                        ("dft", po::value<std::vector<float>>()->multitoken(),
+                         "Frequencies (Hz) at which the complex pressure of every cell is stored")
+                        ("checkpoint", po::value<std::string>(),
+                         "Checkpoint file of the simulation (default: the scene file with .checkpoint appended)")
+                        ("checkpoint-every", po::value<int>()->default_value(0),
+                         "Store a checkpoint every n time steps (default: no checkpoints)")
+                        ("commit-every", po::value<int>()->default_value(100),
+                         "Commit the results to the scene file every n time steps, 0 commits only at the end")
+                        ("frame-codec", po::value<std::string>()->default_value("raw"),
+                         "Storage of the pressure frames: raw, shuffle-zlib (lossless compression), float16 or "
+                                 "quantized (fixed point)")
+                        ("max-error", po::value<float>()->default_value(0),
+                         "Maximum absolute error of the pressure of float16 (0 is no maximum) or quantized frames")
+                        ("time-series", "Also organize the frames as time series during the simulation, so that "
+                                "the values of grid points are probed fast (see OpenPSTD-cli probe -h)")
+                        ("resume", "Continue the simulation from its checkpoint, with the same output options")
+                        ("separate-speakers", "Simulate every speaker separately in one batched run, the results "
+                                "of speaker n > 0 are stored in the scene file with .speaker<n> appended")
                         ("debug", "shows debug information(only useful for development)")
                     //("write-plot,p", "Plots are written to the output directory")
                     //("write-array,a", "Arrays are written to the output directory")
@@ -410,6 +483,43 @@ namespace OpenPSTD
                     GPU = true;
                 }
 
+                std::string precision = vm["precision"].as<std::string>();
+                if (precision != "float" && precision != "double")
+                {
+                    std::cerr << "precision must be either float or double" << std::endl;
+                    std::cout << desc << std::endl;
+                    return 1;
+                }
+
+                Kernel::FFTLengthPolicy fft_policy;
+                if (!ParseFFTLengthPolicy(vm["fft-length"].as<std::string>(), fft_policy))
+                {
+                    std::cerr << "fft-length must be either smooth or pow2" << std::endl;
+                    std::cout << desc << std::endl;
+                    return 1;
+                }
+
+                Shared::PSTD_FRAME_CODEC frame_codec;
+                if (!Shared::FrameCodec::Parse(vm["frame-codec"].as<std::string>(), frame_codec))
+                {
+                    std::cerr << "frame-codec must be either raw, shuffle-zlib, float16 or quantized" << std::endl;
+                    std::cout << desc << std::endl;
+                    return 1;
+                }
+                float max_error = vm["max-error"].as<float>();
+                if (max_error < 0 || (frame_codec == Shared::PSTD_FRAME_CODEC::QUANTIZED && max_error == 0))
+                {
+                    std::cerr << "max-error must be positive for quantized frames" << std::endl;
+                    return 1;
+                }
+
+                bool separate_speakers = vm.count("separate-speakers") > 0;
+                if (separate_speakers && vm.count("mock") > 0)
+                {
+                    std::cerr << "the mock kernel can not simulate separate speakers" << std::endl;
+                    return 1;
+                }
+
                 if (vm.count("mock") > 0 && (vm.count("multithreaded") > 0 || vm.count("gpu-accelerated") > 0))
                 {
                     std::cout << "warning: no multithreaded or gpu accelerated versions of the mock kernel, "
@@ -420,15 +530,54 @@ namespace OpenPSTD
 
                 //open file (and make a shared_ptr of the unique_ptr)
                 std::shared_ptr<Shared::PSTDFile> file = Shared::PSTDFile::Open(filename);
-                //get conf for the kernel
-                std::shared_ptr<Kernel::PSTDConfiguration> conf = file->GetSceneConf();
-                //initilize output in file
-                std::cout << "Delete old results(if any)" << std::endl;
-                file->DeleteResults();
-                std::cout << "initilize new results" << std::endl;
-                file->InitializeResults();
+                std::string checkpoint = filename + ".checkpoint";
+                if (vm.count("checkpoint") > 0)
+                {
+                    checkpoint = vm["checkpoint"].as<std::string>();
+                }
+                std::shared_ptr<Kernel::PSTDConfiguration> conf;
+                if (vm.count("resume") > 0)
+                {
+                    conf = file->GetResultsSceneConf();
+                }
+                else
+                {
+                    conf = file->GetSceneConf();
+                }
+                //the first speaker is stored in the scene file, the other speakers in a file of their own
+                std::vector<std::shared_ptr<Shared::PSTDFile>> files = {file};
+                for (unsigned long s = 1; separate_speakers && s < conf->Speakers.size(); s++)
+                {
+                    std::string speaker_filename = filename + ".speaker" + std::to_string(s);
+                    std::shared_ptr<Shared::PSTDFile> speaker_file = vm.count("resume") > 0 ?
+                                                                     Shared::PSTDFile::Open(speaker_filename) :
+                                                                     Shared::PSTDFile::New(speaker_filename);
+                    speaker_file->SetSceneConf(conf);
+                    files.push_back(speaker_file);
+                }
+                if (vm.count("resume") > 0)
+                {
+                    //continue the results of the interrupted run, without the results after its checkpoint
+                    Kernel::CheckpointPosition position = Kernel::CheckpointPosition::Read(checkpoint);
+                    std::cout << "Resume after frame " << position.Frame << std::endl;
+                    for (auto speaker_file : files)
+                    {
+                        speaker_file->TruncateResults(position.DomainFrames, position.ReceiverSamples);
+                    }
+                }
+                else
+                {
+                    //initilize output in file
+                    std::cout << "Delete old results(if any)" << std::endl;
+                    for (auto speaker_file : files)
+                    {
+                        speaker_file->DeleteResults();
+                    }
+                }
                 //create kernel
                 std::unique_ptr<Kernel::KernelInterface> kernel;
+                std::function<void(std::vector<std::shared_ptr<Kernel::KernelCallback>>,
+                                   std::shared_ptr<Kernel::OutputPlan>)> run_sources;
                 if (vm.count("mock") > 0)
                 {
                     //use the mocking
@@ -437,18 +586,228 @@ namespace OpenPSTD
                 else
                 {
                     //use the real kernel
-                    kernel = std::unique_ptr<Kernel::PSTDKernel>(new Kernel::PSTDKernel(GPU, MCPU));
+                    if (precision == "double")
+                    {
+                        auto pstd_kernel = new Kernel::PSTDKernel<double>(GPU, MCPU, fft_policy, separate_speakers);
+                        kernel = std::unique_ptr<Kernel::PSTDKernel<double>>(pstd_kernel);
+                        run_sources = [pstd_kernel](std::vector<std::shared_ptr<Kernel::KernelCallback>> callbacks,
+                                                    std::shared_ptr<Kernel::OutputPlan> plan)
+                        {
+                            pstd_kernel->run_sources(callbacks, plan);
+                        };
+                    }
+                    else
+                    {
+                        auto pstd_kernel = new Kernel::PSTDKernel<float>(GPU, MCPU, fft_policy, separate_speakers);
+                        kernel = std::unique_ptr<Kernel::PSTDKernel<float>>(pstd_kernel);
+                        run_sources = [pstd_kernel](std::vector<std::shared_ptr<Kernel::KernelCallback>> callbacks,
+                                                    std::shared_ptr<Kernel::OutputPlan> plan)
+                        {
+                            pstd_kernel->run_sources(callbacks, plan);
+                        };
+                    }
                 }
                 //create output
-                std::shared_ptr<Kernel::KernelCallback> output = std::make_shared<CLIOutput>(file, vm.count("debug") > 0);
+                int commit_every = vm["commit-every"].as<int>();
+                std::shared_ptr<Kernel::KernelCallback> output = std::make_shared<CLIOutput>(
+                        file, vm.count("debug") > 0, commit_every);
+                std::vector<std::shared_ptr<Kernel::KernelCallback>> outputs = {output};
+                for (unsigned long s = 1; s < files.size(); s++)
+                {
+                    outputs.push_back(std::make_shared<CLIOutput>(files.at(s), vm.count("debug") > 0, commit_every));
+                }
 
                 //configure the kernel
                 kernel->initialize_kernel(conf, output); //output is used, because that can also be used as log
 
+                //only produce the requested results
+                std::shared_ptr<Kernel::OutputPlan> plan;
+                if (vm.count("receivers-only") > 0)
+                {
+                    plan = Kernel::OutputPlan::CreateReceiversOnlyPlan(conf->Settings);
+                }
+                else
+                {
+                    plan = Kernel::OutputPlan::CreateDefaultPlan(conf->Settings);
+                }
+                if (vm.count("receivers") > 0)
+                {
+                    plan->Receivers = vm["receivers"].as<std::vector<int>>();
+                }
+                if (vm.count("reductions") > 0)
+                {
+                    plan->Reductions = true;
+                    plan->ArrivalThreshold = vm["arrival-threshold"].as<float>();
+                }
+                if (vm.count("dft") > 0)
+                {
+                    plan->DFTFrequencies = vm["dft"].as<std::vector<float>>();
+                }
+                plan->CheckpointFile = checkpoint;
+                plan->CheckpointNth = vm["checkpoint-every"].as<int>();
+                plan->Resume = vm.count("resume") > 0;
+
+                if (vm.count("resume") == 0)
+                {
+                    //the metadata of the kernel is stored with the results
+                    std::cout << "initilize new results" << std::endl;
+                    Kernel::SimulationMetadata metadata = kernel->get_metadata();
+                    metadata.SetOutputPlan(*plan);
+                    for (auto speaker_file : files)
+                    {
+                        speaker_file->InitializeResults(metadata);
+                        speaker_file->SetResultsFrameCodec(frame_codec, max_error);
+                    }
+                }
+
+                //organize the time series of the frames in the background while the kernel runs
+                boost::thread organizer;
+                if (vm.count("time-series") > 0)
+                {
+                    organizer = boost::thread([files]()
+                    {
+                        try
+                        {
+                            while (true)
+                            {
+                                UpdateTimeSeries(files);
+                                boost::this_thread::sleep_for(boost::chrono::seconds(1));
+                            }
+                        }
+                        catch (std::exception &e)
+                        {
+                            std::cerr << "warning: the frames are not organized as time series: " << e.what()
+                                      << std::endl;
+                        }
+                    });
+                }
+
                 //run kernel
-                kernel->run(output);
+                if (separate_speakers)
+                {
+                    run_sources(outputs, plan);
+                }
+                else
+                {
+                    kernel->run(output, plan);
+                }
 
-                file->Commit();
+                if (vm.count("time-series") > 0)
+                {
+                    organizer.interrupt();
+                    organizer.join();
+                    UpdateTimeSeries(files);
+                }
+
+                for (auto speaker_file : files)
+                {
+                    speaker_file->Commit();
+                }
+                return 0;
+            }
+            catch (std::exception &e)
+            {
+                std::cerr << "error: " << e.what() << "\n";
+                return 1;
+            }
+            catch (...)
+            {
+                std::cerr << "Exception of unknown type!\n";
+                return 1;
+            }
+        }
+
+        std::string BenchmarkCommand::GetName()
+        {
+            return "benchmark";
+        }
+
+        std::string BenchmarkCommand::GetDescription()
+        {
+            return "Time the kernel on a scene for different FFT length policies, see OpenPSTD-cli benchmark -h";
+        }
+
+        int BenchmarkCommand::execute(int argc, const char **argv)
+        {
+            po::variables_map vm;
+
+            try
+            {
+                po::options_description desc("Allowed options");
+                desc.add_options()
+                        ("help,h", "produce help message")
+                        ("scene-file,f", po::value<std::string>(), "The scene file that has to be used (required)")
+                        ("multithreaded,m", "Use the multi-threaded solver")
+                        ("fft-length", po::value<std::vector<std::string>>()->multitoken(),
+                         "FFT length policies to compare (smooth and/or pow2), default both")
+                        ("repeat,r", po::value<int>()->default_value(1), "Number of runs per policy, the fastest is reported")
+                        ;
+
+                po::positional_options_description p;
+                p.add("scene-file", 1);
+
+                po::store(po::command_line_parser(argc, argv).options(desc).positional(p).run(), vm);
+                po::notify(vm);
+
+                if (vm.count("help"))
+                {
+                    std::cout << desc << std::endl;
+                    return 0;
+                }
+
+                if (vm.count("scene-file") == 0)
+                {
+                    std::cerr << "scene file is required" << std::endl;
+                    std::cout << desc << std::endl;
+                    return 1;
+                }
+
+                std::vector<std::string> policies = {"pow2", "smooth"};
+                if (vm.count("fft-length") > 0)
+                {
+                    policies = vm["fft-length"].as<std::vector<std::string>>();
+                }
+                int repeat = std::max(vm["repeat"].as<int>(), 1);
+                bool MCPU = vm.count("multithreaded") > 0;
+
+                std::string filename = vm["scene-file"].as<std::string>();
+                //the results are discarded, so the file is only read
+                std::shared_ptr<Kernel::PSTDConfiguration> conf = Shared::PSTDFile::Open(filename)->GetSceneConf();
+                std::shared_ptr<Kernel::KernelCallback> output = std::make_shared<BenchmarkOutput>();
+
+                std::vector<double> timings;
+                for (std::string name : policies)
+                {
+                    Kernel::FFTLengthPolicy policy;
+                    if (!ParseFFTLengthPolicy(name, policy))
+                    {
+                        std::cerr << "fft-length must be either smooth or pow2" << std::endl;
+                        std::cout << desc << std::endl;
+                        return 1;
+                    }
+
+                    double best = -1;
+                    for (int i = 0; i < repeat; ++i)
+                    {
+                        Kernel::PSTDKernel<float> kernel(false, MCPU, policy);
+                        kernel.initialize_kernel(conf, output);
+
+                        auto start = std::chrono::steady_clock::now();
+                        kernel.run(output);
+                        auto end = std::chrono::steady_clock::now();
+
+                        double time = std::chrono::duration<double, std::milli>(end - start).count();
+                        if (best < 0 || time < best) best = time;
+                    }
+                    timings.push_back(best);
+                    std::cout << name << ":\t" << best << " ms" << std::endl;
+                }
+
+                for (unsigned long i = 1; i < timings.size(); ++i)
+                {
+                    std::cout << policies[i] << " vs " << policies[0] << ":\t" << timings[0] / timings[i] << "x"
+                    << std::endl;
+                }
                 return 0;
             }
             catch (std::exception &e)
@@ -582,6 +941,219 @@ namespace OpenPSTD
             }
         }
 
+        std::string ProbeCommand::GetName()
+        {
+            return "probe";
+        }
+
+        std::string ProbeCommand::GetDescription()
+        {
+            return "Prints the values of grid points in all frames as csv, see OpenPSTD-cli probe -h";
+        }
+
+        int ProbeCommand::execute(int argc, const char **argv)
+        {
+            po::variables_map vm;
+
+            try
+            {
+                po::options_description desc("Allowed options");
+                desc.add_options()
+                        ("help,h", "produce help message")
+                        ("scene-file,f", po::value<std::string>(), "The scene file that has to be used (required)")
+                        ("domain,d", po::value<int>()->default_value(0), "The domain of the grid points")
+                        ("point,p", po::value<std::vector<int>>()->multitoken()->composing(),
+                         "x y: a grid point of the domain, can be used multiple times")
+                        ("line,l", po::value<std::vector<int>>()->multitoken()->composing(),
+                         "x0 y0 x1 y1: all the grid points on a line in the domain, can be used multiple times")
+                        ("organize", "Organize the frames as time series first and store them in the file, so that "
+                                "the next probes are fast")
+                        ("output,o", po::value<std::string>(), "The csv file, by default the values are printed")
+                        ;
+
+                po::positional_options_description p;
+                p.add("scene-file", 1);
+
+                po::store(po::command_line_parser(argc, argv).options(desc).positional(p).run(), vm);
+                po::notify(vm);
+
+                if (vm.count("help"))
+                {
+                    std::cout << desc << std::endl;
+                    return 0;
+                }
+
+                if (vm.count("scene-file") == 0)
+                {
+                    std::cerr << "scene file is required" << std::endl;
+                    std::cout << desc << std::endl;
+                    return 1;
+                }
+
+                std::vector<std::pair<int, int>> points;
+                if (vm.count("point") > 0)
+                {
+                    std::vector<int> values = vm["point"].as<std::vector<int>>();
+                    if (values.size() % 2 != 0)
+                    {
+                        std::cerr << "a point consists of x and y" << std::endl;
+                        return 1;
+                    }
+                    for (unsigned long i = 0; i < values.size(); i += 2)
+                    {
+                        points.push_back(std::make_pair(values[i], values[i + 1]));
+                    }
+                }
+                if (vm.count("line") > 0)
+                {
+                    std::vector<int> values = vm["line"].as<std::vector<int>>();
+                    if (values.size() % 4 != 0)
+                    {
+                        std::cerr << "a line consists of x0, y0, x1 and y1" << std::endl;
+                        return 1;
+                    }
+                    for (unsigned long i = 0; i < values.size(); i += 4)
+                    {
+                        int dx = values[i + 2] - values[i], dy = values[i + 3] - values[i + 1];
+                        int steps = std::max(std::abs(dx), std::abs(dy));
+                        for (int step = 0; step <= steps; step++)
+                        {
+                            double t = steps == 0 ? 0 : (double) step / steps;
+                            points.push_back(std::make_pair(values[i] + (int) std::lround(t * dx),
+                                                            values[i + 1] + (int) std::lround(t * dy)));
+                        }
+                    }
+                }
+                if (points.empty())
+                {
+                    std::cerr << "at least one point or line is required" << std::endl;
+                    std::cout << desc << std::endl;
+                    return 1;
+                }
+
+                std::string filename = vm["scene-file"].as<std::string>();
+                std::shared_ptr<Shared::PSTDFile> file = Shared::PSTDFile::Open(filename);
+                int domain = vm["domain"].as<int>();
+                if (domain < 0 || domain >= file->GetResultsDomainCount())
+                {
+                    std::cerr << "unknown domain: " << domain << std::endl;
+                    return 1;
+                }
+
+                if (vm.count("organize") > 0)
+                {
+                    UpdateTimeSeries({file});
+                    file->Commit();
+                }
+
+                std::vector<Kernel::PSTD_RECEIVER_DATA> series = file->GetResultsTimeSeries(domain, points);
+
+                std::ofstream outputFile;
+                if (vm.count("output") > 0)
+                {
+                    outputFile.open(vm["output"].as<std::string>());
+                }
+                std::ostream &output = vm.count("output") > 0 ? outputFile : std::cout;
+                output << "frame";
+                for (auto &point : points)
+                {
+                    output << ",x" << point.first << "y" << point.second;
+                }
+                output << std::endl;
+                int frameCount = file->GetResultsFrameCount(domain);
+                for (int f = 0; f < frameCount; f++)
+                {
+                    output << f;
+                    for (auto &values : series)
+                    {
+                        output << "," << values[f];
+                    }
+                    output << "\n";
+                }
+                return 0;
+            }
+            catch (std::exception &e)
+            {
+                std::cerr << "error: " << e.what() << "\n";
+                return 1;
+            }
+            catch (...)
+            {
+                std::cerr << "Exception of unknown type!\n";
+                return 1;
+            }
+        }
+
+        std::string CompactCommand::GetName()
+        {
+            return "compact";
+        }
+
+        std::string CompactCommand::GetDescription()
+        {
+            return "Rewrites a scene file without the space of deleted results, see OpenPSTD-cli compact -h";
+        }
+
+        int CompactCommand::execute(int argc, const char **argv)
+        {
+            po::variables_map vm;
+
+            try
+            {
+                po::options_description desc("Allowed options");
+                desc.add_options()
+                        ("help,h", "produce help message")
+                        ("scene-file,f", po::value<std::string>(), "The scene file that has to be used (required)");
+
+                po::positional_options_description p;
+                p.add("scene-file", 1);
+
+                po::store(po::command_line_parser(argc, argv).options(desc).positional(p).run(), vm);
+                po::notify(vm);
+
+                if (vm.count("help"))
+                {
+                    std::cout << desc << std::endl;
+                    return 0;
+                }
+
+                if (vm.count("scene-file") == 0)
+                {
+                    std::cerr << "scene file is required" << std::endl;
+                    std::cout << desc << std::endl;
+                    return 1;
+                }
+
+                std::string filename = vm["scene-file"].as<std::string>();
+                std::string results_filename = filename + ".results";
+                auto file_sizes = [&filename, &results_filename]()
+                {
+                    boost::uintmax_t size = boost::filesystem::file_size(filename);
+                    if (boost::filesystem::exists(results_filename))
+                    {
+                        size += boost::filesystem::file_size(results_filename);
+                    }
+                    return size;
+                };
+
+                boost::uintmax_t before = file_sizes();
+                Shared::PSTDFile::Open(filename)->Compact();
+                std::cout << "Compacted " << filename << " from " << before << " to " << file_sizes() << " bytes"
+                          << std::endl;
+                return 0;
+            }
+            catch (std::exception &e)
+            {
+                std::cerr << "error: " << e.what() << "\n";
+                return 1;
+            }
+            catch (...)
+            {
+                std::cerr << "Exception of unknown type!\n";
+                return 1;
+            }
+        }
+
         std::string TestCommand::GetName()
         {
             return "test";
@@ -630,7 +1202,10 @@ int main(int argc, const char *argv[])
     commands.push_back(std::unique_ptr<ListCommand>(new ListCommand()));
     commands.push_back(std::unique_ptr<EditCommand>(new EditCommand()));
     commands.push_back(std::unique_ptr<RunCommand>(new RunCommand()));
+    commands.push_back(std::unique_ptr<BenchmarkCommand>(new BenchmarkCommand()));
     commands.push_back(std::unique_ptr<ExportCommand>(new ExportCommand()));
+    commands.push_back(std::unique_ptr<ProbeCommand>(new ProbeCommand()));
+    commands.push_back(std::unique_ptr<CompactCommand>(new CompactCommand()));
     commands.push_back(std::unique_ptr<TestCommand>(new TestCommand()));
 
     if (argc >= 2)
@@ -67,6 +67,16 @@ namespace OpenPSTD
             int execute(int argc, const char *argv[]) override;
         };
 
+        class BenchmarkCommand : public Command
+        {
+        public:
+            std::string GetName() override;
+
+            std::string GetDescription() override;
+
+            int execute(int argc, const char *argv[]) override;
+        };
+
         class ExportCommand : public Command
         {
         public:
@@ -77,6 +87,26 @@ namespace OpenPSTD
             int execute(int argc, const char *argv[]) override;
         };
 
+        class ProbeCommand : public Command
+        {
+        public:
+            std::string GetName() override;
+
+            std::string GetDescription() override;
+
+            int execute(int argc, const char *argv[]) override;
+        };
+
+        class CompactCommand : public Command
+        {
+        public:
+            std::string GetName() override;
+
+            std::string GetDescription() override;
+
+            int execute(int argc, const char *argv[]) override;
+        };
+
         class TestCommand : public Command
         {
         public:
@@ -29,13 +29,48 @@ namespace OpenPSTD
 
         void CLIOutput::WriteFrame(int frame, int domain, PSTD_FRAME_PTR data)
         {
-            _file->SaveNextResultsFrame(domain, data);
+            _batch.AddFrame(domain, data);
         }
 
         void CLIOutput::WriteSample(int startSample, int receiver, std::vector<float> data)
         {
             Kernel::PSTD_RECEIVER_DATA_PTR data_ptr = std::make_shared<Kernel::PSTD_RECEIVER_DATA>(data);
-            _file->SaveReceiverData(receiver, data_ptr);
+            _batch.AddSamples(receiver, data_ptr);
+        }
+
+        void CLIOutput::WriteEnergy(int frame, float energy)
+        {
+            this->Debug("Energy of frame " + boost::lexical_cast<std::string>(frame) + ": " +
+                        boost::lexical_cast<std::string>(energy) + " J/m");
+        }
+
+        void CLIOutput::WriteReduction(int domain, Kernel::FIELD_REDUCTION reduction, PSTD_FRAME_PTR data)
+        {
+            _file->SaveResultsReduction(domain, reduction, data);
+        }
+
+        void CLIOutput::WriteDFT(int domain, int index, float frequency, PSTD_FRAME_PTR data)
+        {
+            _file->SaveResultsDFT(domain, index, frequency, data);
+        }
+
+        void CLIOutput::FinishFrame(int frame)
+        {
+            _file->WriteBatch(_batch);
+            _uncommittedFrames++;
+            //commit regularly, so that the journal of the file does not grow during the whole simulation
+            if (_commitInterval > 0 && _uncommittedFrames >= _commitInterval)
+            {
+                _file->Commit();
+                _uncommittedFrames = 0;
+            }
+        }
+
+        void CLIOutput::WriteCheckpoint(int frame)
+        {
+            _file->WriteBatch(_batch);
+            _file->Commit();
+            _uncommittedFrames = 0;
         }
 
         void CLIOutput::Fatal(std::string message)
@@ -65,5 +100,32 @@ namespace OpenPSTD
                 std::cout << message << std::endl;
             }
         }
+
+        void BenchmarkOutput::Callback(Kernel::CALLBACKSTATUS status, std::string message, int frame)
+        {
+        }
+
+        void BenchmarkOutput::WriteFrame(int frame, int domain, PSTD_FRAME_PTR data)
+        {
+        }
+
+        void BenchmarkOutput::WriteSample(int startSample, int receiver, std::vector<float> data)
+        {
+        }
+
+        void BenchmarkOutput::Fatal(std::string message)
+        {
+            std::cerr << "FATAL: " << message << std::endl;
+        }
+
+        void BenchmarkOutput::Error(std::string message)
+        {
+            std::cerr << "ERROR: " << message << std::endl;
+        }
+
+        void BenchmarkOutput::Warning(std::string message)
+        {
+            std::cout << "WARNING: " << message << std::endl;
+        }
     }
 }
\ No newline at end of file
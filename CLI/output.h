@@ -15,8 +15,16 @@ namespace OpenPSTD
         private:
             std::shared_ptr<Shared::PSTDFile> _file;
             bool _debugInfo;
+            Shared::PSTDFileWriteBatch _batch;
+            int _commitInterval;
+            int _uncommittedFrames;
         public:
-            CLIOutput(std::shared_ptr<Shared::PSTDFile> file, bool debugInfo) : _file(file), _debugInfo(debugInfo)
+            /**
+             * @param commitInterval: number of time steps after which the results are committed to the file,
+             * 0 to leave committing to the caller
+             */
+            CLIOutput(std::shared_ptr<Shared::PSTDFile> file, bool debugInfo, int commitInterval = 0) :
+                    _file(file), _debugInfo(debugInfo), _commitInterval(commitInterval), _uncommittedFrames(0)
             { };
 
             virtual void Callback(Kernel::CALLBACKSTATUS status, std::string message, int frame) override;
@@ -25,6 +33,17 @@ namespace OpenPSTD
 
             virtual void WriteSample(int startSample, int receiver, std::vector<float> data) override;
 
+            virtual void WriteEnergy(int frame, float energy) override;
+
+            virtual void WriteReduction(int domain, Kernel::FIELD_REDUCTION reduction,
+                                        Kernel::PSTD_FRAME_PTR data) override;
+
+            virtual void WriteDFT(int domain, int index, float frequency, Kernel::PSTD_FRAME_PTR data) override;
+
+            virtual void FinishFrame(int frame) override;
+
+            virtual void WriteCheckpoint(int frame) override;
+
             virtual void Fatal(std::string message) override;
 
             virtual void Error(std::string message) override;
@@ -35,6 +54,25 @@ namespace OpenPSTD
 
             virtual void Debug(std::string message) override;
         };
+
+        /**
+         * Output that only logs errors and warnings and discards all the results, used for benchmarking
+         */
+        class BenchmarkOutput : public Kernel::KernelCallback
+        {
+        public:
+            virtual void Callback(Kernel::CALLBACKSTATUS status, std::string message, int frame) override;
+
+            virtual void WriteFrame(int frame, int domain, Kernel::PSTD_FRAME_PTR data) override;
+
+            virtual void WriteSample(int startSample, int receiver, std::vector<float> data) override;
+
+            virtual void Fatal(std::string message) override;
+
+            virtual void Error(std::string message) override;
+
+            virtual void Warning(std::string message) override;
+        };
     }
 }
 #endif //OPENPSTD_OUTPUT_CLI_H
@@ -30,8 +30,9 @@
 //////////////////////////////////////////////////////////////////////////
 
 #include "ResultsLayer.h"
-#include <kernel/MockKernel.h>
 #include <queue>
+#include <algorithm>
+#include <cmath>
 
 namespace OpenPSTD
 {
@@ -121,11 +122,27 @@ namespace OpenPSTD
                 auto conf = doc->GetResultsSceneConf();
                 int frame = m->interactive->visibleFrame;
 
-                Kernel::SimulationMetadata metadata;
+                std::shared_ptr<const Kernel::SimulationMetadata> metadata = doc->GetResultsMetadata();
+
+                if (m->documentAccess->IsChanged())
                 {
-                    Kernel::MockKernel k;
-                    k.initialize_kernel(conf, std::make_shared<OpenPSTD::Kernel::KernelCallbackLog>());
-                    metadata = k.get_metadata();
+                    //scale the colors to the largest amplitude in the results, known from the frame statistics
+                    float amplitude = 0;
+                    for (int i = 0; i < doc->GetResultsDomainCount(); i++)
+                    {
+                        Shared::ResultsFrameStatistics statistics = doc->GetResultsStatistics(i);
+                        if (statistics.Count > 0)
+                        {
+                            amplitude = std::max(amplitude, std::max(std::abs(statistics.Min),
+                                                                     std::abs(statistics.Max)));
+                        }
+                    }
+                    if (amplitude <= 0)
+                    {
+                        amplitude = 1;
+                    }
+                    program->setUniformValue("vmin", -amplitude);
+                    program->setUniformValue("vmax", amplitude);
                 }
 
                 //store buffers in queue for re-use. Using queues, because in most cases the former sizes matches the
@@ -149,10 +166,17 @@ namespace OpenPSTD
                             DomainGLInfo info;
 
                             //create positions buffer
-                            QVector2D pos(metadata.DomainPositions[i][0], metadata.DomainPositions[i][1]);
-                            QVector2D size(metadata.DomainMetadata[i][0], metadata.DomainMetadata[i][1]);
+                            //the frame may contain a region or a decimated grid of the domain
+                            std::vector<int> grid = metadata->GetFrameGrid(i);
+                            int regionWidth = std::min(grid[0] * grid[4], metadata->DomainMetadata[i][0] - grid[2]);
+                            int regionHeight = std::min(grid[1] * grid[4], metadata->DomainMetadata[i][1] - grid[3]);
+                            //the sizes and offsets are in grid points of the refined grid of the domain
+                            float cellSize = conf->Settings.GetGridSpacing() / std::max(conf->Domains[i].Refinement, 1);
+                            QVector2D pos(metadata->DomainPositions[i][0], metadata->DomainPositions[i][1]);
                             pos *= conf->Settings.GetGridSpacing();
-                            size *= conf->Settings.GetGridSpacing();
+                            pos += QVector2D(grid[2], grid[3]) * cellSize;
+                            QVector2D size(regionWidth, regionHeight);
+                            size *= cellSize;
 
                             std::vector<QVector2D> worldPos;
                             worldPos.push_back(pos + QVector2D(0, 0) * size);
@@ -175,7 +199,7 @@ namespace OpenPSTD
                                             GL_DYNAMIC_DRAW);
 
                             //create the values texture
-                            Kernel::PSTD_FRAME_PTR values = doc->GetResultsFrame(frame, i);
+                            Shared::PSTDFileDataView values = doc->GetResultsFrameView(frame, i);
 
                             if (ReUsePosBuffer.size() > 0)
                             {
@@ -189,8 +213,8 @@ namespace OpenPSTD
 
                             f->glActiveTexture(GL_TEXTURE1);
                             f->glBindTexture(GL_TEXTURE_2D, info.texture);
-                            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, metadata.DomainMetadata[i][0],
-                                         metadata.DomainMetadata[i][1], 0, GL_RED, GL_FLOAT, values->data());
+                            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, grid[0], grid[1], 0, GL_RED, GL_FLOAT,
+                                         values.data());
 
                             f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
                             f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
@@ -40,6 +40,7 @@ using namespace OpenPSTD::GUI;
 SimulateLOperation::SimulateLOperation():
     started(false),
     finished(false),
+    uncommittedFrames(0),
     currentFrame(0)
 {
 
@@ -65,10 +66,9 @@ void SimulateLOperation::Run(const Reciever &reciever)
 
         //make room in the document for results
         doc->DeleteResults();
-        doc->InitializeResults();
 
         //get the configuration
-        conf = doc->GetResultsSceneConf();
+        conf = doc->GetSceneConf();
     }//make sure the doc ptr does not exist (release of the lock)
     //create and initialize kernel
     std::unique_ptr<KernelInterface> kernel;
@@ -78,16 +78,22 @@ void SimulateLOperation::Run(const Reciever &reciever)
     }
     else
     {
-        kernel = std::unique_ptr<PSTDKernel>(new PSTDKernel(reciever.model->settings->GPUAcceleration,
-                                                            reciever.model->settings->CPUAcceleration));
+        kernel = std::unique_ptr<PSTDKernel<float>>(new PSTDKernel<float>(reciever.model->settings->GPUAcceleration,
+                                                                          reciever.model->settings->CPUAcceleration));
     }
 
     kernel->initialize_kernel(conf, this->shared_from_this());
 
-    //get metadata
+    //get metadata and store it with the results
     metadata = kernel->get_metadata();
+    {
+        auto doc = this->pstdFileAccess->GetDocument();
+        doc->InitializeResults(metadata);
+    }
     //execute kernel
     kernel->run(this->shared_from_this());
+    this->pstdFileAccess->GetDocument()->Commit();
+    this->uncommittedFrames = 0;
     this->finished = true;
 }
 
@@ -113,14 +119,26 @@ void SimulateLOperation::WriteFrame(int frame, int domain, PSTD_FRAME_PTR data)
     {
         this->currentFrame = frame;
     }
-    this->pstdFileAccess->GetDocument()->SaveNextResultsFrame(domain, data);
+    this->batch.AddFrame(domain, data);
 }
 
 void SimulateLOperation::WriteSample(int startSample, int receiver, std::vector<float> data)
 {
     this->Update();
     Kernel::PSTD_RECEIVER_DATA_PTR data_ptr = std::make_shared<Kernel::PSTD_RECEIVER_DATA>(data);
-    this->pstdFileAccess->GetDocument()->SaveReceiverData(receiver, data_ptr);
+    this->batch.AddSamples(receiver, data_ptr);
+}
+
+void SimulateLOperation::FinishFrame(int frame)
+{
+    auto doc = this->pstdFileAccess->GetDocument();
+    doc->WriteBatch(this->batch);
+    this->uncommittedFrames++;
+    if(this->uncommittedFrames >= COMMIT_INTERVAL)
+    {
+        doc->Commit();
+        this->uncommittedFrames = 0;
+    }
 }
 
 void SimulateLOperation::Fatal(std::string message)
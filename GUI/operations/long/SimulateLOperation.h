@@ -50,6 +50,16 @@ namespace OpenPSTD
         private:
             std::shared_ptr<OpenPSTD::Shared::PSTDFileAccess> pstdFileAccess;
             OpenPSTD::Kernel::SimulationMetadata metadata;
+            /**
+             * The results of the current time step, written to the file when the time step is finished
+             */
+            OpenPSTD::Shared::PSTDFileWriteBatch batch;
+            /**
+             * Number of time steps after which the results are committed to the file, so that the journal of the
+             * file does not grow during the whole simulation
+             */
+            static const int COMMIT_INTERVAL = 100;
+            int uncommittedFrames;
             int currentFrame;
             bool started;
             bool finished;
@@ -69,6 +79,7 @@ namespace OpenPSTD
             void Callback(OpenPSTD::Kernel::CALLBACKSTATUS status, std::string message, int frame) override;
             void WriteFrame(int frame, int domain, OpenPSTD::Kernel::PSTD_FRAME_PTR data) override;
             void WriteSample(int startSample, int receiver, std::vector<float> data) override;
+            void FinishFrame(int frame) override;
             virtual void Fatal(std::string message) override;
             virtual void Error(std::string message) override;
             virtual void Warning(std::string message) override;
@@ -9,6 +9,8 @@ if [ ${TARGET} = "win64" ]; then
     PACKAGE=ZIP
     FFTLIBPATH=${MXEDIR}/usr/${WINTARGET_PATH}/bin/libfftw3f-3.dll
     FFTSOPATH=
+    FFTDLIBPATH=${MXEDIR}/usr/${WINTARGET_PATH}/bin/libfftw3-3.dll
+    FFTDSOPATH=
     HDF5LIBPATH=${MXEDIR}/usr/${WINTARGET_PATH}/bin/libhdf5-8.dll
     HDF5HLLIBPATH=${MXEDIR}/usr/${WINTARGET_PATH}/bin/libhdf5_hl-8.dll
     HDF5INCLUDEPATH=${MXEDIR}/usr/${WINTARGET_PATH}/include/
@@ -20,6 +22,8 @@ else
 
         FFTLIBPATH=/usr/local/lib/libfftw3f.a
         FFTSOPATH=/usr/local/lib/libfftw3f.so
+        FFTDLIBPATH=/usr/local/lib/libfftw3.a
+        FFTDSOPATH=/usr/local/lib/libfftw3.so
 
         HDF5LIBPATH=$PWD/hdf5-1.8.17/hdf5/lib/libhdf5.a
         HDF5HLLIBPATH=$PWD/hdf5-1.8.17/hdf5/lib/libhdf5_hl.a
@@ -30,6 +34,8 @@ else
 
         FFTLIBPATH=/usr/local/lib/libfftw3f.a
         FFTSOPATH=/usr/local/lib/libfftw3f.so
+        FFTDLIBPATH=/usr/local/lib/libfftw3.a
+        FFTDSOPATH=/usr/local/lib/libfftw3.so
 
         HDF5LIBPATH=/usr/local/Cellar/hdf5/1.8.16_1/lib/libhdf5.a
         HDF5HLLIBPATH=/usr/local/Cellar/hdf5/1.8.16_1/lib/libhdf5_hl.a
@@ -42,6 +48,8 @@ ${CMAKE} \
 	-D Qt5_DIR:PATH=${QT5DIR} \
 	-D FFTWF_LIBRARY:PATH=${FFTLIBPATH} \
 	-D FFTWF_SHARED_OBJECT:PATH=${FFTSOPATH} \
+	-D FFTW_LIBRARY:PATH=${FFTDLIBPATH} \
+	-D FFTW_SHARED_OBJECT:PATH=${FFTDSOPATH} \
 	-D HDF5_INCLUDE:PATH=${HDF5INCLUDEPATH} \
 	-D HDF5_LIBRARY:PATH=${HDF5LIBPATH} \
 	-D HDF5_HL_LIBRARY:PATH=${HDF5HLLIBPATH} \
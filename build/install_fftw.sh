@@ -17,6 +17,11 @@ else
         echo compiling...
         make > /dev/null
         sudo make install
+        echo compiling the double precision version for the validation kernel
+        make distclean > /dev/null
+        ./configure --enable-shared --enable-sse2 --enable-avx --enable-avx2 --enable-generic-simd128 CFLAGS="-fPIC" CPPFLAGS="-fPIC" > /dev/null
+        make > /dev/null
+        sudo make install
     else
         echo running on mac os x
         echo fftw in homebrew is not compiled with float support
@@ -29,5 +34,10 @@ else
         echo compiling...
         make > /dev/null
         sudo make install
+        echo compiling the double precision version for the validation kernel
+        make distclean > /dev/null
+        ./configure --enable-shared --enable-sse2 --enable-avx --enable-avx2 --enable-generic-simd128 CXX="g++ -stdlib=libstdc++ -arch x86_64 -fPIC" > /dev/null
+        make > /dev/null
+        sudo make install
     fi
 fi
@@ -125,6 +125,7 @@ endif()
 # FFTW3
 message(STATUS "FFTW3F include path: ${FFTWF_INCLUDE_DIR}")
 message(STATUS "FFTW3F lib path: ${FFTWF_LIBRARY}")
+message(STATUS "FFTW3 lib path: ${FFTW_LIBRARY}")
 
 #------------------------------------
 # Rapidjson
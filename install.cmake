@@ -71,6 +71,7 @@ elseif(OPENPSTD_SYSTEM_NAME STREQUAL "win64")
     install(FILES ${QtOpenGL_location} DESTINATION .)
     install(FILES ${Qt5_LIBRARIES_LOCATIONS} DESTINATION .)
     install(FILES ${FFTWF_LIBRARY} DESTINATION .)
+    install(FILES ${FFTW_LIBRARY} DESTINATION .)
     install(FILES ${HDF5_LIBRARY} DESTINATION .)
     install(FILES ${HDF5_HL_LIBRARY} DESTINATION .)
 
@@ -89,6 +90,7 @@ elseif(OPENPSTD_SYSTEM_NAME STREQUAL "linux")
     install(FILES ${QtOpenGL_location} DESTINATION lib)
     install(FILES ${Qt5_LIBRARIES_LOCATIONS} DESTINATION lib)
     install(FILES ${FFTWF_SHARED_OBJECT} DESTINATION lib)
+    install(FILES ${FFTW_SHARED_OBJECT} DESTINATION lib)
     install(FILES ${HDF5_LIBRARY} DESTINATION lib)
     install(FILES ${HDF5_HL_LIBRARY} DESTINATION lib)
 
@@ -0,0 +1,127 @@
+//////////////////////////////////////////////////////////////////////////
+// This file is part of openPSTD.                                       //
+//                                                                      //
+// openPSTD is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU General Public License as published by //
+// the Free Software Foundation, either version 3 of the License, or    //
+// (at your option) any later version.                                  //
+//                                                                      //
+// openPSTD is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of       //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        //
+// GNU General Public License for more details.                         //
+//                                                                      //
+// You should have received a copy of the GNU General Public License    //
+// along with openPSTD.  If not, see <http://www.gnu.org/licenses/>.    //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Date:
+//      18-10-2026
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "Checkpoint.h"
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <boost/lexical_cast.hpp>
+
+namespace OpenPSTD {
+    namespace Kernel {
+        const char CHECKPOINT_MAGIC[8] = {'P', 'S', 'T', 'D', 'C', 'K', 'P', 'T'};
+
+        CheckpointBuffer::CheckpointBuffer() : position(0) {
+        }
+
+        void CheckpointBuffer::read_bytes(void *destination, unsigned long size) {
+            if (this->position + size > this->data.size()) {
+                throw CheckpointException("The checkpoint is truncated");
+            }
+            std::memcpy(destination, this->data.data() + this->position, size);
+            this->position += size;
+        }
+
+        void CheckpointBuffer::write_map(const std::map<int, int> &map) {
+            this->write<unsigned long>(map.size());
+            for (auto entry: map) {
+                this->write<int>(entry.first);
+                this->write<int>(entry.second);
+            }
+        }
+
+        std::map<int, int> CheckpointBuffer::read_map() {
+            std::map<int, int> map;
+            unsigned long size = this->read<unsigned long>();
+            for (unsigned long i = 0; i < size; i++) {
+                int key = this->read<int>();
+                map[key] = this->read<int>();
+            }
+            return map;
+        }
+
+        void CheckpointBuffer::save(const std::string &path) const {
+            std::string temporary_path = path + ".tmp";
+            {
+                std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+                file.write(this->data.data(), this->data.size());
+                if (!file) {
+                    throw CheckpointException("Could not write checkpoint " + temporary_path);
+                }
+            }
+            if (std::rename(temporary_path.c_str(), path.c_str()) != 0) {
+                throw CheckpointException("Could not replace checkpoint " + path);
+            }
+        }
+
+        std::shared_ptr<CheckpointBuffer> CheckpointBuffer::load(const std::string &path) {
+            std::ifstream file(path, std::ios::binary | std::ios::ate);
+            if (!file) {
+                throw CheckpointException("Could not open checkpoint " + path);
+            }
+            auto buffer = std::make_shared<CheckpointBuffer>();
+            buffer->data.resize((unsigned long) file.tellg());
+            file.seekg(0);
+            file.read(buffer->data.data(), buffer->data.size());
+            if (!file) {
+                throw CheckpointException("Could not read checkpoint " + path);
+            }
+            return buffer;
+        }
+
+        void CheckpointPosition::Write(CheckpointBuffer &buffer) const {
+            for (char c: CHECKPOINT_MAGIC) {
+                buffer.write<char>(c);
+            }
+            buffer.write<int>(CHECKPOINT_VERSION);
+            buffer.write<int>(this->ScalarSize);
+            buffer.write<int>(this->Frame);
+            buffer.write_map(this->DomainFrames);
+            buffer.write_map(this->ReceiverSamples);
+        }
+
+        CheckpointPosition CheckpointPosition::Read(CheckpointBuffer &buffer) {
+            for (char c: CHECKPOINT_MAGIC) {
+                if (buffer.read<char>() != c) {
+                    throw CheckpointException("The file is not an openPSTD checkpoint");
+                }
+            }
+            int version = buffer.read<int>();
+            if (version != CHECKPOINT_VERSION) {
+                throw CheckpointException("Unsupported checkpoint version " + boost::lexical_cast<std::string>(version));
+            }
+            CheckpointPosition position;
+            position.ScalarSize = buffer.read<int>();
+            position.Frame = buffer.read<int>();
+            position.DomainFrames = buffer.read_map();
+            position.ReceiverSamples = buffer.read_map();
+            return position;
+        }
+
+        CheckpointPosition CheckpointPosition::Read(const std::string &path) {
+            return Read(*CheckpointBuffer::load(path));
+        }
+    }
+}
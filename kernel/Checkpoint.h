@@ -0,0 +1,179 @@
+//////////////////////////////////////////////////////////////////////////
+// This file is part of openPSTD.                                       //
+//                                                                      //
+// openPSTD is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU General Public License as published by //
+// the Free Software Foundation, either version 3 of the License, or    //
+// (at your option) any later version.                                  //
+//                                                                      //
+// openPSTD is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of       //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        //
+// GNU General Public License for more details.                         //
+//                                                                      //
+// You should have received a copy of the GNU General Public License    //
+// along with openPSTD.  If not, see <http://www.gnu.org/licenses/>.    //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Date:
+//      18-10-2026
+//
+// Purpose:
+//      Binary checkpoints of a running simulation. The solver stores
+//      the fields of all domains and its own position in a checkpoint,
+//      so that a long run can be resumed after it was interrupted.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#ifndef OPENPSTD_CHECKPOINT_H
+#define OPENPSTD_CHECKPOINT_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include "core/Precision.h"
+
+namespace OpenPSTD {
+    namespace Kernel {
+
+        /**
+         * Version of the checkpoint format, checkpoints of other versions can not be resumed
+         */
+        const int CHECKPOINT_VERSION = 2;
+
+        /**
+         * Error while reading or writing a checkpoint
+         */
+        class CheckpointException : public std::runtime_error {
+        public:
+            CheckpointException(const std::string &message) : std::runtime_error(message) { };
+        };
+
+        /**
+         * Compact binary buffer of a checkpoint. Values are written in their native representation,
+         * so a checkpoint can only be resumed on the same platform.
+         */
+        class CheckpointBuffer {
+        private:
+            std::vector<char> data;
+            unsigned long position;
+
+            void read_bytes(void *destination, unsigned long size);
+
+        public:
+            CheckpointBuffer();
+
+            /**
+             * Append a value of a trivially copyable type
+             */
+            template<typename V>
+            void write(V value) {
+                const char *bytes = reinterpret_cast<const char *>(&value);
+                this->data.insert(this->data.end(), bytes, bytes + sizeof(V));
+            }
+
+            /**
+             * Read the next value of a trivially copyable type
+             */
+            template<typename V>
+            V read() {
+                V value;
+                this->read_bytes(&value, sizeof(V));
+                return value;
+            }
+
+            /**
+             * Append an array with its dimensions
+             */
+            template<typename T>
+            void write_array(const ArrayXXT<T> &array) {
+                this->write<long>(array.rows());
+                this->write<long>(array.cols());
+                const char *bytes = reinterpret_cast<const char *>(array.data());
+                this->data.insert(this->data.end(), bytes, bytes + array.size() * sizeof(T));
+            }
+
+            /**
+             * Read an array that has to have the dimensions of the target
+             */
+            template<typename T>
+            void read_array(ArrayXXT<T> &array) {
+                long rows = this->read<long>();
+                long cols = this->read<long>();
+                if (rows != array.rows() || cols != array.cols()) {
+                    throw CheckpointException("The checkpoint does not match the scene");
+                }
+                this->read_bytes(array.data(), array.size() * sizeof(T));
+            }
+
+            /**
+             * Append a vector with its length
+             */
+            template<typename V>
+            void write_vector(const std::vector<V> &vector) {
+                this->write<unsigned long>(vector.size());
+                const char *bytes = reinterpret_cast<const char *>(vector.data());
+                this->data.insert(this->data.end(), bytes, bytes + vector.size() * sizeof(V));
+            }
+
+            template<typename V>
+            std::vector<V> read_vector() {
+                std::vector<V> vector(this->read<unsigned long>());
+                this->read_bytes(vector.data(), vector.size() * sizeof(V));
+                return vector;
+            }
+
+            void write_map(const std::map<int, int> &map);
+
+            std::map<int, int> read_map();
+
+            /**
+             * Write the buffer to a file. The data is first written to a temporary file that replaces
+             * the file when it is complete, so an interruption never leaves a partial checkpoint.
+             */
+            void save(const std::string &path) const;
+
+            /**
+             * Read a complete file into a buffer
+             */
+            static std::shared_ptr<CheckpointBuffer> load(const std::string &path);
+        };
+
+        /**
+         * Position of a simulation in a checkpoint and the results that were written up to that position
+         */
+        class CheckpointPosition {
+        public:
+            /// Last time step that was completed
+            int Frame;
+            /// Size in bytes of the scalar type of the kernel that wrote the checkpoint
+            int ScalarSize;
+            /// Number of frames written per domain identifier
+            std::map<int, int> DomainFrames;
+            /// Number of samples written per receiver identifier
+            std::map<int, int> ReceiverSamples;
+
+            /**
+             * Write the position as the header of a checkpoint
+             */
+            void Write(CheckpointBuffer &buffer) const;
+
+            /**
+             * Read the header of a checkpoint
+             */
+            static CheckpointPosition Read(CheckpointBuffer &buffer);
+
+            /**
+             * Read the position of a checkpoint file
+             */
+            static CheckpointPosition Read(const std::string &path);
+        };
+    }
+}
+
+#endif //OPENPSTD_CHECKPOINT_H
@@ -141,6 +141,46 @@ namespace OpenPSTD {
             this->rk_coefficients = coef; //Todo: Set somewhere.
         }
 
+        bool PSTDSettings::GetLowStorageRK() {
+            return this->low_storage_rk;
+        }
+
+        void PSTDSettings::SetLowStorageRK(bool value) {
+            this->low_storage_rk = value;
+        }
+
+        float PSTDSettings::GetPointsPerWavelength() {
+            return this->points_per_wavelength;
+        }
+
+        void PSTDSettings::SetPointsPerWavelength(float value) {
+            this->points_per_wavelength = value;
+        }
+
+        float PSTDSettings::GetActivityThreshold() {
+            return this->activity_threshold;
+        }
+
+        void PSTDSettings::SetActivityThreshold(float value) {
+            this->activity_threshold = value;
+        }
+
+        float PSTDSettings::GetStopDecay() {
+            return this->stop_decay;
+        }
+
+        void PSTDSettings::SetStopDecay(float value) {
+            this->stop_decay = value;
+        }
+
+        int PSTDSettings::GetStopDecayFrames() {
+            return this->stop_decay_frames;
+        }
+
+        void PSTDSettings::SetStopDecayFrames(int value) {
+            this->stop_decay_frames = value;
+        }
+
         float DomainConf::GetAbsorption(PSTD_DOMAIN_SIDE side) {
             switch (side) {
                 case PSTD_DOMAIN_SIDE_TOP:
@@ -193,6 +233,98 @@ namespace OpenPSTD {
                 R.Absorption = absorption;
         }
 
+        DomainConf DomainConf::Mirror(PSTD_SYMMETRY symmetry, float plane) const {
+            DomainConf result = *this;
+            if (symmetry == PSTD_SYMMETRY::X) {
+                result.TopLeft.setX(2 * plane - TopLeft.x() - Size.x());
+                result.L = R;
+                result.R = L;
+            } else if (symmetry == PSTD_SYMMETRY::Y) {
+                result.TopLeft.setY(2 * plane - TopLeft.y() - Size.y());
+                result.T = B;
+                result.B = T;
+            }
+            return result;
+        }
+
+        bool DomainOutputPlan::IsFrameSaved(int frame) const {
+            return this->SaveNth > 0 && frame % this->SaveNth == 0;
+        }
+
+        std::vector<int> DomainOutputPlan::GetRegion(int width, int height) const {
+            int x_start = std::min(std::max(this->RegionX, 0), width);
+            int y_start = std::min(std::max(this->RegionY, 0), height);
+            int x_end = this->RegionWidth > 0 ? std::min(x_start + this->RegionWidth, width) : width;
+            int y_end = this->RegionHeight > 0 ? std::min(y_start + this->RegionHeight, height) : height;
+            return {x_start, y_start, x_end, y_end};
+        }
+
+        std::vector<int> DomainOutputPlan::GetFrameGrid(int width, int height) const {
+            std::vector<int> region = this->GetRegion(width, height);
+            int step = std::max(this->Decimation, 1);
+            int columns = (region[2] - region[0] + step - 1) / step;
+            int rows = (region[3] - region[1] + step - 1) / step;
+            return {columns, rows, region[0], region[1], step};
+        }
+
+        int DomainOutputPlan::GetFrameSize(int width, int height) const {
+            std::vector<int> grid = this->GetFrameGrid(width, height);
+            return grid[0] * grid[1];
+        }
+
+        DomainOutputPlan OutputPlan::GetDomainOutput(int domain) const {
+            auto output = this->DomainOutput.find(domain);
+            if (output == this->DomainOutput.end()) {
+                return this->DefaultDomainOutput;
+            }
+            return output->second;
+        }
+
+        bool OutputPlan::IsReceiverSaved(int receiver, int frame) const {
+            if (this->ReceiverSaveNth <= 0 || frame % this->ReceiverSaveNth != 0) {
+                return false;
+            }
+            return this->Receivers.empty() ||
+                   std::find(this->Receivers.begin(), this->Receivers.end(), receiver) != this->Receivers.end();
+        }
+
+        void SimulationMetadata::SetOutputPlan(const OutputPlan &plan) {
+            this->FrameGrids.clear();
+            for (unsigned long i = 0; i < this->DomainMetadata.size(); i++) {
+                this->FrameGrids.push_back(plan.GetDomainOutput((int) i).GetFrameGrid(
+                        this->DomainMetadata[i].at(0), this->DomainMetadata[i].at(1)));
+            }
+        }
+
+        std::vector<int> SimulationMetadata::GetFrameGrid(int domain) const {
+            if (domain < (int) this->FrameGrids.size()) {
+                return this->FrameGrids.at(domain);
+            }
+            return {this->DomainMetadata.at(domain).at(0), this->DomainMetadata.at(domain).at(1), 0, 0, 1};
+        }
+
+        std::shared_ptr<OutputPlan> OutputPlan::CreateDefaultPlan(PSTDSettings settings) {
+            std::shared_ptr<OutputPlan> plan = std::make_shared<OutputPlan>();
+            plan->DefaultDomainOutput.SaveNth = settings.GetSaveNth();
+            plan->DefaultDomainOutput.Decimation = 1;
+            plan->DefaultDomainOutput.RegionX = 0;
+            plan->DefaultDomainOutput.RegionY = 0;
+            plan->DefaultDomainOutput.RegionWidth = 0;
+            plan->DefaultDomainOutput.RegionHeight = 0;
+            plan->ReceiverSaveNth = settings.GetSaveNth();
+            plan->Reductions = false;
+            plan->ArrivalThreshold = 0.01f;
+            plan->CheckpointNth = 0;
+            plan->Resume = false;
+            return plan;
+        }
+
+        std::shared_ptr<OutputPlan> OutputPlan::CreateReceiversOnlyPlan(PSTDSettings settings) {
+            std::shared_ptr<OutputPlan> plan = CreateDefaultPlan(settings);
+            plan->DefaultDomainOutput.SaveNth = 0;
+            return plan;
+        }
+
         std::shared_ptr<PSTDConfiguration> PSTDConfiguration::CreateDefaultConf() {
             std::shared_ptr<PSTDConfiguration> conf = std::make_shared<PSTDConfiguration>();
             conf->Settings.SetRenderTime(1.0f);
@@ -213,6 +345,11 @@ namespace OpenPSTD {
             conf->Settings.SetRKCoefficients(Kernel::rk_coefficients);
 
             conf->Settings.SetSpectralInterpolation(true);
+            conf->Settings.SetLowStorageRK(false);
+            conf->Settings.SetPointsPerWavelength(2);
+            conf->Settings.SetActivityThreshold(0);
+            conf->Settings.SetStopDecay(0);
+            conf->Settings.SetStopDecayFrames(1);
 
             conf->Speakers.push_back(QVector3D(4, 5, 0));
             conf->Receivers.push_back(QVector3D(6, 5, 0));
@@ -264,8 +401,86 @@ namespace OpenPSTD {
             // RK coeffs now hardcoded in kernel functions
 
             conf->Settings.SetSpectralInterpolation(false);
+            conf->Settings.SetLowStorageRK(false);
+            conf->Settings.SetPointsPerWavelength(2);
+            conf->Settings.SetActivityThreshold(0);
+            conf->Settings.SetStopDecay(0);
+            conf->Settings.SetStopDecayFrames(1);
 
             return conf;
         }
+    
+        bool PSTDConfiguration::IsSymmetric(PSTD_SYMMETRY symmetry, float plane) {
+            if (symmetry == PSTD_SYMMETRY::NONE) {
+                return false;
+            }
+            float dx = Settings.GetGridSpacing();
+            if (std::abs(plane - dx * std::round(plane / dx)) > GRID_SPACING_TOLERANCE) {
+                return false;
+            }
+            auto same_position = [](QVector2D a, QVector2D b) {
+                return std::abs(a.x() - b.x()) < GRID_SPACING_TOLERANCE &&
+                       std::abs(a.y() - b.y()) < GRID_SPACING_TOLERANCE;
+            };
+            auto same_edge = [](DomainConfEdge a, DomainConfEdge b) {
+                return a.Absorption == b.Absorption && a.LR == b.LR;
+            };
+            // Every domain has to have a mirror image (possibly itself) with the same edges and refinement
+            for (DomainConf domain: Domains) {
+                DomainConf mirror = domain.Mirror(symmetry, plane);
+                bool found = false;
+                for (DomainConf other: Domains) {
+                    found = found || (same_position(mirror.TopLeft, other.TopLeft) &&
+                                      same_position(mirror.Size, other.Size) &&
+                                      mirror.Refinement == other.Refinement &&
+                                      same_edge(mirror.T, other.T) && same_edge(mirror.B, other.B) &&
+                                      same_edge(mirror.L, other.L) && same_edge(mirror.R, other.R));
+                }
+                if (!found) {
+                    return false;
+                }
+            }
+            // The speakers (with their mirror images) have to be the same set
+            for (QVector3D speaker: Speakers) {
+                QVector3D mirror = speaker;
+                if (symmetry == PSTD_SYMMETRY::X) {
+                    mirror.setX(2 * plane - speaker.x());
+                } else {
+                    mirror.setY(2 * plane - speaker.y());
+                }
+                bool found = false;
+                for (QVector3D other: Speakers) {
+                    found = found || same_position(QVector2D(mirror.x(), mirror.y()),
+                                                   QVector2D(other.x(), other.y()));
+                }
+                if (!found) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        bool PSTDConfiguration::DetectSymmetry() {
+            Symmetry = PSTD_SYMMETRY::NONE;
+            SymmetryPlane = 0;
+            if (Domains.empty()) {
+                return false;
+            }
+            float min_x = Domains.at(0).TopLeft.x(), max_x = min_x, min_y = Domains.at(0).TopLeft.y(), max_y = min_y;
+            for (DomainConf domain: Domains) {
+                min_x = std::min(min_x, domain.TopLeft.x());
+                max_x = std::max(max_x, domain.TopLeft.x() + domain.Size.x());
+                min_y = std::min(min_y, domain.TopLeft.y());
+                max_y = std::max(max_y, domain.TopLeft.y() + domain.Size.y());
+            }
+            if (IsSymmetric(PSTD_SYMMETRY::X, (min_x + max_x) / 2)) {
+                Symmetry = PSTD_SYMMETRY::X;
+                SymmetryPlane = (min_x + max_x) / 2;
+            } else if (IsSymmetric(PSTD_SYMMETRY::Y, (min_y + max_y) / 2)) {
+                Symmetry = PSTD_SYMMETRY::Y;
+                SymmetryPlane = (min_y + max_y) / 2;
+            }
+            return Symmetry != PSTD_SYMMETRY::NONE;
+        }
     }
 }
@@ -6,10 +6,14 @@
 #define OPENPSTD_KERNELINTERFACE_H
 
 #include <string>
+#include <vector>
+#include <map>
+#include <memory>
 #include "GeneralTypes.h"
 #include <QVector2D>
 #include <QVector3D>
 #include <Eigen/Core>
+#include <boost/serialization/version.hpp>
 
 
 namespace OpenPSTD {
@@ -23,6 +27,33 @@ namespace OpenPSTD {
             FINISHED
         };
 
+        /**
+         * Per-cell reductions of the pressure over all computed time steps
+         */
+        enum class FIELD_REDUCTION {
+            /// Maximum absolute pressure
+            PEAK,
+            /// Root mean square of the pressure
+            RMS,
+            /// Time (in seconds) at which the absolute pressure first exceeded the arrival threshold, -1 if never
+            ARRIVAL
+        };
+
+        const std::vector<FIELD_REDUCTION> all_field_reductions = {FIELD_REDUCTION::PEAK, FIELD_REDUCTION::RMS,
+                                                                   FIELD_REDUCTION::ARRIVAL};
+
+        /**
+         * Mirror plane of a symmetric scene
+         */
+        enum class PSTD_SYMMETRY {
+            /// The scene is not simulated as a symmetric scene
+            NONE,
+            /// Mirror-symmetric about the plane x = SymmetryPlane
+            X,
+            /// Mirror-symmetric about the plane y = SymmetryPlane
+            Y
+        };
+
         /**
          * Enums for the domain boundary representation in the interface
          */
@@ -74,6 +105,21 @@ namespace OpenPSTD {
             int SaveNth;
             /// Window coefficients for attenuating the sound
             Eigen::ArrayXf window;
+            /// Flag indicating whether to integrate in time with the low-storage (2N-register) RK scheme
+            /// instead of the six-stage scheme. Saves the memory of the previous field values.
+            bool low_storage_rk = false;
+            /// Minimal number of grid points per wave length of the maximum frequency, used to choose the grid
+            /// spacing. 2 is the Nyquist limit, larger values add a margin.
+            float points_per_wavelength = 2;
+            /// Amplitude (relative to the peak of the initial field) above which the field near a domain edge
+            /// activates the neighbouring domain. Domains that the sound has not reached are not computed.
+            /// 0 disables the tracking, all domains are always computed.
+            float activity_threshold = 0;
+            /// Decay of the acoustic energy (in dB below its peak) at which the simulation stops early,
+            /// 0 always runs the full render time
+            float stop_decay = 0;
+            /// Number of consecutive frames the energy has to stay below the stop decay
+            int stop_decay_frames = 1;
 
         public:
 
@@ -94,6 +140,28 @@ namespace OpenPSTD {
                 ar & spectral_interpolation;
                 ar & PMLCells;
                 ar & SaveNth;
+                if (version >= 1) {
+                    ar & low_storage_rk;
+                } else {
+                    low_storage_rk = false;
+                }
+                if (version >= 2) {
+                    ar & points_per_wavelength;
+                } else {
+                    points_per_wavelength = 2;
+                }
+                if (version >= 3) {
+                    ar & activity_threshold;
+                } else {
+                    activity_threshold = 0;
+                }
+                if (version >= 4) {
+                    ar & stop_decay;
+                    ar & stop_decay_frames;
+                } else {
+                    stop_decay = 0;
+                    stop_decay_frames = 1;
+                }
             }
 
             float GetGridSpacing();
@@ -155,6 +223,26 @@ namespace OpenPSTD {
             std::vector<float> GetRKCoefficients();
 
             void SetRKCoefficients(std::vector<float> coef);
+
+            bool GetLowStorageRK();
+
+            void SetLowStorageRK(bool value);
+
+            float GetPointsPerWavelength();
+
+            void SetPointsPerWavelength(float value);
+
+            float GetActivityThreshold();
+
+            void SetActivityThreshold(float value);
+
+            float GetStopDecay();
+
+            void SetStopDecay(float value);
+
+            int GetStopDecayFrames();
+
+            void SetStopDecayFrames(int value);
         };
 
         /**
@@ -184,6 +272,9 @@ namespace OpenPSTD {
             QVector2D TopLeft;
             QVector2D Size;
             DomainConfEdge T, L, B, R;
+            /// Number of cells of the domain per cell of the base grid, in both directions.
+            /// The grid spacing of the domain is the grid spacing of the settings divided by the refinement.
+            int Refinement = 1;
 
             float GetAbsorption(PSTD_DOMAIN_SIDE side);
 
@@ -193,6 +284,13 @@ namespace OpenPSTD {
 
             void SetLR(PSTD_DOMAIN_SIDE sides, bool LR);
 
+            /**
+             * The mirror image of the domain in a plane, the edges on both sides of the plane are swapped
+             * @param symmetry: axis of the mirror plane
+             * @param plane: position of the mirror plane (m)
+             */
+            DomainConf Mirror(PSTD_SYMMETRY symmetry, float plane) const;
+
             template<class Archive>
             void serialize(Archive & ar, const unsigned int version)
             {
@@ -202,6 +300,11 @@ namespace OpenPSTD {
                 ar & L;
                 ar & B;
                 ar & R;
+                if (version >= 1) {
+                    ar & Refinement;
+                } else {
+                    Refinement = 1;
+                }
             }
         };
 
@@ -218,6 +321,26 @@ namespace OpenPSTD {
             std::vector<QVector3D> Speakers;
             std::vector<QVector3D> Receivers;
             std::vector<DomainConf> Domains;
+            /// Mirror plane of the domains and speakers. Only the half before the plane is simulated,
+            /// the results of the other half are its mirror image.
+            PSTD_SYMMETRY Symmetry = PSTD_SYMMETRY::NONE;
+            /// Position of the mirror plane (m), has to lie on the grid
+            float SymmetryPlane = 0;
+
+            /**
+             * Whether the domains (with their edges) and the speakers are mirror-symmetric about a plane
+             * that lies on the grid. The receivers do not have to be symmetric.
+             * @param symmetry: axis of the mirror plane
+             * @param plane: position of the mirror plane (m)
+             */
+            bool IsSymmetric(PSTD_SYMMETRY symmetry, float plane);
+
+            /**
+             * Find a mirror plane through the center of the domains for which the scene is symmetric,
+             * and set Symmetry and SymmetryPlane to it. The x axis is tried before the y axis.
+             * @return: false (and Symmetry NONE) if the scene is not symmetric
+             */
+            bool DetectSymmetry();
 
             /**
              * Obtain a default configuration with decent values for a simulation run
@@ -237,6 +360,15 @@ namespace OpenPSTD {
                 ar & Speakers;
                 ar & Receivers;
                 ar & Domains;
+                if (version >= 1) {
+                    int symmetry = (int) Symmetry;
+                    ar & symmetry;
+                    Symmetry = (PSTD_SYMMETRY) symmetry;
+                    ar & SymmetryPlane;
+                } else {
+                    Symmetry = PSTD_SYMMETRY::NONE;
+                    SymmetryPlane = 0;
+                }
             }
         };
 
@@ -301,8 +433,52 @@ namespace OpenPSTD {
              * @param data: a set of data points
              */
             virtual void WriteSample(int startSample, int receiver, std::vector<float> data) = 0;
+
+            /**
+             * Return the total acoustic energy (per unit length in z) of the non-PML domains after a time step.
+             * Remark, this should be a non-blocking method. So the kernel will continue after this method.
+             * @param frame: Positive integer corresponding to time step of data.
+             * @param energy: Sum of the potential and kinetic energy in J/m
+             */
+            virtual void WriteEnergy(int /*frame*/, float /*energy*/) {}
+
+            /**
+             * Return a per-cell reduction of the pressure of a domain, called once at the end of the simulation.
+             * @param domain: an identifier that identifies the domain
+             * @param reduction: the reduction that the data contains
+             * @param data: 1D row-major vector, with the same region and decimation as the frames of the domain
+             */
+            virtual void WriteReduction(int /*domain*/, FIELD_REDUCTION /*reduction*/, PSTD_FRAME_PTR /*data*/) {}
+
+            /**
+             * Return the running DFT of the pressure of a domain at a single frequency, called once at the end of
+             * the simulation. The DFT is sum(p(n) * exp(-2 pi i f n dt) * dt) over the computed time steps (in Pa s).
+             * @param domain: an identifier that identifies the domain
+             * @param index: index of the frequency in OutputPlan::DFTFrequencies
+             * @param frequency: the frequency in Hz
+             * @param data: 1D row-major vector of interleaved real and imaginary parts,
+             * with the same region and decimation as the frames of the domain
+             */
+            virtual void WriteDFT(int /*domain*/, int /*index*/, float /*frequency*/, PSTD_FRAME_PTR /*data*/) {}
+
+            /**
+             * Called after all frames and samples of a time step have been written, so that they can be stored
+             * together.
+             * @param frame: the time step
+             */
+            virtual void FinishFrame(int /*frame*/) {}
+
+            /**
+             * Called when the state after a time step is stored in a checkpoint, before the checkpoint is written.
+             * All results up to and including this time step have to be persisted at this point, because a resumed
+             * simulation continues with the next time step.
+             * @param frame: the last time step of which the results have been written
+             */
+            virtual void WriteCheckpoint(int /*frame*/) {}
         };
 
+        class OutputPlan;
+
         /**
          * Data not obtained in running openPSTD but necessary for representing the information.
          */
@@ -324,6 +500,113 @@ namespace OpenPSTD {
              * In the "inner" vectors, v[0],v[1],v[2] correspond to size x,y,z.
              */
             std::vector<std::vector<int>> DomainPositions;
+            /**
+             * The grid of the stored frames, in the same order as DomainMetadata.
+             * In the "inner" vectors, v[0],v[1] are the number of values in x and y, v[2],v[3] the position of the
+             * first value in grid points relative to the domain and v[4] the distance between two values.
+             * Domains without an entry store frames of the complete domain.
+             */
+            std::vector<std::vector<int>> FrameGrids;
+
+            /**
+             * Stores the grids of the frames that the plan writes for every domain in FrameGrids
+             */
+            void SetOutputPlan(const OutputPlan &plan);
+
+            /**
+             * The grid of the stored frames of a domain
+             * @return {width, height, x, y, distance}, see FrameGrids
+             */
+            std::vector<int> GetFrameGrid(int domain) const;
+        };
+
+        /**
+         * Output of the pressure frames of a single domain
+         */
+        class DomainOutputPlan {
+        public:
+            /// Write a frame every SaveNth time step, 0 writes no frames at all
+            int SaveNth;
+            /// Spatial decimation, only every Decimation-th grid point in x and y is written
+            int Decimation;
+            /// Region of interest in grid points, relative to the top left of the domain.
+            /// A region with a width or height of 0 selects the complete domain.
+            int RegionX, RegionY, RegionWidth, RegionHeight;
+
+            /**
+             * Whether a frame of this domain has to be written in the given time step
+             */
+            bool IsFrameSaved(int frame) const;
+
+            /**
+             * The region of interest clipped to a domain
+             * @param width: number of grid points of the domain in x direction
+             * @param height: number of grid points of the domain in y direction
+             * @return {x start, y start, x end, y end}, the ends are exclusive
+             */
+            std::vector<int> GetRegion(int width, int height) const;
+
+            /**
+             * The grid of the values in a frame of a domain
+             * @return {number of values in x, number of values in y, x start, y start, distance between values}
+             * @see GetRegion
+             */
+            std::vector<int> GetFrameGrid(int width, int height) const;
+
+            /**
+             * Number of values in a frame of a domain
+             * @see GetRegion
+             */
+            int GetFrameSize(int width, int height) const;
+        };
+
+        /**
+         * Declares which results the kernel has to produce.
+         * The solver does not compute, copy or store anything that is not requested by the plan.
+         */
+        class OutputPlan {
+        public:
+            /// Output of the domains without an entry in DomainOutput
+            DomainOutputPlan DefaultDomainOutput;
+            /// Output per domain, indexed by the domain identifier used in KernelCallback::WriteFrame
+            std::map<int, DomainOutputPlan> DomainOutput;
+            /// Sample the receivers every ReceiverSaveNth time step, 0 does not compute the receivers at all
+            int ReceiverSaveNth;
+            /// Indices of the receivers that are computed, an empty list selects all receivers
+            std::vector<int> Receivers;
+            /// Accumulate the per-cell reductions of the pressure (FIELD_REDUCTION) during the simulation
+            bool Reductions;
+            /// Pressure at which the sound has arrived in a cell, relative to the peak amplitude of the initial field
+            float ArrivalThreshold;
+            /// Frequencies (Hz) at which the running DFT of the pressure is accumulated per cell
+            std::vector<float> DFTFrequencies;
+            /// File in which the solver stores a checkpoint every CheckpointNth time steps, 0 writes no checkpoints
+            std::string CheckpointFile;
+            int CheckpointNth;
+            /// Continue the simulation from the checkpoint in CheckpointFile instead of starting at the first time step
+            bool Resume;
+
+            /**
+             * Output plan of a domain
+             */
+            DomainOutputPlan GetDomainOutput(int domain) const;
+
+            /**
+             * Whether the receiver has to be computed in the given time step
+             */
+            bool IsReceiverSaved(int receiver, int frame) const;
+
+            /**
+             * The plan that writes all results: full frames of all domains and all receivers, every SaveNth time step
+             * @param settings: settings that provide SaveNth
+             */
+            static std::shared_ptr<OutputPlan> CreateDefaultPlan(PSTDSettings settings);
+
+            /**
+             * Plan that only computes the receivers, every SaveNth time step
+             * @param settings: settings that provide SaveNth
+             */
+            static std::shared_ptr<OutputPlan> CreateReceiversOnlyPlan(PSTDSettings settings);
         };
 
         /**
@@ -341,8 +624,9 @@ namespace OpenPSTD {
              * Runs the kernel. The callback has a single function that informs the rest of the
              * application of the progress of the kernel.
              * Must first be configured, else a PSTDKernelNotConfiguredException is thrown.
+             * @param plan: the results that have to be written, nullptr writes everything (OutputPlan::CreateDefaultPlan)
              */
-            virtual void run(std::shared_ptr<KernelCallback> callback) = 0;
+            virtual void run(std::shared_ptr<KernelCallback> callback, std::shared_ptr<OutputPlan> plan = nullptr) = 0;
 
             /**
              * Query the kernel for metadata about the simulation that is configured.
@@ -358,4 +642,8 @@ namespace OpenPSTD {
 }
 
 
+BOOST_CLASS_VERSION(OpenPSTD::Kernel::PSTDSettings, 4)
+BOOST_CLASS_VERSION(OpenPSTD::Kernel::PSTDConfiguration, 1)
+BOOST_CLASS_VERSION(OpenPSTD::Kernel::DomainConf, 1)
+
 #endif //OPENPSTD_KERNELINTERFACE_H
@@ -3,6 +3,7 @@
 //
 
 #include "MockKernel.h"
+#include <algorithm>
 #include <boost/lexical_cast.hpp>
 
 namespace OpenPSTD
@@ -14,10 +15,12 @@ namespace OpenPSTD
             _conf = config;
         }
 
-        void MockKernel::run(std::shared_ptr<KernelCallback> callback)
+        void MockKernel::run(std::shared_ptr<KernelCallback> callback, std::shared_ptr<OutputPlan> plan)
         {
             if (!_conf)
                 throw PSTDKernelNotConfiguredException();
+            if (!plan)
+                plan = OutputPlan::CreateDefaultPlan(_conf->Settings);
 
             auto meta = get_metadata();
 
@@ -31,6 +34,8 @@ namespace OpenPSTD
                 callback->Info("At frame " + boost::lexical_cast<std::string>(i));
                 for (int j = 0; j < _conf->Domains.size(); ++j)
                 {
+                    if (!plan->GetDomainOutput(j).IsFrameSaved(i))
+                        continue;
                     PSTD_FRAME_PTR frame;
                     int type = j % 6;
                     switch (type)
@@ -58,6 +63,8 @@ namespace OpenPSTD
                 }
                 for(int r = 0; r < _conf->Receivers.size(); r++)
                 {
+                    if (!plan->IsReceiverSaved(r, i))
+                        continue;
                     int receiverSamples = 16;
                     PSTD_RECEIVER_DATA data;
                     for(int j = 0; j < receiverSamples; j++)
@@ -67,6 +74,28 @@ namespace OpenPSTD
                     }
                     callback->WriteSample(receiverSamples*i, r, data);
                 }
+                callback->FinishFrame(i);
+            }
+
+            if (plan->Reductions)
+            {
+                for (int j = 0; j < _conf->Domains.size(); ++j)
+                {
+                    for (FIELD_REDUCTION reduction : all_field_reductions)
+                    {
+                        callback->WriteReduction(j, reduction,
+                                                 CreateRandomFrame(meta.DomainMetadata[j][0], meta.DomainMetadata[j][1]));
+                    }
+                }
+            }
+
+            for (int k = 0; k < plan->DFTFrequencies.size(); ++k)
+            {
+                for (int j = 0; j < _conf->Domains.size(); ++j)
+                {
+                    callback->WriteDFT(j, k, plan->DFTFrequencies[k],
+                                      CreateRandomFrame(2 * meta.DomainMetadata[j][0], meta.DomainMetadata[j][1]));
+                }
             }
 
             callback->Info("Finished mocking");
@@ -82,9 +111,11 @@ namespace OpenPSTD
             float grid = _conf->Settings.GetGridSpacing();
             for (int i = 0; i < _conf->Domains.size(); ++i)
             {
+                //sizes in grid points of the refined grid of the domain, like the frames of the real kernel
+                int refinement = std::max(_conf->Domains[i].Refinement, 1);
                 std::vector<int> d;
-                d.push_back(roundf(_conf->Domains[i].Size.x() / grid));
-                d.push_back(roundf(_conf->Domains[i].Size.y() / grid));
+                d.push_back((int) roundf(_conf->Domains[i].Size.x() / grid) * refinement);
+                d.push_back((int) roundf(_conf->Domains[i].Size.y() / grid) * refinement);
                 d.push_back(1);
 
                 result.DomainMetadata.push_back(d);
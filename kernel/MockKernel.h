@@ -43,7 +43,7 @@ namespace OpenPSTD
              * application of the progress of the kernel.
              * Must first be configured, else a PSTDKernelNotConfiguredException is thrown.
              */
-            virtual void run(std::shared_ptr<KernelCallback> callback) override;
+            virtual void run(std::shared_ptr<KernelCallback> callback, std::shared_ptr<OutputPlan> plan = nullptr) override;
 
             /**
              * Query the kernel for metadata about the simulation that is configured.
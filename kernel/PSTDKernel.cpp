@@ -33,6 +33,7 @@
 #include <ext/string_conversions.h>
 #include <cstdio>
 #include <boost/lexical_cast.hpp>
+#include <stdexcept>
 
 namespace OpenPSTD {
     namespace Kernel {
@@ -41,25 +42,52 @@ namespace OpenPSTD {
 //-----------------------------------------------------------------------------
 // interface of the kernel
 
-        PSTDKernel::PSTDKernel(bool GPU, bool MCPU) {
+        template<typename T>
+        PSTDKernel<T>::PSTDKernel(bool GPU, bool MCPU, FFTLengthPolicy fft_policy, bool separate_speakers) {
             this->GPU = GPU;
             this->MCPU = MCPU;
+            this->fft_policy = fft_policy;
+            this->separate_speakers = separate_speakers;
         }
 
-        void PSTDKernel::initialize_kernel(std::shared_ptr<PSTDConfiguration> config, std::shared_ptr<KernelCallbackLog> callbackLog) {
+        template<typename T>
+        void PSTDKernel<T>::initialize_kernel(std::shared_ptr<PSTDConfiguration> config, std::shared_ptr<KernelCallbackLog> callbackLog) {
             this->callbackLog = callbackLog;
             using namespace Kernel;
             callbackLog->Debug("Initializing kernel");
             this->config = config;
+            this->symmetric_scene = nullptr;
+            if (config->Symmetry != PSTD_SYMMETRY::NONE) {
+                if (this->separate_speakers) {
+                    throw std::invalid_argument("Separate speakers are not supported for symmetric scenes");
+                }
+                this->symmetric_scene = make_shared<SymmetricScene>(config);
+                this->config = this->symmetric_scene->GetHalfConfiguration();
+                callbackLog->Info("Simulating the half of the scene before the mirror plane " +
+                                  string(config->Symmetry == PSTD_SYMMETRY::X ? "x" : "y") + " = " +
+                                  boost::lexical_cast<std::string>(config->SymmetryPlane));
+            }
             this->settings = make_shared<PSTDSettings>(config->Settings);
-            this->wnd = make_shared<WisdomCache>();
-            this->scene = make_shared<Scene>(this->settings);
+            for (auto domain: this->config->Domains) {
+                if (domain.Refinement < 1) {
+                    throw std::invalid_argument("The refinement of a domain has to be at least 1");
+                }
+                // A refined domain takes refinement sub-steps per time step, nested in those of the coarser domains
+                for (auto other: this->config->Domains) {
+                    if (std::max(domain.Refinement, other.Refinement) % std::min(domain.Refinement, other.Refinement) != 0) {
+                        throw std::invalid_argument("The refinements of the domains have to be multiples of each other");
+                    }
+                }
+            }
+            this->wnd = make_shared<WisdomCache<T>>(this->fft_policy);
+            this->scene = make_shared<Scene<T>>(this->settings);
             this->initialize_scene();
             callbackLog->Debug("Finished initializing kernel");
         }
 
 
-        void PSTDKernel::initialize_scene() {
+        template<typename T>
+        void PSTDKernel<T>::initialize_scene() {
             using namespace Kernel;
             callbackLog->Debug("Initializing scene");
             this->add_domains();
@@ -70,20 +98,25 @@ namespace OpenPSTD {
         }
 
 
-        void PSTDKernel::add_domains() {
+        template<typename T>
+        void PSTDKernel<T>::add_domains() {
             int domain_id_int = 0;
-            vector<shared_ptr<Kernel::Domain>> domains;
+            vector<shared_ptr<Kernel::Domain<T>>> domains;
             for (auto domain: this->config->Domains) {
                 callbackLog->Debug("Initializing domain " + boost::lexical_cast<std::string>(domain_id_int));
                 vector<float> tl = scale_to_grid(domain.TopLeft);
                 vector<float> s = scale_to_grid(domain.Size);
-                Kernel::Point grid_top_left((int) tl.at(0), (int) tl.at(1));
-                Kernel::Point grid_size((int) s.at(0), (int) s.at(1));
+                // Round instead of truncate, the edges lie on the grid up to floating point errors
+                Kernel::Point grid_top_left((int) lround(tl.at(0)), (int) lround(tl.at(1)));
+                Kernel::Point grid_size((int) lround(s.at(0)), (int) lround(s.at(1)));
                 map<Kernel::Direction, Kernel::EdgeParameters> edge_param_map = translate_edge_parameters(domain);
                 int domain_id = scene->get_new_id();
-                shared_ptr<Kernel::Domain> domain_ptr = std::make_shared<Kernel::Domain>(
+                shared_ptr<Kernel::Domain<T>> domain_ptr = std::make_shared<Kernel::Domain<T>>(
                         this->settings, domain_id, default_alpha, grid_top_left,
                         grid_size, false, this->wnd, edge_param_map, nullptr);
+                if (domain.Refinement > 1) {
+                    domain_ptr->set_refinement(domain.Refinement);
+                }
                 domains.push_back(domain_ptr);
                 domain_id_int++;
             }
@@ -93,22 +126,29 @@ namespace OpenPSTD {
             scene->add_pml_domains();
             for (auto domain:scene->domain_list) {
                 domain->post_initialization();
+                if (this->separate_speakers) {
+                    // Every speaker gets its own field set, stacked in the rows of the field arrays
+                    domain->set_source_count(this->get_source_count());
+                }
                 this->callbackLog->Debug(domain->ToString());
             }
         }
 
 
-        void PSTDKernel::add_speakers() {
+        template<typename T>
+        void PSTDKernel<T>::add_speakers() {
             using namespace Kernel;
             //Inconsistent: We created domains in this class, and speakers in the scene class
-            for (auto speaker: this->config->Speakers) {
-                vector<float> location = scale_to_grid(speaker);
+            for (unsigned long i = 0; i < this->config->Speakers.size(); i++) {
+                vector<float> location = scale_to_grid(this->config->Speakers.at(i));
                 callbackLog->Debug("Initializing Speaker (" + boost::lexical_cast<std::string>(location.at(0)) + ", " + boost::lexical_cast<std::string>(location.at(1)) + ")");
-                this->scene->add_speaker(location.at(0), location.at(1), 0); // Z-coordinate is 0
+                int source = this->separate_speakers ? (int) i : 0;
+                this->scene->add_speaker(location.at(0), location.at(1), 0, source); // Z-coordinate is 0
             }
         }
 
-        void PSTDKernel::add_receivers() {
+        template<typename T>
+        void PSTDKernel<T>::add_receivers() {
             using namespace Kernel;
             //Inconsistent: We created domains in this class, and receivers in the scene class
             for (unsigned long i = 0; i < this->config->Receivers.size(); i++) {
@@ -118,27 +158,44 @@ namespace OpenPSTD {
             }
         }
 
-        void PSTDKernel::run(std::shared_ptr<KernelCallback> callback) {
+        template<typename T>
+        void PSTDKernel<T>::run(std::shared_ptr<KernelCallback> callback, std::shared_ptr<OutputPlan> plan) {
+            this->run_sources({callback}, plan);
+        }
+
+        template<typename T>
+        void PSTDKernel<T>::run_sources(std::vector<std::shared_ptr<KernelCallback>> callbacks,
+                                        std::shared_ptr<OutputPlan> plan) {
             if (!config)
                 throw PSTDKernelNotConfiguredException();
+            if ((int) callbacks.size() != this->get_source_count())
+                throw std::invalid_argument("Expected a callback for each of the " +
+                                            std::to_string(this->get_source_count()) + " sources");
+            if (!plan)
+                plan = OutputPlan::CreateDefaultPlan(*this->settings);
+            if (this->symmetric_scene) {
+                // The solver computes the half of the scene, the callback receives the results of the full scene
+                callbacks = {make_shared<MirroredCallback>(this->symmetric_scene, callbacks.at(0), plan)};
+                plan = this->symmetric_scene->CreateHalfPlan(plan);
+            }
 
             using namespace Kernel;
             int solver_num = 0;
             if(this->GPU) solver_num++;
             if(this->MCPU) solver_num += 2;
-            std::shared_ptr<Kernel::Solver> solver;
+            std::shared_ptr<Kernel::Solver<T>> solver;
             switch (solver_num) {
                 case 0:
-                    solver = std::make_shared<Kernel::SingleThreadSolver>(this->scene, callback);
+                    solver = std::make_shared<Kernel::SingleThreadSolver<T>>(this->scene, callbacks, plan);
                     break;
                 case 1:
-                    solver = std::make_shared<Kernel::GPUSingleThreadSolver>(this->scene, callback);
+                    solver = std::make_shared<Kernel::GPUSingleThreadSolver<T>>(this->scene, callbacks, plan);
                     break;
                 case 2:
-                    solver = std::make_shared<Kernel::MultiThreadSolver>(this->scene, callback);
+                    solver = std::make_shared<Kernel::MultiThreadSolver<T>>(this->scene, callbacks, plan);
                     break;
                 case 3:
-                    solver = std::make_shared<Kernel::GPUMultiThreadSolver>(this->scene, callback);
+                    solver = std::make_shared<Kernel::GPUMultiThreadSolver<T>>(this->scene, callbacks, plan);
                     break;
                 default:
                     //TODO Raise Error
@@ -147,38 +204,60 @@ namespace OpenPSTD {
             solver->compute_propagation();
         }
 
-        std::shared_ptr<Kernel::Scene> PSTDKernel::get_scene() {
+        template<typename T>
+        int PSTDKernel<T>::get_source_count() {
+            if (!config)
+                throw PSTDKernelNotConfiguredException();
+            return this->separate_speakers ? std::max((int) this->config->Speakers.size(), 1) : 1;
+        }
+
+        template<typename T>
+        std::shared_ptr<Kernel::Scene<T>> PSTDKernel<T>::get_scene() {
             return this->scene;
         }
 
-        SimulationMetadata PSTDKernel::get_metadata() {
+        template<typename T>
+        SimulationMetadata PSTDKernel<T>::get_metadata() {
             if (!config)
                 throw PSTDKernelNotConfiguredException();
 
             SimulationMetadata result;
+            if (this->symmetric_scene) {
+                for (MirroredDomain domain: this->symmetric_scene->GetDomains()) {
+                    result.DomainMetadata.push_back({domain.Width, domain.Height, 0});
+                    result.DomainPositions.push_back({domain.Left, domain.Top, 0});
+                }
+                result.Framecount = (int) (this->settings->GetRenderTime() / this->settings->GetTimeStep());
+                return result;
+            }
             int ndomains = (int) this->scene->domain_list.size();
             for (int i = 0; i < ndomains; i++) {
-                Kernel::Point dsize = this->scene->domain_list[i]->size;
+                Kernel::Point dsize = this->scene->domain_list[i]->cells;
                 std::vector<int> dimensions = {dsize.x, dsize.y, dsize.z};
                 result.DomainMetadata.push_back(dimensions);
+                Kernel::Point position = this->scene->domain_list[i]->top_left;
+                result.DomainPositions.push_back({position.x, position.y, position.z});
             }
 
             result.Framecount = (int) (this->settings->GetRenderTime() / this->settings->GetTimeStep());
             return result;
         }
 
-        vector<float> PSTDKernel::scale_to_grid(QVector2D world_vector) {
+        template<typename T>
+        vector<float> PSTDKernel<T>::scale_to_grid(QVector2D world_vector) {
             QVector2D scaled_vector = world_vector / this->settings->GetGridSpacing();
             return vector<float>{scaled_vector[0], scaled_vector[1]};
         }
 
-        vector<float> PSTDKernel::scale_to_grid(QVector3D world_vector) {
+        template<typename T>
+        vector<float> PSTDKernel<T>::scale_to_grid(QVector3D world_vector) {
             //Not yet adapted to 3D.
             QVector3D scaled_vector = world_vector / this->settings->GetGridSpacing();
             return vector<float>{scaled_vector[0], scaled_vector[1]};
         }
 
-        map<Kernel::Direction, Kernel::EdgeParameters> PSTDKernel::translate_edge_parameters(DomainConf domain) {
+        template<typename T>
+        map<Kernel::Direction, Kernel::EdgeParameters> PSTDKernel<T>::translate_edge_parameters(DomainConf domain) {
             using namespace Kernel;
             map<Direction, EdgeParameters> edge_parameters;
             // Internal matrices are flipped, so T/B switch
@@ -189,10 +268,13 @@ namespace OpenPSTD {
             return edge_parameters;
         }
 
-        vector<int> PSTDKernel::round_off(vector<float> vector) {
+        template<typename T>
+        vector<int> PSTDKernel<T>::round_off(vector<float> vector) {
             assert(vector.size() == 2); // We don't need to be very general here.
             return std::vector<int>{(int) vector.at(0), (int) vector.at(1)};
         }
 
+        template class PSTDKernel<float>;
+        template class PSTDKernel<double>;
     }
 }
@@ -39,6 +39,7 @@
 #include "Solver.h"
 #include "core/Scene.h"
 #include "KernelInterface.h"
+#include "Symmetry.h"
 
 namespace OpenPSTD {
     namespace Kernel {
@@ -48,17 +49,26 @@ namespace OpenPSTD {
          *
          * This API has two methods, one for initialization of the scene and the domains,
          * and one for starting the actual simulation.
+         * The kernel is instantiated for float (fast path) and double (validation path) field values.
+         * @tparam T: scalar type of the field values (float or double)
          */
+        template<typename T>
         class PSTDKernel : public KernelInterface {
         private:
             bool GPU, MCPU;
+            /// Policy for rounding the stripe lengths up to FFT lengths
+            FFTLengthPolicy fft_policy;
+            /// Simulate every speaker as a separate source instead of their superposition
+            bool separate_speakers;
 
-            /// Configuration file from which the simulation is created
+            /// Configuration file from which the simulation is created, the simulated half of symmetric scenes
             std::shared_ptr<PSTDConfiguration> config;
+            /// The full scene of symmetric configurations, nullptr when the complete scene is simulated
+            std::shared_ptr<SymmetricScene> symmetric_scene;
             /// Settings derived from the configuration
             std::shared_ptr<PSTDSettings> settings;
             /// Scene created from the config
-            std::shared_ptr<Kernel::Scene> scene;
+            std::shared_ptr<Kernel::Scene<T>> scene;
             /// Standard alpha
             const float default_alpha = 1.f;
             /// Log callback
@@ -70,7 +80,7 @@ namespace OpenPSTD {
             void initialize_scene();
 
             /// Wisdom cache used in the simulation
-            std::shared_ptr<Kernel::WisdomCache> wnd;
+            std::shared_ptr<Kernel::WisdomCache<T>> wnd;
 
             /**
              * Read the scene description from application or file and converts the coordinates to domains.
@@ -122,20 +132,48 @@ namespace OpenPSTD {
 
         public:
 
-            PSTDKernel(bool GPU, bool MCPU);
+            /**
+             * Create a kernel (still needs to be initialized with a configuration)
+             * @param GPU: use the GPU solvers
+             * @param MCPU: use the multithreaded solvers
+             * @param fft_policy: policy for rounding the stripe lengths up to FFT lengths
+             * @param separate_speakers: simulate every speaker as a separate source,
+             * the sources are computed together in the same batched spatial derivatives
+             */
+            PSTDKernel(bool GPU, bool MCPU, FFTLengthPolicy fft_policy = FFTLengthPolicy::SMOOTH,
+                       bool separate_speakers = false);
 
             /**
              * Sets the configuration,
              * also initializes the kernel and the scene, constructs the domains and sets the parameters.
+             * Of a configuration with a symmetry plane, only the half before the plane is simulated.
              * @param config: Configuration file from the PSTDFile
+             * @throw std::invalid_argument when the configuration is not symmetric about its symmetry plane
              */
             void initialize_kernel(std::shared_ptr<PSTDConfiguration> config, std::shared_ptr<KernelCallbackLog> callbackLog) override;
 
             /**
              * Runs the kernel. The callback has a single function that informs the rest of the
              * application of the progress of the kernel.
+             * @param plan: the results that have to be written, nullptr writes everything
+             */
+            void run(std::shared_ptr<KernelCallback> callback, std::shared_ptr<OutputPlan> plan = nullptr) override;
+
+            /**
+             * Runs the kernel with a callback per source. The frames and samples of every source are written
+             * to the callback of that source, the first callback also receives the progress and the log.
+             * @param callbacks: one callback per source, in the order of the speakers
+             * @param plan: the results that have to be written, nullptr writes everything
+             * @throw std::invalid_argument when the number of callbacks differs from the number of sources
+             */
+            void run_sources(std::vector<std::shared_ptr<KernelCallback>> callbacks,
+                             std::shared_ptr<OutputPlan> plan = nullptr);
+
+            /**
+             * Number of independent sources that are simulated,
+             * the number of speakers with separate speakers and 1 otherwise.
              */
-            void run(std::shared_ptr<KernelCallback> callback) override;
+            int get_source_count();
 
             /**
              * Query the kernel for metadata about the simulation that is configured.
@@ -146,7 +184,7 @@ namespace OpenPSTD {
              * Return the scene of the simulation
              * @return: Shared pointer to simulation of the scene
              */
-            std::shared_ptr<Kernel::Scene> get_scene();
+            std::shared_ptr<Kernel::Scene<T>> get_scene();
         };
 
     }
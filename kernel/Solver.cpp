@@ -28,77 +28,436 @@
 
 #include "Solver.h"
 #include <boost/lexical_cast.hpp>
+#include <limits>
+#include <cmath>
+#include <algorithm>
 
 namespace OpenPSTD {
     namespace Kernel {
-        Solver::Solver(std::shared_ptr<Scene> scene, std::shared_ptr<KernelCallback> callback) {
+        template<typename T>
+        Solver<T>::Solver(std::shared_ptr<Scene<T>> scene, std::vector<std::shared_ptr<KernelCallback>> callbacks,
+                          std::shared_ptr<OutputPlan> plan) {
             this->scene = scene;
             this->settings = scene->settings;
-            this->callback = callback;
+            this->source_callbacks = callbacks;
+            this->callback = callbacks.at(0);
+            this->plan = plan;
             this->callback->Debug("Number of render time: " + boost::lexical_cast<std::string>(this->settings->GetRenderTime()));
             this->callback->Debug("Size of time step: " + boost::lexical_cast<std::string>(this->settings->GetTimeStep()));
 
             this->number_of_time_steps = (int) (this->settings->GetRenderTime() / this->settings->GetTimeStep());
+            this->low_storage = this->settings->GetLowStorageRK();
+            if (this->low_storage) {
+                this->callback->Debug("Using the low-storage RK scheme");
+            }
+
+            // Only the domains that contain a part of the initial field are active
+            T peak_amplitude = 0;
+            for (auto domain:this->scene->domain_list) {
+                peak_amplitude = std::max(peak_amplitude, domain->get_amplitude());
+            }
+            this->activity_threshold = this->settings->GetActivityThreshold() * peak_amplitude;
+            for (auto domain:this->scene->domain_list) {
+                domain->active = this->activity_threshold <= 0 or domain->get_amplitude() > this->activity_threshold;
+            }
+            this->skipped_updates = 0;
+            this->performed_updates = 0;
+            this->computed_frames = 0;
+            this->first_frame = 0;
+            this->arrival_threshold = this->plan->ArrivalThreshold * peak_amplitude;
+            if (this->plan->Reductions) {
+                for (auto domain:this->scene->domain_list) {
+                    if (domain->is_pml) {
+                        continue;
+                    }
+                    long rows = domain->current_values.p0.rows();
+                    long cols = domain->current_values.p0.cols();
+                    FieldReductions reduction;
+                    reduction.peak = ArrayXXT<T>::Zero(rows, cols);
+                    reduction.squares = ArrayXXT<T>::Zero(rows, cols);
+                    reduction.arrival = ArrayXXT<T>::Constant(rows, cols, -1);
+                    this->reductions[domain->id] = reduction;
+                }
+            }
+            T nyquist = 1 / (2 * this->settings->GetTimeStep());
+            for (float frequency: this->plan->DFTFrequencies) {
+                if (frequency <= 0 or frequency >= nyquist) {
+                    throw std::invalid_argument("DFT frequency " + boost::lexical_cast<std::string>(frequency) +
+                                                " Hz is not between 0 and the Nyquist frequency of the time step");
+                }
+            }
+            if (!this->plan->DFTFrequencies.empty()) {
+                for (auto domain:this->scene->domain_list) {
+                    if (domain->is_pml) {
+                        continue;
+                    }
+                    long rows = domain->current_values.p0.rows();
+                    long cols = domain->current_values.p0.cols();
+                    DFTAccumulators accumulators;
+                    for (unsigned long k = 0; k < this->plan->DFTFrequencies.size(); k++) {
+                        accumulators.real.push_back(ArrayXXT<T>::Zero(rows, cols));
+                        accumulators.imag.push_back(ArrayXXT<T>::Zero(rows, cols));
+                    }
+                    this->dft_accumulators[domain->id] = accumulators;
+                }
+            }
+            this->frame_energy = 0;
+            this->peak_energy = 0;
+            this->decayed_frames = 0;
+
+            // The fractions of a time step at which the stages evaluate the derivatives, from du/dt = 1
+            std::vector<float> coefs = this->settings->GetRKCoefficients();
+            double stage_value = 0, stage_register = 0;
+            for (unsigned long rk_step = 0; rk_step < this->number_of_rk_stages(); rk_step++) {
+                this->stage_times.push_back(stage_value);
+                if (this->low_storage) {
+                    stage_register = low_storage_rk_a.at(rk_step) * stage_register + 1;
+                    stage_value += low_storage_rk_b.at(rk_step) * stage_register;
+                } else {
+                    stage_value = coefs.at(rk_step);
+                }
+            }
+
+            // Group the domains by the length of their time step, from coarse to fine
+            std::map<int, TimeLevel> levels;
+            for (auto domain:this->scene->domain_list) {
+                TimeLevel &level = levels[this->get_substeps(domain)];
+                level.substeps = this->get_substeps(domain);
+                level.domains.push_back(domain);
+                level.borders_finer = false;
+            }
+            for (auto &level: levels) {
+                for (auto domain: level.second.domains) {
+                    for (Direction direction: all_directions) {
+                        for (auto neighbour: domain->get_neighbours_at(direction)) {
+                            int substeps = this->get_substeps(neighbour);
+                            auto &neighbours = level.second.neighbours;
+                            if (substeps != level.first and
+                                std::find(neighbours.begin(), neighbours.end(), neighbour) == neighbours.end()) {
+                                neighbours.push_back(neighbour);
+                                this->snapshots[neighbour->id];
+                            }
+                            level.second.borders_finer = level.second.borders_finer or substeps > level.first;
+                        }
+                    }
+                }
+                this->time_levels.push_back(level.second);
+            }
+            this->stage_domains = this->scene->domain_list;
+            this->final_step = true;
+        }
+
+        template<typename T>
+        Solver<T>::~Solver() {
+            if (this->checkpoint_writer.joinable()) {
+                this->checkpoint_writer.join();
+            }
+        }
+
+        template<typename T>
+        void Solver<T>::update_activity() {
+            if (this->activity_threshold > 0) {
+                int width = this->settings->GetWindowSize();
+                for (auto domain:this->scene->domain_list) {
+                    if (domain->active or domain->is_rigid()) {
+                        continue;
+                    }
+                    for (Direction direction: all_directions) {
+                        for (auto neighbour:domain->get_neighbours_at(direction)) {
+                            if (neighbour->active and
+                                neighbour->get_edge_amplitude(get_opposite(direction), width) >
+                                this->activity_threshold) {
+                                domain->active = true;
+                            }
+                        }
+                    }
+                }
+            }
+            for (auto domain:this->stage_domains) {
+                if (not domain->is_rigid()) {
+                    if (domain->active) {
+                        this->performed_updates++;
+                    } else {
+                        this->skipped_updates++;
+                    }
+                }
+            }
+        }
+
+        template<typename T>
+        bool Solver<T>::needs_update(std::shared_ptr<Domain<T>> domain) {
+            return domain->active and not domain->is_rigid();
+        }
+
+        template<typename T>
+        PSTD_FRAME_PTR Solver<T>::get_zero_frame(std::shared_ptr<Domain<T>> domain, const DomainOutputPlan &output) {
+            auto frame = this->zero_frames.find(domain->id);
+            if (frame == this->zero_frames.end()) {
+                auto zeros = std::make_shared<PSTD_FRAME>(
+                        (unsigned long) output.GetFrameSize(domain->cells.x, domain->cells.y), 0);
+                frame = this->zero_frames.insert(std::make_pair(domain->id, zeros)).first;
+            }
+            return frame->second;
+        }
+
+        template<typename T>
+        unsigned long Solver<T>::number_of_rk_stages() {
+            return this->low_storage ? low_storage_rk_a.size() : 6;
+        }
+
+        template<typename T>
+        void Solver<T>::prepare_rk_step(unsigned long rk_step) {
+            T factor = this->low_storage ? (T) low_storage_rk_a.at(rk_step) : 0;
+            for (auto domain:this->stage_domains) {
+                domain->l_values_factor = factor;
+            }
+            this->update_activity();
         }
 
-        SingleThreadSolver::SingleThreadSolver(std::shared_ptr<Scene> scene, std::shared_ptr<KernelCallback> callback) : Solver::Solver(
-                scene, callback) {
+        template<typename T>
+        int Solver<T>::get_substeps(std::shared_ptr<Domain<T>> domain) {
+            return domain->is_pml ? 1 : domain->refinement;
         }
 
-        GPUSingleThreadSolver::GPUSingleThreadSolver(std::shared_ptr<Scene> scene, std::shared_ptr<KernelCallback> callback)
-                : Solver::Solver(scene, callback) {
+        template<typename T>
+        void Solver<T>::store_snapshot(std::shared_ptr<Domain<T>> domain, double time, int frame) {
+            std::vector<FieldSnapshot> &domain_snapshots = this->snapshots.at(domain->id);
+            domain_snapshots.erase(std::remove_if(domain_snapshots.begin(), domain_snapshots.end(),
+                                                  [time, frame](const FieldSnapshot &snapshot) {
+                                                      return snapshot.time < frame - 1 - 1e-9 or
+                                                             std::abs(snapshot.time - time) < 1e-9;
+                                                  }), domain_snapshots.end());
+            FieldSnapshot snapshot;
+            snapshot.time = time;
+            snapshot.values.p0 = domain->current_values.p0;
+            snapshot.values.vx0 = domain->current_values.vx0;
+            snapshot.values.vy0 = domain->current_values.vy0;
+            auto position = std::find_if(domain_snapshots.begin(), domain_snapshots.end(),
+                                         [time](const FieldSnapshot &other) { return other.time > time; });
+            domain_snapshots.insert(position, snapshot);
         }
 
-        MultiThreadSolver::MultiThreadSolver(std::shared_ptr<Scene> scene, std::shared_ptr<KernelCallback> callback) : SingleThreadSolver::SingleThreadSolver(
+        template<typename T>
+        void Solver<T>::set_exchange_values(const TimeLevel &level, double time) {
+            for (auto neighbour: level.neighbours) {
+                std::vector<FieldSnapshot> &domain_snapshots = this->snapshots.at(neighbour->id);
+                // the (up to) three snapshots closest to the time, interpolated with Lagrange polynomials
+                std::vector<const FieldSnapshot *> closest;
+                for (const FieldSnapshot &snapshot: domain_snapshots) {
+                    closest.push_back(&snapshot);
+                }
+                std::sort(closest.begin(), closest.end(), [time](const FieldSnapshot *a, const FieldSnapshot *b) {
+                    return std::abs(a->time - time) < std::abs(b->time - time);
+                });
+                closest.resize(std::min(closest.size(), (size_t) 3));
+                FieldValues<T> &values = neighbour->exchange_values;
+                for (unsigned long i = 0; i < closest.size(); i++) {
+                    double weight = 1;
+                    for (unsigned long j = 0; j < closest.size(); j++) {
+                        if (j != i) {
+                            weight *= (time - closest[j]->time) / (closest[i]->time - closest[j]->time);
+                        }
+                    }
+                    if (i == 0) {
+                        values.p0 = (T) weight * closest[i]->values.p0;
+                        values.vx0 = (T) weight * closest[i]->values.vx0;
+                        values.vy0 = (T) weight * closest[i]->values.vy0;
+                    } else {
+                        values.p0 += (T) weight * closest[i]->values.p0;
+                        values.vx0 += (T) weight * closest[i]->values.vx0;
+                        values.vy0 += (T) weight * closest[i]->values.vy0;
+                    }
+                }
+                neighbour->use_exchange_values = !closest.empty();
+            }
+        }
+
+        template<typename T>
+        void Solver<T>::clear_exchange_values(const TimeLevel &level) {
+            for (auto neighbour: level.neighbours) {
+                neighbour->use_exchange_values = false;
+            }
+        }
+
+        template<typename T>
+        bool Solver<T>::has_decayed(int frame) {
+            this->callback->WriteEnergy(frame, (float) this->frame_energy);
+            this->peak_energy = std::max(this->peak_energy, this->frame_energy);
+            if (this->settings->GetStopDecay() <= 0 or this->peak_energy <= 0) {
+                return false;
+            }
+            T decay = 10 * std::log10(this->peak_energy / std::max(this->frame_energy, std::numeric_limits<T>::min()));
+            if (decay >= this->settings->GetStopDecay()) {
+                this->decayed_frames++;
+            } else {
+                this->decayed_frames = 0;
+            }
+            return this->decayed_frames >= this->settings->GetStopDecayFrames();
+        }
+
+        template<typename T>
+        void Solver<T>::report_field_memory() {
+            unsigned long bytes = 0;
+            for (auto domain:this->scene->domain_list) {
+                bytes += domain->get_field_memory();
+            }
+            this->callback->Info("Field memory: " + boost::lexical_cast<std::string>(bytes / (1024.0 * 1024.0)) +
+                                 " MB" + (this->low_storage ? " (low-storage RK)" : ""));
+        }
+
+        template<typename T>
+        void Solver<T>::report_activity() {
+            if (this->activity_threshold <= 0) {
+                return;
+            }
+            unsigned long total = this->skipped_updates + this->performed_updates;
+            this->callback->Info("Skipped " + boost::lexical_cast<std::string>(this->skipped_updates) + " of " +
+                                 boost::lexical_cast<std::string>(total) +
+                                 " domain updates for domains the sound had not reached");
+        }
+
+        template<typename T>
+        SingleThreadSolver<T>::SingleThreadSolver(std::shared_ptr<Scene<T>> scene,
+                                                  std::vector<std::shared_ptr<KernelCallback>> callbacks,
+                                                  std::shared_ptr<OutputPlan> plan) : Solver<T>::Solver(
+                scene, callbacks, plan) {
+        }
+
+        template<typename T>
+        GPUSingleThreadSolver<T>::GPUSingleThreadSolver(std::shared_ptr<Scene<T>> scene,
+                                                        std::vector<std::shared_ptr<KernelCallback>> callbacks,
+                                                        std::shared_ptr<OutputPlan> plan)
+                : Solver<T>::Solver(scene, callbacks, plan) {
+        }
+
+        template<typename T>
+        MultiThreadSolver<T>::MultiThreadSolver(std::shared_ptr<Scene<T>> scene,
+                                                std::vector<std::shared_ptr<KernelCallback>> callbacks,
+                                                std::shared_ptr<OutputPlan> plan) : SingleThreadSolver<T>::SingleThreadSolver(
                 scene,
-                callback) {
+                callbacks, plan) {
         }
 
-        GPUMultiThreadSolver::GPUMultiThreadSolver(std::shared_ptr<Scene> scene, std::shared_ptr<KernelCallback> callback)
-                : Solver::Solver(
-                scene, callback) {
+        template<typename T>
+        GPUMultiThreadSolver<T>::GPUMultiThreadSolver(std::shared_ptr<Scene<T>> scene,
+                                                      std::vector<std::shared_ptr<KernelCallback>> callbacks,
+                                                      std::shared_ptr<OutputPlan> plan)
+                : Solver<T>::Solver(
+                scene, callbacks, plan) {
         }
 
-        void SingleThreadSolver::compute_propagation() {
+        template<typename T>
+        void SingleThreadSolver<T>::compute_propagation() {
             this->callback->Info("Starting simulation");
+            if (this->plan->Resume) {
+                this->load_checkpoint();
+            }
 
-            for (int frame = 0; frame < this->number_of_time_steps; frame++) {
+            for (int frame = this->first_frame; frame < this->number_of_time_steps; frame++) {
                 compute_timestep(frame);
+                if (this->has_decayed(frame)) {
+                    this->callback->Info("Energy decayed by " +
+                                         boost::lexical_cast<std::string>(this->settings->GetStopDecay()) +
+                                         " dB, stopping after frame " + boost::lexical_cast<std::string>(frame));
+                    break;
+                }
+                if (this->plan->CheckpointNth > 0 and (frame + 1) % this->plan->CheckpointNth == 0) {
+                    this->save_checkpoint(frame);
+                }
             }
+            this->finish_checkpoint();
+            this->write_reductions();
+            this->write_dft();
+            this->report_field_memory();
+            this->report_activity();
             this->callback->Info("Succesfully finished simulation");
         }
 
-        void SingleThreadSolver::compute_timestep(int frame)
+        template<typename T>
+        void SingleThreadSolver<T>::compute_timestep(int frame)
         {
-            for (auto domain:this->scene->domain_list) {
-                domain->push_values();
-                //std::cout << *domain << std::endl;
+            this->frame_energy = 0;
+            this->computed_frames++;
+            this->compute_time_level(frame, 0, frame);
+            this->write_frames(frame);
+            this->scene->apply_pml_matrices();
+            this->write_samples(frame);
+            for (auto source_callback : this->source_callbacks) {
+                source_callback->FinishFrame(frame);
             }
-            for (unsigned long rk_step = 0; rk_step < 6; rk_step++) {
-                compute_rk_step(frame, rk_step);
+            this->callback->Info("Finished frame: " + boost::lexical_cast<std::string>(frame));
+        }
+
+        template<typename T>
+        void SingleThreadSolver<T>::compute_time_level(int frame, unsigned long level, double time)
+        {
+            const typename Solver<T>::TimeLevel &time_level = this->time_levels.at(level);
+            bool finer = level + 1 < this->time_levels.size();
+            bool predicted = finer and time_level.borders_finer;
+            bool ends_frame = std::abs(time + 1.0 / time_level.substeps - (frame + 1)) < 1e-9;
+            std::vector<FieldValues<T>> start_values;
+            if (predicted) {
+                for (auto domain: time_level.domains) {
+                    start_values.push_back(domain->current_values);
+                }
             }
-            for (auto domain:this->scene->domain_list) {
-                if (frame % this->settings->GetSaveNth() == 0 and not domain->is_pml) {
-                    this->callback->WriteFrame(frame, domain->id, this->get_pressure_vector(domain));
+            this->step_time_level(frame, level, time, ends_frame and not predicted);
+            if (finer) {
+                int substeps = this->time_levels.at(level + 1).substeps;
+                for (int s = 0; s < substeps / time_level.substeps; s++) {
+                    this->compute_time_level(frame, level + 1, time + (double) s / substeps);
                 }
             }
-            this->scene->apply_pml_matrices();
-            for (auto receiver:this->scene->receiver_list) {
-                receiver->compute_local_pressure();
-                if (frame % this->settings->GetSaveNth() == 0) {
-                    this->callback->WriteSample(frame, (int) receiver->id, *this->get_receiver_pressure(receiver));
+            if (predicted) {
+                // the finer levels have caught up, so their fields are interpolated instead of extrapolated
+                for (unsigned long d = 0; d < time_level.domains.size(); d++) {
+                    time_level.domains[d]->current_values = start_values[d];
+                }
+                this->step_time_level(frame, level, time, ends_frame);
+            }
+        }
+
+        template<typename T>
+        void SingleThreadSolver<T>::step_time_level(int frame, unsigned long level, double time, bool final)
+        {
+            const typename Solver<T>::TimeLevel &time_level = this->time_levels.at(level);
+            bool multirate = this->time_levels.size() > 1;
+            double step = 1.0 / time_level.substeps;
+            this->stage_domains = time_level.domains;
+            this->final_step = final;
+            for (auto domain:time_level.domains) {
+                if (multirate and this->snapshots.count(domain->id) > 0) {
+                    this->store_snapshot(domain, time, frame);
+                }
+                if (!this->low_storage) {
+                    domain->push_values();
+                }
+            }
+            for (unsigned long rk_step = 0; rk_step < this->number_of_rk_stages(); rk_step++) {
+                if (multirate) {
+                    this->set_exchange_values(time_level, time + this->stage_times.at(rk_step) * step);
+                }
+                this->prepare_rk_step(rk_step);
+                compute_rk_step(frame, rk_step);
+            }
+            if (multirate) {
+                this->clear_exchange_values(time_level);
+                for (auto domain:time_level.domains) {
+                    if (this->snapshots.count(domain->id) > 0) {
+                        this->store_snapshot(domain, time + step, frame);
+                    }
                 }
             }
-            this->callback->Info("Finished frame: " + boost::lexical_cast<std::string>(frame));
         }
 
-        void SingleThreadSolver::compute_rk_step(int frame, int rk_step)
+        template<typename T>
+        void SingleThreadSolver<T>::compute_rk_step(int frame, int rk_step)
         {
             for (Kernel::CalcDirection calc_dir: Kernel::all_calc_directions) {
                 for (Kernel::CalculationType calc_type: Kernel::all_calculation_types) {
-                    for (auto domain:this->scene->domain_list) {
+                    for (auto domain:this->stage_domains) {
                         //std::cout << *domain << std::endl;
-                        if (not domain->is_rigid()) {
+                        if (this->needs_update(domain)) {
                             if (domain->should_update[calc_dir]) {
                                 domain->calc(calc_dir, calc_type);
                             }
@@ -106,17 +465,20 @@ namespace OpenPSTD {
                     }
                 }
             }
-            for (auto domain:this->scene->domain_list) {
-                if (not domain->is_rigid()) {
-                    this->update_field_values(domain, rk_step, frame);
+            for (auto domain:this->stage_domains) {
+                if (this->needs_update(domain)) {
+                    this->update_field_values(domain, rk_step);
                 }
             }
-            for (auto domain:this->scene->domain_list) {
-                domain->current_values.p0 = domain->current_values.px0 + domain->current_values.py0;
+            for (auto domain:this->stage_domains) {
+                if (domain->active) {
+                    this->update_pressure(domain, rk_step);
+                }
             }
         }
 
-        void MultiThreadSolver::compute_rk_step(int frame, int rk_step)
+        template<typename T>
+        void MultiThreadSolver<T>::compute_rk_step(int frame, int rk_step)
         {
             #pragma omp parallel
             {
@@ -124,11 +486,11 @@ namespace OpenPSTD {
                 {
                     for (Kernel::CalcDirection calc_dir: Kernel::all_calc_directions) {
                         for (Kernel::CalculationType calc_type: Kernel::all_calculation_types) {
-                            for (auto domain:this->scene->domain_list) {
+                            for (auto domain:this->stage_domains) {
                                 //std::cout << *domain << std::endl;
                                 #pragma omp task
                                 {
-                                    if (not domain->is_rigid()) {
+                                    if (this->needs_update(domain)) {
                                         if (domain->should_update[calc_dir]) {
                                             domain->calc(calc_dir, calc_type);
                                         }
@@ -140,45 +502,65 @@ namespace OpenPSTD {
                 }
             }
 
-            for (auto domain:this->scene->domain_list) {
-                if (not domain->is_rigid()) {
-                    this->update_field_values(domain, rk_step, frame);
+            for (auto domain:this->stage_domains) {
+                if (this->needs_update(domain)) {
+                    this->update_field_values(domain, rk_step);
                 }
             }
-            for (auto domain:this->scene->domain_list) {
-                domain->current_values.p0 = domain->current_values.px0 + domain->current_values.py0;
+            for (auto domain:this->stage_domains) {
+                if (domain->active) {
+                    this->update_pressure(domain, rk_step);
+                }
             }
         }
 
-        void GPUSingleThreadSolver::compute_propagation() {
+        template<typename T>
+        void GPUSingleThreadSolver<T>::compute_propagation() {
             this->callback->Error("!! GPU SOLVER NOT YET IMPLEMENTED !! ");
             //TODO
         }
-        void GPUMultiThreadSolver::compute_propagation() {
+        template<typename T>
+        void GPUMultiThreadSolver<T>::compute_propagation() {
             this->callback->Error("!! GPU+MCPU SOLVER NOT YET IMPLEMENTED !! ");
             //TODO
         }
 
-        void Solver::update_field_values(std::shared_ptr<Domain> domain, unsigned long rk_step,
-                                         unsigned long frame) { // frame is temp
-            float dt = this->settings->GetTimeStep();
-            float c1_square = this->settings->GetSoundSpeed() * this->settings->GetSoundSpeed();
-            std::vector<float> coefs = this->settings->GetRKCoefficients();
-            if (!domain->is_pml) {
-                //write_array_to_file(domain->current_values.px0+domain->current_values.py0, "pressure_tot", frame * 6 + rk_step);
-                //write_array_to_file(domain->current_values.px0, "pressure_x", frame * 6 + rk_step);
-                //write_array_to_file(domain->current_values.py0, "pressure_y", frame * 6 + rk_step);
-                //write_array_to_file(domain->current_values.vx0, "velocity_x", frame * 6 + rk_step);
-                //write_array_to_file(domain->current_values.vy0, "velocity_y", frame * 6 + rk_step);
-            }
-            domain->current_values.vx0 =
-                    domain->previous_values.vx0 - dt * coefs.at(rk_step) * (domain->l_values.Lpx / domain->rho);
-            domain->current_values.vy0 =
-                    domain->previous_values.vy0 - dt * coefs.at(rk_step) * (domain->l_values.Lpy / domain->rho);
-            domain->current_values.px0 = domain->previous_values.px0 - dt * coefs.at(rk_step) *
-                                                                       (domain->l_values.Lvx * domain->rho * c1_square);
-            domain->current_values.py0 = domain->previous_values.py0 - dt * coefs.at(rk_step) *
-                                                                       (domain->l_values.Lvy * domain->rho * c1_square);
+        template<typename T>
+        void Solver<T>::update_field_values(std::shared_ptr<Domain<T>> domain, unsigned long rk_step) {
+            T dt = this->settings->GetTimeStep() / this->get_substeps(domain);
+            T c1_square = this->settings->GetSoundSpeed() * this->settings->GetSoundSpeed();
+            // The energy of a time step is accumulated in the last stage, in the same pass as the update
+            T velocity_squares = 0;
+            T *square_sum = nullptr;
+            bool last_stage = rk_step + 1 == this->number_of_rk_stages() and this->final_step;
+            if (last_stage and !domain->is_pml) {
+                square_sum = &velocity_squares;
+            }
+            if (this->low_storage) {
+                // l_values hold the stage register D = A*D + L, the field update is u = u + B*dt*D
+                T factor = dt * (T) low_storage_rk_b.at(rk_step);
+                update_field<T>(domain->current_values.vx0, domain->current_values.vx0, domain->l_values.Lpx,
+                                factor / domain->rho, square_sum);
+                update_field<T>(domain->current_values.vy0, domain->current_values.vy0, domain->l_values.Lpy,
+                                factor / domain->rho, square_sum);
+                update_field<T>(domain->current_values.px0, domain->current_values.px0, domain->l_values.Lvx,
+                                factor * domain->rho * c1_square, nullptr);
+                update_field<T>(domain->current_values.py0, domain->current_values.py0, domain->l_values.Lvy,
+                                factor * domain->rho * c1_square, nullptr);
+            } else {
+                std::vector<float> coefs = this->settings->GetRKCoefficients();
+                T factor = dt * coefs.at(rk_step);
+                update_field<T>(domain->current_values.vx0, domain->previous_values.vx0, domain->l_values.Lpx,
+                                factor / domain->rho, square_sum);
+                update_field<T>(domain->current_values.vy0, domain->previous_values.vy0, domain->l_values.Lpy,
+                                factor / domain->rho, square_sum);
+                update_field<T>(domain->current_values.px0, domain->previous_values.px0, domain->l_values.Lvx,
+                                factor * domain->rho * c1_square, nullptr);
+                update_field<T>(domain->current_values.py0, domain->previous_values.py0, domain->l_values.Lvy,
+                                factor * domain->rho * c1_square, nullptr);
+            }
+            T dx = domain->get_grid_spacing();
+            this->frame_energy += velocity_squares * domain->rho / 2 * dx * dx;
 
             /*if (!domain->is_pml) {
                 this->callback->Callback(CALLBACKSTATUS::RUNNING, "Subframe " + boost::lexical_cast<std::string>(rk_step), 0);
@@ -205,21 +587,354 @@ namespace OpenPSTD {
             }*/
         }
 
-        PSTD_FRAME_PTR Solver::get_pressure_vector(std::shared_ptr<Domain> domain) {
+        template<typename T>
+        void Solver<T>::update_pressure(std::shared_ptr<Domain<T>> domain, unsigned long rk_step) {
+            T pressure_squares = 0;
+            T *square_sum = nullptr;
+            bool last_stage = rk_step + 1 == this->number_of_rk_stages() and this->final_step;
+            if (last_stage and !domain->is_pml) {
+                square_sum = &pressure_squares;
+            }
+            auto reduction = this->reductions.find(domain->id);
+            if (last_stage and !domain->is_pml and reduction != this->reductions.end()) {
+                // The reductions of a time step are updated in the same pass as its final pressure
+                T time = (this->computed_frames - 1) * this->settings->GetTimeStep();
+                add_fields_reduced<T>(domain->current_values.p0, domain->current_values.px0,
+                                      domain->current_values.py0, square_sum, reduction->second.peak,
+                                      reduction->second.squares, reduction->second.arrival, this->arrival_threshold,
+                                      time);
+            } else {
+                add_fields<T>(domain->current_values.p0, domain->current_values.px0, domain->current_values.py0,
+                              square_sum);
+            }
+            if (last_stage and !domain->is_pml) {
+                this->update_dft(domain);
+            }
+            T c1_square = this->settings->GetSoundSpeed() * this->settings->GetSoundSpeed();
+            T dx = domain->get_grid_spacing();
+            this->frame_energy += pressure_squares / (2 * domain->rho * c1_square) * dx * dx;
+        }
+
+        template<typename T>
+        void Solver<T>::update_dft(std::shared_ptr<Domain<T>> domain) {
+            auto accumulators = this->dft_accumulators.find(domain->id);
+            if (accumulators == this->dft_accumulators.end()) {
+                return;
+            }
+            // exp(-2 pi i f t) dt, the phase is computed in double precision to avoid drift in long simulations
+            double dt = this->settings->GetTimeStep();
+            double time = (this->computed_frames - 1) * dt;
+            std::vector<T> real_factors, imag_factors;
+            for (float frequency: this->plan->DFTFrequencies) {
+                double phase = 2 * M_PI * frequency * time;
+                real_factors.push_back((T) (std::cos(phase) * dt));
+                imag_factors.push_back((T) (-std::sin(phase) * dt));
+            }
+            accumulate_dft<T>(accumulators->second.real, accumulators->second.imag, domain->current_values.p0,
+                              real_factors, imag_factors);
+        }
+
+        template<typename T>
+        PSTD_FRAME_PTR Solver<T>::get_pressure_vector(std::shared_ptr<Domain<T>> domain,
+                                                      const DomainOutputPlan &output, int source) {
+            return this->get_output_vector(domain->current_values.p0, domain, output, source);
+        }
+
+        template<typename T>
+        PSTD_FRAME_PTR Solver<T>::get_output_vector(const ArrayXXT<T> &field, std::shared_ptr<Domain<T>> domain,
+                                                    const DomainOutputPlan &output, int source) {
+            auto block = domain->get_source_block(field, source);
+            std::vector<int> region = output.GetRegion(domain->cells.x, domain->cells.y);
+            int step = std::max(output.Decimation, 1);
             auto aligned_pressure = std::make_shared<PSTD_FRAME>();
-            aligned_pressure->reserve((unsigned long) domain->size.x * domain->size.y);
-            for (unsigned long i=0;i<domain->size.y;i++) {
-                for (unsigned long j=0;j<domain->size.x;j++) {
-                    aligned_pressure->push_back(domain->current_values.p0(i,j));
+            aligned_pressure->reserve((unsigned long) output.GetFrameSize(domain->cells.x, domain->cells.y));
+            for (int i = region[1]; i < region[3]; i += step) {
+                for (int j = region[0]; j < region[2]; j += step) {
+                    aligned_pressure->push_back((PSTD_FRAME_UNIT) block(i,j));
                 }
             }
             return aligned_pressure;
         }
 
-        PSTD_FRAME_PTR Solver::get_receiver_pressure(std::shared_ptr<Receiver> receiver) {
-            auto pressure_vector = std::make_shared<PSTD_FRAME>();
-            pressure_vector->push_back(receiver->received_values.back());
-            return pressure_vector;
+        template<typename T>
+        void Solver<T>::write_frames(int frame) {
+            for (auto domain:this->scene->domain_list) {
+                if (domain->is_pml) {
+                    continue;
+                }
+                DomainOutputPlan output = this->plan->GetDomainOutput(domain->id);
+                if (output.IsFrameSaved(frame)) {
+                    for (int s = 0; s < (int) this->source_callbacks.size(); s++) {
+                        if (domain->active) {
+                            this->source_callbacks[s]->WriteFrame(frame, domain->id,
+                                                                  this->get_pressure_vector(domain, output, s));
+                        } else {
+                            this->source_callbacks[s]->WriteFrame(frame, domain->id,
+                                                                  this->get_zero_frame(domain, output));
+                        }
+                    }
+                    this->written_frames[domain->id]++;
+                }
+            }
+        }
+
+        template<typename T>
+        void Solver<T>::write_reductions() {
+            for (auto domain:this->scene->domain_list) {
+                auto reduction = this->reductions.find(domain->id);
+                if (domain->is_pml or reduction == this->reductions.end()) {
+                    continue;
+                }
+                DomainOutputPlan output = this->plan->GetDomainOutput(domain->id);
+                ArrayXXT<T> rms = (reduction->second.squares / (T) std::max(this->computed_frames, 1)).sqrt();
+                for (int s = 0; s < (int) this->source_callbacks.size(); s++) {
+                    auto source_callback = this->source_callbacks[s];
+                    source_callback->WriteReduction(domain->id, FIELD_REDUCTION::PEAK,
+                                                    this->get_output_vector(reduction->second.peak, domain, output, s));
+                    source_callback->WriteReduction(domain->id, FIELD_REDUCTION::RMS,
+                                                    this->get_output_vector(rms, domain, output, s));
+                    source_callback->WriteReduction(domain->id, FIELD_REDUCTION::ARRIVAL,
+                                                    this->get_output_vector(reduction->second.arrival, domain,
+                                                                            output, s));
+                }
+            }
+        }
+
+        template<typename T>
+        void Solver<T>::write_dft() {
+            for (auto domain:this->scene->domain_list) {
+                auto accumulators = this->dft_accumulators.find(domain->id);
+                if (domain->is_pml or accumulators == this->dft_accumulators.end()) {
+                    continue;
+                }
+                DomainOutputPlan output = this->plan->GetDomainOutput(domain->id);
+                for (unsigned long k = 0; k < accumulators->second.real.size(); k++) {
+                    for (int s = 0; s < (int) this->source_callbacks.size(); s++) {
+                        PSTD_FRAME_PTR real = this->get_output_vector(accumulators->second.real.at(k), domain,
+                                                                      output, s);
+                        PSTD_FRAME_PTR imag = this->get_output_vector(accumulators->second.imag.at(k), domain,
+                                                                      output, s);
+                        auto data = std::make_shared<PSTD_FRAME>();
+                        data->reserve(2 * real->size());
+                        for (unsigned long i = 0; i < real->size(); i++) {
+                            data->push_back(real->at(i));
+                            data->push_back(imag->at(i));
+                        }
+                        this->source_callbacks[s]->WriteDFT(domain->id, (int) k, this->plan->DFTFrequencies.at(k),
+                                                            data);
+                    }
+                }
+            }
+        }
+
+        template<typename T>
+        void Solver<T>::write_samples(int frame) {
+            for (auto receiver:this->scene->receiver_list) {
+                // Receivers are interpolated only when their samples are requested
+                if (this->plan->IsReceiverSaved((int) receiver->id, frame)) {
+                    for (int s = 0; s < (int) this->source_callbacks.size(); s++) {
+                        T pressure = receiver->compute_local_pressure(s);
+                        this->source_callbacks[s]->WriteSample(frame, (int) receiver->id,
+                                                               {(PSTD_FRAME_UNIT) pressure});
+                    }
+                    this->written_samples[(int) receiver->id]++;
+                }
+            }
         }
+
+        template<typename T>
+        void Solver<T>::save_checkpoint(int frame) {
+            this->finish_checkpoint();
+            auto buffer = std::make_shared<CheckpointBuffer>();
+            CheckpointPosition position;
+            position.Frame = frame;
+            position.ScalarSize = sizeof(T);
+            position.DomainFrames = this->written_frames;
+            position.ReceiverSamples = this->written_samples;
+            position.Write(*buffer);
+            this->write_state(*buffer);
+            // The checkpoint refers to the results up to this frame, so they have to be stored first
+            for (auto source_callback : this->source_callbacks) {
+                source_callback->WriteCheckpoint(frame);
+            }
+
+            std::string path = this->plan->CheckpointFile;
+            this->checkpoint_writer = std::thread([this, buffer, path]() {
+                try {
+                    buffer->save(path);
+                } catch (CheckpointException &e) {
+                    this->checkpoint_error = e.what();
+                }
+            });
+        }
+
+        template<typename T>
+        void Solver<T>::finish_checkpoint() {
+            if (this->checkpoint_writer.joinable()) {
+                this->checkpoint_writer.join();
+            }
+            if (!this->checkpoint_error.empty()) {
+                this->callback->Error(this->checkpoint_error);
+                this->checkpoint_error.clear();
+            }
+        }
+
+        template<typename T>
+        void Solver<T>::load_checkpoint() {
+            auto buffer = CheckpointBuffer::load(this->plan->CheckpointFile);
+            CheckpointPosition position = CheckpointPosition::Read(*buffer);
+            if (position.ScalarSize != sizeof(T)) {
+                throw CheckpointException("The checkpoint was written by a kernel with a different precision");
+            }
+            this->read_state(*buffer);
+            this->written_frames = position.DomainFrames;
+            this->written_samples = position.ReceiverSamples;
+            this->first_frame = position.Frame + 1;
+            this->callback->Info("Resuming simulation after frame " + boost::lexical_cast<std::string>(position.Frame));
+        }
+
+        template<typename T>
+        void Solver<T>::write_state(CheckpointBuffer &buffer) {
+            buffer.write<int>(this->computed_frames);
+            buffer.write<T>(this->peak_energy);
+            buffer.write<int>(this->decayed_frames);
+            buffer.write<unsigned long>(this->skipped_updates);
+            buffer.write<unsigned long>(this->performed_updates);
+
+            // At the start of a time step only the current values are needed, the previous values and the
+            // stage register of the low-storage scheme are overwritten before they are read.
+            buffer.write<unsigned long>(this->scene->domain_list.size());
+            for (auto domain:this->scene->domain_list) {
+                buffer.write<bool>(domain->active);
+                buffer.write_array<T>(domain->current_values.vx0);
+                buffer.write_array<T>(domain->current_values.vy0);
+                buffer.write_array<T>(domain->current_values.p0);
+                buffer.write_array<T>(domain->current_values.px0);
+                buffer.write_array<T>(domain->current_values.py0);
+            }
+
+            // The neighbours of another time level interpolate the snapshots of the previous time steps
+            buffer.write<unsigned long>(this->snapshots.size());
+            for (auto &domain_snapshots: this->snapshots) {
+                buffer.write<int>(domain_snapshots.first);
+                buffer.write<unsigned long>(domain_snapshots.second.size());
+                for (const FieldSnapshot &snapshot: domain_snapshots.second) {
+                    buffer.write<double>(snapshot.time);
+                    buffer.write_array<T>(snapshot.values.p0);
+                    buffer.write_array<T>(snapshot.values.vx0);
+                    buffer.write_array<T>(snapshot.values.vy0);
+                }
+            }
+
+            buffer.write<unsigned long>(this->scene->receiver_list.size());
+            for (auto receiver:this->scene->receiver_list) {
+                buffer.write_vector<T>(receiver->received_values);
+            }
+
+            buffer.write<unsigned long>(this->reductions.size());
+            for (auto &reduction: this->reductions) {
+                buffer.write<int>(reduction.first);
+                buffer.write_array<T>(reduction.second.peak);
+                buffer.write_array<T>(reduction.second.squares);
+                buffer.write_array<T>(reduction.second.arrival);
+            }
+
+            buffer.write_vector<float>(this->plan->DFTFrequencies);
+            for (auto &accumulators: this->dft_accumulators) {
+                buffer.write<int>(accumulators.first);
+                for (unsigned long k = 0; k < accumulators.second.real.size(); k++) {
+                    buffer.write_array<T>(accumulators.second.real.at(k));
+                    buffer.write_array<T>(accumulators.second.imag.at(k));
+                }
+            }
+        }
+
+        template<typename T>
+        void Solver<T>::read_state(CheckpointBuffer &buffer) {
+            this->computed_frames = buffer.read<int>();
+            this->peak_energy = buffer.read<T>();
+            this->decayed_frames = buffer.read<int>();
+            this->skipped_updates = buffer.read<unsigned long>();
+            this->performed_updates = buffer.read<unsigned long>();
+
+            if (buffer.read<unsigned long>() != this->scene->domain_list.size()) {
+                throw CheckpointException("The checkpoint does not match the scene");
+            }
+            for (auto domain:this->scene->domain_list) {
+                domain->active = buffer.read<bool>();
+                buffer.read_array<T>(domain->current_values.vx0);
+                buffer.read_array<T>(domain->current_values.vy0);
+                buffer.read_array<T>(domain->current_values.p0);
+                buffer.read_array<T>(domain->current_values.px0);
+                buffer.read_array<T>(domain->current_values.py0);
+            }
+
+            if (buffer.read<unsigned long>() != this->snapshots.size()) {
+                throw CheckpointException("The checkpoint does not match the scene");
+            }
+            for (auto &domain_snapshots: this->snapshots) {
+                if (buffer.read<int>() != domain_snapshots.first) {
+                    throw CheckpointException("The checkpoint does not match the scene");
+                }
+                auto domain = std::find_if(this->scene->domain_list.begin(), this->scene->domain_list.end(),
+                                           [&domain_snapshots](std::shared_ptr<Domain<T>> other) {
+                                               return other->id == domain_snapshots.first;
+                                           });
+                domain_snapshots.second.resize(buffer.read<unsigned long>());
+                for (FieldSnapshot &snapshot: domain_snapshots.second) {
+                    snapshot.time = buffer.read<double>();
+                    // the arrays get the dimensions of the fields of the domain, which read_array checks
+                    snapshot.values.p0 = (*domain)->current_values.p0;
+                    snapshot.values.vx0 = (*domain)->current_values.vx0;
+                    snapshot.values.vy0 = (*domain)->current_values.vy0;
+                    buffer.read_array<T>(snapshot.values.p0);
+                    buffer.read_array<T>(snapshot.values.vx0);
+                    buffer.read_array<T>(snapshot.values.vy0);
+                }
+            }
+
+            if (buffer.read<unsigned long>() != this->scene->receiver_list.size()) {
+                throw CheckpointException("The checkpoint does not match the scene");
+            }
+            for (auto receiver:this->scene->receiver_list) {
+                receiver->received_values = buffer.read_vector<T>();
+            }
+
+            if (buffer.read<unsigned long>() != this->reductions.size()) {
+                throw CheckpointException("The checkpoint was written with different reductions");
+            }
+            for (auto &reduction: this->reductions) {
+                if (buffer.read<int>() != reduction.first) {
+                    throw CheckpointException("The checkpoint was written with different reductions");
+                }
+                buffer.read_array<T>(reduction.second.peak);
+                buffer.read_array<T>(reduction.second.squares);
+                buffer.read_array<T>(reduction.second.arrival);
+            }
+
+            if (buffer.read_vector<float>() != this->plan->DFTFrequencies) {
+                throw CheckpointException("The checkpoint was written with different DFT frequencies");
+            }
+            for (auto &accumulators: this->dft_accumulators) {
+                if (buffer.read<int>() != accumulators.first) {
+                    throw CheckpointException("The checkpoint was written with different DFT frequencies");
+                }
+                for (unsigned long k = 0; k < accumulators.second.real.size(); k++) {
+                    buffer.read_array<T>(accumulators.second.real.at(k));
+                    buffer.read_array<T>(accumulators.second.imag.at(k));
+                }
+            }
+        }
+
+        template class Solver<float>;
+        template class Solver<double>;
+        template class SingleThreadSolver<float>;
+        template class SingleThreadSolver<double>;
+        template class MultiThreadSolver<float>;
+        template class MultiThreadSolver<double>;
+        template class GPUSingleThreadSolver<float>;
+        template class GPUSingleThreadSolver<double>;
+        template class GPUMultiThreadSolver<float>;
+        template class GPUMultiThreadSolver<double>;
     }
 }
@@ -36,7 +36,11 @@
 #include "KernelInterface.h"
 #include "core/Scene.h"
 #include "PSTDKernel.h"
+#include "Checkpoint.h"
 #include <fftw3.h>
+#include <thread>
+#include <map>
+#include <vector>
 
 namespace OpenPSTD {
     namespace Kernel {
@@ -48,43 +52,319 @@ namespace OpenPSTD {
          * Based on the settings and the scene, the solver repeatedly executes the
          * PSTD method to approximate the pressure and velocity.
          * The time integration is performed with a RK6 method described in <paper>.
+         * @tparam T: scalar type of the field values (float or double)
          */
+        template<typename T>
         class Solver {
         protected:
             /// Parameters and settings
             std::shared_ptr<PSTDSettings> settings;
             /// Scene (initialized before passed to the solver)
-            std::shared_ptr<Scene> scene;
+            std::shared_ptr<Scene<T>> scene;
 
+            /// Callback for the log and the results of the first source
             std::shared_ptr<KernelCallback> callback;
+            /// Callbacks for the results of every source, in the order of the sources
+            std::vector<std::shared_ptr<KernelCallback>> source_callbacks;
+            /// Results that have to be written
+            std::shared_ptr<OutputPlan> plan;
             /**
              * The final number of computed frames
              */
             int number_of_time_steps;
 
+            /**
+             * Whether the time integration uses the low-storage (2N-register) RK scheme
+             * @see low_storage_rk_a
+             */
+            bool low_storage;
+
+            /**
+             * Absolute amplitude above which the field near an edge activates the neighbouring domain,
+             * 0 if all domains are always active
+             */
+            T activity_threshold;
+
+            /**
+             * Number of domain updates (RK stages) that were skipped and performed
+             */
+            unsigned long skipped_updates, performed_updates;
+
+            /**
+             * Activate the inactive domains that border on an active domain
+             * with a non-zero halo (above the activity threshold)
+             */
+            void update_activity();
+
+            /**
+             * Whether the solver has to compute the domain
+             */
+            bool needs_update(std::shared_ptr<Domain<T>> domain);
+
+            /**
+             * Frame of zeros with the size of the domain, shared by all output of inactive domains
+             */
+            PSTD_FRAME_PTR get_zero_frame(std::shared_ptr<Domain<T>> domain, const DomainOutputPlan &output);
+
+            /**
+             * Total acoustic energy of the non-PML domains, accumulated during the last RK stage of a time step
+             */
+            T frame_energy;
+
+            /**
+             * Largest frame energy so far and the number of consecutive frames it has been decayed
+             * by more than the stop decay
+             */
+            T peak_energy;
+            int decayed_frames;
+
+            /**
+             * Report the energy of the last time step and check the stop criterion
+             * @return true if the energy has decayed long enough to stop the simulation
+             */
+            bool has_decayed(int frame);
+
+            /**
+             * Per-cell reductions of the pressure of a domain over the computed time steps
+             * @see FIELD_REDUCTION
+             */
+            struct FieldReductions {
+                ArrayXXT<T> peak;
+                ArrayXXT<T> squares;
+                ArrayXXT<T> arrival;
+            };
+
+            /**
+             * Reductions of the non-PML domains by domain identifier, empty if the output plan does not request them
+             */
+            std::map<int, FieldReductions> reductions;
+
+            /**
+             * Absolute pressure at which the sound has arrived in a cell
+             */
+            T arrival_threshold;
+
+            /**
+             * Number of time steps that have been started
+             */
+            int computed_frames;
+
+            /**
+             * Write the reductions of all domains, at the end of the simulation
+             */
+            void write_reductions();
+
+            /**
+             * Running DFT of the pressure of a domain, one real and one imaginary array per frequency of the output plan
+             */
+            struct DFTAccumulators {
+                std::vector<ArrayXXT<T>> real;
+                std::vector<ArrayXXT<T>> imag;
+            };
+
+            /**
+             * DFT accumulators of the non-PML domains by domain identifier, empty if no frequencies are requested
+             */
+            std::map<int, DFTAccumulators> dft_accumulators;
+
+            /**
+             * Add the pressure of the current time step to the DFT accumulators of the domain
+             */
+            void update_dft(std::shared_ptr<Domain<T>> domain);
+
+            /**
+             * Write the DFT of all domains and frequencies, at the end of the simulation
+             */
+            void write_dft();
+
+            /**
+             * Number of stages of the RK scheme in use
+             */
+            unsigned long number_of_rk_stages();
+
+            /**
+             * Domains that take time steps of the same length. A domain with a refined grid takes as many time
+             * steps as its refinement in one time step of the scene (the time step of the settings), the PML
+             * domains take the time step of the scene.
+             */
+            struct TimeLevel {
+                /// Number of time steps of the domains in one time step of the scene
+                int substeps;
+                /// Domains of the level
+                std::vector<std::shared_ptr<Domain<T>>> domains;
+                /// Domains of other levels that border on a domain of this level
+                std::vector<std::shared_ptr<Domain<T>>> neighbours;
+                /// Whether a domain of a finer level borders on a domain of this level
+                bool borders_finer;
+            };
+
+            /**
+             * The time levels from the coarsest to the finest time step, a single level if no grid is refined
+             */
+            std::vector<TimeLevel> time_levels;
+
+            /**
+             * Domains that take part in the current RK stages, the domains of the time level that is computed
+             */
+            std::vector<std::shared_ptr<Domain<T>>> stage_domains;
+
+            /**
+             * Whether the current time step of the stage domains is the last one that ends the time step of the
+             * scene, after which the energy, reductions and DFT are updated
+             */
+            bool final_step;
+
+            /**
+             * Fractions of a time step at which the RK stages evaluate the spatial derivatives
+             */
+            std::vector<double> stage_times;
+
+            /**
+             * Pressure and velocities of a domain at a time, in time steps of the scene
+             */
+            struct FieldSnapshot {
+                double time;
+                FieldValues<T> values;
+            };
+
+            /**
+             * Recent snapshots of the domains that border on a domain of another time level, by domain identifier
+             * and in order of time. Their neighbours interpolate them in time at the interface.
+             */
+            std::map<int, std::vector<FieldSnapshot>> snapshots;
+
+            /**
+             * Number of time steps that a domain takes in one time step of the scene
+             */
+            int get_substeps(std::shared_ptr<Domain<T>> domain);
+
+            /**
+             * Store a snapshot of the current fields of a domain, replacing a snapshot at the same time.
+             * Snapshots older than one time step of the scene before the frame are dropped.
+             */
+            void store_snapshot(std::shared_ptr<Domain<T>> domain, double time, int frame);
+
+            /**
+             * Interpolate the neighbours of a time level to a time and let the level read the interpolation.
+             * The quadratic through the three snapshots closest to the time is used.
+             */
+            void set_exchange_values(const TimeLevel &level, double time);
+
+            /**
+             * Let the domains that border on a time level read their own fields again
+             */
+            void clear_exchange_values(const TimeLevel &level);
+
+            /**
+             * Prepare the domains for a RK stage. For the low-storage scheme the derivatives of
+             * the previous stage are kept in l_values and scaled when the new derivatives are added.
+             * @param rk_step: sub-step of the RK method
+             */
+            void prepare_rk_step(unsigned long rk_step);
+
             /**
              * Updates the pressure and velocity fields of the domains to the new values computed in the RK scheme
              * @param domain: Domain under consideration
              * @param rk_step: sub-step of RK6 method
              */
-            void update_field_values(std::shared_ptr<Domain> domain, unsigned long rk_step, unsigned long frame);
+            void update_field_values(std::shared_ptr<Domain<T>> domain, unsigned long rk_step);
 
             /**
-             * The GUI format for pressure fields
+             * Computes the pressure from its x and y components after the update of the field values
+             * @param domain: Domain under consideration
+             * @param rk_step: sub-step of the RK method
+             */
+            void update_pressure(std::shared_ptr<Domain<T>> domain, unsigned long rk_step);
+
+            /**
+             * Log the memory that is allocated for the fields of all domains
+             */
+            void report_field_memory();
+
+            /**
+             * Log how much of the work was skipped for domains that the sound had not reached yet
+             */
+            void report_activity();
+
+            /**
+             * The GUI format for the pressure field of a source, restricted to the region and decimation of the output plan
              * @return PSTD_FRAME (shared pointer to float vector)
              */
-            PSTD_FRAME_PTR get_pressure_vector(std::shared_ptr<Domain> domain);
+            PSTD_FRAME_PTR get_pressure_vector(std::shared_ptr<Domain<T>> domain, const DomainOutputPlan &output,
+                                               int source);
+
+            /**
+             * The values of a source in a field of the domain in the GUI format,
+             * restricted to the region and decimation of the output plan
+             */
+            PSTD_FRAME_PTR get_output_vector(const ArrayXXT<T> &field, std::shared_ptr<Domain<T>> domain,
+                                             const DomainOutputPlan &output, int source);
 
-            PSTD_FRAME_PTR get_receiver_pressure(std::shared_ptr<Receiver> receiver);
+            /**
+             * Write the frames that the output plan requests for a time step
+             */
+            void write_frames(int frame);
+
+            /**
+             * Compute and write the receiver samples that the output plan requests for a time step
+             */
+            void write_samples(int frame);
+
+
+            /**
+             * Number of frames written per domain and of samples written per receiver, stored in checkpoints
+             */
+            std::map<int, int> written_frames, written_samples;
+
+            /**
+             * First time step to compute, the step after the checkpoint when the simulation is resumed
+             */
+            int first_frame;
+
+            /**
+             * Store the state after a time step in the checkpoint file of the output plan.
+             * The state is copied synchronously, the file is written in the background.
+             */
+            void save_checkpoint(int frame);
+
+            /**
+             * Restore the state of the checkpoint file of the output plan and continue after its time step
+             */
+            void load_checkpoint();
+
+            /**
+             * Wait until the checkpoint that is being written in the background is complete
+             */
+            void finish_checkpoint();
+
+            /**
+             * Serialize the fields of the scene and the position of the solver
+             */
+            void write_state(CheckpointBuffer &buffer);
+
+            /**
+             * Restore the state written by write_state
+             * @throws CheckpointException if the state does not belong to this scene and output plan
+             */
+            void read_state(CheckpointBuffer &buffer);
+
+        private:
+            std::map<int, PSTD_FRAME_PTR> zero_frames;
+            std::thread checkpoint_writer;
+            std::string checkpoint_error;
 
         public:
             /**
              * Solver constructor (abstract). Initialized parameters for running the openPSTD algorithm
              * @param scene: Pointer to scene object.
-             * @param callback: Pointer to callback function
+             * @param callbacks: Pointers to the callbacks of every source, the first one is also used for logging
+             * @param plan: Results that have to be written
              * @return: New solver object.
              */
-            Solver(std::shared_ptr<Scene> scene, std::shared_ptr<KernelCallback> callback);
+            Solver(std::shared_ptr<Scene<T>> scene, std::vector<std::shared_ptr<KernelCallback>> callbacks,
+                   std::shared_ptr<OutputPlan> plan);
+
+            virtual ~Solver();
 
             /**
              * Start the simulation solver.
@@ -97,13 +377,16 @@ namespace OpenPSTD {
         /**
          * Default singlethreaded solver.
          */
-        class SingleThreadSolver : public Solver {
+        template<typename T>
+        class SingleThreadSolver : public Solver<T> {
         public:
             /**
              * Default constructor. Blocking call: will not return before the solver is done.
              * @see Solver
              */
-            SingleThreadSolver(std::shared_ptr<Scene> scene, std::shared_ptr<KernelCallback> callback);
+            SingleThreadSolver(std::shared_ptr<Scene<T>> scene,
+                               std::vector<std::shared_ptr<KernelCallback>> callbacks,
+                               std::shared_ptr<OutputPlan> plan);
 
             /**
              * Single threaded implementation of the simulation solver
@@ -121,18 +404,37 @@ namespace OpenPSTD {
              * @param rk_step
              */
             virtual void compute_rk_step(int frame, int rk_step);
+
+            /**
+             * Compute one time step of a time level and, recursively, the time steps of the finer levels that
+             * it contains. A level that borders on a finer level is first predicted with the extrapolated fields
+             * of the finer level and computed again when the finer level has caught up.
+             * @param frame: time step of the scene
+             * @param level: index of the time level
+             * @param time: start of the time step, in time steps of the scene
+             */
+            void compute_time_level(int frame, unsigned long level, double time);
+
+            /**
+             * Compute the RK stages of one time step of the domains of a time level
+             * @param final: whether this is the last time step that ends the time step of the scene
+             */
+            void step_time_level(int frame, unsigned long level, double time, bool final);
         };
 
         /**
          * Solver that exploits the multiple CPU cores of a machine
          */
-        class MultiThreadSolver : public SingleThreadSolver {
+        template<typename T>
+        class MultiThreadSolver : public SingleThreadSolver<T> {
         public:
             /**
              * Multithreaded solver. This instance employs multiple CPU's
              * @see Solver
              */
-            MultiThreadSolver(std::shared_ptr<Scene> scene, std::shared_ptr<KernelCallback> callback);
+            MultiThreadSolver(std::shared_ptr<Scene<T>> scene,
+                              std::vector<std::shared_ptr<KernelCallback>> callbacks,
+                              std::shared_ptr<OutputPlan> plan);
 
             void compute_rk_step(int frame, int rk_step) override;
         };
@@ -140,13 +442,16 @@ namespace OpenPSTD {
         /**
          * Solver that performs the computational intensive parts on a GPU
          */
-        class GPUSingleThreadSolver : public Solver {
+        template<typename T>
+        class GPUSingleThreadSolver : public Solver<T> {
         public:
             /**
              * GPU solver. This instance runs the PSTD computations on the graphics card
              * @see Solver
              */
-            GPUSingleThreadSolver(std::shared_ptr<Scene> scene, std::shared_ptr<KernelCallback> callback);
+            GPUSingleThreadSolver(std::shared_ptr<Scene<T>> scene,
+                                  std::vector<std::shared_ptr<KernelCallback>> callbacks,
+                                  std::shared_ptr<OutputPlan> plan);
 
             /**
              * GPU-enabled implementation of the simulation solver
@@ -157,13 +462,16 @@ namespace OpenPSTD {
         /**
          * Solver that both utilized multiple cores and the GPU
          */
-        class GPUMultiThreadSolver : public Solver {
+        template<typename T>
+        class GPUMultiThreadSolver : public Solver<T> {
         public:
             /**
              * Multithreaded GPU solver. This instance employs both multiple CPU's as well as the graphics card.
              * @see Solver
              */
-            GPUMultiThreadSolver(std::shared_ptr<Scene> scene, std::shared_ptr<KernelCallback> callback);
+            GPUMultiThreadSolver(std::shared_ptr<Scene<T>> scene,
+                                 std::vector<std::shared_ptr<KernelCallback>> callbacks,
+                                 std::shared_ptr<OutputPlan> plan);
 
             /**
              * GPU-enabled and multi-threaded implementation of the simulation solver
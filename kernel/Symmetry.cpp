@@ -0,0 +1,265 @@
+//////////////////////////////////////////////////////////////////////////
+// This file is part of openPSTD.                                       //
+//                                                                      //
+// openPSTD is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU General Public License as published by //
+// the Free Software Foundation, either version 3 of the License, or    //
+// (at your option) any later version.                                  //
+//                                                                      //
+// openPSTD is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of       //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        //
+// GNU General Public License for more details.                         //
+//                                                                      //
+// You should have received a copy of the GNU General Public License    //
+// along with openPSTD.  If not, see <http://www.gnu.org/licenses/>.    //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Date:
+//      18-10-2026
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "Symmetry.h"
+#include <cmath>
+#include <stdexcept>
+#include "core/kernel_functions.h"
+
+namespace OpenPSTD {
+    namespace Kernel {
+
+        SymmetricScene::SymmetricScene(std::shared_ptr<PSTDConfiguration> config) {
+            if (!config->IsSymmetric(config->Symmetry, config->SymmetryPlane)) {
+                throw std::invalid_argument("The scene is not mirror-symmetric about its symmetry plane");
+            }
+            this->symmetry = config->Symmetry;
+            bool x_axis = this->symmetry == PSTD_SYMMETRY::X;
+            float dx = config->Settings.GetGridSpacing();
+            this->plane = (int) std::lround(config->SymmetryPlane / dx);
+
+            this->half = std::make_shared<PSTDConfiguration>(*config);
+            this->half->Symmetry = PSTD_SYMMETRY::NONE;
+            this->half->SymmetryPlane = 0;
+            this->half->Domains.clear();
+            this->half->Speakers.clear();
+            this->half->Receivers.clear();
+
+            DomainConfEdge rigid;
+            rigid.Absorption = 0;
+            rigid.LR = false;
+            for (unsigned long i = 0; i < config->Domains.size(); i++) {
+                DomainConf domain = config->Domains.at(i);
+                float start = x_axis ? domain.TopLeft.x() : domain.TopLeft.y();
+                float size = x_axis ? domain.Size.x() : domain.Size.y();
+                int grid_start = (int) std::lround(start / dx);
+                int grid_end = (int) std::lround((start + size) / dx);
+
+                MirroredDomain mirrored_domain;
+                mirrored_domain.HalfDomain = -1;
+                mirrored_domain.Mirrored = grid_start >= this->plane;
+                mirrored_domain.Unfolded = grid_start < this->plane && grid_end > this->plane;
+                mirrored_domain.Width = (int) std::lround(domain.Size.x() / dx) * domain.Refinement;
+                mirrored_domain.Height = (int) std::lround(domain.Size.y() / dx) * domain.Refinement;
+                mirrored_domain.Left = (int) std::lround(domain.TopLeft.x() / dx);
+                mirrored_domain.Top = (int) std::lround(domain.TopLeft.y() / dx);
+                if (!mirrored_domain.Mirrored) {
+                    if (grid_end >= this->plane) {
+                        // The top edge of the configuration is the edge with the highest y (the kernel swaps T and B)
+                        if (x_axis) {
+                            domain.Size.setX((this->plane - grid_start) * dx);
+                            domain.R = rigid;
+                        } else {
+                            domain.Size.setY((this->plane - grid_start) * dx);
+                            domain.T = rigid;
+                        }
+                    }
+                    mirrored_domain.HalfDomain = (int) this->half->Domains.size();
+                    this->half->Domains.push_back(domain);
+                }
+                this->domains.push_back(mirrored_domain);
+            }
+
+            // The domains behind the plane are the mirror images of domains before it
+            for (unsigned long i = 0; i < config->Domains.size(); i++) {
+                if (!this->domains.at(i).Mirrored) {
+                    continue;
+                }
+                DomainConf mirror = config->Domains.at(i).Mirror(this->symmetry, config->SymmetryPlane);
+                for (unsigned long j = 0; j < config->Domains.size(); j++) {
+                    QVector2D offset = config->Domains.at(j).TopLeft - mirror.TopLeft;
+                    if (!this->domains.at(j).Mirrored && std::abs(offset.x()) < GRID_SPACING_TOLERANCE &&
+                        std::abs(offset.y()) < GRID_SPACING_TOLERANCE) {
+                        this->domains.at(i).HalfDomain = this->domains.at(j).HalfDomain;
+                    }
+                }
+            }
+
+            for (QVector3D speaker: config->Speakers) {
+                float position = x_axis ? speaker.x() : speaker.y();
+                if (position < config->SymmetryPlane + GRID_SPACING_TOLERANCE) {
+                    this->half->Speakers.push_back(speaker);
+                }
+            }
+            for (QVector3D receiver: config->Receivers) {
+                if (x_axis && receiver.x() > config->SymmetryPlane) {
+                    receiver.setX(2 * config->SymmetryPlane - receiver.x());
+                } else if (!x_axis && receiver.y() > config->SymmetryPlane) {
+                    receiver.setY(2 * config->SymmetryPlane - receiver.y());
+                }
+                this->half->Receivers.push_back(receiver);
+            }
+        }
+
+        std::shared_ptr<PSTDConfiguration> SymmetricScene::GetHalfConfiguration() const {
+            return this->half;
+        }
+
+        const std::vector<MirroredDomain> &SymmetricScene::GetDomains() const {
+            return this->domains;
+        }
+
+        std::shared_ptr<OutputPlan> SymmetricScene::CreateHalfPlan(std::shared_ptr<OutputPlan> plan) const {
+            if (plan->CheckpointNth > 0 || plan->Resume) {
+                throw std::invalid_argument("Checkpoints are not supported for symmetric scenes");
+            }
+            auto result = std::make_shared<OutputPlan>(*plan);
+            DomainOutputPlan complete;
+            complete.SaveNth = 0;
+            complete.Decimation = 1;
+            complete.RegionX = complete.RegionY = complete.RegionWidth = complete.RegionHeight = 0;
+            result->DefaultDomainOutput = complete;
+            result->DomainOutput.clear();
+            for (int k = 0; k < (int) this->half->Domains.size(); k++) {
+                // A frame is needed in every multiple of the save interval of one of the domains
+                int save_nth = 0;
+                for (unsigned long i = 0; i < this->domains.size(); i++) {
+                    int domain_nth = plan->GetDomainOutput((int) i).SaveNth;
+                    if (this->domains.at(i).HalfDomain != k || domain_nth <= 0) {
+                        continue;
+                    }
+                    int a = save_nth, b = domain_nth;
+                    while (a != 0) {
+                        int remainder = b % a;
+                        b = a;
+                        a = remainder;
+                    }
+                    save_nth = b;
+                }
+                result->DomainOutput[k] = complete;
+                result->DomainOutput[k].SaveNth = save_nth;
+            }
+            return result;
+        }
+
+        PSTD_FRAME_PTR SymmetricScene::Reconstruct(int domain, const PSTD_FRAME &half, int values,
+                                                   const DomainOutputPlan &output) const {
+            const MirroredDomain &mirrored_domain = this->domains.at((unsigned long) domain);
+            bool x_axis = this->symmetry == PSTD_SYMMETRY::X;
+            int width = mirrored_domain.Width, height = mirrored_domain.Height;
+            int half_width = (x_axis && mirrored_domain.Unfolded) ? width / 2 : width;
+            int half_height = (!x_axis && mirrored_domain.Unfolded) ? height / 2 : height;
+
+            std::vector<int> region = output.GetRegion(width, height);
+            int step = std::max(output.Decimation, 1);
+            auto result = std::make_shared<PSTD_FRAME>();
+            result->reserve((unsigned long) (values * output.GetFrameSize(width, height)));
+            for (int i = region[1]; i < region[3]; i += step) {
+                int row = i;
+                if (!x_axis && (mirrored_domain.Mirrored || i >= half_height)) {
+                    row = height - 1 - i;
+                }
+                for (int j = region[0]; j < region[2]; j += step) {
+                    int col = j;
+                    if (x_axis && (mirrored_domain.Mirrored || j >= half_width)) {
+                        col = width - 1 - j;
+                    }
+                    for (int v = 0; v < values; v++) {
+                        result->push_back(half.at((unsigned long) ((row * half_width + col) * values + v)));
+                    }
+                }
+            }
+            return result;
+        }
+
+        MirroredCallback::MirroredCallback(std::shared_ptr<SymmetricScene> scene,
+                                           std::shared_ptr<KernelCallback> callback,
+                                           std::shared_ptr<OutputPlan> plan) {
+            this->scene = scene;
+            this->callback = callback;
+            this->plan = plan;
+        }
+
+        void MirroredCallback::Fatal(std::string message) {
+            this->callback->Fatal(message);
+        }
+
+        void MirroredCallback::Error(std::string message) {
+            this->callback->Error(message);
+        }
+
+        void MirroredCallback::Warning(std::string message) {
+            this->callback->Warning(message);
+        }
+
+        void MirroredCallback::Info(std::string message) {
+            this->callback->Info(message);
+        }
+
+        void MirroredCallback::Debug(std::string message) {
+            this->callback->Debug(message);
+        }
+
+        void MirroredCallback::Callback(CALLBACKSTATUS status, std::string message, int frame) {
+            this->callback->Callback(status, message, frame);
+        }
+
+        void MirroredCallback::WriteFrame(int frame, int domain, PSTD_FRAME_PTR data) {
+            const std::vector<MirroredDomain> &domains = this->scene->GetDomains();
+            for (int i = 0; i < (int) domains.size(); i++) {
+                DomainOutputPlan output = this->plan->GetDomainOutput(i);
+                if (domains.at(i).HalfDomain == domain && output.IsFrameSaved(frame)) {
+                    this->callback->WriteFrame(frame, i, this->scene->Reconstruct(i, *data, 1, output));
+                }
+            }
+        }
+
+        void MirroredCallback::WriteSample(int startSample, int receiver, std::vector<float> data) {
+            this->callback->WriteSample(startSample, receiver, data);
+        }
+
+        void MirroredCallback::WriteEnergy(int frame, float energy) {
+            this->callback->WriteEnergy(frame, 2 * energy);
+        }
+
+        void MirroredCallback::WriteReduction(int domain, FIELD_REDUCTION reduction, PSTD_FRAME_PTR data) {
+            const std::vector<MirroredDomain> &domains = this->scene->GetDomains();
+            for (int i = 0; i < (int) domains.size(); i++) {
+                if (domains.at(i).HalfDomain == domain) {
+                    this->callback->WriteReduction(i, reduction, this->scene->Reconstruct(
+                            i, *data, 1, this->plan->GetDomainOutput(i)));
+                }
+            }
+        }
+
+        void MirroredCallback::WriteDFT(int domain, int index, float frequency, PSTD_FRAME_PTR data) {
+            const std::vector<MirroredDomain> &domains = this->scene->GetDomains();
+            for (int i = 0; i < (int) domains.size(); i++) {
+                if (domains.at(i).HalfDomain == domain) {
+                    this->callback->WriteDFT(i, index, frequency, this->scene->Reconstruct(
+                            i, *data, 2, this->plan->GetDomainOutput(i)));
+                }
+            }
+        }
+
+        void MirroredCallback::FinishFrame(int frame) {
+            this->callback->FinishFrame(frame);
+        }
+
+        void MirroredCallback::WriteCheckpoint(int frame) {
+            this->callback->WriteCheckpoint(frame);
+        }
+    }
+}
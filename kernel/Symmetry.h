@@ -0,0 +1,161 @@
+//////////////////////////////////////////////////////////////////////////
+// This file is part of openPSTD.                                       //
+//                                                                      //
+// openPSTD is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU General Public License as published by //
+// the Free Software Foundation, either version 3 of the License, or    //
+// (at your option) any later version.                                  //
+//                                                                      //
+// openPSTD is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of       //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        //
+// GNU General Public License for more details.                         //
+//                                                                      //
+// You should have received a copy of the GNU General Public License    //
+// along with openPSTD.  If not, see <http://www.gnu.org/licenses/>.    //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Date:
+//      18-10-2026
+//
+// Purpose:
+//      Mirror-symmetric scenes. Only the half of the scene before the
+//      mirror plane is simulated, with a rigid edge on the plane, and
+//      the results of the full scene are reconstructed from that half.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#ifndef OPENPSTD_SYMMETRY_H
+#define OPENPSTD_SYMMETRY_H
+
+#include <memory>
+#include <vector>
+#include "KernelInterface.h"
+
+namespace OpenPSTD {
+    namespace Kernel {
+
+        /**
+         * A domain of a symmetric scene and the domain of the simulated half that holds its results
+         */
+        struct MirroredDomain {
+            /// Identifier of the domain in the simulated half
+            int HalfDomain;
+            /// The domain lies behind the plane, its results are the mirror image of the half domain
+            bool Mirrored;
+            /// The domain crosses the plane, the half domain is its part before the plane
+            bool Unfolded;
+            /// Size of the domain in grid points (of its refined grid)
+            int Width, Height;
+            /// Position of the top left corner of the domain in grid points (of the base grid)
+            int Left, Top;
+        };
+
+        /**
+         * The simulated half of a symmetric scene.
+         *
+         * The half contains the domains before the mirror plane, the domains that cross the plane are cut at
+         * the plane. A rigid edge reflects the field exactly like its mirror image would, so the edges on the
+         * plane are made rigid. The speakers behind the plane are dropped (they are the mirror images of
+         * speakers before it) and the receivers behind the plane are moved to their mirror image.
+         */
+        class SymmetricScene {
+        private:
+            PSTD_SYMMETRY symmetry;
+            /// Position of the mirror plane in grid points
+            int plane;
+            std::shared_ptr<PSTDConfiguration> half;
+            std::vector<MirroredDomain> domains;
+
+        public:
+            /**
+             * Split a configuration at its mirror plane
+             * @param config: configuration with a Symmetry other than NONE
+             * @throw std::invalid_argument when the scene is not symmetric about its mirror plane
+             */
+            SymmetricScene(std::shared_ptr<PSTDConfiguration> config);
+
+            /**
+             * Configuration of the simulated half
+             */
+            std::shared_ptr<PSTDConfiguration> GetHalfConfiguration() const;
+
+            /**
+             * The domains of the full scene, in the order of the configuration
+             */
+            const std::vector<MirroredDomain> &GetDomains() const;
+
+            /**
+             * The plan for the simulated half. The half domains write their complete frames in every time step
+             * in which one of their domains in the full scene needs a frame.
+             * @param plan: plan of the full scene
+             * @throw std::invalid_argument for checkpoints, which are not supported for symmetric scenes
+             */
+            std::shared_ptr<OutputPlan> CreateHalfPlan(std::shared_ptr<OutputPlan> plan) const;
+
+            /**
+             * Reconstruct the results of a domain of the full scene from the complete results of its half domain
+             * @param domain: index of the domain in the full scene
+             * @param half: results of the half domain, without region and decimation
+             * @param values: number of values per grid point (2 for the interleaved DFT data)
+             * @param output: region and decimation of the results of the domain
+             */
+            PSTD_FRAME_PTR Reconstruct(int domain, const PSTD_FRAME &half, int values,
+                                       const DomainOutputPlan &output) const;
+        };
+
+        /**
+         * Callback that receives the results of the simulated half of a symmetric scene
+         * and writes the results of the full scene to another callback
+         */
+        class MirroredCallback : public KernelCallback {
+        private:
+            std::shared_ptr<SymmetricScene> scene;
+            std::shared_ptr<KernelCallback> callback;
+            std::shared_ptr<OutputPlan> plan;
+
+        public:
+            /**
+             * @param scene: the symmetric scene that is simulated
+             * @param callback: callback for the results of the full scene
+             * @param plan: plan of the full scene
+             */
+            MirroredCallback(std::shared_ptr<SymmetricScene> scene, std::shared_ptr<KernelCallback> callback,
+                             std::shared_ptr<OutputPlan> plan);
+
+            void Fatal(std::string message) override;
+
+            void Error(std::string message) override;
+
+            void Warning(std::string message) override;
+
+            void Info(std::string message) override;
+
+            void Debug(std::string message) override;
+
+            void Callback(CALLBACKSTATUS status, std::string message, int frame) override;
+
+            void WriteFrame(int frame, int domain, PSTD_FRAME_PTR data) override;
+
+            void WriteSample(int startSample, int receiver, std::vector<float> data) override;
+
+            /**
+             * The energy of the full scene is twice the energy of the simulated half
+             */
+            void WriteEnergy(int frame, float energy) override;
+
+            void WriteReduction(int domain, FIELD_REDUCTION reduction, PSTD_FRAME_PTR data) override;
+
+            void WriteDFT(int domain, int index, float frequency, PSTD_FRAME_PTR data) override;
+
+            void FinishFrame(int frame) override;
+
+            void WriteCheckpoint(int frame) override;
+        };
+    }
+}
+
+#endif //OPENPSTD_SYMMETRY_H
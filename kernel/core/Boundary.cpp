@@ -33,10 +33,15 @@
 namespace OpenPSTD {
     namespace Kernel {
 
-        Boundary::Boundary(std::shared_ptr<Domain> domain1, std::shared_ptr<Domain> domain2, CalcDirection type) {
+        template<typename T>
+        Boundary<T>::Boundary(std::shared_ptr<Domain<T>> domain1, std::shared_ptr<Domain<T>> domain2,
+                              CalcDirection type) {
             this->domain1 = domain1;
             this->domain2 = domain2;
             this->type = type;
         }
+
+        template class Boundary<float>;
+        template class Boundary<double>;
     }
 }
\ No newline at end of file
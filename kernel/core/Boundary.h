@@ -45,14 +45,15 @@ namespace OpenPSTD
          * Boundaries are represented as line segments parallel to one of the two (three) axes in the coordinate system.
          * Each boundary is adjacent to at most two domains.
          */
+        template<typename T>
         class Boundary
         {
         public:
             /** First of the domains separated by the boundary **/
-            std::shared_ptr<Domain> domain1;
+            std::shared_ptr<Domain<T>> domain1;
 
             /** Second of the domains separated by the boundary **/
-            std::shared_ptr<Domain> domain2;
+            std::shared_ptr<Domain<T>> domain2;
 
             /** Whether the boundary is used for horizontal or vertical computations **/
             CalcDirection type;
@@ -66,7 +67,7 @@ namespace OpenPSTD
              * @param Enum containing the direction of calculation (horizontal or vertical)
              * @return: new Boundary object
              */
-            Boundary(std::shared_ptr<Domain> domain1, std::shared_ptr<Domain> domain2, CalcDirection type);
+            Boundary(std::shared_ptr<Domain<T>> domain1, std::shared_ptr<Domain<T>> domain2, CalcDirection type);
 
         };
     }
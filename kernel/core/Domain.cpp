@@ -33,32 +33,37 @@ using namespace Eigen;
 namespace OpenPSTD {
     namespace Kernel {
 
-        Domain::Domain(shared_ptr<PSTDSettings> settings, int id, const float alpha,
-                       Point top_left, Point size, const bool is_pml,
-                       shared_ptr<WisdomCache> wnd, map<Direction, EdgeParameters> edge_param_map,
-                       const shared_ptr<Domain> pml_for_domain = shared_ptr<Domain>(nullptr)) {
+        template<typename T>
+        Domain<T>::Domain(shared_ptr<PSTDSettings> settings, int id, const float alpha,
+                          Point top_left, Point size, const bool is_pml,
+                          shared_ptr<WisdomCache<T>> wnd, map<Direction, EdgeParameters> edge_param_map,
+                          const shared_ptr<Domain> pml_for_domain) {
 
             this->initialize_domain(settings, id, alpha, top_left, size, is_pml, wnd, edge_param_map, pml_for_domain);
         }
 
-        Domain::Domain(shared_ptr<PSTDSettings> settings, int id, const float alpha,
-                       vector<float> top_left_vector, vector<float> size_vector, const bool is_pml,
-                       shared_ptr<WisdomCache> wnd, map<Direction, EdgeParameters> edge_param_map,
-                       const shared_ptr<Domain> pml_for_domain = shared_ptr<Domain>(nullptr)) {
+        template<typename T>
+        Domain<T>::Domain(shared_ptr<PSTDSettings> settings, int id, const float alpha,
+                          vector<float> top_left_vector, vector<float> size_vector, const bool is_pml,
+                          shared_ptr<WisdomCache<T>> wnd, map<Direction, EdgeParameters> edge_param_map,
+                          const shared_ptr<Domain> pml_for_domain) {
             Point top_left((int) top_left_vector.at(0), (int) top_left_vector.at(1));
             Point size((int) size_vector.at(0), (int) size_vector.at(1));
             this->initialize_domain(settings, id, alpha, top_left, size, is_pml, wnd, edge_param_map, pml_for_domain);
         }
 
-        void Domain::initialize_domain(shared_ptr<PSTDSettings> settings, int id, const float alpha,
-                                       Point top_left, Point size, const bool is_pml,
-                                       shared_ptr<WisdomCache> wnd,
-                                       map<Direction, EdgeParameters> edge_param_map,
-                                       const shared_ptr<Domain> pml_for_domain) {
+        template<typename T>
+        void Domain<T>::initialize_domain(shared_ptr<PSTDSettings> settings, int id, const float alpha,
+                                          Point top_left, Point size, const bool is_pml,
+                                          shared_ptr<WisdomCache<T>> wnd,
+                                          map<Direction, EdgeParameters> edge_param_map,
+                                          const shared_ptr<Domain> pml_for_domain) {
             this->settings = settings;
             this->top_left = top_left;
             this->size = size; // Remember PML domains have a fixed size.
             this->bottom_right = top_left + size;
+            this->refinement = 1;
+            this->cells = size;
             this->wnd = wnd;
             this->id = id;
             this->edge_param_map = edge_param_map;
@@ -74,6 +79,8 @@ namespace OpenPSTD {
                 this->rho = this->settings->GetDensityOfAir()*this->impedance;
             }
             this->is_pml = is_pml;
+            this->active = true;
+            this->source_count = 1;
             this->is_secondary_pml = false;
             for (auto domain:this->pml_for_domain_list) {
                 if (domain->is_pml) {
@@ -84,6 +91,9 @@ namespace OpenPSTD {
             this->current_values = {};
             this->previous_values = {};
             this->l_values = {};
+            this->l_values_factor = 0;
+            this->exchange_values = {};
+            this->use_exchange_values = false;
             this->pml_arrays = {};
             this->clear_fields();
             this->clear_matrices();
@@ -92,8 +102,9 @@ namespace OpenPSTD {
         }
 
         // version of calc that would have a return value.
-        ArrayXXf Domain::calc(CalcDirection cd, CalculationType ct, ArrayXcf dest) {
-            ArrayXXf source;
+        template<typename T>
+        ArrayXXT<T> Domain<T>::calc(CalcDirection cd, CalculationType ct, ArrayXcT<T> dest) {
+            ArrayXXT<T> source;
             vector<shared_ptr<Domain>> domains1, domains2;
             vector<int> own_range = get_range(cd);
 
@@ -117,12 +128,14 @@ namespace OpenPSTD {
             }
             cout << "\n\n";*/
 
+            // the stored derivatives are only accumulated into when they are the destination
+            T accumulate_factor = dest.rows() == 0 ? this->l_values_factor : 0;
             if (dest.rows() != 0) {
                 if (cd == CalcDirection::X) {
-                    source = extended_zeros(0, 1);
+                    source = source_zeros(0, 1);
                 }
                 else {
-                    source = extended_zeros(1, 0);
+                    source = source_zeros(1, 0);
                 }
             }
             else {
@@ -185,7 +198,7 @@ namespace OpenPSTD {
                     int range_start = *min_element(range_intersection.begin(), range_intersection.end());
                     int range_end = *max_element(range_intersection.begin(), range_intersection.end()) + 1;
                     int full_range = range_end-range_start;
-                    int primary_dimension = (cd == CalcDirection::X) ? size.x : size.y;
+                    int primary_dimension = (cd == CalcDirection::X) ? cells.x : cells.y;
                     int result_dimension = primary_dimension;
                     int wlen = settings->GetWindowSize();
                     while (wlen > primary_dimension){
@@ -193,48 +206,51 @@ namespace OpenPSTD {
                         wlen = wlen/2;
                         //cout << "using reduced window length" << endl;
                     }
-                    int N_total = 2 * wlen + primary_dimension;
-                    ArrayXf wind = get_window_coefficients(wlen, settings->GetPatchError());
+                    ArrayXT<T> wind = get_window_coefficients<T>(wlen, settings->GetPatchError());
 
                     if (ct == CalculationType::PRESSURE) {
-                        N_total++;
                         result_dimension++;
                     }
                     else {
                         primary_dimension++;
                     }
+                    // Length of the windowed stripe that is transformed, rounded up to the FFT length by the cache
+                    int fft_length = wnd->get_fft_length(2 * wlen + primary_dimension);
+                    // Rigid walls on both sides: the halos are exact mirror images, so the derivative
+                    // can be computed with cosine and sine transforms instead of windowed, padded FFTs
+                    bool reflecting = dest.rows() == 0 && is_reflecting(d1, d2, cd);
 
-                    ArrayXXf matrix_main, matrix_side1, matrix_side2;
+                    ArrayXXT<T> matrix_main, matrix_side1, matrix_side2;
                     // Changed piece of code start
 
                     if (ct == CalculationType::VELOCITY) {
                         if (d1 == nullptr ) {
-                            d1 = shared_from_this();
+                            d1 = this->shared_from_this();
                             if (cd == CalcDirection::X) {
-                                matrix_side1 = extended_zeros(0, 1);
+                                matrix_side1 = source_zeros(0, 1);
                             } else {
-                                matrix_side1 = extended_zeros(1, 0);
+                                matrix_side1 = source_zeros(1, 0);
                             }
                         }
                         if (d2 == nullptr ) {
-                            d2 = shared_from_this();
+                            d2 = this->shared_from_this();
                             if (cd == CalcDirection::X) {
-                                matrix_side2 = extended_zeros(0, 1);
+                                matrix_side2 = source_zeros(0, 1);
                             } else {
-                                matrix_side2 = extended_zeros(1, 0);
+                                matrix_side2 = source_zeros(1, 0);
                             }
                         }
                     } else {
                         if (d1 == nullptr ) {
-                            d1 = shared_from_this();
+                            d1 = this->shared_from_this();
 
-                            matrix_side1 = extended_zeros(0, 0);
+                            matrix_side1 = source_zeros(0, 0);
 
                         }
                         if (d2 == nullptr ) {
-                            d2 = shared_from_this();
+                            d2 = this->shared_from_this();
 
-                            matrix_side2 = extended_zeros(0, 0);
+                            matrix_side2 = source_zeros(0, 0);
 
                         }
                     }
@@ -247,7 +263,7 @@ namespace OpenPSTD {
                         // __|_____________|___
                         //   |     PML     |
                         //  <--------------->
-                        d1 = d2 = shared_from_this();
+                        d1 = d2 = this->shared_from_this();
                         if (cd == CalcDirection::X) {
                             matrix_side1 = extended_zeros(0, 1);
                             matrix_side2 = extended_zeros(0, 1);
@@ -259,10 +275,10 @@ namespace OpenPSTD {
                     }
                     else {
                         if (d1 == nullptr) {
-                            d1 = shared_from_this();
+                            d1 = this->shared_from_this();
                         }
                         if (d2 == nullptr) {
-                            d2 = shared_from_this();
+                            d2 = this->shared_from_this();
                         }
                     }*/
 
@@ -277,95 +293,148 @@ namespace OpenPSTD {
                     }
 
                     // If the matrices are _not_ already filled with zeroes, choose which values to fill them with.
+                    // Neighbours with another refinement are resampled to the grid of this domain.
+                    bool x_faces = ct == CalculationType::VELOCITY && cd == CalcDirection::X;
+                    bool y_faces = ct == CalculationType::VELOCITY && cd == CalcDirection::Y;
                     if (matrix_side1.cols() == 0) {
                         if (ct == CalculationType::PRESSURE) {
-                            matrix_side1 = d1->current_values.p0;
+                            matrix_side1 = d1->get_exchange_values().p0;
                         }
                         else {
                             if (cd == CalcDirection::X) {
-                                matrix_side1 = d1->current_values.vx0;
+                                matrix_side1 = d1->get_exchange_values().vx0;
                             }
                             else {
-                                matrix_side1 = d1->current_values.vy0;
+                                matrix_side1 = d1->get_exchange_values().vy0;
                             }
                         }
+                        if (d1->refinement != this->refinement) {
+                            matrix_side1 = resample_neighbour(matrix_side1, d1->refinement, x_faces, y_faces, cd,
+                                                          true, wlen + 1);
+                        }
                     }
                     if (matrix_side2.cols() == 0) {
                         if (ct == CalculationType::PRESSURE) {
-                            matrix_side2 = d2->current_values.p0;
+                            matrix_side2 = d2->get_exchange_values().p0;
                         }
                         else {
                             if (cd == CalcDirection::X) {
-                                matrix_side2 = d2->current_values.vx0;
+                                matrix_side2 = d2->get_exchange_values().vx0;
                             }
                             else {
-                                matrix_side2 = d2->current_values.vy0;
+                                matrix_side2 = d2->get_exchange_values().vy0;
                             }
                         }
+                        if (d2->refinement != this->refinement) {
+                            matrix_side2 = resample_neighbour(matrix_side2, d2->refinement, x_faces, y_faces, cd,
+                                                          false, wlen + 1);
+                        }
                     }
 
-                    ArrayXcf derfact;
+                    ArrayXcT<T> derfact;
                     if (dest.rows() != 0) {
                         derfact = dest;
                     }
                     else {
                         if (ct == CalculationType::PRESSURE) {
-                            derfact = wnd->get_discretization(settings->GetGridSpacing(),
-                                                              N_total).pressure_deriv_factors;
+                            derfact = wnd->get_discretization(get_grid_spacing(), fft_length).pressure_deriv_factors;
                         }
                         else {
-                            derfact = wnd->get_discretization(settings->GetGridSpacing(),
-                                                              N_total).velocity_deriv_factors;
+                            derfact = wnd->get_discretization(get_grid_spacing(), fft_length).velocity_deriv_factors;
                         }
                     }
 
-                    float max_rho = 1E10;
-                    RhoArray rho_array = get_rho_array(d1 != nullptr ? d1->rho : max_rho,
+                    T max_rho = 1E10;
+                    RhoArray<T> rho_array = get_rho_array<T>(d1 != nullptr ? d1->rho : max_rho,
                                                        this->rho,
                                                        d2 != nullptr ? d2->rho : max_rho);
 
-                    // Calculate the spatial derivatives for the current intersection range and store
+                    // Calculate the spatial derivatives for the current intersection range and store.
+                    // The ranges and offsets are in base grid units, the field arrays in cells of this domain.
+                    int r = this->refinement;
                     int matrix_main_offset, matrix_side1_offset, matrix_side2_offset;
-                    ArrayXXf matrix_main_indexed, matrix_side1_indexed, matrix_side2_indexed;
+                    ArrayXXT<T> matrix_main_indexed, matrix_side1_indexed, matrix_side2_indexed;
                     if (cd == CalcDirection::X) {
-                        WisdomCache::Planset_FFTW planset = wnd->get_fftw_planset(
-                                next_2_power(matrix_main.cols() + 2 * wlen), matrix_main.rows());
+                        typename WisdomCache<T>::Planset_FFTW planset = wnd->get_fftw_planset(
+                                (int) derfact.rows(), matrix_main.rows());
                         matrix_main_offset = this->top_left.y;
                         matrix_side1_offset = d1->top_left.y;
                         matrix_side2_offset = d2->top_left.y;
 
-                        int nrows = range_end - range_start;
-
-                        matrix_main_indexed = matrix_main.block(range_start - matrix_main_offset, 0,
-                                                                  nrows, matrix_main.cols());
-                        matrix_side1_indexed = matrix_side1.block(range_start - matrix_side1_offset, 0,
-                                                                  nrows, matrix_side1.cols());
-                        matrix_side2_indexed = matrix_side2.block(range_start - matrix_side2_offset, 0,
-                                                                  nrows, matrix_side2.cols());
-
-                        Eigen:ArrayXXf spatresult = spatderp3(matrix_side1_indexed, matrix_main_indexed, matrix_side2_indexed, derfact,
-                                                              rho_array, wind, wlen, ct, cd, planset.plan, planset.plan_inv);
-                        source.block(range_start - matrix_main_offset, 0, full_range, result_dimension) = spatresult;
+                        int nrows = r * (range_end - range_start);
+
+                        // The rows of all sources are derived in a single batch
+                        matrix_main_indexed = stack_source_rows(matrix_main, r * (range_start - matrix_main_offset),
+                                                                nrows);
+                        matrix_side1_indexed = stack_source_rows(matrix_side1, r * (range_start - matrix_side1_offset),
+                                                                 nrows);
+                        matrix_side2_indexed = stack_source_rows(matrix_side2, r * (range_start - matrix_side2_offset),
+                                                                 nrows);
+
+                        ArrayXXT<T> spatresult;
+                        if (reflecting) {
+                            typename WisdomCache<T>::Planset_R2R r2r_planset = wnd->get_r2r_planset(
+                                    cells.x, (int) matrix_main_indexed.rows(), ct);
+                            spatresult = spatderp3_reflecting<T>(matrix_main_indexed, get_grid_spacing(), ct, cd,
+                                                                 r2r_planset.cosine_plan, r2r_planset.sine_plan);
+                        }
+                        else {
+                            spatresult = spatderp3<T>(matrix_side1_indexed, matrix_main_indexed, matrix_side2_indexed, derfact,
+                                                      rho_array, wind, wlen, ct, cd, planset.plan, planset.plan_inv);
+                        }
+                        long source_rows = source.rows() / source_count;
+                        for (int s = 0; s < source_count; s++) {
+                            auto source_block = source.block(s * source_rows + r * (range_start - matrix_main_offset),
+                                                             0, r * full_range, result_dimension);
+                            auto result_block = spatresult.middleRows(s * nrows, nrows);
+                            if (accumulate_factor != 0) {
+                                source_block = accumulate_factor * source_block + result_block;
+                            }
+                            else {
+                                source_block = result_block;
+                            }
+                        }
                     }
                     else {
-                        WisdomCache::Planset_FFTW planset = wnd->get_fftw_planset(
-                                next_2_power(matrix_main.rows() + 2 * wlen), matrix_main.cols());
+                        typename WisdomCache<T>::Planset_FFTW planset = wnd->get_fftw_planset(
+                                (int) derfact.rows(), matrix_main.cols());
                         matrix_main_offset = this->top_left.x;
                         matrix_side1_offset = d1->top_left.x;
                         matrix_side2_offset = d2->top_left.x;
 
-                        int ncols = range_end - range_start;
-
-                        matrix_main_indexed = matrix_main.block(0, range_start - matrix_main_offset,
-                                                                matrix_main.rows(), ncols);
-                        matrix_side1_indexed = matrix_side1.block(0, range_start - matrix_side1_offset,
-                                                                  matrix_side1.rows(), ncols);
-                        matrix_side2_indexed = matrix_side2.block(0, range_start - matrix_side2_offset,
-                                                                  matrix_side2.rows(), ncols);
-
-                        ArrayXXf spatresult = spatderp3(matrix_side1_indexed, matrix_main_indexed, matrix_side2_indexed, derfact,
-                                                              rho_array, wind, wlen, ct, cd, planset.plan, planset.plan_inv);
-                        source.block(0, range_start - matrix_main_offset, result_dimension, ncols) = spatresult;
+                        int ncols = r * (range_end - range_start);
+
+                        // The columns of all sources are placed side by side and derived in a single batch
+                        matrix_main_indexed = stack_source_columns(matrix_main, r * (range_start - matrix_main_offset),
+                                                                   ncols);
+                        matrix_side1_indexed = stack_source_columns(matrix_side1,
+                                                                    r * (range_start - matrix_side1_offset), ncols);
+                        matrix_side2_indexed = stack_source_columns(matrix_side2,
+                                                                    r * (range_start - matrix_side2_offset), ncols);
+
+                        ArrayXXT<T> spatresult;
+                        if (reflecting) {
+                            typename WisdomCache<T>::Planset_R2R r2r_planset = wnd->get_r2r_planset(
+                                    cells.y, (int) matrix_main_indexed.cols(), ct);
+                            spatresult = spatderp3_reflecting<T>(matrix_main_indexed, get_grid_spacing(), ct, cd,
+                                                                 r2r_planset.cosine_plan, r2r_planset.sine_plan);
+                        }
+                        else {
+                            spatresult = spatderp3<T>(matrix_side1_indexed, matrix_main_indexed, matrix_side2_indexed, derfact,
+                                                      rho_array, wind, wlen, ct, cd, planset.plan, planset.plan_inv);
+                        }
+                        long source_rows = source.rows() / source_count;
+                        for (int s = 0; s < source_count; s++) {
+                            auto source_block = source.block(s * source_rows, r * (range_start - matrix_main_offset),
+                                                             result_dimension, ncols);
+                            auto result_block = spatresult.middleCols(s * ncols, ncols);
+                            if (accumulate_factor != 0) {
+                                source_block = accumulate_factor * source_block + result_block;
+                            }
+                            else {
+                                source_block = result_block;
+                            }
+                        }
                     }
                 }
             }
@@ -394,17 +463,20 @@ namespace OpenPSTD {
          * Near-alias to calc(CalcDirection cd, CalculationType ct, vector<float> dest), but with
          * a default empty vector as dest.
          */
-        void Domain::calc(CalcDirection cd, CalculationType ct) {
-            ArrayXcf nulldest;
+        template<typename T>
+        void Domain<T>::calc(CalcDirection cd, CalculationType ct) {
+            ArrayXcT<T> nulldest;
             Domain::calc(cd, ct, nulldest);
         }
 
-        bool Domain::contains_point(Point point) {
+        template<typename T>
+        bool Domain<T>::contains_point(Point point) {
             vector<float> location = {(float) point.x, (float) point.y, (float) point.z};
             return contains_location(location);
         }
 
-        bool Domain::contains_location(vector<float> location) {
+        template<typename T>
+        bool Domain<T>::contains_location(vector<float> location) {
             for (unsigned long dim = 0; dim < location.size(); dim++) {
                 if (top_left.array.at(dim) > location.at(dim) or
                     location.at(dim) > bottom_right.array.at(dim)) {
@@ -414,7 +486,8 @@ namespace OpenPSTD {
             return true;
         }
 
-        bool Domain::is_neighbour_of(shared_ptr<Domain> domain) {
+        template<typename T>
+        bool Domain<T>::is_neighbour_of(shared_ptr<Domain> domain) {
             for (Direction direction :all_directions) {
                 auto dir_nb = get_neighbours_at(direction);
                 if (find(dir_nb.begin(), dir_nb.end(), domain) != dir_nb.end()) {
@@ -424,15 +497,37 @@ namespace OpenPSTD {
             return false;
         }
 
-        bool Domain::is_pml_for(shared_ptr<Domain> domain) {
+        template<typename T>
+        bool Domain<T>::is_pml_for(shared_ptr<Domain> domain) {
             return (find(pml_for_domain_list.begin(), pml_for_domain_list.end(), domain) != pml_for_domain_list.end());
         }
 
-        bool Domain::is_rigid() {
+        template<typename T>
+        bool Domain<T>::is_rigid() {
             return impedance > 1000; //Why this exact value?
         }
 
-        vector<int> Domain::get_range(CalcDirection cd) {
+        template<typename T>
+        bool Domain<T>::is_reflecting(shared_ptr<Domain> d1, shared_ptr<Domain> d2, CalcDirection cd) {
+            // without a neighbour the edge itself bounds the domain, which is rigid if it absorbs nothing
+            auto rigid_side = [this](shared_ptr<Domain> neighbour, Direction edge) {
+                if (neighbour != nullptr) {
+                    return neighbour->is_rigid();
+                }
+                auto edge_parameters = this->edge_param_map.find(edge);
+                return !this->is_pml && edge_parameters != this->edge_param_map.end() &&
+                       edge_parameters->second.alpha == 0;
+            };
+            if (cd == CalcDirection::X) {
+                return rigid_side(d1, Direction::LEFT) && rigid_side(d2, Direction::RIGHT);
+            }
+            else {
+                return rigid_side(d1, Direction::BOTTOM) && rigid_side(d2, Direction::TOP);
+            }
+        }
+
+        template<typename T>
+        vector<int> Domain<T>::get_range(CalcDirection cd) {
             int a_l, b_l;
             if (cd == CalcDirection::X) {
                 a_l = top_left.y;
@@ -447,7 +542,8 @@ namespace OpenPSTD {
             return tmp;
         }
 
-        vector<int> Domain::get_intersection_with(shared_ptr<Domain> other_domain, Direction direction) {
+        template<typename T>
+        vector<int> Domain<T>::get_intersection_with(shared_ptr<Domain> other_domain, Direction direction) {
             vector<int> own_range;
             vector<int> other_range;
             switch (direction) {
@@ -469,13 +565,104 @@ namespace OpenPSTD {
             return range_intersection;
         }
 
-        ArrayXXf Domain::extended_zeros(int y, int x, int z) {
+        template<typename T>
+        ArrayXXT<T> Domain<T>::extended_zeros(int y, int x, int z) {
             // Matrices have the same shape of the domain.
             // Therefore, domains with size (x,y) have 2D array shape (y,x)
-            return ArrayXXf::Zero(size.y + y, size.x + x);
+            return ArrayXXT<T>::Zero(cells.y + y, cells.x + x);
+        }
+
+        template<typename T>
+        ArrayXXT<T> Domain<T>::stack_source_rows(const ArrayXXT<T> &field, int start, int count) {
+            if (source_count == 1) {
+                return field.middleRows(start, count);
+            }
+            long rows = field.rows() / source_count;
+            ArrayXXT<T> result(source_count * count, field.cols());
+            for (int s = 0; s < source_count; s++) {
+                result.middleRows(s * count, count) = field.middleRows(s * rows + start, count);
+            }
+            return result;
+        }
+
+        template<typename T>
+        ArrayXXT<T> Domain<T>::stack_source_columns(const ArrayXXT<T> &field, int start, int count) {
+            if (source_count == 1) {
+                return field.middleCols(start, count);
+            }
+            long rows = field.rows() / source_count;
+            ArrayXXT<T> result(rows, source_count * count);
+            for (int s = 0; s < source_count; s++) {
+                result.middleCols(s * count, count) = field.block(s * rows, start, rows, count);
+            }
+            return result;
+        }
+
+        template<typename T>
+        ArrayXXT<T> Domain<T>::source_zeros(int y, int x) {
+            return ArrayXXT<T>::Zero(source_count * (cells.y + y), cells.x + x);
+        }
+
+        template<typename T>
+        void Domain<T>::set_source_count(int source_count) {
+            this->source_count = source_count;
+            this->clear_fields();
+            this->clear_matrices();
         }
 
-        vector<shared_ptr<Domain>> Domain::get_neighbours_at(Direction direction) {
+        template<typename T>
+        void Domain<T>::set_refinement(int refinement) {
+            this->refinement = refinement;
+            this->cells = Point(size.x * refinement, size.y * refinement, size.z * refinement);
+            this->clear_fields();
+            this->clear_matrices();
+        }
+
+        template<typename T>
+        float Domain<T>::get_grid_spacing() const {
+            return settings->GetGridSpacing() / refinement;
+        }
+
+        template<typename T>
+        ArrayXXT<T> Domain<T>::resample_neighbour(const ArrayXXT<T> &field, int from, bool x_faces, bool y_faces,
+                                                  CalcDirection cd, bool before, int strip) {
+            long rows = field.rows() / source_count;
+            int cells_y = (int) rows - (y_faces ? 1 : 0);
+            int cells_x = (int) field.cols() - (x_faces ? 1 : 0);
+            // The resampling along both axes: (new rows, rows) and (new columns, columns)
+            const ArrayXXT<T> &resample_y = wnd->get_resampling(cells_y, from, refinement, y_faces);
+            const ArrayXXT<T> &resample_x = wnd->get_resampling(cells_x, from, refinement, x_faces);
+            // Only the points of the strip next to this domain are computed, and the strip is resampled first
+            if (cd == CalcDirection::X) {
+                long points = std::min((long) strip, (long) resample_x.rows());
+                auto strip_x = before ? resample_x.bottomRows(points) : resample_x.topRows(points);
+                ArrayXXT<T> result(source_count * resample_y.rows(), points);
+                for (int s = 0; s < source_count; s++) {
+                    result.middleRows(s * resample_y.rows(), resample_y.rows()) =
+                            (resample_y.matrix() *
+                             (field.middleRows(s * rows, rows).matrix() * strip_x.matrix().transpose())).array();
+                }
+                return result;
+            }
+            long points = std::min((long) strip, (long) resample_y.rows());
+            auto strip_y = before ? resample_y.bottomRows(points) : resample_y.topRows(points);
+            ArrayXXT<T> result(source_count * points, resample_x.rows());
+            for (int s = 0; s < source_count; s++) {
+                result.middleRows(s * points, points) =
+                        ((strip_y.matrix() * field.middleRows(s * rows, rows).matrix()) *
+                         resample_x.matrix().transpose()).array();
+            }
+            return result;
+        }
+
+        template<typename T>
+        Eigen::Block<const ArrayXXT<T>> Domain<T>::get_source_block(const ArrayXXT<T> &field, int source) const {
+            long rows = field.rows() / source_count;
+            return field.middleRows(source * rows, rows);
+        }
+
+        template<typename T>
+        vector<shared_ptr<Domain<T>>> Domain<T>::get_neighbours_at(Direction direction) {
             switch (direction) {
                 case Direction::LEFT:
                     return left;
@@ -488,7 +675,8 @@ namespace OpenPSTD {
             }
         }
 
-        shared_ptr<Domain> Domain::get_neighbour_at(Direction direction, vector<float> location) {
+        template<typename T>
+        shared_ptr<Domain<T>> Domain<T>::get_neighbour_at(Direction direction, vector<float> location) {
             shared_ptr<Domain> correct_domain = nullptr;
             auto dir_neighbours = get_neighbours_at(direction);
             for (shared_ptr<Domain> domain:dir_neighbours) {
@@ -501,7 +689,8 @@ namespace OpenPSTD {
         }
 
 
-        void Domain::compute_number_of_neighbours() {
+        template<typename T>
+        void Domain<T>::compute_number_of_neighbours() {
             num_neighbour_domains = 0;
             num_pml_neighbour_domains = 0;
             for (Direction direction: all_directions) {
@@ -514,7 +703,8 @@ namespace OpenPSTD {
             }
         }
 
-        int Domain::number_of_neighbours(bool count_pml) {
+        template<typename T>
+        int Domain<T>::number_of_neighbours(bool count_pml) {
             if (count_pml) {
                 return num_neighbour_domains;
             }
@@ -523,7 +713,8 @@ namespace OpenPSTD {
             }
         }
 
-        void Domain::add_neighbour_at(shared_ptr<Domain> domain, Direction direction) {
+        template<typename T>
+        void Domain<T>::add_neighbour_at(shared_ptr<Domain> domain, Direction direction) {
             switch (direction) {
                 case Direction::LEFT:
                     left.push_back(domain);
@@ -540,7 +731,8 @@ namespace OpenPSTD {
             }
         }
 
-        ArrayXXi Domain::get_vacant_range(Direction direction) {
+        template<typename T>
+        ArrayXXi Domain<T>::get_vacant_range(Direction direction) {
             vector<shared_ptr<Domain>> neighbour_list;
             CalcDirection calc_dir = direction_to_calc_direction(direction);
             vector<int> range = get_range(calc_dir);
@@ -584,7 +776,8 @@ namespace OpenPSTD {
         }
 
 
-        void Domain::find_update_directions() {
+        template<typename T>
+        void Domain<T>::find_update_directions() {
             for (CalcDirection calc_dir: all_calc_directions) {
                 bool should_update = true;
                 if (number_of_neighbours(false) == 1 and is_pml) {
@@ -615,33 +808,33 @@ namespace OpenPSTD {
             }
         }
 
-        void Domain::clear_matrices() {
-            l_values.Lpx = extended_zeros(0, 1);
-            l_values.Lpy = extended_zeros(1, 0);
-            l_values.Lvx = extended_zeros(0, 0);
-            l_values.Lvy = extended_zeros(0, 0);
+        template<typename T>
+        void Domain<T>::clear_matrices() {
+            l_values.Lpx = source_zeros(0, 1);
+            l_values.Lpy = source_zeros(1, 0);
+            l_values.Lvx = source_zeros(0, 0);
+            l_values.Lvy = source_zeros(0, 0);
         }
 
-        void Domain::clear_fields() {
-            current_values.p0 = extended_zeros(0, 0);
-            current_values.px0 = extended_zeros(0, 0);
-            current_values.py0 = extended_zeros(0, 0);
-            current_values.vx0 = extended_zeros(0, 1);
-            current_values.vy0 = extended_zeros(1, 0);
+        template<typename T>
+        void Domain<T>::clear_fields() {
+            current_values.p0 = source_zeros(0, 0);
+            current_values.px0 = source_zeros(0, 0);
+            current_values.py0 = source_zeros(0, 0);
+            current_values.vx0 = source_zeros(0, 1);
+            current_values.vy0 = source_zeros(1, 0);
 
             previous_values = {}; // Do we def need to empty this?
         }
 
 
-        void Domain::clear_pml_arrays() {
-            pml_arrays.px = extended_zeros(0, 0);
-            pml_arrays.py = extended_zeros(0, 0);
-            pml_arrays.vx = extended_zeros(0, 1);
-            pml_arrays.vy = extended_zeros(1, 0);
-
+        template<typename T>
+        void Domain<T>::clear_pml_arrays() {
+            pml_arrays = {};
         }
 
-        void Domain::compute_pml_matrices() {
+        template<typename T>
+        void Domain<T>::compute_pml_matrices() {
             //Todo (0mar): Refactor this method? It's asymmetric and spaghetty
             /*
              * TK: Only calculate PML matrices for PML domains with a single non-pml neighbour
@@ -684,53 +877,114 @@ namespace OpenPSTD {
                 has_horizontal_attenuation = all_air_left or all_air_right;
                 needs_reversed_attenuation.push_back(all_air_left or all_air_bottom);
             }
+            clear_pml_arrays();
             if (is_secondary_pml and is_corner_domain) {
                 // TK: PML is the product of horizontal and vertical attenuation.
-                create_attenuation_array(CalcDirection::X, needs_reversed_attenuation.at(0),
-                                         pml_arrays.px, pml_arrays.vx);
-                create_attenuation_array(CalcDirection::Y, needs_reversed_attenuation.at(1),
-                                         pml_arrays.py, pml_arrays.vy);
+                create_attenuation_array(needs_reversed_attenuation.at(0), pml_arrays.px, pml_arrays.vx);
+                create_attenuation_array(needs_reversed_attenuation.at(1), pml_arrays.py, pml_arrays.vy);
+            }
+            else if (has_horizontal_attenuation) {
+                create_attenuation_array(needs_reversed_attenuation.at(0), pml_arrays.px, pml_arrays.vx);
             }
             else {
-                CalcDirection calc_dir = CalcDirection::Y;
-                if (has_horizontal_attenuation) {
-                    calc_dir = CalcDirection::X;
-                }
-                switch (calc_dir) {
-                    case CalcDirection::X:
-                        create_attenuation_array(calc_dir, needs_reversed_attenuation.at(0),
-                                                 pml_arrays.px, pml_arrays.vx);
-                        pml_arrays.py = ArrayXXf::Ones(size.y, size.x);//Change if unique
-                        pml_arrays.vy = ArrayXXf::Ones(size.y+1, size.x); //TODO check if x/y is correct here
-                        break;
-                    case CalcDirection::Y:
-                        create_attenuation_array(calc_dir, needs_reversed_attenuation.at(0),
-                                                 pml_arrays.py, pml_arrays.vy);
-                        pml_arrays.px = ArrayXXf::Ones(size.y, size.x);//Change if unique
-                        pml_arrays.vx = ArrayXXf::Ones(size.y, size.x + 1);//Change if unique
-                        break;
-                }
+                create_attenuation_array(needs_reversed_attenuation.at(0), pml_arrays.py, pml_arrays.vy);
             }
         }
 
-        void Domain::apply_pml_matrices() //Todo: Rename to pml_arrays
+        template<typename T>
+        void Domain<T>::apply_pml_matrices() //Todo: Rename to pml_arrays
         {
             assert(number_of_neighbours(false) == 1 and is_pml or number_of_neighbours(true) <= 2 and
                    is_secondary_pml);
-            // The pressure and velocity matrices are multiplied by the PML values.
-            current_values.px0 *= pml_arrays.px;
-            current_values.py0 *= pml_arrays.py;
-            current_values.vx0 *= pml_arrays.vx;
-            current_values.vy0 *= pml_arrays.vy;
+            // The pressure and velocity matrices are multiplied by the PML profiles, broadcast over the other axis.
+            if (pml_arrays.px.size() > 0) {
+                current_values.px0.rowwise() *= pml_arrays.px.transpose();
+                current_values.vx0.rowwise() *= pml_arrays.vx.transpose();
+            }
+            if (pml_arrays.py.size() > 0) {
+                if (source_count == 1) {
+                    current_values.py0.colwise() *= pml_arrays.py;
+                    current_values.vy0.colwise() *= pml_arrays.vy;
+                } else {
+                    // The profiles repeat for every source in the rows
+                    ArrayXT<T> py = pml_arrays.py.replicate(source_count, 1);
+                    ArrayXT<T> vy = pml_arrays.vy.replicate(source_count, 1);
+                    current_values.py0.colwise() *= py;
+                    current_values.vy0.colwise() *= vy;
+                }
+            }
         }
 
 
-        void Domain::push_values() {
+        template<typename T>
+        void Domain<T>::push_values() {
             previous_values = current_values;
         }
 
+        template<typename T>
+        const FieldValues<T> &Domain<T>::get_exchange_values() const {
+            return this->use_exchange_values ? this->exchange_values : this->current_values;
+        }
+
+        template<typename T>
+        unsigned long Domain<T>::get_field_memory() const {
+            vector<const ArrayXXT<T> *> arrays = {
+                    &current_values.vx0, &current_values.vy0, &current_values.p0, &current_values.px0,
+                    &current_values.py0, &previous_values.vx0, &previous_values.vy0, &previous_values.p0,
+                    &previous_values.px0, &previous_values.py0, &l_values.Lpx, &l_values.Lpy, &l_values.Lvx,
+                    &l_values.Lvy, &exchange_values.vx0, &exchange_values.vy0, &exchange_values.p0};
+            unsigned long bytes = 0;
+            for (auto array: arrays) {
+                bytes += array->size() * sizeof(T);
+            }
+            bytes += (pml_arrays.px.size() + pml_arrays.py.size() + pml_arrays.vx.size() + pml_arrays.vy.size()) *
+                     sizeof(T);
+            return bytes;
+        }
+
+
+        template<typename T>
+        T Domain<T>::get_amplitude() {
+            T amplitude = 0;
+            for (ArrayXXT<T> *field: {&current_values.p0, &current_values.vx0, &current_values.vy0}) {
+                if (field->size() != 0) {
+                    amplitude = max(amplitude, field->abs().maxCoeff());
+                }
+            }
+            return amplitude;
+        }
+
+        template<typename T>
+        T Domain<T>::get_edge_amplitude(Direction direction, int width) {
+            T amplitude = 0;
+            for (ArrayXXT<T> *field: {&current_values.p0, &current_values.vx0, &current_values.vy0}) {
+                if (field->size() == 0) {
+                    continue;
+                }
+                // The bottom neighbour borders on the first rows, see calc()
+                for (int source = 0; source < source_count; source++) {
+                    auto block = get_source_block(*field, source);
+                    switch (direction) {
+                        case Direction::LEFT:
+                            amplitude = max(amplitude, block.leftCols(min(width, (int) block.cols())).abs().maxCoeff());
+                            break;
+                        case Direction::RIGHT:
+                            amplitude = max(amplitude, block.rightCols(min(width, (int) block.cols())).abs().maxCoeff());
+                            break;
+                        case Direction::BOTTOM:
+                            amplitude = max(amplitude, block.topRows(min(width, (int) block.rows())).abs().maxCoeff());
+                            break;
+                        case Direction::TOP:
+                            amplitude = max(amplitude, block.bottomRows(min(width, (int) block.rows())).abs().maxCoeff());
+                            break;
+                    }
+                }
+            }
+            return amplitude;
+        }
 
-        int Domain::get_num_pmls_in_direction(Direction direction) {
+        template<typename T>
+        int Domain<T>::get_num_pmls_in_direction(Direction direction) {
             int num_pml_doms = 0;
             for (auto domain: get_neighbours_at(direction)) {
                 if (domain->is_pml) {
@@ -740,8 +994,8 @@ namespace OpenPSTD {
             return num_pml_doms;
         }
 
-        void Domain::create_attenuation_array(CalcDirection calc_dir, bool ascending, ArrayXXf &pml_pressure,
-                                              ArrayXXf &pml_velocity) {
+        template<typename T>
+        void Domain<T>::create_attenuation_array(bool ascending, ArrayXT<T> &pml_pressure, ArrayXT<T> &pml_velocity) {
             /*
              * 0mar: Most of this method only needs to be computed once for all domains.
              * However, the computations are not that big and only executed in the initialization phase.
@@ -749,47 +1003,41 @@ namespace OpenPSTD {
 
             //Pressure defined in cell centers
             auto pressure_range =
-                    VectorXf::LinSpaced(settings->GetPMLCells(), 0.5, float(settings->GetPMLCells() - 0.5)).array() /
+                    ArrayXT<T>::LinSpaced(settings->GetPMLCells(), 0.5, T(settings->GetPMLCells() - 0.5)) /
                     settings->GetPMLCells();
             //Velocity defined in cell edges
             auto velocity_range =
-                    VectorXf::LinSpaced(settings->GetPMLCells() + 1, 0, float(settings->GetPMLCells())).array() /
+                    ArrayXT<T>::LinSpaced(settings->GetPMLCells() + 1, 0, T(settings->GetPMLCells())) /
                     settings->GetPMLCells();
-            ArrayXXf alpha_pml_pressure = settings->GetAttenuationOfPMLCells() * pressure_range.pow(4);
-            ArrayXXf alpha_pml_velocity =
+            ArrayXT<T> alpha_pml_pressure = settings->GetAttenuationOfPMLCells() * pressure_range.pow(4);
+            ArrayXT<T> alpha_pml_velocity =
                     settings->GetDensityOfAir() * settings->GetAttenuationOfPMLCells() * velocity_range.pow(4);
-            ArrayXXf pressure_pml_factors = (-alpha_pml_pressure * settings->GetTimeStep() /
+            ArrayXT<T> pressure_pml_factors = (-alpha_pml_pressure * settings->GetTimeStep() /
                                              settings->GetDensityOfAir()).exp();
-            ArrayXXf velocity_pml_factors = (-alpha_pml_velocity * settings->GetTimeStep()).exp();
+            ArrayXT<T> velocity_pml_factors = (-alpha_pml_velocity * settings->GetTimeStep()).exp();
             if (!ascending) {
                 //Reverse if the attenuation takes place in the other direction
                 pressure_pml_factors.reverseInPlace();
                 velocity_pml_factors.reverseInPlace();
             }
-            switch (calc_dir) {
-                //Replicate matrices to size of domain
-                case CalcDirection::X:
-                    pml_pressure = pressure_pml_factors.transpose().replicate(size.y, 1);
-                    pml_velocity = velocity_pml_factors.transpose().replicate(size.y, 1);
-                    break;
-                case CalcDirection::Y:
-                    pml_pressure = pressure_pml_factors.replicate(1, size.x);
-                    pml_velocity = velocity_pml_factors.replicate(1, size.x);
-                    break;
-            }
+            pml_pressure = pressure_pml_factors;
+            pml_velocity = velocity_pml_factors;
         }
 
-        ostream &operator<<(ostream &str, Domain const &v) {
+        template<typename T>
+        ostream &operator<<(ostream &str, Domain<T> const &v) {
             str << v.ToString();
             return str;
         }
 
-        void Domain::post_initialization() {
+        template<typename T>
+        void Domain<T>::post_initialization() {
             compute_number_of_neighbours();
             find_update_directions();
         }
 
-        string Domain::ToString() const
+        template<typename T>
+        string Domain<T>::ToString() const
         {
             std::string str = "";
             str += "Domain " + boost::lexical_cast<std::string>(this->id);
@@ -799,8 +1047,16 @@ namespace OpenPSTD {
                 str += " (pml)";
             }
             str += ", top left " + top_left.ToString() + ", bottom right " + bottom_right.ToString() + " (alpha: " + boost::lexical_cast<std::string>(alpha) + ")";
+            if (refinement > 1) {
+                str += ", refinement " + boost::lexical_cast<std::string>(refinement);
+            }
 
             return str;
         }
+
+        template class Domain<float>;
+        template class Domain<double>;
+        template ostream &operator<<(ostream &str, Domain<float> const &v);
+        template ostream &operator<<(ostream &str, Domain<double> const &v);
     }
 }
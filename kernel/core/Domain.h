@@ -54,36 +54,42 @@ namespace OpenPSTD {
          * We simulate pressure and velocity, decomposed in x and y direction, as well as the combined pressure.
          * These values represent the state of the system for a fixed time.
          */
+        template<typename T>
         struct FieldValues {
-            Eigen::ArrayXXf vx0;
-            Eigen::ArrayXXf vy0;
-            Eigen::ArrayXXf p0;
-            Eigen::ArrayXXf px0;
-            Eigen::ArrayXXf py0;
+            ArrayXXT<T> vx0;
+            ArrayXXT<T> vy0;
+            ArrayXXT<T> p0;
+            ArrayXXT<T> px0;
+            ArrayXXT<T> py0;
         };
 
         /**
          * The spatial derivatives of the pressure and velocity in x and y direction
          */
+        template<typename T>
         struct FieldLValues { // Todo (0mar): Rename, these are spatial derivatives
-            Eigen::ArrayXXf Lpx;
-            Eigen::ArrayXXf Lpy;
-            Eigen::ArrayXXf Lvx;
-            Eigen::ArrayXXf Lvy;
+            ArrayXXT<T> Lpx;
+            ArrayXXT<T> Lpy;
+            ArrayXXT<T> Lvx;
+            ArrayXXT<T> Lvy;
 
         };
 
         /**
-         * The arrays used for attenuating the pressure and velocities at the boundaries of the domain.
+         * The attenuation profiles used for attenuating the pressure and velocities at the boundaries of the domain.
          * These are only effective for PML domains.
-         * A (2D) PML domain is able to attenuate sound in up to two directions.
+         * A (2D) PML domain is able to attenuate sound in up to two directions. The attenuation only varies
+         * in the direction of attenuation, so px and vx are profiles along the x axis (broadcast over the rows)
+         * and py and vy are profiles along the y axis (broadcast over the columns).
+         * An empty profile means that there is no attenuation in that direction.
          * @see apply_pml_matrices()
          */
+        template<typename T>
         struct PMLArrays {
-            Eigen::ArrayXXf px;
-            Eigen::ArrayXXf py;
-            Eigen::ArrayXXf vx;
-            Eigen::ArrayXXf vy;
+            ArrayXT<T> px;
+            ArrayXT<T> py;
+            ArrayXT<T> vx;
+            ArrayXT<T> vy;
         };
 
         /**
@@ -99,8 +105,10 @@ namespace OpenPSTD {
          *
          * This object stores the values for pressure and velocities, and references to its neighbours.
          * It supports boundaries with different impedance values as well as attenuating boundaries.
+         * @tparam T: scalar type of the field values (float or double)
          */
-        class Domain : public std::enable_shared_from_this<Domain> {
+        template<typename T>
+        class Domain : public std::enable_shared_from_this<Domain<T>> {
         public:
             /// Settings from the PSTDKernel
             std::shared_ptr<PSTDSettings> settings;
@@ -110,9 +118,9 @@ namespace OpenPSTD {
             float alpha;
             // Todo: What is the alpha coefficient?
             /// Impedance of the boundary
-            float impedance;
+            T impedance;
             /// Density of the domain interior. Defaults to air.
-            float rho;
+            T rho;
             /// Map with boundary coefficients
             std::map<Direction, EdgeParameters> edge_param_map;
             /// Map with update directions
@@ -123,19 +131,37 @@ namespace OpenPSTD {
             Point bottom_right;
             /// Domain size
             Point size;
+            /// Number of cells per cell of the base grid, in both directions. Positions, sizes and ranges
+            /// are in base grid units, the field arrays have refinement times as many cells.
+            int refinement;
+            /// Number of cells of the field arrays, the size times the refinement
+            Point cells;
             /// Whether the domain is a perfectly matched layer
             bool is_pml;
+            /// Whether the sound has reached the domain. Inactive domains are zero and are not computed.
+            bool active;
+            /// Number of independent sources that are simulated at once. The fields of the sources are
+            /// stacked in the rows of every field array, source s occupies the s-th block of rows.
+            int source_count;
             /// Another parameter (PML-related)
             //Todo: What is this local?
             bool local;
             /// Collection of state variables in this time step (not thread-safe)
-            FieldValues current_values;
+            FieldValues<T> current_values;
             /// Collection of state variables in previous time step (should be thread-safe)
-            FieldValues previous_values;
+            FieldValues<T> previous_values;
+            /// State variables at the time of the RK stage of neighbours that take other time steps
+            /// (the pressure and the velocities only), see use_exchange_values
+            FieldValues<T> exchange_values;
+            /// Whether the neighbours read exchange_values instead of current_values in calc()
+            bool use_exchange_values;
             /// Derivative approximations of the state variables
-            FieldLValues l_values;
+            FieldLValues<T> l_values;
+            /// Factor with which calc() scales the stored derivatives before adding the new ones.
+            /// Zero overwrites them; the low-storage RK scheme uses l_values as its stage register.
+            T l_values_factor;
             /// Pointer to WisdomCache object
-            std::shared_ptr<WisdomCache> wnd;
+            std::shared_ptr<WisdomCache<T>> wnd;
             /// Whether the domain is a PML domain for other PML domains
             bool is_secondary_pml;
             /// List of domains that this domain functions for as a PML
@@ -150,7 +176,7 @@ namespace OpenPSTD {
             int num_pml_neighbour_domains;
             bool has_horizontal_attenuation, is_corner_domain;
             std::vector<bool> needs_reversed_attenuation;
-            PMLArrays pml_arrays;
+            PMLArrays<T> pml_arrays;
         public:
 
             /**
@@ -166,7 +192,7 @@ namespace OpenPSTD {
              */
             Domain(std::shared_ptr<PSTDSettings> settings, int id, const float alpha,
                    Point top_left, Point size, const bool is_pml,
-                   std::shared_ptr<WisdomCache> wnd, std::map<Direction, EdgeParameters> edge_param_map,
+                   std::shared_ptr<WisdomCache<T>> wnd, std::map<Direction, EdgeParameters> edge_param_map,
                    const std::shared_ptr<Domain> pml_for_domain);
 
             /**
@@ -177,7 +203,7 @@ namespace OpenPSTD {
              */
             Domain(std::shared_ptr<PSTDSettings> settings, int id, const float alpha,
                    std::vector<float> top_left_vector, std::vector<float> size_vector, const bool is_pml,
-                   std::shared_ptr<WisdomCache> wnd, std::map<Direction, EdgeParameters> edge_param_map,
+                   std::shared_ptr<WisdomCache<T>> wnd, std::map<Direction, EdgeParameters> edge_param_map,
                    const std::shared_ptr<Domain> pml_for_domain);
 
             /**
@@ -186,6 +212,12 @@ namespace OpenPSTD {
              */
             void push_values();
 
+            /**
+             * The state variables that neighbours read at the interface with this domain
+             * @see use_exchange_values
+             */
+            const FieldValues<T> &get_exchange_values() const;
+
             /**
              * Clears the matrices used in computing the field values
              */
@@ -262,6 +294,16 @@ namespace OpenPSTD {
              */
             bool is_rigid();
 
+            /**
+             * Checks whether this domain is bounded by rigid walls on both sides in direction cd, in which case
+             * the spatial derivatives can be computed with spatderp3_reflecting().
+             * A missing neighbour counts as rigid when the edge of this (non-PML) domain does not absorb.
+             * @param d1 neighbour on the left (x) or bottom (y) side, or nullptr
+             * @param d2 neighbour on the right (x) or top (y) side, or nullptr
+             * @param cd direction of the derivative
+             */
+            bool is_reflecting(std::shared_ptr<Domain> d1, std::shared_ptr<Domain> d2, CalcDirection cd);
+
             /**
              * Returns a vector of 1d locations of all nodes spanned by the domain in world grid
              * coordinates in direction cd. This exists to facilitate porting the legacy code.
@@ -284,7 +326,7 @@ namespace OpenPSTD {
              * @param dest Values to be used as factor to compute derivative in wavenumber domain
              * @see kernel_functions.cpp
              */
-            Eigen::ArrayXXf calc(CalcDirection cd, CalculationType ct, Eigen::ArrayXcf dest);
+            ArrayXXT<T> calc(CalcDirection cd, CalculationType ct, ArrayXcT<T> dest);
 
             /**
              * Calculate one time step of propagation in this domain
@@ -314,7 +356,55 @@ namespace OpenPSTD {
              * @param y extension in y direction
              * @param z extension in z direction (default: 0)
              */
-            Eigen::ArrayXXf extended_zeros(int x, int y, int z = 0);
+            ArrayXXT<T> extended_zeros(int x, int y, int z = 0);
+
+            /**
+             * Zeroes for the fields of all sources, source_count copies of extended_zeros stacked in the rows
+             * @see extended_zeros
+             */
+            ArrayXXT<T> source_zeros(int x, int y);
+
+            /**
+             * Simulate several independent sources at once, clears all field values
+             * @param source_count: number of sources
+             */
+            void set_source_count(int source_count);
+
+            /**
+             * Refine the grid of the domain, clears all field values
+             * @param refinement: number of cells per cell of the base grid
+             */
+            void set_refinement(int refinement);
+
+            /**
+             * Grid spacing of the domain, the grid spacing of the settings divided by the refinement
+             */
+            float get_grid_spacing() const;
+
+            /**
+             * Rows of a field array that belong to a source
+             * @param field: field array of this domain, with the fields of all sources
+             * @param source: index of the source
+             */
+            Eigen::Block<const ArrayXXT<T>> get_source_block(const ArrayXXT<T> &field, int source) const;
+
+            /**
+             * Number of bytes allocated for the field values, derivatives and PML arrays of this domain
+             */
+            unsigned long get_field_memory() const;
+
+            /**
+             * Largest absolute pressure or velocity value in the domain
+             */
+            T get_amplitude();
+
+            /**
+             * Largest absolute pressure or velocity value in the cells along one of the domain edges.
+             * These are the values that neighbours in that direction use as halo.
+             * @param direction: Domain side under consideration
+             * @param width: Number of cells from the edge
+             */
+            T get_edge_amplitude(Direction direction, int width);
 
             /**
              * Create a string representation of a domain
@@ -325,12 +415,37 @@ namespace OpenPSTD {
         private:
             void initialize_domain(std::shared_ptr<PSTDSettings> settings, int id, const float alpha,
                                    Point top_left, Point size, const bool is_pml,
-                                   std::shared_ptr<WisdomCache> wnd,
+                                   std::shared_ptr<WisdomCache<T>> wnd,
                                    std::map<Direction, EdgeParameters> edge_param_map,
                                    const std::shared_ptr<Domain> pml_for_domain);
 
             void clear_fields();
 
+            /**
+             * Rows [start, start + count) of every source, stacked in the rows (batch of the X derivative)
+             */
+            ArrayXXT<T> stack_source_rows(const ArrayXXT<T> &field, int start, int count);
+
+            /**
+             * Columns [start, start + count) of every source, placed side by side (batch of the Y derivative)
+             */
+            ArrayXXT<T> stack_source_columns(const ArrayXXT<T> &field, int start, int count);
+
+            /**
+             * Resample the strip of the field of a neighbour with another refinement that borders on this domain
+             * to the refinement of this domain. Across the direction of the derivative the whole field is resampled.
+             * @param field: field array of the neighbour, with the fields of all sources
+             * @param from: refinement of the neighbour
+             * @param x_faces: the values lie on the cell faces in x direction (vx)
+             * @param y_faces: the values lie on the cell faces in y direction (vy)
+             * @param cd: direction of the derivative
+             * @param before: the neighbour lies before this domain, so its last points border on it
+             * @param strip: number of points of the strip along the direction of the derivative
+             * @see get_resampling_matrix()
+             */
+            ArrayXXT<T> resample_neighbour(const ArrayXXT<T> &field, int from, bool x_faces, bool y_faces,
+                                           CalcDirection cd, bool before, int strip);
+
             void clear_pml_arrays();
 
             void find_update_directions();
@@ -339,11 +454,11 @@ namespace OpenPSTD {
 
             int get_num_pmls_in_direction(Direction direction);
 
-            void create_attenuation_array(CalcDirection calc_dir, bool ascending, Eigen::ArrayXXf &pml_pressure,
-                                          Eigen::ArrayXXf &pml_velocity);
+            void create_attenuation_array(bool ascending, ArrayXT<T> &pml_pressure, ArrayXT<T> &pml_velocity);
         };
 
-        std::ostream &operator<<(std::ostream &str, Domain const &v);
+        template<typename T>
+        std::ostream &operator<<(std::ostream &str, Domain<T> const &v);
     }
 }
 
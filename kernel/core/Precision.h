@@ -0,0 +1,149 @@
+//////////////////////////////////////////////////////////////////////////
+// This file is part of openPSTD.                                       //
+//                                                                      //
+// openPSTD is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU General Public License as published by //
+// the Free Software Foundation, either version 3 of the License, or    //
+// (at your option) any later version.                                  //
+//                                                                      //
+// openPSTD is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of       //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        //
+// GNU General Public License for more details.                         //
+//                                                                      //
+// You should have received a copy of the GNU General Public License    //
+// along with openPSTD.  If not, see <http://www.gnu.org/licenses/>.    //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Date:
+//      18-10-2026
+//
+// Purpose:
+//      Scalar type dependent definitions of the kernel core. The kernel
+//      is instantiated for float (production) and double (validation);
+//      this file maps the scalar type to Eigen arrays and to the FFTW
+//      library of the matching precision.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#ifndef OPENPSTD_PRECISION_H
+#define OPENPSTD_PRECISION_H
+
+#include <complex>
+#include <fftw3.h>
+#include <Eigen/Dense>
+
+namespace OpenPSTD {
+    namespace Kernel {
+
+        /**
+         * Dynamic 2D array of scalar type T (ArrayXXf for float, ArrayXXd for double)
+         */
+        template<typename T>
+        using ArrayXXT = Eigen::Array<T, Eigen::Dynamic, Eigen::Dynamic>;
+
+        /**
+         * Dynamic 1D array of scalar type T (ArrayXf for float, ArrayXd for double)
+         */
+        template<typename T>
+        using ArrayXT = Eigen::Array<T, Eigen::Dynamic, 1>;
+
+        /**
+         * Dynamic 1D array of complex numbers with scalar type T (ArrayXcf for float, ArrayXcd for double)
+         */
+        template<typename T>
+        using ArrayXcT = Eigen::Array<std::complex<T>, Eigen::Dynamic, 1>;
+
+        /**
+         * Thin wrapper around the FFTW API of the precision matching T.
+         *
+         * FFTW ships a separate library per precision with prefixed symbols (fftwf_ for float,
+         * fftw_ for double). Only the calls used by the kernel are wrapped.
+         */
+        template<typename T>
+        struct FFTW;
+
+        template<>
+        struct FFTW<float> {
+            typedef fftwf_plan plan;
+            typedef fftwf_complex complex;
+
+            static void *malloc(size_t n) { return fftwf_malloc(n); }
+
+            static void free(void *p) { fftwf_free(p); }
+
+            static plan plan_many_dft_r2c(int rank, const int *n, int howmany, float *in, const int *inembed,
+                                          int istride, int idist, complex *out, const int *onembed,
+                                          int ostride, int odist, unsigned flags) {
+                return fftwf_plan_many_dft_r2c(rank, n, howmany, in, inembed, istride, idist,
+                                               out, onembed, ostride, odist, flags);
+            }
+
+            static plan plan_many_dft_c2r(int rank, const int *n, int howmany, complex *in, const int *inembed,
+                                          int istride, int idist, float *out, const int *onembed,
+                                          int ostride, int odist, unsigned flags) {
+                return fftwf_plan_many_dft_c2r(rank, n, howmany, in, inembed, istride, idist,
+                                               out, onembed, ostride, odist, flags);
+            }
+
+            static void execute_dft_r2c(const plan p, float *in, complex *out) { fftwf_execute_dft_r2c(p, in, out); }
+
+            static void execute_dft_c2r(const plan p, complex *in, float *out) { fftwf_execute_dft_c2r(p, in, out); }
+
+            static plan plan_many_r2r(int rank, const int *n, int howmany, float *in, const int *inembed,
+                                      int istride, int idist, float *out, const int *onembed,
+                                      int ostride, int odist, const fftw_r2r_kind *kind, unsigned flags) {
+                return fftwf_plan_many_r2r(rank, n, howmany, in, inembed, istride, idist,
+                                           out, onembed, ostride, odist, kind, flags);
+            }
+
+            static void execute_r2r(const plan p, float *in, float *out) { fftwf_execute_r2r(p, in, out); }
+
+            static void destroy_plan(plan p) { fftwf_destroy_plan(p); }
+        };
+
+        template<>
+        struct FFTW<double> {
+            typedef fftw_plan plan;
+            typedef fftw_complex complex;
+
+            static void *malloc(size_t n) { return fftw_malloc(n); }
+
+            static void free(void *p) { fftw_free(p); }
+
+            static plan plan_many_dft_r2c(int rank, const int *n, int howmany, double *in, const int *inembed,
+                                          int istride, int idist, complex *out, const int *onembed,
+                                          int ostride, int odist, unsigned flags) {
+                return fftw_plan_many_dft_r2c(rank, n, howmany, in, inembed, istride, idist,
+                                              out, onembed, ostride, odist, flags);
+            }
+
+            static plan plan_many_dft_c2r(int rank, const int *n, int howmany, complex *in, const int *inembed,
+                                          int istride, int idist, double *out, const int *onembed,
+                                          int ostride, int odist, unsigned flags) {
+                return fftw_plan_many_dft_c2r(rank, n, howmany, in, inembed, istride, idist,
+                                              out, onembed, ostride, odist, flags);
+            }
+
+            static void execute_dft_r2c(const plan p, double *in, complex *out) { fftw_execute_dft_r2c(p, in, out); }
+
+            static void execute_dft_c2r(const plan p, complex *in, double *out) { fftw_execute_dft_c2r(p, in, out); }
+
+            static plan plan_many_r2r(int rank, const int *n, int howmany, double *in, const int *inembed,
+                                      int istride, int idist, double *out, const int *onembed,
+                                      int ostride, int odist, const fftw_r2r_kind *kind, unsigned flags) {
+                return fftw_plan_many_r2r(rank, n, howmany, in, inembed, istride, idist,
+                                          out, onembed, ostride, odist, kind, flags);
+            }
+
+            static void execute_r2r(const plan p, double *in, double *out) { fftw_execute_r2r(p, in, out); }
+
+            static void destroy_plan(plan p) { fftw_destroy_plan(p); }
+        };
+    }
+}
+
+#endif //OPENPSTD_PRECISION_H
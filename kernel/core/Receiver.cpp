@@ -31,8 +31,10 @@ using namespace Eigen;
 using namespace std;
 namespace OpenPSTD {
     namespace Kernel {
-        Receiver::Receiver(vector<float> location, shared_ptr<PSTDSettings> config, unsigned long id,
-                           shared_ptr<Domain> container) : x(location.at(0)), y(location.at(1)), z(location.at(2)) {
+        template<typename T>
+        Receiver<T>::Receiver(vector<float> location, shared_ptr<PSTDSettings> config, unsigned long id,
+                              shared_ptr<Domain<T>> container) : x(location.at(0)), y(location.at(1)),
+                                                                 z(location.at(2)) {
             this->config = config;
             this->location = location;
             this->container_domain = container;
@@ -43,19 +45,21 @@ namespace OpenPSTD {
             this->id = id;
         }
 
-        float Receiver::compute_local_pressure() {
-            float pressure;
+        template<typename T>
+        T Receiver<T>::compute_local_pressure(int source) {
+            T pressure;
             if (config->GetSpectralInterpolation() && false) { //always use nn until si is fixed (TODO: re-enable)
                 pressure = compute_with_si();
             }
             else {
-                pressure = compute_with_nn();
+                pressure = compute_with_nn(source);
             }
             received_values.push_back(pressure);
             return pressure;
         }
 
-        ArrayXcf Receiver::get_fft_factors(Point size, CalcDirection bt) {
+        template<typename T>
+        ArrayXcT<T> Receiver<T>::get_fft_factors(Point size, CalcDirection bt) {
             int primary_dimension = 0;
             if (bt == CalcDirection::X) {
                 primary_dimension = size.x;
@@ -66,58 +70,69 @@ namespace OpenPSTD {
             float dx = config->GetGridSpacing();
             int wave_length_number = (int) (2 * config->GetWaveLength() + primary_dimension + 1);
             //Pressure grid is staggered, hence + 1
-            WisdomCache::Discretization discr = container_domain->wnd->get_discretization(dx, wave_length_number);
+            typename WisdomCache<T>::Discretization discr = container_domain->wnd->get_discretization(dx, wave_length_number);
             float offset = grid_offset.at(static_cast<unsigned long>(bt));
-            ArrayXcf fft_factors(discr.wave_numbers.rows());
+            ArrayXcT<T> fft_factors(discr.wave_numbers.rows());
             for (int i = 0; i < discr.wave_numbers.rows(); i++) {
-                float wave_number = discr.wave_numbers(i);
-                complex<float> complex_factor = discr.complex_factors(i);
-                fft_factors(i) = exp(offset * dx * wave_number * complex_factor);
+                T wave_number = discr.wave_numbers(i);
+                complex<T> complex_factor = discr.complex_factors(i);
+                fft_factors(i) = exp(T(offset * dx) * wave_number * complex_factor);
             }
             return fft_factors;
         }
 
-        float Receiver::compute_with_nn() {
+        template<typename T>
+        T Receiver<T>::compute_with_nn(int source) {
             Point rel_location = grid_location - container_domain->top_left;
-            return container_domain->current_values.p0(rel_location.x, rel_location.y);
+            int r = container_domain->refinement;
+            if (r > 1) {
+                // The cell of the refined grid that contains the receiver
+                rel_location = Point((int) ((x - container_domain->top_left.x) * r),
+                                     (int) ((y - container_domain->top_left.y) * r));
+            }
+            // The fields have the shape (y, x)
+            return container_domain->get_source_block(container_domain->current_values.p0, source)(rel_location.y,
+                                                                                                 rel_location.x);
         }
 
-        float Receiver::compute_with_si() {
-            shared_ptr<Domain> top_domain = container_domain->get_neighbour_at(Direction::TOP, location);
-            shared_ptr<Domain> bottom_domain = container_domain->get_neighbour_at(Direction::BOTTOM, location);
-            ArrayXXf p0dx = calc_domain_fields(container_domain, CalcDirection::X);
+        template<typename T>
+        T Receiver<T>::compute_with_si() {
+            shared_ptr<Domain<T>> top_domain = container_domain->get_neighbour_at(Direction::TOP, location);
+            shared_ptr<Domain<T>> bottom_domain = container_domain->get_neighbour_at(Direction::BOTTOM, location);
+            ArrayXXT<T> p0dx = calc_domain_fields(container_domain, CalcDirection::X);
             int rel_x_point = grid_location.x - container_domain->top_left.x;
-            ArrayXXf p0dx_slice = p0dx.middleCols(rel_x_point, 1);
+            ArrayXXT<T> p0dx_slice = p0dx.middleCols(rel_x_point, 1);
 
-            ArrayXXf p0dx_top = calc_domain_fields(top_domain, CalcDirection::X);
+            ArrayXXT<T> p0dx_top = calc_domain_fields(top_domain, CalcDirection::X);
             int top_rel_x_point = grid_location.x - top_domain->top_left.x;
-            ArrayXXf p0dx_top_slice = p0dx_top.middleCols(top_rel_x_point, 1);
+            ArrayXXT<T> p0dx_top_slice = p0dx_top.middleCols(top_rel_x_point, 1);
 
-            ArrayXXf p0dx_bottom = calc_domain_fields(bottom_domain, CalcDirection::X);
+            ArrayXXT<T> p0dx_bottom = calc_domain_fields(bottom_domain, CalcDirection::X);
             int bottom_rel_x_point = grid_location.x - bottom_domain->top_left.x;
-            ArrayXXf p0dx_bottom_slice = p0dx_bottom.middleCols(bottom_rel_x_point, 1);
-
-            ArrayXcf z_fact = get_fft_factors(Point(1, container_domain->size.y), CalcDirection::Y);
-            float wave_number = 2 * config->GetWaveLength() + container_domain->size.y + 1;
-            int opt_wave_number = next_2_power(wave_number);
+            ArrayXXT<T> p0dx_bottom_slice = p0dx_bottom.middleCols(bottom_rel_x_point, 1);
 
-            RhoArray rho_array = get_rho_array(top_domain->rho, container_domain->rho, bottom_domain->rho);
+            ArrayXcT<T> z_fact = get_fft_factors(Point(1, container_domain->size.y), CalcDirection::Y);
+            RhoArray<T> rho_array = get_rho_array<T>(top_domain->rho, container_domain->rho, bottom_domain->rho);
 
-            ArrayXXf p0shift = spatderp3(p0dx_bottom_slice, p0dx_slice, p0dx_top_slice,
-                                         z_fact, rho_array, get_window_coefficients(70.0f, config->GetWindowSize()),
-                                         config->GetWindowSize(), CalculationType::PRESSURE, CalcDirection::Y);
+            ArrayXXT<T> p0shift = spatderp3<T>(p0dx_bottom_slice, p0dx_slice, p0dx_top_slice,
+                                               z_fact, rho_array, get_window_coefficients<T>(70.0f, config->GetWindowSize()),
+                                               config->GetWindowSize(), CalculationType::PRESSURE, CalcDirection::Y);
 
             int rel_y_point = grid_location.y - container_domain->top_left.y;
-            float si_value = p0shift(rel_y_point, 0);
+            T si_value = p0shift(rel_y_point, 0);
             return si_value;
         }
 
         // Todo: Different name;
         // Todo: Can we improve memory management here?
-        ArrayXXf Receiver::calc_domain_fields(shared_ptr<Domain> domain, CalcDirection bt) {
+        template<typename T>
+        ArrayXXT<T> Receiver<T>::calc_domain_fields(shared_ptr<Domain<T>> domain, CalcDirection bt) {
             int win_size = config->GetWindowSize();
             Point domsize_windowed(domain->size.x + 2 * win_size, domain->size.y + 2 * win_size, domain->size.z + 2 * win_size);
             return domain->calc(bt, CalculationType::PRESSURE, get_fft_factors(domsize_windowed, bt));
         }
+
+        template class Receiver<float>;
+        template class Receiver<double>;
     }
 }
\ No newline at end of file
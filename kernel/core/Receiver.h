@@ -53,6 +53,7 @@ namespace OpenPSTD {
          * If the Receiver is not located on a grid point, the sound values are interpolated,
          * either from the nearest grid point or using a spectral interpolation method.
          */
+        template<typename T>
         class Receiver {
 
         public:
@@ -84,13 +85,14 @@ namespace OpenPSTD {
             /**
              * Domain containing the receiver
              */
-            std::shared_ptr<Domain> container_domain;
+            std::shared_ptr<Domain<T>> container_domain;
 
             /**
-             * Vector of observed pressure values in the receiver
+             * Vector of observed pressure values in the receiver.
+             * With several sources, the values of all sources of a time step follow each other.
              */
 
-            std::vector<float> received_values;
+            std::vector<T> received_values;
 
             /**
              * Initializes a receiver on coordinates (x,y,z) in grid space (not fixed to integers)
@@ -100,7 +102,7 @@ namespace OpenPSTD {
              * @param container: The domain in which the receiver is located. This should not be a PML-domain.
              */
             Receiver(std::vector<float> location, std::shared_ptr<PSTDSettings> config, unsigned long id,
-                     std::shared_ptr<Domain> container);
+                     std::shared_ptr<Domain<T>> container);
 
             /**
              * Calculates the sound pressure at the receiver at the current time step.
@@ -108,32 +110,33 @@ namespace OpenPSTD {
              * or spectral interpolation (slower, more accurate)
              * @see spatderp3
              * @see config
-             * @return float approximation of the sound pressure in receiver location
+             * @param source: index of the source of which the pressure is computed (default: 0)
+             * @return approximation of the sound pressure in receiver location
              */
-            float compute_local_pressure();
+            T compute_local_pressure(int source = 0);
 
         private:
             /**
              * Computes the fft_factors along the provided boundary
              */
-            Eigen::ArrayXcf get_fft_factors(Point size, CalcDirection bt);
+            ArrayXcT<T> get_fft_factors(Point size, CalcDirection bt);
 
             /**
              * Computes the pressure from the nearest neighbour
              * @return nearest neighbour pressure approximation
              */
-            float compute_with_nn();
+            T compute_with_nn(int source);
 
             /**
              * Computes the pressure using spectral interpolation
              * @return spectral interpolated pressure approximation
              */
-            float compute_with_si();
+            T compute_with_si();
 
             /**
              * Compute the pressure for the receiver.
              */
-            Eigen::ArrayXXf calc_domain_fields(std::shared_ptr<Domain> container, CalcDirection bt);
+            ArrayXXT<T> calc_domain_fields(std::shared_ptr<Domain<T>> container, CalcDirection bt);
 
         };
 
@@ -30,7 +30,8 @@
 using namespace std;
 namespace OpenPSTD {
     namespace Kernel {
-        Scene::Scene(shared_ptr<PSTDSettings> settings) {
+        template<typename T>
+        Scene<T>::Scene(shared_ptr<PSTDSettings> settings) {
             this->settings = settings;
             this->top_left = Point(0, 0);
             this->bottom_right = Point(0, 0);
@@ -38,15 +39,16 @@ namespace OpenPSTD {
             number_of_domains = 0;
         }
 
-        void Scene::add_pml_domains() {
+        template<typename T>
+        void Scene<T>::add_pml_domains() {
             int number_of_cells = settings->GetPMLCells();
             vector<Direction> directions{Direction::LEFT, Direction::TOP, Direction::RIGHT, Direction::BOTTOM};
             vector<string> dir_strings{"left", "top", "right", "bottom"};
 
-            vector<shared_ptr<Domain>> first_order_pmls;
-            map<shared_ptr<Domain>, Direction> second_order_pml_map;
+            vector<shared_ptr<Domain<T>>> first_order_pmls;
+            map<shared_ptr<Domain<T>>, Direction> second_order_pml_map;
 
-            for (shared_ptr<Domain> domain:domain_list) {
+            for (shared_ptr<Domain<T>> domain:domain_list) {
                 if (domain->is_pml) {
                     continue;
                 }
@@ -104,7 +106,7 @@ namespace OpenPSTD {
                                 break;
                         }
 
-                        shared_ptr<Domain> pml_domain_ptr = make_shared<Domain>(
+                        shared_ptr<Domain<T>> pml_domain_ptr = make_shared<Domain<T>>(
                                 settings, pml_id, pml_alpha, pml_top_left, pml_size_pointer, true,
                                 domain->wnd, default_edge_parameters, domain);
                         //cout << *pml_domain_ptr << endl;
@@ -154,7 +156,7 @@ namespace OpenPSTD {
                                 Point sec_pml_offset(sec_x_offset, sec_y_offset);
                                 Point sec_pml_top_left = domain->top_left + pml_offset + sec_pml_offset;
                                 Point sec_pml_size(number_of_cells, number_of_cells);
-                                shared_ptr<Domain> sec_pml_domain = make_shared<Domain>(settings, second_pml_id, second_pml_alpha, sec_pml_top_left,
+                                shared_ptr<Domain<T>> sec_pml_domain = make_shared<Domain<T>>(settings, second_pml_id, second_pml_alpha, sec_pml_top_left,
                                                    sec_pml_size, true, domain->wnd, default_edge_parameters, pml_domain_ptr);
                                 second_order_pml_map[sec_pml_domain] = second_dir;
                                 //cout << *sec_pml_domain << endl;
@@ -163,15 +165,15 @@ namespace OpenPSTD {
                     }
                 }
             }
-            for (shared_ptr<Domain> domain:first_order_pmls) {
+            for (shared_ptr<Domain<T>> domain:first_order_pmls) {
                 add_domain(domain);
             }
 
             //Collect the domains with the same top and size.
-            map<vector<int>, vector<shared_ptr<Domain>>> domains_by_cornerpoints;
+            map<vector<int>, vector<shared_ptr<Domain<T>>>> domains_by_cornerpoints;
 
             for (auto &entry: second_order_pml_map) {
-                shared_ptr<Domain> parent_domain = entry.first->pml_for_domain_list.at(0);
+                shared_ptr<Domain<T>> parent_domain = entry.first->pml_for_domain_list.at(0);
                 Direction second_dir = entry.second;
                 if (!parent_domain->get_neighbours_at(second_dir).empty()) {
                     continue;
@@ -180,7 +182,7 @@ namespace OpenPSTD {
                 domains_by_cornerpoints[corner_points].push_back(entry.first);
 
             }
-            vector<shared_ptr<Domain>> second_order_pml_list;
+            vector<shared_ptr<Domain<T>>> second_order_pml_list;
             for (auto &entry: domains_by_cornerpoints) {
                 if (entry.second.size() == 1) {
                     for (auto sec_pml_domain:entry.second) {
@@ -188,11 +190,11 @@ namespace OpenPSTD {
                     }
                     continue;
                 }
-                vector<shared_ptr<Domain>> processed_domains;
+                vector<shared_ptr<Domain<T>>> processed_domains;
                 for (unsigned long i = 0; i < entry.second.size(); i++) {
                     for (unsigned long j = i + 1; j < entry.second.size(); j++) {
-                        shared_ptr<Domain> domain_i = entry.second.at(i);
-                        shared_ptr<Domain> domain_j = entry.second.at(j);
+                        shared_ptr<Domain<T>> domain_i = entry.second.at(i);
+                        shared_ptr<Domain<T>> domain_j = entry.second.at(j);
                         bool processed_i =
                                 find(processed_domains.begin(), processed_domains.end(), domain_i) !=
                                 processed_domains.end();
@@ -225,7 +227,8 @@ namespace OpenPSTD {
         }
 
 
-        vector<int> Scene::get_corner_points(shared_ptr<Domain> domain) {
+        template<typename T>
+        vector<int> Scene<T>::get_corner_points(shared_ptr<Domain<T>> domain) {
             vector<int> corner_points;
             corner_points.push_back(domain->top_left.x);
             corner_points.push_back(domain->top_left.y);
@@ -235,13 +238,15 @@ namespace OpenPSTD {
         }
 
 
-        bool Scene::should_merge_domains(shared_ptr<Domain> domain1, shared_ptr<Domain> domain2) {
-            shared_ptr<Domain> parent_domain1 = get_singular_parent_domain(get_singular_parent_domain(domain1));
-            shared_ptr<Domain> parent_domain2 = get_singular_parent_domain(get_singular_parent_domain(domain2));
+        template<typename T>
+        bool Scene<T>::should_merge_domains(shared_ptr<Domain<T>> domain1, shared_ptr<Domain<T>> domain2) {
+            shared_ptr<Domain<T>> parent_domain1 = get_singular_parent_domain(get_singular_parent_domain(domain1));
+            shared_ptr<Domain<T>> parent_domain2 = get_singular_parent_domain(get_singular_parent_domain(domain2));
             return ((parent_domain1 != nullptr) and (parent_domain1->id == parent_domain2->id));
         }
 
-        shared_ptr<Domain> Scene::get_singular_parent_domain(shared_ptr<Domain> domain) {
+        template<typename T>
+        shared_ptr<Domain<T>> Scene<T>::get_singular_parent_domain(shared_ptr<Domain<T>> domain) {
             if (domain != nullptr) {
                 if (domain->is_pml && domain->pml_for_domain_list.size() == 1) {
                     return domain->pml_for_domain_list.at(0);
@@ -251,20 +256,22 @@ namespace OpenPSTD {
         }
 
 
-        void Scene::add_receiver(const float x, const float y, const float z, unsigned long id) {
+        template<typename T>
+        void Scene<T>::add_receiver(const float x, const float y, const float z, unsigned long id) {
             vector<float> grid_like_location = {x, y, z};
-            shared_ptr<Domain> container(nullptr);
+            shared_ptr<Domain<T>> container(nullptr);
             for (auto domain:domain_list) {
                 if (!domain->is_pml && domain->contains_location(grid_like_location)) {
                     container = domain;
                 }
             }
             assert(container != nullptr);
-            shared_ptr<Receiver> receiver = make_shared<Receiver>(grid_like_location, settings, id, container);
+            shared_ptr<Receiver<T>> receiver = make_shared<Receiver<T>>(grid_like_location, settings, id, container);
             receiver_list.push_back(receiver);
         }
 
-        void Scene::add_speaker(const float x, const float y, const float z) {
+        template<typename T>
+        void Scene<T>::add_speaker(const float x, const float y, const float z, int source) {
             // Do not really need to be on the heap. Doing it now for consistency with Receiver.
 
             // Put 0,0 at the actual point 0,0 instead of in the middle of the first pressure sample
@@ -272,13 +279,14 @@ namespace OpenPSTD {
             vector<float> grid_like_location = {x - dx_2, y - dx_2, z - dx_2};
             shared_ptr<Speaker> speaker = make_shared<Speaker>(grid_like_location);
             for (unsigned long i = 0; i < domain_list.size(); i++) {
-                speaker->addDomainContribution(domain_list.at(i));
+                speaker->addDomainContribution(domain_list.at(i), source);
                 // Todo: Only add when speaker in domain
             }
             speaker_list.push_back(speaker);
         }
 
-        void Scene::compute_pml_matrices() {
+        template<typename T>
+        void Scene<T>::compute_pml_matrices() {
             for (auto domain:domain_list) {
                 if (domain->is_pml) {
                     domain->compute_pml_matrices();
@@ -286,15 +294,17 @@ namespace OpenPSTD {
             }
         }
 
-        void Scene::apply_pml_matrices() {
+        template<typename T>
+        void Scene<T>::apply_pml_matrices() {
             for (auto domain:domain_list) {
-                if (domain->is_pml) {
+                if (domain->is_pml and domain->active) {
                     domain->apply_pml_matrices();
                 }
             }
         }
 
-        void Scene::add_domain(shared_ptr<Domain> domain) {
+        template<typename T>
+        void Scene<T>::add_domain(shared_ptr<Domain<T>> domain) {
             if (not domain->is_pml) {
                 top_left = Point(min(top_left.x, domain->top_left.x),
                                  min(top_left.y, domain->top_left.y));
@@ -304,7 +314,7 @@ namespace OpenPSTD {
                 // Todo: Topleft, bottom right and size are never read from
             }
             for (unsigned long i = 0; i < domain_list.size(); i++) {
-                shared_ptr<Domain> other_domain = domain_list.at(i);
+                shared_ptr<Domain<T>> other_domain = domain_list.at(i);
                 if (domain->is_secondary_pml && other_domain->is_secondary_pml) {
                     // Cannot interact, since no secondary PML domains are adjacent
                     continue;
@@ -369,7 +379,7 @@ namespace OpenPSTD {
                 if (is_neighbour && !other_domain_pml_for_different_domain && !domain_pml_for_different_domain) {
                     intersection = domain->get_intersection_with(other_domain, orientation);
                     if (intersection.size()) {
-                        shared_ptr<Boundary> boundary = make_shared<Boundary>(domain, other_domain, bt);
+                        shared_ptr<Boundary<T>> boundary = make_shared<Boundary<T>>(domain, other_domain, bt);
                         boundary_list.push_back(boundary);
                         domain->add_neighbour_at(other_domain, orientation);
                         other_domain->add_neighbour_at(domain, get_opposite(orientation));
@@ -379,15 +389,22 @@ namespace OpenPSTD {
             domain_list.push_back(domain);
         }
 
-        ostream &operator<<(ostream &str, Scene const &v) {
+        template<typename T>
+        ostream &operator<<(ostream &str, Scene<T> const &v) {
             return str << "Scene: " << v.domain_list.size() << " domains, " << v.speaker_list.size() << " speakers, " <<
                    v.receiver_list.size() << " receivers";
 
         }
 
-        int Scene::get_new_id() {
+        template<typename T>
+        int Scene<T>::get_new_id() {
             number_of_domains++;
             return number_of_domains - 1;
         }
+
+        template class Scene<float>;
+        template class Scene<double>;
+        template ostream &operator<<(ostream &str, Scene<float> const &v);
+        template ostream &operator<<(ostream &str, Scene<double> const &v);
     }
 }
@@ -51,11 +51,13 @@ namespace OpenPSTD {
          *
          * This class holds all the (PML) domains through which the sound propagates.
          * It also has a reference to all speakers and receivers as well as the boundaries.
+         * @tparam T: scalar type of the field values (float or double)
          */
+        template<typename T>
         class Scene {
         public:
             /// List with domains
-            std::vector<std::shared_ptr<Domain>> domain_list;
+            std::vector<std::shared_ptr<Domain<T>>> domain_list;
             /// Settings for the simulation
             std::shared_ptr<PSTDSettings> settings;
             /// Top left of the most top left domain
@@ -65,8 +67,8 @@ namespace OpenPSTD {
             /// Difference between top left and bottom right
             Point size;
 
-            std::vector<std::shared_ptr<Boundary>> boundary_list;
-            std::vector<std::shared_ptr<Receiver>> receiver_list;
+            std::vector<std::shared_ptr<Boundary<T>>> boundary_list;
+            std::vector<std::shared_ptr<Receiver<T>>> receiver_list;
             std::vector<std::shared_ptr<Speaker>> speaker_list;
         private:
             /// Set with default parameters for domain separators
@@ -99,15 +101,16 @@ namespace OpenPSTD {
              * @param x coordinate on grid in x dimension
              * @param y coordinate on grid in y dimension
              * @param x coordinate on grid in z dimension
+             * @param source index of the source of the domains that the speaker emits into (default: 0)
              */
-            void add_speaker(const float x, const float y, const float z);
+            void add_speaker(const float x, const float y, const float z, int source = 0);
 
             /**
              * Add domain to the scene. Checks for every other domain
              * whether they share a boundary and processes pml domains correctly
              * @param domain: pointer to domain object to be added.
              */
-            void add_domain(std::shared_ptr<Domain> domain);
+            void add_domain(std::shared_ptr<Domain<T>> domain);
 
             /**
              * Computes the perfectly matched layer matrix coefficients for each domain in the scene.
@@ -136,23 +139,24 @@ namespace OpenPSTD {
              * Helper function for add_pml_domains.
              * Collects the topleft and bottom right points of a domain.
              */
-            std::vector<int> get_corner_points(std::shared_ptr<Domain> domain);
+            std::vector<int> get_corner_points(std::shared_ptr<Domain<T>> domain);
 
             /**
              * Helper function for add_pml_domains
              * Checks if two pml domains can (and should) be merged.
              */
 
-            bool should_merge_domains(std::shared_ptr<Domain> domain1, std::shared_ptr<Domain> domain2);
+            bool should_merge_domains(std::shared_ptr<Domain<T>> domain1, std::shared_ptr<Domain<T>> domain2);
 
             /**
              * Helper function for add_pml_domains
              * Finds the common parent of two pml domains.
              */
-            std::shared_ptr<Domain> get_singular_parent_domain(std::shared_ptr<Domain> domain);
+            std::shared_ptr<Domain<T>> get_singular_parent_domain(std::shared_ptr<Domain<T>> domain);
         };
 
-        std::ostream &operator<<(std::ostream &str, Scene const &v);
+        template<typename T>
+        std::ostream &operator<<(std::ostream &str, Scene<T> const &v);
     }
 }
 
@@ -18,24 +18,33 @@ namespace OpenPSTD {
                                              this->location.at(2) - grid_point.z};
         }
 
-        void Speaker::addDomainContribution(std::shared_ptr<Domain> domain) {
+        template<typename T>
+        void Speaker::addDomainContribution(std::shared_ptr<Domain<T>> domain, int source) {
             float dx = domain->settings->GetGridSpacing();
             float rel_x = this->x - domain->top_left.x;
             float rel_y = this->y - domain->top_left.y;
-            for (int i = 0; i < domain->size.x; i++) {
-                for (int j = 0; j < domain->size.y; j++) {
-                    float squared_distance = SQR((rel_x - i) * dx) + SQR((rel_y - j) * dx);
+            int r = domain->refinement;
+            int row_offset = source * domain->cells.y;
+            for (int i = 0; i < domain->cells.x; i++) {
+                // Position of the cell in base grid units, shifted like the location of the speaker
+                float cell_x = (i + 0.5f) / r - 0.5f;
+                for (int j = 0; j < domain->cells.y; j++) {
+                    float cell_y = (j + 0.5f) / r - 0.5f;
+                    float squared_distance = SQR((rel_x - cell_x) * dx) + SQR((rel_y - cell_y) * dx);
                     float pressure = std::exp(-domain->settings->GetBandWidth() * squared_distance);
                     // Vectorized versions of above expressions exists
                     // but we need to get into a for loop anyway, because of atan2
-                    float angle = std::atan2(rel_x - i,rel_y - j);
+                    float angle = std::atan2(rel_x - cell_x, rel_y - cell_y);
                     float horizontal_component = SQR(std::cos(angle)) * pressure;
                     float vertical_component = SQR(std::sin(angle)) * pressure;
-                    domain->current_values.p0(j, i) += pressure;
-                    domain->current_values.px0(j, i) += horizontal_component;
-                    domain->current_values.py0(j, i) += vertical_component;
+                    domain->current_values.p0(row_offset + j, i) += pressure;
+                    domain->current_values.px0(row_offset + j, i) += horizontal_component;
+                    domain->current_values.py0(row_offset + j, i) += vertical_component;
                 }
             }
         }
+
+        template void Speaker::addDomainContribution<float>(std::shared_ptr<Domain<float>> domain, int source);
+        template void Speaker::addDomainContribution<double>(std::shared_ptr<Domain<double>> domain, int source);
     }
 }
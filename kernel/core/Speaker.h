@@ -71,8 +71,10 @@ namespace OpenPSTD {
              * with bandwidth @f$\beta = -3e^{-6}c^2/dx^2@f$
              * and speaker location @f$(x_s,y_s)@f$.
              * @param domain: domain to compute sound pressure contribution for
+             * @param source: index of the field set of the domain that the pressure is added to
              */
-            void addDomainContribution(std::shared_ptr<Domain> domain);
+            template<typename T>
+            void addDomainContribution(std::shared_ptr<Domain<T>> domain, int source = 0);
 
         };
     }
@@ -34,48 +34,59 @@ namespace OpenPSTD {
     namespace Kernel {
 
 
-        WisdomCache::WisdomCache() { };
+        template<typename T>
+        WisdomCache<T>::WisdomCache(FFTLengthPolicy policy) : policy(policy) { };
 
-        WisdomCache::Discretization WisdomCache::get_discretization(float dx, int N) {
+        template<typename T>
+        int WisdomCache<T>::get_fft_length(int N) {
+            return Kernel::get_fft_length(N, this->policy);
+        }
+
+        template<typename T>
+        typename WisdomCache<T>::Discretization WisdomCache<T>::get_discretization(float dx, int N) {
             int matched_int = this->match_number(N);
-            auto search = this->computed_discretization.find(matched_int); // Crashes here
+            // Refined domains use a smaller grid spacing with the same FFT lengths
+            std::pair<float, int> key(dx, matched_int);
+            std::lock_guard<std::mutex> lock(this->cache_mutex);
+            auto search = this->computed_discretization.find(key); // Crashes here
             if (search != this->computed_discretization.end()) {
                 return search->second;
             }
             else {
                 Discretization new_wave_discretizer = discretize_wave_numbers(dx, matched_int);
-                computed_discretization[matched_int] = new_wave_discretizer;
+                computed_discretization[key] = new_wave_discretizer;
                 return new_wave_discretizer;
             }
         }
 
 
-        WisdomCache::Discretization WisdomCache::discretize_wave_numbers(float dx, int N) {
-            float max_wave_number = (float) M_PI / dx;
-            int two_power = (int) pow(2, N - 1);
+        template<typename T>
+        typename WisdomCache<T>::Discretization WisdomCache<T>::discretize_wave_numbers(float dx, int N) {
+            T max_wave_number = (T) M_PI / dx;
+            int half_length = N / 2;
 
-            float dka = max_wave_number / two_power;
+            T dka = max_wave_number / half_length;
             Discretization discr;
-            float wave = 0;
-            discr.wave_numbers = Eigen::ArrayXf(2 * two_power);
-            unsigned long index = 0;
-
-            discr.wave_numbers.head(two_power + 1) = Eigen::ArrayXf::LinSpaced(two_power + 1, 0, max_wave_number);
-            discr.wave_numbers.tail(two_power - 1) = Eigen::ArrayXf::LinSpaced(two_power - 1, max_wave_number - dka,
-                                                                               dka);
-            discr.complex_factors = Eigen::ArrayXcf(2 * two_power);
-            Eigen::ArrayXf partial_ones = Eigen::ArrayXf::Ones(2 * two_power);
-            partial_ones.tail(two_power - 1) = -Eigen::ArrayXf::Ones(two_power - 1);
+            discr.wave_numbers = ArrayXT<T>(2 * half_length);
+
+            discr.wave_numbers.head(half_length + 1) = ArrayXT<T>::LinSpaced(half_length + 1, 0, max_wave_number);
+            discr.wave_numbers.tail(half_length - 1) = ArrayXT<T>::LinSpaced(half_length - 1, max_wave_number - dka,
+                                                                             dka);
+            discr.complex_factors = ArrayXcT<T>(2 * half_length);
+            ArrayXT<T> partial_ones = ArrayXT<T>::Ones(2 * half_length);
+            partial_ones.tail(half_length - 1) = -ArrayXT<T>::Ones(half_length - 1);
             discr.complex_factors.imag() = partial_ones;
-            discr.complex_factors.real() = Eigen::ArrayXf::Zero(2 * two_power);
-            Eigen::ArrayXcf complex_wave_numbers = discr.complex_factors * discr.wave_numbers;
-            discr.pressure_deriv_factors = (-complex_wave_numbers * (dx * 0.5)).exp() * complex_wave_numbers;
-            discr.velocity_deriv_factors = (complex_wave_numbers * (dx * 0.5)).exp() * complex_wave_numbers;
+            discr.complex_factors.real() = ArrayXT<T>::Zero(2 * half_length);
+            ArrayXcT<T> complex_wave_numbers = discr.complex_factors * discr.wave_numbers;
+            discr.pressure_deriv_factors = (-complex_wave_numbers * std::complex<T>(dx * 0.5)).exp() * complex_wave_numbers;
+            discr.velocity_deriv_factors = (complex_wave_numbers * std::complex<T>(dx * 0.5)).exp() * complex_wave_numbers;
             return discr;
         }
 
-        WisdomCache::Planset_FFTW WisdomCache::get_fftw_planset(int fft_length, int fft_batch_size) {
+        template<typename T>
+        typename WisdomCache<T>::Planset_FFTW WisdomCache<T>::get_fftw_planset(int fft_length, int fft_batch_size) {
             std::string plan_key = boost::lexical_cast<std::string>(fft_length).append(",").append(boost::lexical_cast<std::string>(fft_batch_size));
+            std::lock_guard<std::mutex> lock(this->cache_mutex);
             auto search = this->cached_fftw_plans.find(plan_key);
             if (search != this->cached_fftw_plans.end()) {
                 return search->second;
@@ -87,41 +98,81 @@ namespace OpenPSTD {
             }
         }
 
-        WisdomCache::Planset_FFTW WisdomCache::create_fftw_planset(int fft_length, int fft_batch_size) {
+        template<typename T>
+        typename WisdomCache<T>::Planset_FFTW WisdomCache<T>::create_fftw_planset(int fft_length, int fft_batch_size) {
             int shape[] = {fft_length};
             int istride = 1; //distance between two elements in one fft-able array
             int ostride = istride;
             int idist = fft_length; //distance between first element of different arrays
             int odist = idist;
-            fftwf_plan plan = 0;
+            typename FFTW<T>::plan plan = 0;
             #pragma omp critical
-            plan = fftwf_plan_many_dft_r2c(1, shape, fft_batch_size, NULL, NULL, istride, idist,
-                                                      NULL, NULL, ostride, odist, FFTW_ESTIMATE);
+            plan = FFTW<T>::plan_many_dft_r2c(1, shape, fft_batch_size, NULL, NULL, istride, idist,
+                                              NULL, NULL, ostride, odist, FFTW_ESTIMATE);
             idist = (fft_length / 2) + 1;
             odist = idist;
             int ishape[] = {fft_length / 2 + 1};
-            fftwf_plan plan_inv = 0;
+            typename FFTW<T>::plan plan_inv = 0;
             #pragma omp critical
-            plan_inv = fftwf_plan_many_dft_c2r(1, ishape, fft_batch_size, NULL, NULL, ostride, odist,
-                                                          NULL, NULL, istride, idist, FFTW_ESTIMATE);
+            plan_inv = FFTW<T>::plan_many_dft_c2r(1, ishape, fft_batch_size, NULL, NULL, ostride, odist,
+                                                  NULL, NULL, istride, idist, FFTW_ESTIMATE);
             Planset_FFTW result;
             result.plan = plan;
             result.plan_inv = plan_inv;
             return result;
         }
 
-        int WisdomCache::match_number(int n) {
-            return (int) ceil(log2(n));
+        template<typename T>
+        typename WisdomCache<T>::Planset_R2R WisdomCache<T>::get_r2r_planset(int cells, int batch_size,
+                                                                             CalculationType ct) {
+            std::string plan_key = boost::lexical_cast<std::string>(cells) + "," +
+                                   boost::lexical_cast<std::string>(batch_size) +
+                                   (ct == CalculationType::PRESSURE ? ",pressure" : ",velocity");
+            std::lock_guard<std::mutex> lock(this->cache_mutex);
+            auto search = this->cached_r2r_plans.find(plan_key);
+            if (search == this->cached_r2r_plans.end()) {
+                // planned in place on NULL buffers like the FFT plans, executed on FFTW allocated buffers
+                Planset_R2R new_planset;
+                plan_reflecting_transforms<T>(cells, batch_size, ct, NULL, NULL,
+                                              new_planset.cosine_plan, new_planset.sine_plan);
+                search = this->cached_r2r_plans.insert(std::make_pair(plan_key, new_planset)).first;
+            }
+            return search->second;
         }
 
+        template<typename T>
+        const ArrayXXT<T> &WisdomCache<T>::get_resampling(int cells, int from, int to, bool faces) {
+            std::string key = boost::lexical_cast<std::string>(cells) + "," + boost::lexical_cast<std::string>(from) +
+                              "," + boost::lexical_cast<std::string>(to) + (faces ? ",faces" : ",centres");
+            // The map keeps the matrix in place, so the reference stays valid after the lock is released
+            std::lock_guard<std::mutex> lock(this->cache_mutex);
+            auto search = this->cached_resamplings.find(key);
+            if (search == this->cached_resamplings.end()) {
+                search = this->cached_resamplings.insert(
+                        std::make_pair(key, get_resampling_matrix<T>(cells, from, to, faces))).first;
+            }
+            return search->second;
+        }
 
-        ostream &operator<<(ostream &str, WisdomCache const &v) {
+        template<typename T>
+        int WisdomCache<T>::match_number(int n) {
+            return this->get_fft_length(n);
+        }
+
+
+        template<typename T>
+        ostream &operator<<(ostream &str, WisdomCache<T> const &v) {
             string number_repr;
             for (auto iterator = v.computed_discretization.begin();
                  iterator != v.computed_discretization.end(); iterator++) {
-                number_repr += "n = 2^" + boost::lexical_cast<std::string>(iterator->first) + " ";
+                number_repr += "n = " + boost::lexical_cast<std::string>(iterator->first.second) + " ";
             }
             return str << "Wavenumberdiscretizations: " << number_repr;
         }
+
+        template class WisdomCache<float>;
+        template class WisdomCache<double>;
+        template ostream &operator<<(ostream &str, WisdomCache<float> const &v);
+        template ostream &operator<<(ostream &str, WisdomCache<double> const &v);
     }
 }
\ No newline at end of file
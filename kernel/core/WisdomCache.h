@@ -33,8 +33,11 @@
 #include <fftw3.h>
 #include <complex>
 #include <memory>
+#include <mutex>
 #include <iostream>
 #include <Eigen/Dense>
+#include "Precision.h"
+#include "kernel_functions.h"
 
 namespace OpenPSTD {
     namespace Kernel {
@@ -45,7 +48,9 @@ namespace OpenPSTD {
          * Purpose: Discretize wave numbers dynamically,
          * and optimize them for FFT computations.
          * Also contains the plans for FFTW.
+         * @tparam T: scalar type of the kernel (float or double)
          */
+        template<typename T>
         class WisdomCache {
         public:
 
@@ -53,28 +58,38 @@ namespace OpenPSTD {
              * Storage of the wave number discretizations
              */
             struct Discretization {
-                Eigen::ArrayXf wave_numbers;
-                Eigen::ArrayXcf complex_factors;
-                Eigen::ArrayXcf pressure_deriv_factors;
-                Eigen::ArrayXcf velocity_deriv_factors;
+                ArrayXT<T> wave_numbers;
+                ArrayXcT<T> complex_factors;
+                ArrayXcT<T> pressure_deriv_factors;
+                ArrayXcT<T> velocity_deriv_factors;
             };
 
             /**
              * Storage of the plans used in the Fast Fourier Transform
              */
             struct Planset_FFTW {
-                fftwf_plan plan;
-                fftwf_plan plan_inv;
+                typename FFTW<T>::plan plan;
+                typename FFTW<T>::plan plan_inv;
+            };
+
+            /**
+             * Storage of the plans used in the cosine and sine transforms of reflecting domains
+             */
+            struct Planset_R2R {
+                typename FFTW<T>::plan cosine_plan;
+                typename FFTW<T>::plan sine_plan;
             };
 
             /**
              * Obtain the discretization for the given grid size and number of grid points.
+             * The number of grid points is rounded up to an FFT length according to the FFT length policy,
+             * so the length of the discretization is the length of the FFT that should be used.
              * If discretization is unknown, it is computed and stored for future reference.
              * @param dx: grid size
              * @param N: number of grid points
              * @return: Struct with wave discretization values.
              */
-            Discretization get_discretization(float dx, int N); //Todo: should we include dx here?
+            Discretization get_discretization(float dx, int N);
 
             /**
              * Obtain an FFTW plan for the given fft length and batch size.
@@ -84,20 +99,52 @@ namespace OpenPSTD {
              */
             Planset_FFTW get_fftw_planset(int fft_length, int fft_batch_size);
 
+            /**
+             * Obtain the cosine and sine transform plans of spatderp3_reflecting for the given length and batch size.
+             * If the plans do not exist yet, they are created and cached.
+             * @param cells: Number of cells in the derivative direction
+             * @param batch_size: Batch size of the planned transforms
+             * @param ct: Calculation type, determines the kind of the cosine transform
+             */
+            Planset_R2R get_r2r_planset(int cells, int batch_size, CalculationType ct);
+
+            /**
+             * Round the number of grid points up to the FFT length prescribed by the policy of this cache.
+             * @param N: number of grid points
+             * @return: FFT length >= N
+             */
+            int get_fft_length(int N);
+
+            /**
+             * Obtain the matrix that resamples the values on a grid to another refinement.
+             * If the matrix does not exist yet, it is computed and cached.
+             * @see get_resampling_matrix()
+             */
+            const ArrayXXT<T> &get_resampling(int cells, int from, int to, bool faces);
+
             /**
              * Initializer for the cache. Initialize only a single instance to optimize computations.
+             * @param policy: policy for rounding the stripe lengths up to FFT lengths
              */
-            WisdomCache();
+            WisdomCache(FFTLengthPolicy policy = FFTLengthPolicy::SMOOTH);
 
-            std::map<int, Discretization> computed_discretization; // Should be private! public for debugging purposes
+            /// Policy for rounding the stripe lengths up to FFT lengths
+            const FFTLengthPolicy policy;
+
+            /// Discretizations per grid spacing and FFT length. Should be private! public for debugging purposes
+            std::map<std::pair<float, int>, Discretization> computed_discretization;
             std::map<std::string, Planset_FFTW> cached_fftw_plans; // Should be private! public for debugging purposes
+            std::map<std::string, Planset_R2R> cached_r2r_plans;
+            std::map<std::string, ArrayXXT<T>> cached_resamplings;
 
         private:
+            /// Guards the caches, which the domains fill from concurrent tasks
+            std::mutex cache_mutex;
 
             /**
-             * Compute discretization for the given grid size and number of grid points.
+             * Compute discretization for the given grid size and FFT length.
              * @param dx: grid size
-             * @param N: number of grid points
+             * @param N: FFT length (even)
              * @return: Struct with wave discretization values.
              */
             Discretization discretize_wave_numbers(float dx, int N); //Todo: Needs a better name
@@ -114,12 +161,13 @@ namespace OpenPSTD {
              */
 
             /**
-             * Compute the rounded up @f$\log_2@f$ of the number of grid cells.
+             * Compute the key of the discretization for the number of grid cells (the FFT length).
              */
             int match_number(int n);
         };
 
-        std::ostream &operator<<(std::ostream &str, WisdomCache const &v);
+        template<typename T>
+        std::ostream &operator<<(std::ostream &str, WisdomCache<T> const &v);
     }
 }
 
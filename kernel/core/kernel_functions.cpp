@@ -30,27 +30,30 @@
 #include "kernel_functions.h"
 #include <iostream>
 #include <fstream>
+#include <stdexcept>
+#include <cmath>
 
 using namespace Eigen;
 namespace OpenPSTD {
     namespace Kernel {
-        RhoArray get_rho_array(const float rho1, const float rho_self, const float rho2) {
-            float zn1 = rho1 / rho_self;
-            float inv_zn1 = rho_self / rho1;
-            float rlw1 = (zn1 - 1) / (zn1 + 1);
-            float rlw2 = (inv_zn1 - 1) / (inv_zn1 + 1);
-            float tlw1 = (2 * zn1) / (zn1 + 1);
-            float tlw2 = (2 * inv_zn1) / (inv_zn1 + 1);
-
-            float zn2 = rho2 / rho_self;
-            float inv_zn2 = rho_self / rho2;
-            float rrw1 = (zn2 - 1) / (zn2 + 1);
-            float rrw2 = (inv_zn2 - 1) / (inv_zn2 + 1);
-            float trw1 = (2 * zn2) / (zn2 + 1);
-            float trw2 = (2 * inv_zn2) / (inv_zn2 + 1);
-            RhoArray result = {};
-            result.pressure = ArrayXXf(4, 2);
-            result.velocity = ArrayXXf(4, 2);;
+        template<typename T>
+        RhoArray<T> get_rho_array(const T rho1, const T rho_self, const T rho2) {
+            T zn1 = rho1 / rho_self;
+            T inv_zn1 = rho_self / rho1;
+            T rlw1 = (zn1 - 1) / (zn1 + 1);
+            T rlw2 = (inv_zn1 - 1) / (inv_zn1 + 1);
+            T tlw1 = (2 * zn1) / (zn1 + 1);
+            T tlw2 = (2 * inv_zn1) / (inv_zn1 + 1);
+
+            T zn2 = rho2 / rho_self;
+            T inv_zn2 = rho_self / rho2;
+            T rrw1 = (zn2 - 1) / (zn2 + 1);
+            T rrw2 = (inv_zn2 - 1) / (inv_zn2 + 1);
+            T trw1 = (2 * zn2) / (zn2 + 1);
+            T trw2 = (2 * inv_zn2) / (inv_zn2 + 1);
+            RhoArray<T> result = {};
+            result.pressure = ArrayXXT<T>(4, 2);
+            result.velocity = ArrayXXT<T>(4, 2);
             result.pressure << rlw1, rlw2,
                                rrw1, rrw2,
                                tlw1, tlw2,
@@ -67,24 +70,194 @@ namespace OpenPSTD {
             return std::max((int) pow(2, ceil(log2(n))), 1);
         }
 
-        int next_2_power(int n) {
+        /**
+         * Integer variant of next_2_power(float) for the FFT lengths of this file. It is local, so calls of
+         * next_2_power elsewhere always resolve to the declared float overload.
+         */
+        static int next_2_power(int n) {
             return std::max((int) pow(2, ceil(log2(n))), 1);
         }
 
+        int next_smooth_length(int n) {
+            int candidate = std::max(n, 2);
+            if (candidate % 2 != 0) {
+                candidate++;
+            }
+            for (;; candidate += 2) {
+                int rest = candidate;
+                for (int factor: {2, 3, 5, 7}) {
+                    while (rest % factor == 0) {
+                        rest /= factor;
+                    }
+                }
+                if (rest == 1) {
+                    return candidate;
+                }
+            }
+        }
+
+        int get_fft_length(int n, FFTLengthPolicy policy) {
+            if (policy == FFTLengthPolicy::SMOOTH) {
+                return next_smooth_length(n);
+            }
+            return next_2_power(n);
+        }
+
+        template<typename T>
+        void update_field(ArrayXXT<T> &target, const ArrayXXT<T> &base, const ArrayXXT<T> &derivative, T factor,
+                          T *square_sum) {
+            if (derivative.rows() != base.rows() || derivative.cols() != base.cols()) {
+                throw std::invalid_argument("The derivative does not have the shape of the updated field");
+            }
+            if (target.rows() != base.rows() || target.cols() != base.cols()) {
+                target.resize(base.rows(), base.cols());
+            }
+            T *out = target.data();
+            const T *in = base.data();
+            const T *deriv = derivative.data();
+            long n = target.size();
+            if (square_sum == nullptr) {
+                for (long i = 0; i < n; i++) {
+                    out[i] = in[i] - factor * deriv[i];
+                }
+            } else {
+                T sum = 0;
+                for (long i = 0; i < n; i++) {
+                    T value = in[i] - factor * deriv[i];
+                    out[i] = value;
+                    sum += value * value;
+                }
+                *square_sum += sum;
+            }
+        }
+
+        template<typename T>
+        void add_fields(ArrayXXT<T> &target, const ArrayXXT<T> &a, const ArrayXXT<T> &b, T *square_sum) {
+            if (b.rows() != a.rows() || b.cols() != a.cols()) {
+                throw std::invalid_argument("The added fields do not have the same shape");
+            }
+            if (target.rows() != a.rows() || target.cols() != a.cols()) {
+                target.resize(a.rows(), a.cols());
+            }
+            T *out = target.data();
+            const T *in_a = a.data();
+            const T *in_b = b.data();
+            long n = target.size();
+            if (square_sum == nullptr) {
+                for (long i = 0; i < n; i++) {
+                    out[i] = in_a[i] + in_b[i];
+                }
+            } else {
+                T sum = 0;
+                for (long i = 0; i < n; i++) {
+                    T value = in_a[i] + in_b[i];
+                    out[i] = value;
+                    sum += value * value;
+                }
+                *square_sum += sum;
+            }
+        }
+
+        template<typename T>
+        void add_fields_reduced(ArrayXXT<T> &target, const ArrayXXT<T> &a, const ArrayXXT<T> &b, T *square_sum,
+                                ArrayXXT<T> &peak, ArrayXXT<T> &squares, ArrayXXT<T> &arrival,
+                                T arrival_threshold, T time) {
+            if (target.rows() != a.rows() || target.cols() != a.cols()) {
+                target.resize(a.rows(), a.cols());
+            }
+            T *out = target.data();
+            const T *in_a = a.data();
+            const T *in_b = b.data();
+            T *out_peak = peak.data();
+            T *out_squares = squares.data();
+            T *out_arrival = arrival.data();
+            long n = target.size();
+            T sum = 0;
+            for (long i = 0; i < n; i++) {
+                T value = in_a[i] + in_b[i];
+                T square = value * value;
+                T amplitude = std::abs(value);
+                out[i] = value;
+                sum += square;
+                out_squares[i] += square;
+                if (amplitude > out_peak[i]) {
+                    out_peak[i] = amplitude;
+                }
+                if (out_arrival[i] < 0 && amplitude > arrival_threshold) {
+                    out_arrival[i] = time;
+                }
+            }
+            if (square_sum != nullptr) {
+                *square_sum += sum;
+            }
+        }
+
+        template<typename T>
+        void accumulate_dft(std::vector<ArrayXXT<T>> &real, std::vector<ArrayXXT<T>> &imag, const ArrayXXT<T> &field,
+                            const std::vector<T> &real_factors, const std::vector<T> &imag_factors) {
+            unsigned long frequencies = real_factors.size();
+            std::vector<T *> out_real, out_imag;
+            for (unsigned long k = 0; k < frequencies; k++) {
+                out_real.push_back(real.at(k).data());
+                out_imag.push_back(imag.at(k).data());
+            }
+            const T *in = field.data();
+            long n = field.size();
+            for (long i = 0; i < n; i++) {
+                T value = in[i];
+                for (unsigned long k = 0; k < frequencies; k++) {
+                    out_real[k][i] += real_factors[k] * value;
+                    out_imag[k][i] += imag_factors[k] * value;
+                }
+            }
+        }
+
         float get_grid_spacing(PSTDSettings cnf) {
-            Array<float, 9, 1> dxv;
-            dxv <<
-            0.002, 0.005, 0.01, 0.02, 0.05, 0.1, 0.2, 0.5, 1; //TODO: is there a good reason to disallow other vals?
-            float waveLength = cnf.GetSoundSpeed() / cnf.GetMaxFrequency() / 2;
-            if (waveLength < 0.002) {
+            if (cnf.GetPointsPerWavelength() < 2) {
+                throw std::invalid_argument("At least 2 points per wave length are required (Nyquist)");
+            }
+            double max_spacing = (double) cnf.GetSoundSpeed() / cnf.GetMaxFrequency() / cnf.GetPointsPerWavelength();
+            double spacing = floor(max_spacing / GRID_SPACING_TOLERANCE) * GRID_SPACING_TOLERANCE;
+            if (!(spacing > 0)) {
                 throw std::invalid_argument("Wavelength (speed/frequency) is too small");
             }
-            for (int i = 0; i < dxv.size(); i++) {
-                if (dxv(i) >= waveLength) {
-                    return dxv(i - 1);
+            float result = (float) spacing;
+            // Never exceed the limit because of the conversion to float
+            return result > max_spacing ? std::nextafter(result, 0.0f) : result;
+        }
+
+        float get_grid_spacing(const PSTDConfiguration &conf) {
+            double max_spacing = get_grid_spacing(conf.Settings);
+            // The greatest common divisor of all edges, in units of the tolerance
+            long long divisor = 0;
+            for (auto domain: conf.Domains) {
+                std::vector<float> edges = {domain.TopLeft.x(), domain.TopLeft.y(),
+                                            domain.TopLeft.x() + domain.Size.x(), domain.TopLeft.y() + domain.Size.y()};
+                for (float edge: edges) {
+                    long long units = std::llabs(std::llround(edge / GRID_SPACING_TOLERANCE));
+                    while (units != 0) {
+                        long long rest = divisor % units;
+                        divisor = units;
+                        units = rest;
+                    }
                 }
             }
-            return dxv(dxv.size() - 1);
+            if (divisor == 0) {
+                return (float) max_spacing;
+            }
+            double common_spacing = divisor * GRID_SPACING_TOLERANCE;
+            double cells_per_divisor = ceil(common_spacing / max_spacing - EPSILON);
+            float result = (float) (common_spacing / cells_per_divisor);
+            return result > max_spacing ? std::nextafter(result, 0.0f) : result;
+        }
+
+        long get_number_of_cells(const PSTDConfiguration &conf, float grid_spacing) {
+            long cells = 0;
+            for (auto domain: conf.Domains) {
+                cells += lround(domain.Size.x() / grid_spacing) * lround(domain.Size.y() / grid_spacing) *
+                         domain.Refinement * domain.Refinement;
+            }
+            return cells;
         }
 
         Direction get_opposite(Direction direction) {
@@ -120,11 +293,13 @@ namespace OpenPSTD {
             }
         }
 
-        ArrayXXf spatderp3(ArrayXXf p1, ArrayXXf p2,
-                           ArrayXXf p3, ArrayXcf derfact,
-                           RhoArray rho_array, ArrayXf window, int wlen,
-                           CalculationType ct, CalcDirection direct,
-                           fftwf_plan plan, fftwf_plan plan_inv) {
+        template<typename T>
+        ArrayXXT<T> spatderp3(ArrayXXT<T> p1, ArrayXXT<T> p2,
+                              ArrayXXT<T> p3, ArrayXcT<T> derfact,
+                              RhoArray<T> rho_array, ArrayXT<T> window, int wlen,
+                              CalculationType ct, CalcDirection direct,
+                              typename FFTW<T>::plan plan, typename FFTW<T>::plan plan_inv) {
+            typedef typename FFTW<T>::complex fftw_complex_t;
 
             /*//debug stuff
             int writenum;
@@ -160,16 +335,20 @@ namespace OpenPSTD {
 
             //in the Python code: N1 = fft_batch and N2 = fft_length
             int fft_batch, fft_length;
-            ArrayXXf result; //also called Lp in some places in documentation
+            ArrayXXT<T> result; //also called Lp in some places in documentation
 
             fft_batch = p2.rows();
-            fft_length = next_2_power((int) p2.cols() + wlen * 2);
+            // the discretization of the derivative factors determines the FFT length (see WisdomCache)
+            fft_length = (int) derfact.rows();
+            if (fft_length < p2.cols() + wlen * 2) {
+                throw std::invalid_argument("Derivative factors are shorter than the windowed stripe");
+            }
 
-            float *in_buffer;
-            in_buffer = (float *) fftwf_malloc(sizeof(float) * fft_length * fft_batch);
+            T *in_buffer;
+            in_buffer = (T *) FFTW<T>::malloc(sizeof(T) * fft_length * fft_batch);
 
-            fftwf_complex *out_buffer;
-            out_buffer = (fftwf_complex *) fftwf_malloc(sizeof(fftwf_complex) * ((fft_length / 2) + 1) * fft_batch);
+            fftw_complex_t *out_buffer;
+            out_buffer = (fftw_complex_t *) FFTW<T>::malloc(sizeof(fftw_complex_t) * ((fft_length / 2) + 1) * fft_batch);
 
             //non-domains don't have a wisdomcache, so this is needed. TODO Perhaps put it in the Scene itself.
             if (plan == NULL || true) { //always use this one for now, mainly debugging purposes TODO change that
@@ -179,11 +358,11 @@ namespace OpenPSTD {
                 int idist = fft_length; //distance between first element of different arrays
                 int odist = (fft_length / 2) + 1;
                 #pragma omp critical
-                plan = fftwf_plan_many_dft_r2c(1, shape, fft_batch, in_buffer, NULL, istride, idist,
-                                               out_buffer, NULL, ostride, odist, FFTW_ESTIMATE);
+                plan = FFTW<T>::plan_many_dft_r2c(1, shape, fft_batch, in_buffer, NULL, istride, idist,
+                                                  out_buffer, NULL, ostride, odist, FFTW_ESTIMATE);
                 #pragma omp critical
-                plan_inv = fftwf_plan_many_dft_c2r(1, shape, fft_batch, out_buffer, NULL, ostride, odist,
-                                                   in_buffer, NULL, istride, idist, FFTW_ESTIMATE);
+                plan_inv = FFTW<T>::plan_many_dft_c2r(1, shape, fft_batch, out_buffer, NULL, ostride, odist,
+                                                      in_buffer, NULL, istride, idist, FFTW_ESTIMATE);
             }
 
             //the pressure is calculated for len(p2)+1, velocity for len(p2)-1
@@ -192,19 +371,19 @@ namespace OpenPSTD {
                 result.resize(fft_batch, p2.cols() + wlen * 2 + 1);
 
                 //window the outer domains, add a portion of the middle one to the sides and concatenate them all
-                ArrayXf window_left = window.head(wlen);
-                ArrayXf window_right = window.tail(wlen);
+                ArrayXT<T> window_left = window.head(wlen);
+                ArrayXT<T> window_right = window.tail(wlen);
 
                 if (wlen > p1.cols() || wlen > p3.cols()) {
                     std::cout << "CAREFUL: WINDOW IS BIGGER THAN SIDES" << std::endl;
                 }
 
-                ArrayXXf dom1(fft_batch, wlen);
-                ArrayXXf dom3(fft_batch, wlen);
-                ArrayXXf windowed_data(fft_batch, fft_length);
-                ArrayXXf fft_input_data(fft_length, fft_batch);
-                ArrayXXf zero_pad(fft_batch, fft_length - 2 * wlen - p2.cols());
-                zero_pad = ArrayXXf::Zero(fft_batch, fft_length - 2 * wlen - p2.cols());
+                ArrayXXT<T> dom1(fft_batch, wlen);
+                ArrayXXT<T> dom3(fft_batch, wlen);
+                ArrayXXT<T> windowed_data(fft_batch, fft_length);
+                ArrayXXT<T> fft_input_data(fft_length, fft_batch);
+                ArrayXXT<T> zero_pad(fft_batch, fft_length - 2 * wlen - p2.cols());
+                zero_pad = ArrayXXT<T>::Zero(fft_batch, fft_length - 2 * wlen - p2.cols());
 
                 //this looks inefficient, but the compiler optimizes almost all of it away
                 dom1 = p1.rightCols(wlen) * rho_array.pressure(2, 1) +
@@ -223,20 +402,20 @@ namespace OpenPSTD {
                 fft_input_data = windowed_data.transpose();
 
                 //perform the fft
-                memcpy(in_buffer, fft_input_data.data(), sizeof(float) * fft_batch * fft_length);
-                fftwf_execute_dft_r2c(plan, in_buffer, out_buffer);
+                memcpy(in_buffer, fft_input_data.data(), sizeof(T) * fft_batch * fft_length);
+                FFTW<T>::execute_dft_r2c(plan, in_buffer, out_buffer);
 
                 //map the results back into an eigen array
-                typedef Matrix<std::complex<float>, Dynamic, Dynamic, RowMajor> ArrayXXcfrm;
-                Map<ArrayXXcfrm> spectrum_array((std::complex<float> *) out_buffer[0], fft_batch, fft_length / 2 + 1);
+                typedef Matrix<std::complex<T>, Dynamic, Dynamic, RowMajor> ArrayXXcfrm;
+                Map<ArrayXXcfrm> spectrum_array((std::complex<T> *) out_buffer[0], fft_batch, fft_length / 2 + 1);
 
                 //apply the spectral derivative
                 spectrum_array = spectrum_array.array().rowwise() * derfact.topRows(fft_length / 2 + 1).transpose();
-                fftwf_execute_dft_c2r(plan_inv, out_buffer, in_buffer);
+                FFTW<T>::execute_dft_c2r(plan_inv, out_buffer, in_buffer);
 
 
-                Matrix<float, Dynamic, Dynamic, RowMajor> derived_array =
-                        Map<Matrix<float, Dynamic, Dynamic, RowMajor>>(in_buffer, fft_batch, fft_length).array();
+                Matrix<T, Dynamic, Dynamic, RowMajor> derived_array =
+                        Map<Matrix<T, Dynamic, Dynamic, RowMajor>>(in_buffer, fft_batch, fft_length).array();
 
                 //ifft result contains the outer domains, so slice
                 result = derived_array.leftCols(wlen + p2.cols() + 1).rightCols(p2.cols() + 1);
@@ -247,19 +426,19 @@ namespace OpenPSTD {
                 result.resize(fft_batch, p2.cols() + wlen * 2 - 1);
 
                 //window the outer domains, add a portion of the middle one to the sides and concatenate them all
-                ArrayXf window_left = window.head(wlen);
-                ArrayXf window_right = window.tail(wlen);
+                ArrayXT<T> window_left = window.head(wlen);
+                ArrayXT<T> window_right = window.tail(wlen);
 
                 if (wlen > p1.cols() || wlen > p3.cols()) {
                     //TODO error (or just warn) if this happens and give user feedback.
                 }
 
-                ArrayXXf dom1(fft_batch, wlen);
-                ArrayXXf dom3(fft_batch, wlen);
-                ArrayXXf windowed_data(fft_batch, fft_length);
-                ArrayXXf fft_input_data(fft_length, fft_batch);
-                ArrayXXf zero_pad(fft_batch, fft_length - 2 * wlen - p2.cols());
-                zero_pad = ArrayXXf::Zero(fft_batch, fft_length - 2 * wlen - p2.cols());
+                ArrayXXT<T> dom1(fft_batch, wlen);
+                ArrayXXT<T> dom3(fft_batch, wlen);
+                ArrayXXT<T> windowed_data(fft_batch, fft_length);
+                ArrayXXT<T> fft_input_data(fft_length, fft_batch);
+                ArrayXXT<T> zero_pad(fft_batch, fft_length - 2 * wlen - p2.cols());
+                zero_pad = ArrayXXT<T>::Zero(fft_batch, fft_length - 2 * wlen - p2.cols());
                 dom1 = p1.rightCols(wlen + 1).leftCols(wlen) * rho_array.velocity(2, 1) +
                         (p2.leftCols(wlen+1).rightCols(wlen)).rowwise().reverse() * rho_array.velocity(0, 0);
                 dom3 = p3.leftCols(wlen + 1).rightCols(wlen) * rho_array.velocity(3, 1) +
@@ -279,12 +458,12 @@ namespace OpenPSTD {
                 fft_input_data = windowed_data.transpose();
 
                 //perform the fft
-                memcpy(in_buffer, fft_input_data.data(), sizeof(float) * fft_batch * fft_length);
-                fftwf_execute_dft_r2c(plan, in_buffer, out_buffer);
+                memcpy(in_buffer, fft_input_data.data(), sizeof(T) * fft_batch * fft_length);
+                FFTW<T>::execute_dft_r2c(plan, in_buffer, out_buffer);
 
                 //map the results back into an eigen array
-                typedef Matrix<std::complex<float>, Dynamic, Dynamic, RowMajor> ArrayXXcfrm;
-                Map<ArrayXXcfrm> spectrum_array((std::complex<float> *) out_buffer[0], fft_batch, fft_length / 2 + 1);
+                typedef Matrix<std::complex<T>, Dynamic, Dynamic, RowMajor> ArrayXXcfrm;
+                Map<ArrayXXcfrm> spectrum_array((std::complex<T> *) out_buffer[0], fft_batch, fft_length / 2 + 1);
 
                 //debug
                 //write_array_to_file(spectrum_array.array().real(), "cppspecr", 0);
@@ -293,10 +472,10 @@ namespace OpenPSTD {
                 //apply the spectral derivative
                 spectrum_array = spectrum_array.array().rowwise() * derfact.topRows(fft_length / 2 + 1).transpose();
 
-                fftwf_execute_dft_c2r(plan_inv, out_buffer, in_buffer);
+                FFTW<T>::execute_dft_c2r(plan_inv, out_buffer, in_buffer);
 
-                Matrix<float, Dynamic, Dynamic, RowMajor> derived_array =
-                        Map<Matrix<float, Dynamic, Dynamic, RowMajor>>(in_buffer, fft_batch, fft_length).array();
+                Matrix<T, Dynamic, Dynamic, RowMajor> derived_array =
+                        Map<Matrix<T, Dynamic, Dynamic, RowMajor>>(in_buffer, fft_batch, fft_length).array();
 
                 //debug
                 //write_array_to_file(derived_array, "cppderarr", 0);
@@ -308,27 +487,175 @@ namespace OpenPSTD {
             if (direct == CalcDirection::Y) {
                 result.transposeInPlace();
             }
-            fftwf_free(in_buffer);
-            fftwf_free(out_buffer);
+            FFTW<T>::free(in_buffer);
+            FFTW<T>::free(out_buffer);
             if (plan == NULL || true) { //always use local plan for now, mainly debugging purposes TODO change that
-                fftwf_destroy_plan(plan);
-                fftwf_destroy_plan(plan_inv);
+                FFTW<T>::destroy_plan(plan);
+                FFTW<T>::destroy_plan(plan_inv);
             }
             return result;
         }
 
-        ArrayXXf spatderp3(ArrayXXf p1, ArrayXXf p2,
-                           ArrayXXf p3, ArrayXcf derfact,
-                           RhoArray rho_array, ArrayXf window, int wlen,
-                           CalculationType ct, CalcDirection direct) {
-            return spatderp3(p1, p2, p3, derfact, rho_array, window, wlen, ct, direct, NULL, NULL);
+        template<typename T>
+        ArrayXXT<T> spatderp3(ArrayXXT<T> p1, ArrayXXT<T> p2,
+                              ArrayXXT<T> p3, ArrayXcT<T> derfact,
+                              RhoArray<T> rho_array, ArrayXT<T> window, int wlen,
+                              CalculationType ct, CalcDirection direct) {
+            return spatderp3<T>(p1, p2, p3, derfact, rho_array, window, wlen, ct, direct, NULL, NULL);
+        }
+
+        template<typename T>
+        void plan_reflecting_transforms(int cells, int batch, CalculationType ct, T *cosine_buffer, T *sine_buffer,
+                                        typename FFTW<T>::plan &cosine_plan, typename FFTW<T>::plan &sine_plan) {
+            // the sine transform only contains the interior of the domain, the values on the walls are zero
+            int cosine_shape[] = {cells};
+            int sine_shape[] = {cells - 1};
+            fftw_r2r_kind sine_kind[] = {FFTW_RODFT00};
+            fftw_r2r_kind cosine_kind[] = {ct == CalculationType::PRESSURE ? FFTW_REDFT10 : FFTW_REDFT01};
+            #pragma omp critical
+            {
+                cosine_plan = FFTW<T>::plan_many_r2r(1, cosine_shape, batch, cosine_buffer, NULL, 1, cells,
+                                                     cosine_buffer, NULL, 1, cells, cosine_kind, FFTW_ESTIMATE);
+                sine_plan = FFTW<T>::plan_many_r2r(1, sine_shape, batch, sine_buffer, NULL, 1, cells - 1,
+                                                   sine_buffer, NULL, 1, cells - 1, sine_kind, FFTW_ESTIMATE);
+            }
         }
 
-        ArrayXf get_window_coefficients(int window_size, int patch_error) {
-            float window_alpha = (patch_error - 40) / 20.0 + 1;
-            ArrayXf window_coefficients = (
-                    (ArrayXf::LinSpaced(2 * window_size + 1, -window_size, window_size) / window_size).square().cube() *
-                    log(10) * window_alpha * -1).exp(); // Need to go to power 6 (^2^3)
+        template<typename T>
+        ArrayXXT<T> spatderp3_reflecting(ArrayXXT<T> p2, float dx, CalculationType ct, CalcDirection direct,
+                                         typename FFTW<T>::plan cosine_plan, typename FFTW<T>::plan sine_plan) {
+            typedef Matrix<T, Dynamic, Dynamic, RowMajor> ArrayXXrm;
+
+            if (direct == CalcDirection::Y) {
+                p2.transposeInPlace();
+            }
+
+            // number of cells, the pressure has N values (cell centres) and the velocity N+1 (cell edges)
+            int batch = (int) p2.rows();
+            int N = (ct == CalculationType::PRESSURE) ? (int) p2.cols() : (int) p2.cols() - 1;
+            ArrayXXT<T> result = ArrayXXT<T>::Zero(batch, ct == CalculationType::PRESSURE ? N + 1 : N);
+            if (N < 2) {
+                if (direct == CalcDirection::Y) {
+                    result.transposeInPlace();
+                }
+                return result;
+            }
+
+            // FFTW buffers, so that cached plans (which assume an aligned buffer) can be executed on them
+            T *cosine_buffer = (T *) FFTW<T>::malloc(sizeof(T) * batch * N);
+            T *sine_buffer = (T *) FFTW<T>::malloc(sizeof(T) * batch * (N - 1));
+            Map<ArrayXXrm> cosine_data(cosine_buffer, batch, N);
+            Map<ArrayXXrm> sine_data(sine_buffer, batch, N - 1);
+            bool local_plans = cosine_plan == NULL || sine_plan == NULL;
+            if (local_plans) {
+                plan_reflecting_transforms<T>(N, batch, ct, cosine_buffer, sine_buffer, cosine_plan, sine_plan);
+            }
+
+            // wave numbers of the cosine and sine modes k = 1..N-1
+            ArrayXT<T> wave_numbers = ArrayXT<T>::LinSpaced(N - 1, 1, N - 1) * T(M_PI / (N * dx));
+
+            if (ct == CalculationType::PRESSURE) {
+                // even extension around the walls: p = sum C_k cos(k x), dp/dx = -sum k C_k sin(k x)
+                cosine_data = p2.matrix();
+                FFTW<T>::execute_r2r(cosine_plan, cosine_buffer, cosine_buffer);
+                sine_data = (cosine_data.rightCols(N - 1).array().rowwise() * wave_numbers.transpose()).matrix();
+                FFTW<T>::execute_r2r(sine_plan, sine_buffer, sine_buffer);
+                // derivatives on the walls (first and last column) vanish
+                result.middleCols(1, N - 1) = -sine_data.array() / (2 * N);
+            }
+            else {
+                // odd extension around the walls: v = sum S_k sin(k x), dv/dx = sum k S_k cos(k x)
+                sine_data = p2.middleCols(1, N - 1).matrix();
+                FFTW<T>::execute_r2r(sine_plan, sine_buffer, sine_buffer);
+                cosine_data.col(0).setZero();
+                cosine_data.rightCols(N - 1) = (sine_data.array().rowwise() * wave_numbers.transpose()).matrix();
+                FFTW<T>::execute_r2r(cosine_plan, cosine_buffer, cosine_buffer);
+                result = cosine_data.array() / (2 * N);
+            }
+
+            if (local_plans) {
+                FFTW<T>::destroy_plan(cosine_plan);
+                FFTW<T>::destroy_plan(sine_plan);
+            }
+            FFTW<T>::free(cosine_buffer);
+            FFTW<T>::free(sine_buffer);
+
+            if (direct == CalcDirection::Y) {
+                result.transposeInPlace();
+            }
+            return result;
+        }
+
+        template<typename T>
+        ArrayXXT<T> spatderp3_reflecting(ArrayXXT<T> p2, float dx, CalculationType ct, CalcDirection direct) {
+            return spatderp3_reflecting<T>(p2, dx, ct, direct, NULL, NULL);
+        }
+
+        template<typename T>
+        ArrayXXT<T> get_resampling_matrix(int cells, int from, int to, bool faces) {
+            int new_cells = cells / from * to;
+            int points = faces ? cells + 1 : cells;
+            int new_points = faces ? new_cells + 1 : new_cells;
+            if (from == to || cells == 0) {
+                return ArrayXXT<T>(MatrixXd::Identity(points, points).cast<T>());
+            }
+            // positions of the points of both grids, in cells of the grid
+            VectorXd positions(points), new_positions(new_points);
+            for (int j = 0; j < points; j++) {
+                positions(j) = faces ? j : j + 0.5;
+            }
+            for (int i = 0; i < new_points; i++) {
+                new_positions(i) = (faces ? i : i + 0.5) * cells / new_cells;
+            }
+            // quadratics with a unit derivative at one end and a zero derivative at the other end
+            auto quadratics = [cells](const VectorXd &x) {
+                MatrixXd result(x.rows(), 2);
+                result.col(0) = x - x.cwiseAbs2() / (2.0 * cells);
+                result.col(1) = x.cwiseAbs2() / (2.0 * cells);
+                return result;
+            };
+
+            // analysis: the cosine coefficients of all modes of the grid, 0..N-1 for the cell centres (DCT-II),
+            // 0..N for the cell faces (DCT-I)
+            MatrixXd analysis(points, points);
+            for (int j = 0; j < points; j++) {
+                double weight = (faces && (j == 0 || j == cells)) ? 0.5 : 1;
+                for (int k = 0; k < points; k++) {
+                    analysis(k, j) = 2 * weight * cos(M_PI * k * positions(j) / cells) / cells;
+                }
+            }
+
+            // The even extension has a kink at an end where the derivative is not zero, and the cosine series then
+            // converges slowly. The derivatives at both ends are estimated by fitting the quadratics to the upper
+            // third of the modes (where the kinks dominate), subtracted before and added again after the resampling.
+            MatrixXd slopes = MatrixXd::Zero(2, points);
+            int high_modes = points / 3;
+            if (high_modes >= 2) {
+                MatrixXd high = analysis.bottomRows(high_modes);
+                slopes = (high * quadratics(positions)).colPivHouseholderQr().solve(high);
+            }
+
+            // synthesis: the modes that both grids resolve, on the new grid.
+            // The first (and the Nyquist) mode count half.
+            int modes = std::min(cells, new_cells) + (faces ? 1 : 0);
+            MatrixXd synthesis(new_points, modes);
+            for (int i = 0; i < new_points; i++) {
+                for (int k = 0; k < modes; k++) {
+                    double weight = (k == 0 || (faces && k == modes - 1)) ? 0.5 : 1;
+                    synthesis(i, k) = weight * cos(M_PI * k * new_positions(i) / cells);
+                }
+            }
+            MatrixXd remainder = MatrixXd::Identity(points, points) - quadratics(positions) * slopes;
+            MatrixXd result = synthesis * analysis.topRows(modes) * remainder + quadratics(new_positions) * slopes;
+            return ArrayXXT<T>(result.cast<T>());
+        }
+
+        template<typename T>
+        ArrayXT<T> get_window_coefficients(int window_size, int patch_error) {
+            T window_alpha = (patch_error - 40) / 20.0 + 1;
+            ArrayXT<T> window_coefficients = (
+                    (ArrayXT<T>::LinSpaced(2 * window_size + 1, -window_size, window_size) / window_size).square().cube() *
+                    T(log(10)) * window_alpha * -1).exp(); // Need to go to power 6 (^2^3)
             return window_coefficients;
         }
 
@@ -362,5 +689,73 @@ namespace OpenPSTD {
             }
             data_stream << "];\n";
         }
+
+        template RhoArray<float> get_rho_array<float>(const float rho1, const float rho_self, const float rho2);
+        template RhoArray<double> get_rho_array<double>(const double rho1, const double rho_self, const double rho2);
+
+        template ArrayXXT<float> spatderp3_reflecting<float>(ArrayXXT<float> p2, float dx, CalculationType ct,
+                                                             CalcDirection direct);
+        template ArrayXXT<double> spatderp3_reflecting<double>(ArrayXXT<double> p2, float dx, CalculationType ct,
+                                                               CalcDirection direct);
+        template ArrayXXT<float> spatderp3_reflecting<float>(ArrayXXT<float> p2, float dx, CalculationType ct,
+                                                             CalcDirection direct, FFTW<float>::plan cosine_plan,
+                                                             FFTW<float>::plan sine_plan);
+        template ArrayXXT<double> spatderp3_reflecting<double>(ArrayXXT<double> p2, float dx, CalculationType ct,
+                                                               CalcDirection direct, FFTW<double>::plan cosine_plan,
+                                                               FFTW<double>::plan sine_plan);
+        template void plan_reflecting_transforms<float>(int cells, int batch, CalculationType ct,
+                                                        float *cosine_buffer, float *sine_buffer,
+                                                        FFTW<float>::plan &cosine_plan, FFTW<float>::plan &sine_plan);
+        template void plan_reflecting_transforms<double>(int cells, int batch, CalculationType ct,
+                                                         double *cosine_buffer, double *sine_buffer,
+                                                         FFTW<double>::plan &cosine_plan,
+                                                         FFTW<double>::plan &sine_plan);
+        template ArrayXXT<float> spatderp3<float>(ArrayXXT<float> p1, ArrayXXT<float> p2, ArrayXXT<float> p3,
+                                                  ArrayXcT<float> derfact, RhoArray<float> rho_array,
+                                                  ArrayXT<float> window, int wlen, CalculationType ct,
+                                                  CalcDirection direct);
+        template ArrayXXT<double> spatderp3<double>(ArrayXXT<double> p1, ArrayXXT<double> p2, ArrayXXT<double> p3,
+                                                    ArrayXcT<double> derfact, RhoArray<double> rho_array,
+                                                    ArrayXT<double> window, int wlen, CalculationType ct,
+                                                    CalcDirection direct);
+        template ArrayXXT<float> spatderp3<float>(ArrayXXT<float> p1, ArrayXXT<float> p2, ArrayXXT<float> p3,
+                                                  ArrayXcT<float> derfact, RhoArray<float> rho_array,
+                                                  ArrayXT<float> window, int wlen, CalculationType ct,
+                                                  CalcDirection direct, FFTW<float>::plan plan,
+                                                  FFTW<float>::plan plan_inv);
+        template ArrayXXT<double> spatderp3<double>(ArrayXXT<double> p1, ArrayXXT<double> p2, ArrayXXT<double> p3,
+                                                    ArrayXcT<double> derfact, RhoArray<double> rho_array,
+                                                    ArrayXT<double> window, int wlen, CalculationType ct,
+                                                    CalcDirection direct, FFTW<double>::plan plan,
+                                                    FFTW<double>::plan plan_inv);
+
+        template ArrayXXT<float> get_resampling_matrix<float>(int cells, int from, int to, bool faces);
+        template ArrayXXT<double> get_resampling_matrix<double>(int cells, int from, int to, bool faces);
+
+        template ArrayXT<float> get_window_coefficients<float>(int window_size, int patch_error);
+        template ArrayXT<double> get_window_coefficients<double>(int window_size, int patch_error);
+
+        template void update_field<float>(ArrayXXT<float> &target, const ArrayXXT<float> &base,
+                                          const ArrayXXT<float> &derivative, float factor, float *square_sum);
+        template void update_field<double>(ArrayXXT<double> &target, const ArrayXXT<double> &base,
+                                           const ArrayXXT<double> &derivative, double factor, double *square_sum);
+        template void add_fields<float>(ArrayXXT<float> &target, const ArrayXXT<float> &a, const ArrayXXT<float> &b,
+                                        float *square_sum);
+        template void add_fields<double>(ArrayXXT<double> &target, const ArrayXXT<double> &a,
+                                         const ArrayXXT<double> &b, double *square_sum);
+        template void add_fields_reduced<float>(ArrayXXT<float> &target, const ArrayXXT<float> &a,
+                                                const ArrayXXT<float> &b, float *square_sum, ArrayXXT<float> &peak,
+                                                ArrayXXT<float> &squares, ArrayXXT<float> &arrival,
+                                                float arrival_threshold, float time);
+        template void add_fields_reduced<double>(ArrayXXT<double> &target, const ArrayXXT<double> &a,
+                                                 const ArrayXXT<double> &b, double *square_sum,
+                                                 ArrayXXT<double> &peak, ArrayXXT<double> &squares,
+                                                 ArrayXXT<double> &arrival, double arrival_threshold, double time);
+        template void accumulate_dft<float>(std::vector<ArrayXXT<float>> &real, std::vector<ArrayXXT<float>> &imag,
+                                            const ArrayXXT<float> &field, const std::vector<float> &real_factors,
+                                            const std::vector<float> &imag_factors);
+        template void accumulate_dft<double>(std::vector<ArrayXXT<double>> &real, std::vector<ArrayXXT<double>> &imag,
+                                             const ArrayXXT<double> &field, const std::vector<double> &real_factors,
+                                             const std::vector<double> &imag_factors);
     }
 }
@@ -44,6 +44,7 @@
 #include <algorithm>
 #include "../KernelInterface.h"
 #include "Geometry.h"
+#include "Precision.h"
 
 namespace OpenPSTD {
     namespace Kernel {
@@ -96,12 +97,38 @@ namespace OpenPSTD {
         const std::vector<CalculationType> all_calculation_types = {CalculationType::PRESSURE,
                                                                     CalculationType::VELOCITY};
 
+        /**
+         * Policy used to round the length of the windowed stripes up to an FFT length
+         */
+        enum class FFTLengthPolicy {
+            /// Smallest power of two (the historic behaviour, kept for comparison)
+            POWER_OF_TWO,
+            /// Smallest even length of the form 2^a*3^b*5^c*7^d, which FFTW transforms efficiently
+            SMOOTH
+        };
+
         /**
          * Coefficients for a six stage RK time integration
          */
         const std::vector<float> rk_coefficients = {1.179799016570605e-1f, 1.846469664911166e-1f, 2.466236043095944e-1f,
                                                     3.318395427360000e-1f, 5e-1, 1.f}; // Temporary until bugfix
 
+        /**
+         * Coefficients of the five stage, fourth order, 2N-register RK scheme of Carpenter and Kennedy (1994).
+         * Every stage updates the register with du = A*du + dt*L(u) and the fields with u = u + B*du,
+         * so only the fields and the register (the spatial derivatives) have to be stored.
+         */
+        const std::vector<double> low_storage_rk_a = {0.0,
+                                                      -567301805773.0 / 1357537059087.0,
+                                                      -2404267990393.0 / 2016746695238.0,
+                                                      -3550918686646.0 / 2091501179385.0,
+                                                      -1275806237668.0 / 842570457699.0};
+        const std::vector<double> low_storage_rk_b = {1432997174477.0 / 9575080441755.0,
+                                                      5161836677717.0 / 13612068292357.0,
+                                                      1720146321549.0 / 2090206949498.0,
+                                                      3134564353537.0 / 4481467310338.0,
+                                                      2277821191437.0 / 14882151754819.0};
+
 
         /**
          * Return the opposite direction of the provided direction
@@ -128,9 +155,10 @@ namespace OpenPSTD {
          * Struct with arrays containing the reflection and transmission
          * coefficients of the pressure and the velocity
          */
+        template<typename T>
         struct RhoArray {
-            Eigen::ArrayXXf pressure;
-            Eigen::ArrayXXf velocity;
+            ArrayXXT<T> pressure;
+            ArrayXXT<T> velocity;
         };
 
         /**
@@ -146,27 +174,125 @@ namespace OpenPSTD {
          * @param p1 variable matrix subdomain 1
          * @param p2 variable matrix subdomain 2
          * @param p3 variable matrix subdomain 3
-         * @param fft_length
-         * @param derfact factor to compute derivative in wavenumber domain
+         * @param derfact factor to compute derivative in wavenumber domain, its length is the FFT length
+         *        and must be at least the number of columns of p2 plus 2*wlen
          * @param Rmatrix matrix of reflection coefficients
          * @param var_index variable index: 0 for pressure, 1,2,3, for respectively x, z and y (in 3rd dimension) velocity
          * @param direct direction for computation of derivative
          * @return a 2d array containing the derivative of p2
          */
-        Eigen::ArrayXXf spatderp3(Eigen::ArrayXXf p1, Eigen::ArrayXXf p2,
-                                  Eigen::ArrayXXf p3, Eigen::ArrayXcf derfact,
-                                  RhoArray rho_array, Eigen::ArrayXf window, int wlen,
-                                  CalculationType ct, CalcDirection direct);
+        template<typename T>
+        ArrayXXT<T> spatderp3(ArrayXXT<T> p1, ArrayXXT<T> p2,
+                              ArrayXXT<T> p3, ArrayXcT<T> derfact,
+                              RhoArray<T> rho_array, ArrayXT<T> window, int wlen,
+                              CalculationType ct, CalcDirection direct);
 
         /**
          * Version of spatderp3 that takes cached plans as input.
          * @see spatderp3(9)
          */
-        Eigen::ArrayXXf spatderp3(Eigen::ArrayXXf p1, Eigen::ArrayXXf p2,
-                                  Eigen::ArrayXXf p3, Eigen::ArrayXcf derfact,
-                                  RhoArray rho_array, Eigen::ArrayXf window, int wlen,
-                                  CalculationType ct, CalcDirection direct,
-                                  fftwf_plan plan, fftwf_plan plan_inv);
+        template<typename T>
+        ArrayXXT<T> spatderp3(ArrayXXT<T> p1, ArrayXXT<T> p2,
+                              ArrayXXT<T> p3, ArrayXcT<T> derfact,
+                              RhoArray<T> rho_array, ArrayXT<T> window, int wlen,
+                              CalculationType ct, CalcDirection direct,
+                              typename FFTW<T>::plan plan, typename FFTW<T>::plan plan_inv);
+
+        /**
+         * Spatial derivative of a domain that is bounded by fully reflecting (rigid) edges on both sides.
+         *
+         * The halos built by spatderp3 are then mirror images of p2 (even for the pressure, odd for the velocity),
+         * which is exactly the extension assumed by the discrete cosine and sine transforms. The derivative is
+         * therefore computed with real-to-real transforms of the length of p2, without windows or zero padding.
+         * The pressure is transformed with a DCT-II and derived with a DST-I, the velocity with a DST-I and a DCT-III.
+         *
+         * @param p2 variable matrix of the domain
+         * @param dx grid spacing
+         * @param ct calculation type, determines whether p2 contains pressure or velocity values
+         * @param direct direction for computation of derivative
+         * @return a 2d array containing the derivative of p2 (with the same shape as the result of spatderp3)
+         */
+        template<typename T>
+        ArrayXXT<T> spatderp3_reflecting(ArrayXXT<T> p2, float dx, CalculationType ct, CalcDirection direct);
+
+        /**
+         * Version of spatderp3_reflecting that takes cached plans as input.
+         * The plans are created with plan_reflecting_transforms() for the number of cells and batch size of p2.
+         * @see spatderp3_reflecting(4)
+         */
+        template<typename T>
+        ArrayXXT<T> spatderp3_reflecting(ArrayXXT<T> p2, float dx, CalculationType ct, CalcDirection direct,
+                                         typename FFTW<T>::plan cosine_plan, typename FFTW<T>::plan sine_plan);
+
+        /**
+         * Create the in-place cosine and sine transforms used by spatderp3_reflecting.
+         * @param cells number of cells in the derivative direction
+         * @param batch number of rows (or columns) that are derived at once
+         * @param ct calculation type, determines the kind of the cosine transform
+         * @param cosine_buffer buffer of batch * cells values, or NULL for plans that are executed on other buffers
+         * @param sine_buffer buffer of batch * (cells - 1) values, or NULL
+         * @param cosine_plan output, plan of the cosine transform
+         * @param sine_plan output, plan of the sine transform
+         */
+        template<typename T>
+        void plan_reflecting_transforms(int cells, int batch, CalculationType ct, T *cosine_buffer, T *sine_buffer,
+                                        typename FFTW<T>::plan &cosine_plan, typename FFTW<T>::plan &sine_plan);
+
+        /**
+         * Matrix that resamples the values on a grid to a grid of the same length with another refinement.
+         *
+         * The values are expanded in a cosine series, which is the Fourier series of their even extension and
+         * therefore does not suffer from the jump between both ends of the grid. The series is truncated to the
+         * modes that both grids resolve and evaluated in the points of the new grid.
+         *
+         * @param cells number of cells of the grid
+         * @param from refinement of the grid
+         * @param to refinement of the new grid, which has cells / from * to cells
+         * @param faces whether the values lie on the cell faces (cells + 1 values) instead of in the cell centres
+         * @return matrix with a row per point of the new grid and a column per point of the grid
+         */
+        template<typename T>
+        ArrayXXT<T> get_resampling_matrix(int cells, int from, int to, bool faces);
+
+        /**
+         * Fused field update target = base - factor * derivative, performed in a single pass over the arrays.
+         * target may be the same array as base, it is resized to the shape of base.
+         * @param square_sum if not null, the sum of the squares of the updated values is added to it
+         * @throws std::invalid_argument if derivative does not have the shape of base
+         */
+        template<typename T>
+        void update_field(ArrayXXT<T> &target, const ArrayXXT<T> &base, const ArrayXXT<T> &derivative, T factor,
+                          T *square_sum);
+
+        /**
+         * Fused sum target = a + b, performed in a single pass over the arrays.
+         * @param square_sum if not null, the sum of the squares of the values of target is added to it
+         * @throws std::invalid_argument if a and b do not have the same shape
+         */
+        template<typename T>
+        void add_fields(ArrayXXT<T> &target, const ArrayXXT<T> &a, const ArrayXXT<T> &b, T *square_sum);
+
+        /**
+         * Fused sum target = a + b that also updates the per-cell reductions of the values of target,
+         * performed in a single pass over the arrays.
+         * @param square_sum if not null, the sum of the squares of the values of target is added to it
+         * @param peak maximum absolute value per cell
+         * @param squares sum over time of the squared value per cell
+         * @param arrival time per cell at which the absolute value first exceeded arrival_threshold, negative if never
+         * @param time time of the values in target
+         */
+        template<typename T>
+        void add_fields_reduced(ArrayXXT<T> &target, const ArrayXXT<T> &a, const ArrayXXT<T> &b, T *square_sum,
+                                ArrayXXT<T> &peak, ArrayXXT<T> &squares, ArrayXXT<T> &arrival,
+                                T arrival_threshold, T time);
+
+        /**
+         * Adds a field to running DFT accumulators of several frequencies, in a single pass over the field:
+         * real[k] += real_factors[k] * field and imag[k] += imag_factors[k] * field.
+         */
+        template<typename T>
+        void accumulate_dft(std::vector<ArrayXXT<T>> &real, std::vector<ArrayXXT<T>> &imag, const ArrayXXT<T> &field,
+                            const std::vector<T> &real_factors, const std::vector<T> &imag_factors);
 
         /**
          * Computes and return reflection and transmission matrices for pressure and velocity
@@ -176,24 +302,49 @@ namespace OpenPSTD {
          * @param rho density of opposite neighbour
          * return struct containing pressure and velocity matrix (4x2)
          */
-        RhoArray get_rho_array(const float rho1, const float rho_self, const float rho2);
+        template<typename T>
+        RhoArray<T> get_rho_array(const T rho1, const T rho_self, const T rho2);
 
         /**
-         * Computes the largest grid spacing possible based
-         * on the speed of the medium and the maximum frequency
+         * Resolution (in meters) to which grid spacings and domain edges are rounded
+         */
+        const double GRID_SPACING_TOLERANCE = 1E-4;
+
+        /**
+         * Computes the largest grid spacing possible based on the speed of the medium,
+         * the maximum frequency and the number of points per wave length,
+         * rounded down to the GRID_SPACING_TOLERANCE.
          * Throws an exception if no compatible grid size can be found
          * @param cnf config object containing the properties of the geometry
          * @return float corresponding to the grid size
         */
         float get_grid_spacing(PSTDSettings cnf);
 
+        /**
+         * Computes the largest grid spacing possible for a scene, such that all domain edges lie on the grid.
+         * The edges are rounded to the GRID_SPACING_TOLERANCE, and the grid spacing is the largest
+         * integer fraction of their common divisor that does not exceed get_grid_spacing(conf.Settings).
+         * @param conf configuration of the scene
+         * @return float corresponding to the grid size
+         */
+        float get_grid_spacing(const PSTDConfiguration &conf);
+
+        /**
+         * Computes the number of grid cells of the (non-PML) domains of a scene, including their refinement
+         * @param conf configuration of the scene
+         * @param grid_spacing size of a grid cell of the base grid
+         * @return total number of cells
+         */
+        long get_number_of_cells(const PSTDConfiguration &conf, float grid_spacing);
+
         /**
          * Gives a two-sided array of window coefficients for a given window size and patch error
          * @param window_size length of the window
          * @param patch_error given patch error
-         * @return Eigen::ArrayXf Eigen array of length window_size*2 containing window coefficients
+         * @return Eigen array of length window_size*2 containing window coefficients
          */
-        Eigen::ArrayXf get_window_coefficients(int window_size, int patch_error);
+        template<typename T>
+        ArrayXT<T> get_window_coefficients(int window_size, int patch_error);
 
         /**
          * Computes the smallest power of 2 larger or equal to n if n positive, and 1 otherwise
@@ -202,6 +353,23 @@ namespace OpenPSTD {
          */
         int next_2_power(float n);
 
+        /**
+         * Computes the smallest even number larger or equal to n with no prime factors other than 2, 3, 5 and 7.
+         * FFTW has optimized codelets for these factors, so transforms of such lengths are nearly as fast
+         * (per element) as power of two transforms, while the padding is much smaller.
+         * @param n
+         * @return 2^a*3^b*5^c*7^d >= n with a >= 1
+         */
+        int next_smooth_length(int n);
+
+        /**
+         * Round the length of a windowed stripe up to the FFT length prescribed by the policy
+         * @param n: number of grid points to transform
+         * @param policy: rounding policy
+         * @return FFT length >= n
+         */
+        int get_fft_length(int n, FFTLengthPolicy policy);
+
         /**
          * Perform a numerical check whether a approximately equals b.
          * Returns
@@ -15,7 +15,9 @@ SET(SOURCE_FILES_LIB
         kernel/Solver.cpp
         kernel/core/Geometry.cpp
         kernel/core/WisdomCache.cpp
-        kernel/KernelInterface.cpp)
+        kernel/KernelInterface.cpp
+        kernel/Checkpoint.cpp
+        kernel/Symmetry.cpp)
 
 # DG
 SET(SOURCE_FILES_LIB ${SOURCE_FILES_LIB}
@@ -54,4 +56,5 @@ target_include_directories(OpenPSTD PUBLIC ${FFTWF_OMP_INCLUDE_DIR})
 target_link_libraries(OpenPSTD ${Boost_LIBRARIES})
 target_link_libraries(OpenPSTD ${Qt5_LIBRARIES})
 target_link_libraries(OpenPSTD ${FFTWF_LIBRARY})
+target_link_libraries(OpenPSTD ${FFTW_LIBRARY})
 target_link_libraries(OpenPSTD ${FFTWF_OMP_LIBRARY})
@@ -0,0 +1,423 @@
+//////////////////////////////////////////////////////////////////////////
+// This file is part of openPSTD.                                       //
+//                                                                      //
+// openPSTD is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU General Public License as published by //
+// the Free Software Foundation, either version 3 of the License, or    //
+// (at your option) any later version.                                  //
+//                                                                      //
+// openPSTD is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of       //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        //
+// GNU General Public License for more details.                         //
+//                                                                      //
+// You should have received a copy of the GNU General Public License    //
+// along with openPSTD.  If not, see <http://www.gnu.org/licenses/>.    //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Date:
+//      18-10-2026
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "FrameCodec.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <Eigen/Dense>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+
+namespace OpenPSTD
+{
+    namespace Shared
+    {
+        const uint64_t ShuffleZlibFrameCodec::BLOCK_SIZE;
+
+        OPENPSTD_SHARED_EXPORT std::shared_ptr<FrameCodec> FrameCodec::Create(PSTD_FRAME_CODEC codec, float maxError)
+        {
+            switch (codec)
+            {
+                case PSTD_FRAME_CODEC::RAW:
+                    return std::make_shared<RawFrameCodec>();
+                case PSTD_FRAME_CODEC::SHUFFLE_ZLIB:
+                    return std::make_shared<ShuffleZlibFrameCodec>();
+                case PSTD_FRAME_CODEC::FLOAT16:
+                    return std::make_shared<ReducedPrecisionFrameCodec>(true, maxError);
+                case PSTD_FRAME_CODEC::QUANTIZED:
+                    return std::make_shared<ReducedPrecisionFrameCodec>(false, maxError);
+            }
+            throw std::invalid_argument("Unknown frame codec " + std::to_string((int) codec));
+        }
+
+        OPENPSTD_SHARED_EXPORT bool FrameCodec::Parse(const std::string &name, PSTD_FRAME_CODEC &codec)
+        {
+            if (name == "raw")
+            {
+                codec = PSTD_FRAME_CODEC::RAW;
+                return true;
+            }
+            if (name == "shuffle-zlib")
+            {
+                codec = PSTD_FRAME_CODEC::SHUFFLE_ZLIB;
+                return true;
+            }
+            if (name == "float16")
+            {
+                codec = PSTD_FRAME_CODEC::FLOAT16;
+                return true;
+            }
+            if (name == "quantized")
+            {
+                codec = PSTD_FRAME_CODEC::QUANTIZED;
+                return true;
+            }
+            return false;
+        }
+
+        void RawFrameCodec::Encode(const float *values, uint64_t count, std::vector<char> &output) const
+        {
+            output.resize(count * sizeof(float));
+            std::memcpy(output.data(), values, output.size());
+        }
+
+        uint64_t RawFrameCodec::GetCount(const char *, uint64_t size) const
+        {
+            return size / sizeof(float);
+        }
+
+        void RawFrameCodec::Decode(const char *data, uint64_t size, float *values) const
+        {
+            std::memcpy(values, data, size / sizeof(float) * sizeof(float));
+        }
+
+        /*
+         * The encoded data consists of the number of values, the number of blocks and the compressed size of
+         * every block (all uint64_t), followed by the compressed blocks.
+         */
+
+        void ShuffleZlibFrameCodec::Encode(const float *values, uint64_t count, std::vector<char> &output) const
+        {
+            long blockCount = (long) ((count + BLOCK_SIZE - 1) / BLOCK_SIZE);
+            std::vector<std::vector<char>> blocks((unsigned long) blockCount);
+            #pragma omp parallel for
+            for (long b = 0; b < blockCount; b++)
+            {
+                uint64_t start = b * BLOCK_SIZE;
+                uint64_t n = std::min(BLOCK_SIZE, count - start);
+                const char *bytes = (const char *) (values + start);
+                std::vector<char> shuffled(n * sizeof(float));
+                for (uint64_t i = 0; i < n; i++)
+                {
+                    for (uint64_t j = 0; j < sizeof(float); j++)
+                    {
+                        shuffled[j * n + i] = bytes[i * sizeof(float) + j];
+                    }
+                }
+
+                // the stream is flushed when it is destroyed
+                boost::iostreams::filtering_ostream out;
+                out.push(boost::iostreams::zlib_compressor(boost::iostreams::zlib::best_speed));
+                out.push(boost::iostreams::back_inserter(blocks[b]));
+                out.write(shuffled.data(), shuffled.size());
+            }
+
+            std::vector<uint64_t> header = {count, (uint64_t) blockCount};
+            for (auto &block : blocks)
+            {
+                header.push_back(block.size());
+            }
+            output.assign((const char *) header.data(), (const char *) (header.data() + header.size()));
+            for (auto &block : blocks)
+            {
+                output.insert(output.end(), block.begin(), block.end());
+            }
+        }
+
+        uint64_t ShuffleZlibFrameCodec::GetCount(const char *data, uint64_t size) const
+        {
+            if (size < 2 * sizeof(uint64_t))
+            {
+                throw std::runtime_error("The compressed frame is truncated");
+            }
+            uint64_t count;
+            std::memcpy(&count, data, sizeof(uint64_t));
+            return count;
+        }
+
+        void ShuffleZlibFrameCodec::Decode(const char *data, uint64_t size, float *values) const
+        {
+            uint64_t count = this->GetCount(data, size);
+            uint64_t blockCount;
+            std::memcpy(&blockCount, data + sizeof(uint64_t), sizeof(uint64_t));
+            uint64_t headerSize = (2 + blockCount) * sizeof(uint64_t);
+            if (blockCount != (count + BLOCK_SIZE - 1) / BLOCK_SIZE || size < headerSize)
+            {
+                throw std::runtime_error("The compressed frame is corrupt");
+            }
+            std::vector<uint64_t> offsets = {headerSize};
+            for (uint64_t b = 0; b < blockCount; b++)
+            {
+                uint64_t blockSize;
+                std::memcpy(&blockSize, data + (2 + b) * sizeof(uint64_t), sizeof(uint64_t));
+                offsets.push_back(offsets.back() + blockSize);
+            }
+            if (offsets.back() > size)
+            {
+                throw std::runtime_error("The compressed frame is truncated");
+            }
+
+            // exceptions can not leave the parallel loop, the blocks that fail are marked instead
+            std::vector<char> failed(blockCount, 0);
+            #pragma omp parallel for
+            for (long b = 0; b < (long) blockCount; b++)
+            {
+                uint64_t start = b * BLOCK_SIZE;
+                uint64_t n = std::min(BLOCK_SIZE, count - start);
+                std::vector<char> shuffled(n * sizeof(float));
+                try
+                {
+                    boost::iostreams::filtering_istream in;
+                    in.push(boost::iostreams::zlib_decompressor());
+                    in.push(boost::iostreams::array_source(data + offsets[b], offsets[b + 1] - offsets[b]));
+                    in.read(shuffled.data(), shuffled.size());
+                    if ((uint64_t) in.gcount() != shuffled.size())
+                    {
+                        failed[b] = 1;
+                        continue;
+                    }
+                }
+                catch (const std::exception &)
+                {
+                    failed[b] = 1;
+                    continue;
+                }
+
+                char *bytes = (char *) (values + start);
+                for (uint64_t i = 0; i < n; i++)
+                {
+                    for (uint64_t j = 0; j < sizeof(float); j++)
+                    {
+                        bytes[i * sizeof(float) + j] = shuffled[j * n + i];
+                    }
+                }
+            }
+            if (std::find(failed.begin(), failed.end(), 1) != failed.end())
+            {
+                throw std::runtime_error("The compressed frame is corrupt");
+            }
+        }
+
+        /*
+         * The data of reduced precision frames consists of the number of values (uint64_t), the number of bits of
+         * the values (uint32_t), the scale and offset (float) and 4 reserved bytes, followed by the values.
+         */
+
+        static const uint64_t REDUCED_HEADER_SIZE = 24;
+
+        /**
+         * Half precision bits of a float, rounded to nearest even. The value must be finite and smaller than 65520.
+         */
+        static uint16_t float_to_half(float value)
+        {
+            uint32_t bits;
+            std::memcpy(&bits, &value, sizeof(float));
+            uint16_t sign = (uint16_t) ((bits >> 16) & 0x8000);
+            uint32_t magnitude = bits & 0x7fffffff;
+            float absolute = std::abs(value);
+            if (absolute < std::ldexp(1.0f, -14))
+            {
+                // subnormal half, a multiple of 2^-24 (1024 rounds up to the smallest normal half)
+                return sign | (uint16_t) std::lrint(absolute * std::ldexp(1.0f, 24));
+            }
+            // rebias the exponent and round the 13 dropped bits of the mantissa, a carry increments the exponent
+            magnitude += 0xfff + ((magnitude >> 13) & 1);
+            return sign | (uint16_t) ((magnitude - (112u << 23)) >> 13);
+        }
+
+        /**
+         * Converts half precision bits to floats multiplied by a scale. The half is shifted to the position of a
+         * float with an exponent that is too small by 112, which a multiplication by 2^112 corrects exactly, also
+         * for subnormal halves. The scale is applied separately, because 2^112 times a scale of 2^16 or more does not
+         * fit in a float. The loop has no branches, so the compiler vectorizes it.
+         */
+        static void half_to_float(const char *data, uint64_t count, float scale, float *values)
+        {
+            const float rebias = std::ldexp(1.0f, 112);
+            for (uint64_t i = 0; i < count; i++)
+            {
+                uint16_t half;
+                std::memcpy(&half, data + i * sizeof(uint16_t), sizeof(uint16_t));
+                uint32_t bits = (uint32_t) (half & 0x7fff) << 13;
+                float magnitude;
+                std::memcpy(&magnitude, &bits, sizeof(float));
+                magnitude = magnitude * rebias * scale;
+                std::memcpy(&bits, &magnitude, sizeof(float));
+                bits |= (uint32_t) (half & 0x8000) << 16;
+                std::memcpy(values + i, &bits, sizeof(float));
+            }
+        }
+
+        /**
+         * Decodes fixed point values of type T
+         */
+        template<typename T>
+        static void fixed_to_float(const char *data, uint64_t count, float scale, float offset, float *values)
+        {
+            Eigen::Map<Eigen::ArrayXf>(values, (Eigen::Index) count) =
+                    Eigen::Map<const Eigen::Array<T, Eigen::Dynamic, 1>>((const T *) data, (Eigen::Index) count)
+                            .template cast<float>() * scale + offset;
+        }
+
+        ReducedPrecisionFrameCodec::ReducedPrecisionFrameCodec(bool halfPrecision, float maxError) :
+                halfPrecision(halfPrecision), maxError(maxError)
+        {
+            if (!(maxError >= 0))
+            {
+                throw std::invalid_argument("The maximum error of frames can not be negative");
+            }
+        }
+
+        void ReducedPrecisionFrameCodec::Encode(const float *values, uint64_t count, std::vector<char> &output) const
+        {
+            if (!this->halfPrecision && this->maxError == 0)
+            {
+                throw std::invalid_argument("The maximum error of quantized frames has to be positive");
+            }
+            Eigen::Map<const Eigen::ArrayXf> frame(values, (Eigen::Index) count);
+            float min = count > 0 ? frame.minCoeff() : 0;
+            float max = count > 0 ? frame.maxCoeff() : 0;
+
+            uint32_t bits = 32;
+            float scale = 1, offset = 0;
+            std::vector<char> reduced;
+            std::vector<float> decoded(count);
+            // the minimum and maximum skip NaN values, so every value is checked
+            if (std::isfinite(min) && std::isfinite(max) && frame.allFinite())
+            {
+                if (this->halfPrecision)
+                {
+                    // a power of two keeps the scaling exact, the largest value is scaled to [2^14, 2^15)
+                    float largest = std::max(std::abs(min), std::abs(max));
+                    scale = largest > 0 ? std::ldexp(1.0f, std::ilogb(largest) - 14) : 1;
+                    bits = 16;
+                    reduced.resize(count * sizeof(uint16_t));
+                    for (uint64_t i = 0; i < count; i++)
+                    {
+                        uint16_t half = float_to_half(values[i] / scale);
+                        std::memcpy(reduced.data() + i * sizeof(uint16_t), &half, sizeof(uint16_t));
+                    }
+                    half_to_float(reduced.data(), count, scale, decoded.data());
+                }
+                else
+                {
+                    // rounding to steps of twice the maximum error keeps the error within the maximum, minus a
+                    // margin for the rounding of the float operations of the decoder
+                    float largest = std::max(std::abs(min), std::abs(max));
+                    float margin = 4 * std::numeric_limits<float>::epsilon() * largest;
+                    scale = 2 * (this->maxError - margin);
+                    offset = min;
+                    double levels = scale > 0 ? std::ceil(((double) max - min) / scale) + 1 : 0;
+                    bits = scale > 0 && levels <= 256 ? 8 : (scale > 0 && levels <= 65536 ? 16 : 32);
+                    if (bits < 32)
+                    {
+                        reduced.resize(count * bits / 8);
+                        for (uint64_t i = 0; i < count; i++)
+                        {
+                            uint32_t level = (uint32_t) std::lround((values[i] - offset) / scale);
+                            level = std::min(level, (uint32_t) levels - 1);
+                            if (bits == 8)
+                            {
+                                reduced[i] = (char) (uint8_t) level;
+                            }
+                            else
+                            {
+                                uint16_t fixed = (uint16_t) level;
+                                std::memcpy(reduced.data() + i * sizeof(uint16_t), &fixed, sizeof(uint16_t));
+                            }
+                        }
+                        if (bits == 8)
+                        {
+                            fixed_to_float<uint8_t>(reduced.data(), count, scale, offset, decoded.data());
+                        }
+                        else
+                        {
+                            fixed_to_float<uint16_t>(reduced.data(), count, scale, offset, decoded.data());
+                        }
+                    }
+                }
+            }
+            if (bits < 32 && this->maxError > 0 && count > 0 &&
+                (Eigen::Map<Eigen::ArrayXf>(decoded.data(), (Eigen::Index) count) - frame).abs().maxCoeff() >
+                this->maxError)
+            {
+                // the rounding of the float operations exceeds the maximum error
+                bits = 32;
+            }
+            if (bits == 32)
+            {
+                scale = 1;
+                offset = 0;
+                reduced.resize(count * sizeof(float));
+                std::memcpy(reduced.data(), values, reduced.size());
+            }
+
+            output.assign(REDUCED_HEADER_SIZE, 0);
+            std::memcpy(output.data(), &count, sizeof(uint64_t));
+            std::memcpy(output.data() + 8, &bits, sizeof(uint32_t));
+            std::memcpy(output.data() + 12, &scale, sizeof(float));
+            std::memcpy(output.data() + 16, &offset, sizeof(float));
+            output.insert(output.end(), reduced.begin(), reduced.end());
+        }
+
+        uint64_t ReducedPrecisionFrameCodec::GetCount(const char *data, uint64_t size) const
+        {
+            if (size < REDUCED_HEADER_SIZE)
+            {
+                throw std::runtime_error("The reduced precision frame is truncated");
+            }
+            uint64_t count;
+            std::memcpy(&count, data, sizeof(uint64_t));
+            return count;
+        }
+
+        void ReducedPrecisionFrameCodec::Decode(const char *data, uint64_t size, float *values) const
+        {
+            uint64_t count = this->GetCount(data, size);
+            uint32_t bits;
+            float scale, offset;
+            std::memcpy(&bits, data + 8, sizeof(uint32_t));
+            std::memcpy(&scale, data + 12, sizeof(float));
+            std::memcpy(&offset, data + 16, sizeof(float));
+            if ((bits != 8 && bits != 16 && bits != 32) || size < REDUCED_HEADER_SIZE + count * bits / 8)
+            {
+                throw std::runtime_error("The reduced precision frame is corrupt");
+            }
+
+            const char *reduced = data + REDUCED_HEADER_SIZE;
+            if (bits == 32)
+            {
+                std::memcpy(values, reduced, count * sizeof(float));
+            }
+            else if (bits == 8)
+            {
+                fixed_to_float<uint8_t>(reduced, count, scale, offset, values);
+            }
+            else if (this->halfPrecision)
+            {
+                half_to_float(reduced, count, scale, values);
+            }
+            else
+            {
+                fixed_to_float<uint16_t>(reduced, count, scale, offset, values);
+            }
+        }
+    }
+}
@@ -0,0 +1,164 @@
+//////////////////////////////////////////////////////////////////////////
+// This file is part of openPSTD.                                       //
+//                                                                      //
+// openPSTD is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU General Public License as published by //
+// the Free Software Foundation, either version 3 of the License, or    //
+// (at your option) any later version.                                  //
+//                                                                      //
+// openPSTD is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of       //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        //
+// GNU General Public License for more details.                         //
+//                                                                      //
+// You should have received a copy of the GNU General Public License    //
+// along with openPSTD.  If not, see <http://www.gnu.org/licenses/>.    //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Date:
+//      18-10-2026
+//
+// Purpose:
+//      Encodings of the result frames in the results store.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#ifndef OPENPSTD_FRAMECODEC_H
+#define OPENPSTD_FRAMECODEC_H
+
+#include "openpstd-shared_export.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace OpenPSTD
+{
+    namespace Shared
+    {
+        /**
+         * The encoding of a stored frame, the values are stored in the file and must not change
+         */
+        enum class PSTD_FRAME_CODEC : uint8_t
+        {
+            /// The float values as they are
+            RAW = 0,
+            /// Lossless, the bytes of the values are grouped by significance and compressed with zlib
+            SHUFFLE_ZLIB = 1,
+            /// Half precision floats with a scale per frame
+            FLOAT16 = 2,
+            /// Fixed point values of 8 or 16 bits with a scale and offset per frame
+            QUANTIZED = 3,
+        };
+
+        /**
+         * Encoder and decoder of the values of a frame. The encoded data holds everything that is needed for
+         * decoding it, so the codec only has to be recorded with the frame.
+         */
+        class FrameCodec
+        {
+        public:
+            virtual ~FrameCodec()
+            { }
+
+            /**
+             * Encodes values
+             * @param output: receives the encoded data
+             */
+            virtual void Encode(const float *values, uint64_t count, std::vector<char> &output) const = 0;
+
+            /**
+             * The number of values in encoded data
+             */
+            virtual uint64_t GetCount(const char *data, uint64_t size) const = 0;
+
+            /**
+             * Decodes data
+             * @param values: receives the values, room for GetCount(data, size) values
+             */
+            virtual void Decode(const char *data, uint64_t size, float *values) const = 0;
+
+            /**
+             * Creates a codec
+             * @param maxError: the maximum absolute error of the values of lossy codecs, only used for encoding
+             * @throw std::invalid_argument for unknown codecs (of files of newer versions) or an invalid maxError
+             */
+            OPENPSTD_SHARED_EXPORT static std::shared_ptr<FrameCodec> Create(PSTD_FRAME_CODEC codec,
+                                                                             float maxError = 0);
+
+            /**
+             * Parses the name of a codec (raw, shuffle-zlib, float16 or quantized)
+             * @return false when the name is unknown
+             */
+            OPENPSTD_SHARED_EXPORT static bool Parse(const std::string &name, PSTD_FRAME_CODEC &codec);
+        };
+
+        /**
+         * The values as they are
+         */
+        class RawFrameCodec : public FrameCodec
+        {
+        public:
+            void Encode(const float *values, uint64_t count, std::vector<char> &output) const override;
+
+            uint64_t GetCount(const char *data, uint64_t size) const override;
+
+            void Decode(const char *data, uint64_t size, float *values) const override;
+        };
+
+        /**
+         * Lossless compression of the values.
+         *
+         * The bytes of the values are shuffled, so that the bytes of the same significance are stored together.
+         * The exponents and high bytes of a smooth field or a field that is mostly zero are very repetitive and
+         * compress well. The values are compressed in independent blocks, which are compressed and decompressed
+         * in parallel.
+         */
+        class ShuffleZlibFrameCodec : public FrameCodec
+        {
+        public:
+            /// Number of values in a block
+            static const uint64_t BLOCK_SIZE = 256 * 1024;
+
+            void Encode(const float *values, uint64_t count, std::vector<char> &output) const override;
+
+            uint64_t GetCount(const char *data, uint64_t size) const override;
+
+            void Decode(const char *data, uint64_t size, float *values) const override;
+        };
+
+        /**
+         * Lossy storage of the values with fewer bits.
+         *
+         * Every frame stores the number of bits of its values with a scale and an offset. The values are decoded
+         * as offset + scale * value in loops that the compiler vectorizes. A frame that can not be stored within
+         * the maximum error with fewer bits is stored as 32 bit floats.
+         */
+        class ReducedPrecisionFrameCodec : public FrameCodec
+        {
+        private:
+            bool halfPrecision;
+            float maxError;
+
+        public:
+            /**
+             * @param halfPrecision: store half precision floats instead of fixed point values
+             * @param maxError: the maximum absolute error of the values, 0 is no maximum for half precision floats.
+             * Fixed point values can only be encoded with a positive maximum error.
+             * @throw std::invalid_argument when maxError is negative
+             */
+            ReducedPrecisionFrameCodec(bool halfPrecision, float maxError);
+
+            void Encode(const float *values, uint64_t count, std::vector<char> &output) const override;
+
+            uint64_t GetCount(const char *data, uint64_t size) const override;
+
+            void Decode(const char *data, uint64_t size, float *values) const override;
+        };
+    }
+}
+
+#endif //OPENPSTD_FRAMECODEC_H
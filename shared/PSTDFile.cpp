@@ -27,15 +27,22 @@
 //////////////////////////////////////////////////////////////////////////
 
 #include "PSTDFile.h"
+#include "kernel/MockKernel.h"
 
 extern "C"
 {
 #include <unqlite.h>
 }
 
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
 #include <boost/lexical_cast.hpp>
 #include <boost/archive/text_iarchive.hpp>
-#include <boost/archive/text_oarchive.hpp>
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
 #include <boost/iostreams/stream_buffer.hpp>
 #include <boost/iostreams/stream.hpp>
 #include <boost/iostreams/device/back_inserter.hpp>
@@ -56,9 +63,115 @@ namespace OpenPSTD
 #define PSTD_FILE_PREFIX_RESULTS_FRAME_COUNT 102
 #define PSTD_FILE_PREFIX_RESULTS_FRAMEDATA 103
 #define PSTD_FILE_PREFIX_RESULTS_RECEIVERDATA 104
+#define PSTD_FILE_PREFIX_RESULTS_REDUCTION 105
+#define PSTD_FILE_PREFIX_RESULTS_DFT_FREQUENCY 106
+#define PSTD_FILE_PREFIX_RESULTS_DFT 107
+#define PSTD_FILE_PREFIX_RESULTS_FRAME_INDEX 108
+#define PSTD_FILE_PREFIX_RESULTS_STORE_END 109
+#define PSTD_FILE_PREFIX_RESULTS_FRAME_STATISTICS 110
+#define PSTD_FILE_PREFIX_RESULTS_METADATA 111
+#define PSTD_FILE_PREFIX_RESULTS_FRAME_CODEC 112
+#define PSTD_FILE_PREFIX_RESULTS_CODEC 113
+#define PSTD_FILE_PREFIX_RESULTS_CODEC_MAX_ERROR 114
+#define PSTD_FILE_PREFIX_RESULTS_TIME_SERIES 115
+#define PSTD_FILE_PREFIX_RESULTS_GENERATION 116
+#define PSTD_FILE_PREFIX_RESULTS_FRAME_GRID 117
 
 #define PSTD_FILE_PREFIX_VERSION 10000
 
+#define PSTD_FILE_RESULTS_STORE_EXTENSION ".results"
+#define PSTD_FILE_COMPACT_EXTENSION ".compact"
+#define PSTD_FILE_COMPACT_DONE_EXTENSION ".done"
+
+        /**
+         * The generation of the results is stored in the high bits of the prefix of their keys
+         */
+        static const unsigned int RESULTS_GENERATION_SHIFT = 16;
+        static const unsigned int PREFIX_MASK = (1u << RESULTS_GENERATION_SHIFT) - 1;
+        /// The largest generation that fits in the high bits of the prefix
+        static const unsigned int MAX_RESULTS_GENERATION = (1u << (32 - RESULTS_GENERATION_SHIFT)) - 1;
+
+        /**
+         * Whether the keys with a prefix belong to a generation of the results. The other keys are kept when the
+         * results are deleted.
+         */
+        static bool is_results_generation_prefix(unsigned int prefix)
+        {
+            switch (prefix)
+            {
+                case PSTD_FILE_PREFIX_RESULTS_SCENE:
+                case PSTD_FILE_PREFIX_RESULTS_FRAME_COUNT:
+                case PSTD_FILE_PREFIX_RESULTS_FRAMEDATA:
+                case PSTD_FILE_PREFIX_RESULTS_RECEIVERDATA:
+                case PSTD_FILE_PREFIX_RESULTS_REDUCTION:
+                case PSTD_FILE_PREFIX_RESULTS_DFT_FREQUENCY:
+                case PSTD_FILE_PREFIX_RESULTS_DFT:
+                case PSTD_FILE_PREFIX_RESULTS_FRAME_INDEX:
+                case PSTD_FILE_PREFIX_RESULTS_FRAME_STATISTICS:
+                case PSTD_FILE_PREFIX_RESULTS_METADATA:
+                case PSTD_FILE_PREFIX_RESULTS_FRAME_CODEC:
+                case PSTD_FILE_PREFIX_RESULTS_TIME_SERIES:
+                case PSTD_FILE_PREFIX_RESULTS_FRAME_GRID:
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
+        /**
+         * Removes the files of a compaction that was not completed
+         */
+        static void remove_compaction(const boost::filesystem::path &filename)
+        {
+            boost::filesystem::path compactFilename = filename.string() + PSTD_FILE_COMPACT_EXTENSION;
+            boost::filesystem::remove(compactFilename.string() + PSTD_FILE_COMPACT_DONE_EXTENSION);
+            boost::filesystem::remove(compactFilename);
+            boost::filesystem::remove(compactFilename.string() + PSTD_FILE_RESULTS_STORE_EXTENSION);
+        }
+
+        /**
+         * Replaces the file and its results store by their compacted versions when the compaction was completed,
+         * which the marker file records. The store is replaced before the file, so a compacted file without a
+         * compacted store means that its store is already in place. This finishes a compaction that was
+         * interrupted while the files were replaced.
+         */
+        static void finish_compaction(const boost::filesystem::path &filename)
+        {
+            boost::filesystem::path compactFilename = filename.string() + PSTD_FILE_COMPACT_EXTENSION;
+            boost::filesystem::path compactStoreFilename = compactFilename.string() + PSTD_FILE_RESULTS_STORE_EXTENSION;
+            boost::filesystem::path markerFilename = compactFilename.string() + PSTD_FILE_COMPACT_DONE_EXTENSION;
+            if (!boost::filesystem::exists(markerFilename))
+            {
+                return;
+            }
+            if (boost::filesystem::exists(compactStoreFilename))
+            {
+                boost::filesystem::rename(compactStoreFilename, filename.string() + PSTD_FILE_RESULTS_STORE_EXTENSION);
+            }
+            if (boost::filesystem::exists(compactFilename))
+            {
+                boost::filesystem::rename(compactFilename, filename);
+            }
+            boost::filesystem::remove(markerFilename);
+        }
+
+        /**
+         * Offset in the frame index of frames that older versions stored as values in the database
+         */
+        static const uint64_t LEGACY_FRAME_OFFSET = std::numeric_limits<uint64_t>::max();
+
+        const unsigned int PSTDFile::TIME_SERIES_BLOCK_FRAMES;
+        const unsigned int PSTDFile::TIME_SERIES_TILE_SIZE;
+
+        /**
+         * Number of tiles of the time series of a domain in x and y direction
+         */
+        static void get_time_series_tiles(int width, int height, int &columns, int &rows)
+        {
+            columns = (width + PSTDFile::TIME_SERIES_TILE_SIZE - 1) / PSTDFile::TIME_SERIES_TILE_SIZE;
+            rows = (height + PSTDFile::TIME_SERIES_TILE_SIZE - 1) / PSTDFile::TIME_SERIES_TILE_SIZE;
+        }
+
         std::string PSTDFileKeyToString(PSTDFile_Key_t key)
         {
             unsigned int *values = (unsigned int *) key->data();
@@ -162,47 +275,85 @@ namespace OpenPSTD
             }
         }
 
-        OPENPSTD_SHARED_EXPORT std::unique_ptr<PSTDFile> PSTDFile::Open(const boost::filesystem::path &path)
+        OPENPSTD_SHARED_EXPORT void PSTDFileWriteBatch::AddFrame(unsigned int domain, Kernel::PSTD_FRAME_PTR frame)
+        {
+            this->Frames.push_back(std::make_pair(domain, frame));
+        }
+
+        OPENPSTD_SHARED_EXPORT void PSTDFileWriteBatch::AddSamples(unsigned int receiver,
+                                                                  Kernel::PSTD_RECEIVER_DATA_PTR data)
+        {
+            this->Samples.push_back(std::make_pair(receiver, data));
+        }
+
+        OPENPSTD_SHARED_EXPORT bool PSTDFileWriteBatch::IsEmpty() const
+        {
+            return this->Frames.empty() && this->Samples.empty();
+        }
+
+        OPENPSTD_SHARED_EXPORT void PSTDFileWriteBatch::Clear()
+        {
+            this->Frames.clear();
+            this->Samples.clear();
+        }
+
+        /**
+         * Opens the database of a file, the database is created when it does not exist
+         */
+        static std::unique_ptr<unqlite, int (*)(unqlite *)> open_backend(const boost::filesystem::path &path)
         {
-            std::string filename = path.string();
-            std::unique_ptr<PSTDFile> result = std::unique_ptr<PSTDFile>(new PSTDFile());
             unqlite *backend;
-            unqlite_open(&backend, filename.c_str(), UNQLITE_OPEN_CREATE);
+            int rc = unqlite_open(&backend, path.string().c_str(), UNQLITE_OPEN_CREATE);
+            if (rc != UNQLITE_OK)
+            {
+                throw PSTDFileIOException(rc, nullptr, "open");
+            }
             unqlite_config(backend, UNQLITE_CONFIG_DISABLE_AUTO_COMMIT);//commits are done by the save function
-            result->backend = std::unique_ptr<unqlite, int (*)(unqlite *)>(backend, unqlite_close);
+            return std::unique_ptr<unqlite, int (*)(unqlite *)>(backend, unqlite_close);
+        }
+
+        OPENPSTD_SHARED_EXPORT std::unique_ptr<PSTDFile> PSTDFile::Open(const boost::filesystem::path &path)
+        {
+            std::unique_ptr<PSTDFile> result = std::unique_ptr<PSTDFile>(new PSTDFile());
+            finish_compaction(path);
+            result->backend = open_backend(path);
             int version = result->GetValue<int>(PSTDFile::CreateKey(PSTD_FILE_PREFIX_VERSION, {}));
             if (version != PSTD_FILE_VERSION)
             {
                 throw PSTDFileVersionException(version);
             }
+            result->ReadResultsGeneration();
+            result->OpenResultsStore(path);
             return result;
         }
 
         OPENPSTD_SHARED_EXPORT std::unique_ptr<PSTDFile> PSTDFile::New(const boost::filesystem::path &path)
         {
-            std::string filename = path.string();
             std::unique_ptr<PSTDFile> result(new PSTDFile());
 
-            //create db
-            unqlite *backend;
-            unqlite_open(&backend, filename.c_str(), UNQLITE_OPEN_CREATE);
-            unqlite_config(backend, UNQLITE_CONFIG_DISABLE_AUTO_COMMIT);//commits are done by the save function
-            result->backend = std::unique_ptr<unqlite, int (*)(unqlite *)>(backend, unqlite_close);
+            //create db, without the compacted files of an earlier file with the same name
+            remove_compaction(path);
+            result->backend = open_backend(path);
 
             //add version
             result->SetValue<int>(result->CreateKey(PSTD_FILE_PREFIX_VERSION, {}), PSTD_FILE_VERSION);
 
+            //start with an empty results store
+            result->SetValue<uint64_t>(result->CreateKey(PSTD_FILE_PREFIX_RESULTS_STORE_END, {}), 0);
+            result->OpenResultsStore(path);
+
             //create basic geometry with default options
             result->SetSceneConf(Kernel::PSTDConfiguration::CreateDefaultConf());
 
             //create empty geometry for results
-            result->SetSceneConf(result->CreateKey(PSTD_FILE_PREFIX_RESULTS_SCENE, {}), Kernel::PSTDConfiguration::CreateEmptyConf());
+            result->SetSceneConf(result->CreateResultsKey(PSTD_FILE_PREFIX_RESULTS_SCENE, {}),
+                                 Kernel::PSTDConfiguration::CreateEmptyConf());
 
             result->Commit();
             return result;
         }
 
-        OPENPSTD_SHARED_EXPORT PSTDFile::PSTDFile() : backend(nullptr, unqlite_close)
+        OPENPSTD_SHARED_EXPORT PSTDFile::PSTDFile() : backend(nullptr, unqlite_close), resultsGeneration(0)
         {
 
         }
@@ -225,54 +376,596 @@ namespace OpenPSTD
 
         OPENPSTD_SHARED_EXPORT int PSTDFile::GetResultsFrameCount(unsigned int domain)
         {
-            return GetValue<int>(CreateKey(PSTD_FILE_PREFIX_RESULTS_FRAME_COUNT, {domain}));
+            return GetValue<int>(CreateResultsKey(PSTD_FILE_PREFIX_RESULTS_FRAME_COUNT, {domain}));
         }
 
         OPENPSTD_SHARED_EXPORT Kernel::PSTD_FRAME_PTR PSTDFile::GetResultsFrame(unsigned int frame, unsigned int domain)
         {
-            unqlite_int64 size;
-            float *result = (float *) this->GetRawValue(CreateKey(PSTD_FILE_PREFIX_RESULTS_FRAMEDATA, {domain, frame}), &size);
-            return make_shared<Kernel::PSTD_FRAME>(result, result + (size / 4));
+            PSTDFileDataView view = this->GetResultsFrameView(frame, domain);
+            return make_shared<Kernel::PSTD_FRAME>(view.begin(), view.end());
+        }
+
+        OPENPSTD_SHARED_EXPORT PSTDFileDataView PSTDFile::GetResultsFrameView(unsigned int frame, unsigned int domain)
+        {
+            boost::unique_lock<boost::recursive_mutex> lock(this->backendMutex);
+            std::vector<ResultsStoreEntry> &index = this->GetFrameIndex(domain);
+            if (frame < index.size() && index[frame].Offset != LEGACY_FRAME_OFFSET)
+            {
+                std::shared_ptr<const char> data = this->resultsStore->Get(index[frame]);
+                std::vector<PSTD_FRAME_CODEC> &codecs = this->GetFrameCodecs(domain);
+                if (frame < codecs.size() && codecs[frame] != PSTD_FRAME_CODEC::RAW)
+                {
+                    std::shared_ptr<FrameCodec> codec = FrameCodec::Create(codecs[frame]);
+                    uint64_t count = codec->GetCount(data.get(), index[frame].Size);
+                    std::shared_ptr<Kernel::PSTD_FRAME_UNIT> values(new Kernel::PSTD_FRAME_UNIT[count],
+                                                                    std::default_delete<Kernel::PSTD_FRAME_UNIT[]>());
+                    codec->Decode(data.get(), index[frame].Size, values.get());
+                    return PSTDFileDataView(values, count);
+                }
+                // raw frames are viewed in the store
+                return PSTDFileDataView(std::shared_ptr<const Kernel::PSTD_FRAME_UNIT>(
+                        data, (const Kernel::PSTD_FRAME_UNIT *) data.get()),
+                                        index[frame].Size / sizeof(Kernel::PSTD_FRAME_UNIT));
+            }
+            return this->GetValueView(CreateResultsKey(PSTD_FILE_PREFIX_RESULTS_FRAMEDATA, {domain, frame}));
+        }
+
+        OPENPSTD_SHARED_EXPORT ResultsFrameStatistics PSTDFile::GetResultsFrameStatistics(unsigned int frame,
+                                                                                          unsigned int domain)
+        {
+            boost::unique_lock<boost::recursive_mutex> lock(this->backendMutex);
+            std::vector<ResultsFrameStatistics> &statistics = this->GetFrameStatistics(domain);
+            if (frame < statistics.size() && statistics[frame].Count > 0)
+            {
+                return statistics[frame];
+            }
+            // the frame was written without statistics
+            PSTDFileDataView view = this->GetResultsFrameView(frame, domain);
+            return ResultsFrameStatistics::Compute(view.data(), view.size());
+        }
+
+        OPENPSTD_SHARED_EXPORT ResultsFrameStatistics PSTDFile::GetResultsStatistics(unsigned int domain,
+                                                                                     int startFrame, int endFrame)
+        {
+            boost::unique_lock<boost::recursive_mutex> lock(this->backendMutex);
+            if (endFrame == -1) endFrame = this->GetResultsFrameCount(domain) - 1;
+            ResultsFrameStatistics result = ResultsFrameStatistics::Compute(nullptr, 0);
+            for (int f = startFrame; f <= endFrame; ++f)
+            {
+                result = ResultsFrameStatistics::Combine(result, this->GetResultsFrameStatistics(f, domain));
+            }
+            return result;
+        }
+
+        OPENPSTD_SHARED_EXPORT void PSTDFile::SetResultsFrameCodec(PSTD_FRAME_CODEC codec, float maxError)
+        {
+            if (!(maxError >= 0) || (codec == PSTD_FRAME_CODEC::QUANTIZED && maxError == 0))
+            {
+                throw std::invalid_argument("The maximum error of the frames has to be positive");
+            }
+            this->SetValue<int>(CreateKey(PSTD_FILE_PREFIX_RESULTS_CODEC, {}), (int) codec);
+            this->SetValue<float>(CreateKey(PSTD_FILE_PREFIX_RESULTS_CODEC_MAX_ERROR, {}), maxError);
+        }
+
+        OPENPSTD_SHARED_EXPORT PSTD_FRAME_CODEC PSTDFile::GetResultsFrameCodec()
+        {
+            auto key = CreateKey(PSTD_FILE_PREFIX_RESULTS_CODEC, {});
+            return this->HasValue(key) ? (PSTD_FRAME_CODEC) this->GetValue<int>(key) : PSTD_FRAME_CODEC::RAW;
+        }
+
+        OPENPSTD_SHARED_EXPORT float PSTDFile::GetResultsFrameMaxError()
+        {
+            auto key = CreateKey(PSTD_FILE_PREFIX_RESULTS_CODEC_MAX_ERROR, {});
+            return this->HasValue(key) ? this->GetValue<float>(key) : 0;
+        }
+
+        void PSTDFile::GetResultsFrameGrid(unsigned int domain, int &width, int &height)
+        {
+            std::shared_ptr<const Kernel::SimulationMetadata> metadata = this->GetResultsMetadata();
+            std::vector<int> grid = metadata->GetFrameGrid(domain);
+            width = grid.at(0);
+            height = grid.at(1);
+        }
+
+        OPENPSTD_SHARED_EXPORT int PSTDFile::UpdateResultsTimeSeries(unsigned int domain)
+        {
+            const unsigned int B = TIME_SERIES_BLOCK_FRAMES;
+            const int T = TIME_SERIES_TILE_SIZE;
+            int written = 0;
+            while (true)
+            {
+                int width, height, columns, rows;
+                unsigned int block;
+                std::vector<ResultsStoreEntry> blockEntries;
+                std::vector<PSTDFileDataView> frames;
+                {
+                    boost::unique_lock<boost::recursive_mutex> lock(this->backendMutex);
+                    this->GetResultsFrameGrid(domain, width, height);
+                    get_time_series_tiles(width, height, columns, rows);
+                    block = (unsigned int) (this->GetTimeSeriesIndex(domain).size() / (columns * rows));
+                    if ((block + 1) * B > (unsigned int) this->GetResultsFrameCount(domain))
+                    {
+                        return written;
+                    }
+                    std::vector<ResultsStoreEntry> &index = this->GetFrameIndex(domain);
+                    for (unsigned int f = block * B; f < (block + 1) * B; f++)
+                    {
+                        frames.push_back(this->GetResultsFrameView(f, domain));
+                        if (frames.back().size() != (size_t) width * height)
+                        {
+                            throw std::invalid_argument("Only frames of complete domains can be organized as "
+                                                                "time series");
+                        }
+                        blockEntries.push_back(f < index.size() ? index[f] : ResultsStoreEntry{LEGACY_FRAME_OFFSET, 0});
+                    }
+                }
+
+                // the views hold the frames, so the time block is reordered without holding the lock
+                std::vector<std::vector<Kernel::PSTD_FRAME_UNIT>> tiles((unsigned long) (columns * rows));
+                for (int ty = 0; ty < rows; ty++)
+                {
+                    for (int tx = 0; tx < columns; tx++)
+                    {
+                        int tileWidth = std::min(T, width - tx * T);
+                        int tileHeight = std::min(T, height - ty * T);
+                        std::vector<Kernel::PSTD_FRAME_UNIT> &tile = tiles[ty * columns + tx];
+                        tile.resize((unsigned long) tileWidth * tileHeight * B);
+                        for (unsigned int t = 0; t < B; t++)
+                        {
+                            const Kernel::PSTD_FRAME_UNIT *frame = frames[t].data();
+                            for (int y = 0; y < tileHeight; y++)
+                            {
+                                const Kernel::PSTD_FRAME_UNIT *row = frame + (ty * T + y) * width + tx * T;
+                                for (int x = 0; x < tileWidth; x++)
+                                {
+                                    tile[(y * tileWidth + x) * B + t] = row[x];
+                                }
+                            }
+                        }
+                    }
+                }
+                frames.clear();
+
+                boost::unique_lock<boost::recursive_mutex> lock(this->backendMutex);
+                // the results may have been deleted or truncated in the meantime
+                std::vector<ResultsStoreEntry> &timeSeries = this->GetTimeSeriesIndex(domain);
+                std::vector<ResultsStoreEntry> &index = this->GetFrameIndex(domain);
+                bool unchanged = timeSeries.size() == (unsigned long) block * columns * rows &&
+                                 (block + 1) * B <= (unsigned int) this->GetResultsFrameCount(domain);
+                for (unsigned int t = 0; unchanged && t < B; t++)
+                {
+                    unsigned int f = block * B + t;
+                    ResultsStoreEntry entry = f < index.size() ? index[f] : ResultsStoreEntry{LEGACY_FRAME_OFFSET, 0};
+                    unchanged = entry.Offset == blockEntries[t].Offset && entry.Size == blockEntries[t].Size;
+                }
+                if (!unchanged)
+                {
+                    return written;
+                }
+                std::vector<ResultsStoreEntry> entries;
+                for (auto &tile : tiles)
+                {
+                    entries.push_back(this->resultsStore->Append(tile.data(),
+                                                                 tile.size() * sizeof(Kernel::PSTD_FRAME_UNIT)));
+                }
+                this->AppendRawValue(CreateResultsKey(PSTD_FILE_PREFIX_RESULTS_TIME_SERIES, {domain}),
+                                     entries.size() * sizeof(ResultsStoreEntry), entries.data());
+                this->SetValue<uint64_t>(CreateKey(PSTD_FILE_PREFIX_RESULTS_STORE_END, {}),
+                                         this->resultsStore->GetEnd());
+                timeSeries.insert(timeSeries.end(), entries.begin(), entries.end());
+                written++;
+            }
+        }
+
+        OPENPSTD_SHARED_EXPORT int PSTDFile::GetResultsTimeSeriesFrameCount(unsigned int domain)
+        {
+            boost::unique_lock<boost::recursive_mutex> lock(this->backendMutex);
+            std::vector<ResultsStoreEntry> &timeSeries = this->GetTimeSeriesIndex(domain);
+            if (timeSeries.empty())
+            {
+                return 0;
+            }
+            int width, height, columns, rows;
+            this->GetResultsFrameGrid(domain, width, height);
+            get_time_series_tiles(width, height, columns, rows);
+            return (int) (timeSeries.size() / (columns * rows) * TIME_SERIES_BLOCK_FRAMES);
+        }
+
+        OPENPSTD_SHARED_EXPORT std::vector<Kernel::PSTD_RECEIVER_DATA> PSTDFile::GetResultsTimeSeries(
+                unsigned int domain, const std::vector<std::pair<int, int>> &points)
+        {
+            const unsigned int B = TIME_SERIES_BLOCK_FRAMES;
+            const int T = TIME_SERIES_TILE_SIZE;
+            boost::unique_lock<boost::recursive_mutex> lock(this->backendMutex);
+            int width, height, columns, rows;
+            this->GetResultsFrameGrid(domain, width, height);
+            get_time_series_tiles(width, height, columns, rows);
+            for (auto &point : points)
+            {
+                if (point.first < 0 || point.first >= width || point.second < 0 || point.second >= height)
+                {
+                    throw std::out_of_range("The point (" + std::to_string(point.first) + ", " +
+                                            std::to_string(point.second) + ") lies outside the domain");
+                }
+            }
+
+            int frameCount = this->GetResultsFrameCount(domain);
+            std::vector<Kernel::PSTD_RECEIVER_DATA> result(points.size(), Kernel::PSTD_RECEIVER_DATA(frameCount));
+            int organized = std::min(this->GetResultsTimeSeriesFrameCount(domain), frameCount);
+            std::vector<ResultsStoreEntry> &timeSeries = this->GetTimeSeriesIndex(domain);
+            for (unsigned int block = 0; block < organized / B; block++)
+            {
+                for (unsigned long p = 0; p < points.size(); p++)
+                {
+                    int tx = points[p].first / T, ty = points[p].second / T;
+                    int tileWidth = std::min(T, width - tx * T);
+                    int position = (points[p].second - ty * T) * tileWidth + (points[p].first - tx * T);
+                    std::shared_ptr<const char> tile = this->resultsStore->Get(
+                            timeSeries[block * columns * rows + ty * columns + tx]);
+                    const Kernel::PSTD_FRAME_UNIT *values = (const Kernel::PSTD_FRAME_UNIT *) tile.get() + position * B;
+                    std::copy(values, values + B, result[p].begin() + block * B);
+                }
+            }
+            for (int f = organized / B * B; f < frameCount; f++)
+            {
+                PSTDFileDataView frame = this->GetResultsFrameView(f, domain);
+                if (frame.size() != (size_t) width * height)
+                {
+                    throw std::invalid_argument("The frames are not complete domains");
+                }
+                for (unsigned long p = 0; p < points.size(); p++)
+                {
+                    result[p][f] = frame[points[p].second * width + points[p].first];
+                }
+            }
+            return result;
         }
 
         OPENPSTD_SHARED_EXPORT void PSTDFile::SaveNextResultsFrame(unsigned int domain, Kernel::PSTD_FRAME_PTR frameData)
         {
-            unsigned int frame = IncrementFrameCount(domain);
-            this->SetRawValue(CreateKey(PSTD_FILE_PREFIX_RESULTS_FRAMEDATA, {domain, frame}),
-                              frameData->size() * sizeof(Kernel::PSTD_FRAME_UNIT), frameData->data());
+            PSTDFileWriteBatch batch;
+            batch.AddFrame(domain, frameData);
+            this->WriteBatch(batch);
         }
 
-        OPENPSTD_SHARED_EXPORT void PSTDFile::InitializeResults()
+        OPENPSTD_SHARED_EXPORT void PSTDFile::WriteBatch(PSTDFileWriteBatch &batch)
+        {
+            boost::unique_lock<boost::recursive_mutex> lock(this->backendMutex);
+            std::map<unsigned int, std::vector<Kernel::PSTD_FRAME_PTR>> frames;
+            for (auto &frame : batch.Frames)
+            {
+                frames[frame.first].push_back(frame.second);
+            }
+            PSTD_FRAME_CODEC frameCodec = frames.empty() ? PSTD_FRAME_CODEC::RAW : this->GetResultsFrameCodec();
+            std::shared_ptr<FrameCodec> codec = FrameCodec::Create(frameCodec, this->GetResultsFrameMaxError());
+            for (auto &domainFrames : frames)
+            {
+                unsigned int domain = domainFrames.first;
+                auto countKey = CreateResultsKey(PSTD_FILE_PREFIX_RESULTS_FRAME_COUNT, {domain});
+                unsigned int frameCount = GetValue<int>(countKey);
+                std::vector<ResultsStoreEntry> entries;
+                std::vector<ResultsFrameStatistics> statistics;
+                std::vector<PSTD_FRAME_CODEC> codecs;
+                std::vector<ResultsStoreEntry> &index = this->GetFrameIndex(domain);
+                std::vector<ResultsFrameStatistics> &indexStatistics = this->GetFrameStatistics(domain);
+                std::vector<PSTD_FRAME_CODEC> &indexCodecs = this->GetFrameCodecs(domain);
+                while (index.size() + entries.size() < frameCount)
+                {
+                    // the earlier frames were written by an older version
+                    entries.push_back({LEGACY_FRAME_OFFSET, 0});
+                }
+                while (indexStatistics.size() + statistics.size() < frameCount)
+                {
+                    // the earlier frames were written without statistics
+                    statistics.push_back(ResultsFrameStatistics::Compute(nullptr, 0));
+                }
+                while (indexCodecs.size() + codecs.size() < frameCount)
+                {
+                    // the earlier frames were written before frames were encoded
+                    codecs.push_back(PSTD_FRAME_CODEC::RAW);
+                }
+                std::vector<char> encoded;
+                for (auto &frameData : domainFrames.second)
+                {
+                    ResultsFrameStatistics frameStatistics;
+                    if (frameCodec == PSTD_FRAME_CODEC::RAW)
+                    {
+                        entries.push_back(this->resultsStore->AppendFrame(frameData->data(), frameData->size(),
+                                                                          frameStatistics));
+                    }
+                    else
+                    {
+                        frameStatistics = ResultsFrameStatistics::Compute(frameData->data(), frameData->size());
+                        codec->Encode(frameData->data(), frameData->size(), encoded);
+                        entries.push_back(this->resultsStore->Append(encoded.data(), encoded.size()));
+                    }
+                    statistics.push_back(frameStatistics);
+                    codecs.push_back(frameCodec);
+                }
+
+                this->AppendRawValue(CreateResultsKey(PSTD_FILE_PREFIX_RESULTS_FRAME_INDEX, {domain}),
+                                     entries.size() * sizeof(ResultsStoreEntry), entries.data());
+                this->AppendRawValue(CreateResultsKey(PSTD_FILE_PREFIX_RESULTS_FRAME_STATISTICS, {domain}),
+                                     statistics.size() * sizeof(ResultsFrameStatistics), statistics.data());
+                this->AppendRawValue(CreateResultsKey(PSTD_FILE_PREFIX_RESULTS_FRAME_CODEC, {domain}),
+                                     codecs.size() * sizeof(PSTD_FRAME_CODEC), codecs.data());
+                SetValue<int>(countKey, frameCount + domainFrames.second.size());
+                index.insert(index.end(), entries.begin(), entries.end());
+                indexStatistics.insert(indexStatistics.end(), statistics.begin(), statistics.end());
+                indexCodecs.insert(indexCodecs.end(), codecs.begin(), codecs.end());
+            }
+            if (!frames.empty())
+            {
+                this->SetValue<uint64_t>(CreateKey(PSTD_FILE_PREFIX_RESULTS_STORE_END, {}),
+                                         this->resultsStore->GetEnd());
+            }
+
+            std::map<unsigned int, Kernel::PSTD_RECEIVER_DATA> samples;
+            for (auto &receiverSamples : batch.Samples)
+            {
+                Kernel::PSTD_RECEIVER_DATA &data = samples[receiverSamples.first];
+                data.insert(data.end(), receiverSamples.second->begin(), receiverSamples.second->end());
+            }
+            for (auto &receiverSamples : samples)
+            {
+                this->AppendRawValue(CreateResultsKey(PSTD_FILE_PREFIX_RESULTS_RECEIVERDATA, {receiverSamples.first}),
+                                     receiverSamples.second.size() * sizeof(Kernel::PSTD_FRAME_UNIT),
+                                     receiverSamples.second.data());
+            }
+            batch.Clear();
+        }
+
+        void PSTDFile::OpenResultsStore(const boost::filesystem::path &filename)
+        {
+            this->filename = filename;
+            auto key = CreateKey(PSTD_FILE_PREFIX_RESULTS_STORE_END, {});
+            uint64_t end = this->HasValue(key) ? this->GetValue<uint64_t>(key) : 0;
+            this->resultsStore = std::unique_ptr<ResultsStore>(
+                    new ResultsStore(filename.string() + PSTD_FILE_RESULTS_STORE_EXTENSION, end));
+            this->frameIndex.clear();
+            this->frameStatistics.clear();
+            this->frameCodecs.clear();
+            this->timeSeriesIndex.clear();
+        }
+
+        template<typename T>
+        std::vector<T> &PSTDFile::GetCachedArray(std::map<unsigned int, std::vector<T>> &cache, PSTDFile_Key_t key,
+                                                 unsigned int domain)
+        {
+            boost::unique_lock<boost::recursive_mutex> lock(this->backendMutex);
+            auto array = cache.find(domain);
+            if (array == cache.end())
+            {
+                std::vector<T> values;
+                if (this->HasValue(key))
+                {
+                    values = this->GetArray<T>(key);
+                }
+                array = cache.insert(std::make_pair(domain, values)).first;
+            }
+            return array->second;
+        }
+
+        std::vector<ResultsStoreEntry> &PSTDFile::GetFrameIndex(unsigned int domain)
+        {
+            return this->GetCachedArray(this->frameIndex,
+                                        CreateResultsKey(PSTD_FILE_PREFIX_RESULTS_FRAME_INDEX, {domain}), domain);
+        }
+
+        std::vector<ResultsFrameStatistics> &PSTDFile::GetFrameStatistics(unsigned int domain)
+        {
+            return this->GetCachedArray(this->frameStatistics,
+                                        CreateResultsKey(PSTD_FILE_PREFIX_RESULTS_FRAME_STATISTICS, {domain}), domain);
+        }
+
+        std::vector<PSTD_FRAME_CODEC> &PSTDFile::GetFrameCodecs(unsigned int domain)
+        {
+            return this->GetCachedArray(this->frameCodecs,
+                                        CreateResultsKey(PSTD_FILE_PREFIX_RESULTS_FRAME_CODEC, {domain}), domain);
+        }
+
+        std::vector<ResultsStoreEntry> &PSTDFile::GetTimeSeriesIndex(unsigned int domain)
+        {
+            return this->GetCachedArray(this->timeSeriesIndex,
+                                        CreateResultsKey(PSTD_FILE_PREFIX_RESULTS_TIME_SERIES, {domain}), domain);
+        }
+
+        OPENPSTD_SHARED_EXPORT void PSTDFile::InitializeResults(const Kernel::SimulationMetadata &metadata)
         {
             auto conf = GetSceneConf();
-            SetSceneConf(CreateKey(PSTD_FILE_PREFIX_RESULTS_SCENE, {}), conf);
+            SetSceneConf(CreateResultsKey(PSTD_FILE_PREFIX_RESULTS_SCENE, {}), conf);
+
+            //the metadata is stored as the frame count followed by the size and position of every domain
+            std::vector<int> values = {metadata.Framecount};
+            for (unsigned long i = 0; i < metadata.DomainMetadata.size(); i++)
+            {
+                for (int j = 0; j < 3; j++)
+                {
+                    values.push_back(metadata.DomainMetadata[i].at(j));
+                }
+                for (int j = 0; j < 3; j++)
+                {
+                    values.push_back(i < metadata.DomainPositions.size() ? metadata.DomainPositions[i].at(j) : 0);
+                }
+            }
+            SetArray<int>(CreateResultsKey(PSTD_FILE_PREFIX_RESULTS_METADATA, {}), values);
+            //the grid of the frames when the output plan writes a region or decimates them
+            std::vector<int> grids;
+            for (unsigned long i = 0; i < metadata.FrameGrids.size(); i++)
+            {
+                grids.insert(grids.end(), metadata.FrameGrids[i].begin(), metadata.FrameGrids[i].begin() + 5);
+            }
+            SetArray<int>(CreateResultsKey(PSTD_FILE_PREFIX_RESULTS_FRAME_GRID, {}), grids);
+            this->resultsMetadata = nullptr;
+
             for (unsigned int i = 0; i < conf->Domains.size(); i++)
             {
-                SetValue<int>(CreateKey(PSTD_FILE_PREFIX_RESULTS_FRAME_COUNT, {i}), 0);
+                SetValue<int>(CreateResultsKey(PSTD_FILE_PREFIX_RESULTS_FRAME_COUNT, {i}), 0);
+                SetRawValue(CreateResultsKey(PSTD_FILE_PREFIX_RESULTS_FRAME_INDEX, {i}), 0, nullptr);
+                SetRawValue(CreateResultsKey(PSTD_FILE_PREFIX_RESULTS_FRAME_STATISTICS, {i}), 0, nullptr);
+                SetRawValue(CreateResultsKey(PSTD_FILE_PREFIX_RESULTS_FRAME_CODEC, {i}), 0, nullptr);
+                SetRawValue(CreateResultsKey(PSTD_FILE_PREFIX_RESULTS_TIME_SERIES, {i}), 0, nullptr);
+                this->frameIndex.erase(i);
+                this->frameStatistics.erase(i);
+                this->frameCodecs.erase(i);
+                this->timeSeriesIndex.erase(i);
             }
 
             for(unsigned int i = 0; i < conf->Receivers.size(); i++)
             {
                 //create empty records for the receivers
-                SetRawValue(CreateKey(PSTD_FILE_PREFIX_RESULTS_RECEIVERDATA, {i}), 0, nullptr);
+                SetRawValue(CreateResultsKey(PSTD_FILE_PREFIX_RESULTS_RECEIVERDATA, {i}), 0, nullptr);
+            }
+        }
+
+        OPENPSTD_SHARED_EXPORT std::shared_ptr<const Kernel::SimulationMetadata> PSTDFile::GetResultsMetadata()
+        {
+            boost::unique_lock<boost::recursive_mutex> lock(this->backendMutex);
+            if (this->resultsMetadata)
+            {
+                return this->resultsMetadata;
+            }
+
+            auto key = CreateResultsKey(PSTD_FILE_PREFIX_RESULTS_METADATA, {});
+            std::shared_ptr<Kernel::SimulationMetadata> metadata;
+            if (this->HasValue(key))
+            {
+                std::vector<int> values = this->GetArray<int>(key);
+                metadata = std::make_shared<Kernel::SimulationMetadata>();
+                metadata->Framecount = values.at(0);
+                for (unsigned long i = 1; i + 6 <= values.size(); i += 6)
+                {
+                    metadata->DomainMetadata.push_back({values[i], values[i + 1], values[i + 2]});
+                    metadata->DomainPositions.push_back({values[i + 3], values[i + 4], values[i + 5]});
+                }
+                auto grid_key = CreateResultsKey(PSTD_FILE_PREFIX_RESULTS_FRAME_GRID, {});
+                std::vector<int> grids = this->HasValue(grid_key) ? this->GetArray<int>(grid_key) : std::vector<int>();
+                for (unsigned long i = 0; i + 5 <= grids.size(); i += 5)
+                {
+                    metadata->FrameGrids.push_back(std::vector<int>(grids.begin() + i, grids.begin() + i + 5));
+                }
+            }
+            else
+            {
+                //results of older versions, derive the metadata from the scene the same way as the mock kernel
+                Kernel::MockKernel k;
+                k.initialize_kernel(this->GetResultsSceneConf(),
+                                    std::make_shared<OpenPSTD::Kernel::KernelCallbackLog>());
+                metadata = std::make_shared<Kernel::SimulationMetadata>(k.get_metadata());
             }
+            this->resultsMetadata = metadata;
+            return this->resultsMetadata;
         }
 
         OPENPSTD_SHARED_EXPORT void PSTDFile::DeleteResults()
         {
-            int rc;
+            boost::unique_lock<boost::recursive_mutex> lock(this->backendMutex);
+            // the results of the previous generation are left in the database until the file is compacted
+            if (this->resultsGeneration < MAX_RESULTS_GENERATION)
+            {
+                this->resultsGeneration++;
+            }
+            else
+            {
+                // the next generation does not fit in the keys, so the generations start again without results
+                this->RemoveResultsGenerations();
+                this->resultsGeneration = 0;
+            }
+            this->SetValue<unsigned int>(CreateKey(PSTD_FILE_PREFIX_RESULTS_GENERATION, {}), this->resultsGeneration);
+            this->frameIndex.clear();
+            this->frameStatistics.clear();
+            this->frameCodecs.clear();
+            this->timeSeriesIndex.clear();
+            this->resultsMetadata = nullptr;
+            // the store is truncated when this is committed, the committed results still refer to it until then
+            this->SetValue<uint64_t>(CreateKey(PSTD_FILE_PREFIX_RESULTS_STORE_END, {}), 0);
+            this->SetSceneConf(CreateResultsKey(PSTD_FILE_PREFIX_RESULTS_SCENE, {}),
+                               Kernel::PSTDConfiguration::CreateEmptyConf());
+        }
 
+        OPENPSTD_SHARED_EXPORT void PSTDFile::TruncateResults(const std::map<int, int> &domainFrames,
+                                                              const std::map<int, int> &receiverSamples)
+        {
             int domainCount = this->GetResultsDomainCount();
-            for (unsigned int d = 0; d < domainCount; d++)
+            uint64_t end = 0;
+            for (unsigned int d = 0; d < (unsigned int) domainCount; d++)
             {
+                auto frames = domainFrames.find(d);
+                int keep = frames == domainFrames.end() ? 0 : frames->second;
                 int frameCount = this->GetResultsFrameCount(d);
-                for (unsigned int f = 0; f < frameCount; f++)
+                std::vector<ResultsStoreEntry> &index = this->GetFrameIndex(d);
+                for (unsigned int f = keep; f < (unsigned int) frameCount; f++)
+                {
+                    if (f >= index.size() || index[f].Offset == LEGACY_FRAME_OFFSET)
+                    {
+                        this->DeleteValue(CreateResultsKey(PSTD_FILE_PREFIX_RESULTS_FRAMEDATA, {d, f}));
+                    }
+                }
+                if (keep < frameCount)
+                {
+                    SetValue<int>(CreateResultsKey(PSTD_FILE_PREFIX_RESULTS_FRAME_COUNT, {d}), keep);
+                }
+                if ((unsigned long) keep < index.size())
+                {
+                    index.resize(keep);
+                    SetArray<ResultsStoreEntry>(CreateResultsKey(PSTD_FILE_PREFIX_RESULTS_FRAME_INDEX, {d}), index);
+                }
+                std::vector<ResultsFrameStatistics> &statistics = this->GetFrameStatistics(d);
+                if ((unsigned long) keep < statistics.size())
                 {
-                    this->DeleteValue(CreateKey(PSTD_FILE_PREFIX_RESULTS_FRAMEDATA, {d, f}));
+                    statistics.resize(keep);
+                    SetArray<ResultsFrameStatistics>(CreateResultsKey(PSTD_FILE_PREFIX_RESULTS_FRAME_STATISTICS, {d}),
+                                                     statistics);
+                }
+                std::vector<PSTD_FRAME_CODEC> &codecs = this->GetFrameCodecs(d);
+                if ((unsigned long) keep < codecs.size())
+                {
+                    codecs.resize(keep);
+                    SetArray<PSTD_FRAME_CODEC>(CreateResultsKey(PSTD_FILE_PREFIX_RESULTS_FRAME_CODEC, {d}), codecs);
+                }
+                for (ResultsStoreEntry entry : index)
+                {
+                    if (entry.Offset != LEGACY_FRAME_OFFSET)
+                    {
+                        end = std::max(end, entry.Offset + entry.Size);
+                    }
+                }
+                std::vector<ResultsStoreEntry> &timeSeries = this->GetTimeSeriesIndex(d);
+                if (!timeSeries.empty())
+                {
+                    // only the time blocks of which all frames are kept stay organized
+                    int width, height, columns, rows;
+                    this->GetResultsFrameGrid(d, width, height);
+                    get_time_series_tiles(width, height, columns, rows);
+                    unsigned long tiles = (unsigned long) (keep / TIME_SERIES_BLOCK_FRAMES) * columns * rows;
+                    if (tiles < timeSeries.size())
+                    {
+                        timeSeries.resize(tiles);
+                        SetArray<ResultsStoreEntry>(CreateResultsKey(PSTD_FILE_PREFIX_RESULTS_TIME_SERIES, {d}),
+                                                    timeSeries);
+                    }
+                    for (ResultsStoreEntry entry : timeSeries)
+                    {
+                        end = std::max(end, entry.Offset + entry.Size);
+                    }
+                }
+            }
+            // the frames after the last kept frame are discarded, the next frames are appended after it
+            this->resultsStore->Truncate(end);
+            this->SetValue<uint64_t>(CreateKey(PSTD_FILE_PREFIX_RESULTS_STORE_END, {}), end);
+
+            int receiverCount = this->GetResultsReceiverCount();
+            for (unsigned int r = 0; r < (unsigned int) receiverCount; r++)
+            {
+                auto samples = receiverSamples.find(r);
+                unsigned long keep = samples == receiverSamples.end() ? 0 : (unsigned long) samples->second;
+                Kernel::PSTD_RECEIVER_DATA_PTR data = this->GetReceiverData(r);
+                if (keep < data->size())
+                {
+                    SetRawValue(CreateResultsKey(PSTD_FILE_PREFIX_RESULTS_RECEIVERDATA, {r}),
+                                keep * sizeof(Kernel::PSTD_FRAME_UNIT), data->data());
                 }
-                this->DeleteValue(CreateKey(PSTD_FILE_PREFIX_RESULTS_FRAME_COUNT, {d}));
             }
-            this->SetSceneConf(CreateKey(PSTD_FILE_PREFIX_RESULTS_SCENE, {}), Kernel::PSTDConfiguration::CreateEmptyConf());
         }
 
         OPENPSTD_SHARED_EXPORT void PSTDFile::OutputDebugInfo()
@@ -338,6 +1031,18 @@ namespace OpenPSTD
             return zBuf;
         }
 
+        PSTDFileDataView PSTDFile::GetValueView(PSTDFile_Key_t key)
+        {
+            unqlite_int64 nBytes;
+            char *buffer = this->GetRawValue(key, &nBytes);
+            std::shared_ptr<const Kernel::PSTD_FRAME_UNIT> values((const Kernel::PSTD_FRAME_UNIT *) buffer,
+                                                                  [buffer](const Kernel::PSTD_FRAME_UNIT *)
+                                                                  {
+                                                                      delete[] buffer;
+                                                                  });
+            return PSTDFileDataView(values, nBytes / sizeof(Kernel::PSTD_FRAME_UNIT));
+        }
+
         PSTDFile_Key_t PSTDFile::CreateKey(unsigned int prefix, std::initializer_list<unsigned int> list)
         {
             //the length of the list times int
@@ -363,6 +1068,49 @@ namespace OpenPSTD
             return result;
         }
 
+        PSTDFile_Key_t PSTDFile::CreateResultsKey(unsigned int prefix, std::initializer_list<unsigned int> list)
+        {
+            return CreateKey(prefix | (this->resultsGeneration << RESULTS_GENERATION_SHIFT), list);
+        }
+
+        void PSTDFile::ReadResultsGeneration()
+        {
+            auto key = CreateKey(PSTD_FILE_PREFIX_RESULTS_GENERATION, {});
+            this->resultsGeneration = this->HasValue(key) ? this->GetValue<unsigned int>(key) : 0;
+            if (this->resultsGeneration > MAX_RESULTS_GENERATION)
+            {
+                throw PSTDFileIOException(UNQLITE_CORRUPT, key, "read the generation of the results");
+            }
+        }
+
+        void PSTDFile::RemoveResultsGenerations()
+        {
+            boost::unique_lock<boost::recursive_mutex> lock(this->backendMutex);
+            // the keys are collected first, the cursor does not survive the deletion of its entry
+            std::vector<PSTDFile_Key_t> keys;
+            unqlite_kv_cursor *cursor;
+            unqlite_kv_cursor_init(this->backend.get(), &cursor);
+            for (unqlite_kv_cursor_first_entry(cursor); unqlite_kv_cursor_valid_entry(cursor);
+                 unqlite_kv_cursor_next_entry(cursor))
+            {
+                int keySize;
+                unqlite_kv_cursor_key(cursor, NULL, &keySize);
+                std::vector<char> key((unsigned long) keySize);
+                unqlite_kv_cursor_key(cursor, key.data(), &keySize);
+                unsigned int prefix;
+                std::memcpy(&prefix, key.data(), sizeof(prefix));
+                if (is_results_generation_prefix(prefix & PREFIX_MASK))
+                {
+                    keys.push_back(make_shared<std::vector<char>>(key));
+                }
+            }
+            unqlite_kv_cursor_release(this->backend.get(), cursor);
+            for (auto &key : keys)
+            {
+                this->DeleteValue(key);
+            }
+        }
+
         PSTDFile_Key_t PSTDFile::CreateKeyFromData(char *pBuf, int pnByte)
         {
             PSTDFile_Key_t result = make_shared<std::vector<char>>(pBuf, pBuf + pnByte);
@@ -404,24 +1152,41 @@ namespace OpenPSTD
         OPENPSTD_SHARED_EXPORT std::shared_ptr<Kernel::PSTDConfiguration> PSTDFile::GetSceneConf(PSTDFile_Key_t key)
         {
             namespace io = boost::iostreams;
+            boost::unique_lock<boost::recursive_mutex> lock(this->backendMutex);
+            auto cached = this->sceneConfCache.find(*key);
+            if (cached != this->sceneConfCache.end())
+            {
+                return make_shared<Kernel::PSTDConfiguration>(*cached->second);
+            }
+
             try
             {
                 typedef std::vector<char> buffer_type;
 
-                Kernel::PSTDConfiguration data_in;
+                auto data_in = make_shared<Kernel::PSTDConfiguration>();
                 unqlite_int64 nBytes;
                 auto data = this->GetRawValue(key, &nBytes);//database
 
                 io::basic_array_source<char> source(data, nBytes);
                 io::stream<io::basic_array_source<char> > input_stream(source);
-                boost::archive::text_iarchive ia(input_stream);
 
-                ia >> data_in;
+                // files of older versions contain text archives, these start with the length of the archive
+                // signature in decimal digits, a binary archive starts with the same length as a binary integer
+                if (nBytes > 0 && std::isdigit((unsigned char) data[0]))
+                {
+                    boost::archive::text_iarchive ia(input_stream);
+                    ia >> *data_in;
+                }
+                else
+                {
+                    boost::archive::binary_iarchive ia(input_stream);
+                    ia >> *data_in;
+                }
 
                 delete[] data;
 
-                std::shared_ptr<Kernel::PSTDConfiguration> result = make_shared<Kernel::PSTDConfiguration>(data_in);
-                return result;
+                this->sceneConfCache[*key] = data_in;
+                return make_shared<Kernel::PSTDConfiguration>(*data_in);
             }
             catch(boost::archive::archive_exception e)
             {
@@ -432,18 +1197,22 @@ namespace OpenPSTD
 
         OPENPSTD_SHARED_EXPORT void PSTDFile::SetSceneConf(PSTDFile_Key_t key, std::shared_ptr<Kernel::PSTDConfiguration> scene)
         {
+            boost::unique_lock<boost::recursive_mutex> lock(this->backendMutex);
             try
             {
                 namespace io = boost::iostreams;
                 typedef std::vector<char> buffer_type;
                 buffer_type buffer;
 
-                io::stream<io::back_insert_device<buffer_type> > output_stream(buffer);
-                boost::archive::text_oarchive oa(output_stream);
+                {
+                    io::stream<io::back_insert_device<buffer_type> > output_stream(buffer);
+                    boost::archive::binary_oarchive oa(output_stream);
 
-                oa << (*scene);
-                output_stream.flush();
+                    oa << (*scene);
+                    output_stream.flush();
+                }
                 this->SetRawValue(key, buffer.size(), buffer.data());
+                this->sceneConfCache[*key] = make_shared<Kernel::PSTDConfiguration>(*scene);
             }
             catch(boost::archive::archive_exception e)
             {
@@ -452,12 +1221,21 @@ namespace OpenPSTD
             }
         }
 
-        unsigned int PSTDFile::IncrementFrameCount(unsigned int domain)
+        bool PSTDFile::HasValue(PSTDFile_Key_t key)
         {
-            auto key = CreateKey(PSTD_FILE_PREFIX_RESULTS_FRAME_COUNT, {domain});
-            int frame = GetValue<int>(key);
-            SetValue<int>(key, frame + 1);
-            return frame;
+            boost::unique_lock<boost::recursive_mutex> lock(this->backendMutex);
+            unqlite_int64 nBytes = 0;
+
+            int rc = unqlite_kv_fetch(this->backend.get(), key->data(), key->size(), NULL, &nBytes);
+            if (rc == UNQLITE_NOTFOUND)
+            {
+                return false;
+            }
+            if (rc != UNQLITE_OK)
+            {
+                throw PSTDFileIOException(rc, key, "fetch data");
+            }
+            return true;
         }
 
         void PSTDFile::DeleteValue(PSTDFile_Key_t key)
@@ -475,20 +1253,78 @@ namespace OpenPSTD
 
         OPENPSTD_SHARED_EXPORT std::shared_ptr<Kernel::PSTDConfiguration> PSTDFile::GetResultsSceneConf()
         {
-            return this->GetSceneConf(CreateKey(PSTD_FILE_PREFIX_RESULTS_SCENE, {}));
+            return this->GetSceneConf(CreateResultsKey(PSTD_FILE_PREFIX_RESULTS_SCENE, {}));
         }
 
         OPENPSTD_SHARED_EXPORT void PSTDFile::SaveReceiverData(unsigned int receiver, Kernel::PSTD_RECEIVER_DATA_PTR data)
         {
-            this->AppendRawValue(CreateKey(PSTD_FILE_PREFIX_RESULTS_RECEIVERDATA, {receiver}),
+            this->AppendRawValue(CreateResultsKey(PSTD_FILE_PREFIX_RESULTS_RECEIVERDATA, {receiver}),
                                  data->size() * sizeof(Kernel::PSTD_FRAME_UNIT), data->data());
         }
 
         OPENPSTD_SHARED_EXPORT Kernel::PSTD_RECEIVER_DATA_PTR PSTDFile::GetReceiverData(unsigned int receiver)
+        {
+            PSTDFileDataView view = this->GetReceiverDataView(receiver);
+            return make_shared<Kernel::PSTD_RECEIVER_DATA>(view.begin(), view.end());
+        }
+
+        OPENPSTD_SHARED_EXPORT PSTDFileDataView PSTDFile::GetReceiverDataView(unsigned int receiver)
+        {
+            return this->GetValueView(CreateResultsKey(PSTD_FILE_PREFIX_RESULTS_RECEIVERDATA, {receiver}));
+        }
+
+        OPENPSTD_SHARED_EXPORT void PSTDFile::SaveResultsReduction(unsigned int domain, Kernel::FIELD_REDUCTION reduction,
+                                                                   Kernel::PSTD_FRAME_PTR data)
+        {
+            this->SetRawValue(CreateResultsKey(PSTD_FILE_PREFIX_RESULTS_REDUCTION, {domain, (unsigned int) reduction}),
+                              data->size() * sizeof(Kernel::PSTD_FRAME_UNIT), data->data());
+        }
+
+        OPENPSTD_SHARED_EXPORT bool PSTDFile::HasResultsReduction(unsigned int domain, Kernel::FIELD_REDUCTION reduction)
+        {
+            return this->HasValue(CreateResultsKey(PSTD_FILE_PREFIX_RESULTS_REDUCTION,
+                                                   {domain, (unsigned int) reduction}));
+        }
+
+        OPENPSTD_SHARED_EXPORT Kernel::PSTD_FRAME_PTR PSTDFile::GetResultsReduction(unsigned int domain,
+                                                                                   Kernel::FIELD_REDUCTION reduction)
+        {
+            unqlite_int64 size;
+            float *result = (float *) this->GetRawValue(
+                    CreateResultsKey(PSTD_FILE_PREFIX_RESULTS_REDUCTION, {domain, (unsigned int) reduction}), &size);
+            auto frame = make_shared<Kernel::PSTD_FRAME>(result, result + (size / 4));
+            delete[] result;
+            return frame;
+        }
+
+        OPENPSTD_SHARED_EXPORT void PSTDFile::SaveResultsDFT(unsigned int domain, unsigned int frequencyIndex,
+                                                             float frequency, Kernel::PSTD_FRAME_PTR data)
+        {
+            this->SetValue<float>(CreateResultsKey(PSTD_FILE_PREFIX_RESULTS_DFT_FREQUENCY, {frequencyIndex}),
+                                  frequency);
+            this->SetRawValue(CreateResultsKey(PSTD_FILE_PREFIX_RESULTS_DFT, {domain, frequencyIndex}),
+                              data->size() * sizeof(Kernel::PSTD_FRAME_UNIT), data->data());
+        }
+
+        OPENPSTD_SHARED_EXPORT std::vector<float> PSTDFile::GetResultsDFTFrequencies()
+        {
+            std::vector<float> result;
+            for (unsigned int k = 0; this->HasValue(CreateResultsKey(PSTD_FILE_PREFIX_RESULTS_DFT_FREQUENCY, {k})); k++)
+            {
+                result.push_back(this->GetValue<float>(CreateResultsKey(PSTD_FILE_PREFIX_RESULTS_DFT_FREQUENCY, {k})));
+            }
+            return result;
+        }
+
+        OPENPSTD_SHARED_EXPORT Kernel::PSTD_FRAME_PTR PSTDFile::GetResultsDFT(unsigned int domain,
+                                                                             unsigned int frequencyIndex)
         {
             unqlite_int64 size;
-            float *result = (float *) this->GetRawValue(CreateKey(PSTD_FILE_PREFIX_RESULTS_RECEIVERDATA, {receiver}), &size);
-            return make_shared<Kernel::PSTD_RECEIVER_DATA>(result, result + (size / 4));
+            auto key = CreateResultsKey(PSTD_FILE_PREFIX_RESULTS_DFT, {domain, frequencyIndex});
+            float *result = (float *) this->GetRawValue(key, &size);
+            auto frame = make_shared<Kernel::PSTD_FRAME>(result, result + (size / 4));
+            delete[] result;
+            return frame;
         }
 
         int PSTDFile::GetResultsReceiverCount()
@@ -500,16 +1336,140 @@ namespace OpenPSTD
         void PSTDFile::Commit()
         {
             boost::unique_lock<boost::recursive_mutex> lock(this->backendMutex);
+            // the frames are written before the index that refers to them
+            this->resultsStore->Flush();
             int rc = unqlite_commit(this->backend.get());
 
             if(rc != UNQLITE_OK)
                 throw PSTDFileIOException(rc, nullptr, "Commit");
+
+            // the data after the committed end (of deleted results) is not referred to any more
+            auto key = CreateKey(PSTD_FILE_PREFIX_RESULTS_STORE_END, {});
+            uint64_t end = this->HasValue(key) ? this->GetValue<uint64_t>(key) : 0;
+            if (end < this->resultsStore->GetEnd())
+            {
+                this->resultsStore->Truncate(end);
+            }
+        }
+
+        OPENPSTD_SHARED_EXPORT void PSTDFile::Compact()
+        {
+            boost::unique_lock<boost::recursive_mutex> lock(this->backendMutex);
+            this->Commit();
+
+            boost::filesystem::path compactFilename = this->filename.string() + PSTD_FILE_COMPACT_EXTENSION;
+            boost::filesystem::path compactStoreFilename =
+                    compactFilename.string() + PSTD_FILE_RESULTS_STORE_EXTENSION;
+            remove_compaction(this->filename);
+            {
+                std::unique_ptr<unqlite, int (*)(unqlite *)> compact = open_backend(compactFilename);
+                ResultsStore compactStore(compactStoreFilename, 0);
+
+                int rc = UNQLITE_OK;
+                PSTDFile_Key_t failedKey;
+                unqlite_kv_cursor *cursor;
+                unqlite_kv_cursor_init(this->backend.get(), &cursor);
+                for (unqlite_kv_cursor_first_entry(cursor); rc == UNQLITE_OK && unqlite_kv_cursor_valid_entry(cursor);
+                     unqlite_kv_cursor_next_entry(cursor))
+                {
+                    int keySize;
+                    unqlite_kv_cursor_key(cursor, NULL, &keySize);
+                    std::vector<char> key((unsigned long) keySize);
+                    unqlite_kv_cursor_key(cursor, key.data(), &keySize);
+                    unqlite_int64 dataSize;
+                    unqlite_kv_cursor_data(cursor, NULL, &dataSize);
+                    std::vector<char> data((unsigned long) dataSize);
+                    unqlite_kv_cursor_data(cursor, data.data(), &dataSize);
+
+                    unsigned int prefix;
+                    std::memcpy(&prefix, key.data(), sizeof(prefix));
+                    unsigned int generation = prefix >> RESULTS_GENERATION_SHIFT;
+                    prefix &= PREFIX_MASK;
+                    if (is_results_generation_prefix(prefix))
+                    {
+                        if (generation != this->resultsGeneration)
+                        {
+                            // results that were deleted
+                            continue;
+                        }
+                        // the current results become the first generation of the compacted file
+                        std::memcpy(key.data(), &prefix, sizeof(prefix));
+                    }
+                    else if (prefix == PSTD_FILE_PREFIX_RESULTS_GENERATION ||
+                             prefix == PSTD_FILE_PREFIX_RESULTS_STORE_END)
+                    {
+                        continue;
+                    }
+
+                    if (prefix == PSTD_FILE_PREFIX_RESULTS_FRAME_INDEX ||
+                        prefix == PSTD_FILE_PREFIX_RESULTS_TIME_SERIES)
+                    {
+                        // the data is copied to the compacted store without the discarded data around it
+                        ResultsStoreEntry *entries = (ResultsStoreEntry *) data.data();
+                        for (unsigned long i = 0; i < data.size() / sizeof(ResultsStoreEntry); i++)
+                        {
+                            if (entries[i].Offset != LEGACY_FRAME_OFFSET)
+                            {
+                                std::shared_ptr<const char> values = this->resultsStore->Get(entries[i]);
+                                entries[i] = compactStore.Append(values.get(), entries[i].Size);
+                            }
+                        }
+                    }
+                    rc = unqlite_kv_store(compact.get(), key.data(), (int) key.size(), data.data(), data.size());
+                    if (rc != UNQLITE_OK)
+                    {
+                        failedKey = make_shared<std::vector<char>>(key);
+                    }
+                }
+                unqlite_kv_cursor_release(this->backend.get(), cursor);
+                if (rc != UNQLITE_OK)
+                {
+                    throw PSTDFileIOException(rc, failedKey, "store data");
+                }
+
+                auto endKey = CreateKey(PSTD_FILE_PREFIX_RESULTS_STORE_END, {});
+                uint64_t end = compactStore.GetEnd();
+                rc = unqlite_kv_store(compact.get(), endKey->data(), (int) endKey->size(), &end, sizeof(end));
+                if (rc != UNQLITE_OK)
+                {
+                    throw PSTDFileIOException(rc, endKey, "store data");
+                }
+                compactStore.Flush();
+                rc = unqlite_commit(compact.get());
+                if (rc != UNQLITE_OK)
+                {
+                    throw PSTDFileIOException(rc, nullptr, "Commit");
+                }
+            }
+
+            // replace the file by the compacted file. The marker records that the compacted files are complete, so
+            // that opening the file finishes the replacement when it is interrupted.
+            this->backend = nullptr;
+            this->resultsStore = nullptr;
+            std::ofstream(compactFilename.string() + PSTD_FILE_COMPACT_DONE_EXTENSION).close();
+            finish_compaction(this->filename);
+            this->backend = open_backend(this->filename);
+            this->sceneConfCache.clear();
+            this->resultsMetadata = nullptr;
+            this->ReadResultsGeneration();
+            this->OpenResultsStore(this->filename);
         }
 
         void PSTDFile::Rollback()
         {
             boost::unique_lock<boost::recursive_mutex> lock(this->backendMutex);
             int rc = unqlite_rollback(this->backend.get());
+            // the cached configurations, frame index, statistics, codecs, time series, metadata and generation can
+            // be newer than the rolled back file
+            this->sceneConfCache.clear();
+            this->frameIndex.clear();
+            this->frameStatistics.clear();
+            this->frameCodecs.clear();
+            this->timeSeriesIndex.clear();
+            this->resultsMetadata = nullptr;
+            this->ReadResultsGeneration();
+            auto key = CreateKey(PSTD_FILE_PREFIX_RESULTS_STORE_END, {});
+            this->resultsStore->Truncate(this->HasValue(key) ? this->GetValue<uint64_t>(key) : 0);
 
             if(rc != UNQLITE_OK)
                 throw PSTDFileIOException(rc, nullptr, "Commit");
@@ -48,9 +48,12 @@ extern "C"
 
 #include <memory>
 #include <vector>
+#include <map>
 #include <kernel/GeneralTypes.h>
 #include <kernel/KernelInterface.h>
 #include <shared/InvalidationData.h>
+#include <shared/ResultsStore.h>
+#include <shared/FrameCodec.h>
 #include <QVector2D>
 #include <QVector3D>
 #include <boost/serialization/split_free.hpp>
@@ -158,6 +161,78 @@ namespace OpenPSTD
             OPENPSTD_SHARED_EXPORT const char *what() const noexcept override;
         };
 
+        /**
+         * Read-only view of values stored in a PSTDFile. The view holds the memory it refers to, so it stays valid
+         * when the file changes. Frames are viewed directly in the mapped results store, without copies.
+         */
+        class PSTDFileDataView
+        {
+        private:
+            std::shared_ptr<const Kernel::PSTD_FRAME_UNIT> values;
+            size_t count;
+
+        public:
+            /**
+             * Creates an empty view
+             */
+            PSTDFileDataView() : values(), count(0)
+            {
+
+            }
+
+            /**
+             * Creates a view of count values, the values are kept valid by the shared pointer
+             */
+            PSTDFileDataView(std::shared_ptr<const Kernel::PSTD_FRAME_UNIT> values, size_t count) :
+                    values(values), count(count)
+            {
+
+            }
+
+            const Kernel::PSTD_FRAME_UNIT *data() const
+            { return values.get(); }
+
+            size_t size() const
+            { return count; }
+
+            bool empty() const
+            { return count == 0; }
+
+            const Kernel::PSTD_FRAME_UNIT *begin() const
+            { return values.get(); }
+
+            const Kernel::PSTD_FRAME_UNIT *end() const
+            { return values.get() + count; }
+
+            const Kernel::PSTD_FRAME_UNIT &operator[](size_t i) const
+            { return values.get()[i]; }
+        };
+
+        /**
+         * The frames and receiver samples of a time step, collected to be written in a single operation
+         */
+        class OPENPSTD_SHARED_EXPORT PSTDFileWriteBatch
+        {
+        public:
+            /**
+             * The frames with their domain, in the order they were produced
+             */
+            std::vector<std::pair<unsigned int, Kernel::PSTD_FRAME_PTR>> Frames;
+
+            /**
+             * The samples with their receiver, in the order they were produced
+             */
+            std::vector<std::pair<unsigned int, Kernel::PSTD_RECEIVER_DATA_PTR>> Samples;
+
+            OPENPSTD_SHARED_EXPORT void AddFrame(unsigned int domain, Kernel::PSTD_FRAME_PTR frame);
+
+            OPENPSTD_SHARED_EXPORT void AddSamples(unsigned int receiver, Kernel::PSTD_RECEIVER_DATA_PTR data);
+
+            OPENPSTD_SHARED_EXPORT bool IsEmpty() const;
+
+            OPENPSTD_SHARED_EXPORT void Clear();
+        };
+
         class OPENPSTD_SHARED_EXPORT PSTDFile : public InvalidationData
         {
         private:
@@ -168,6 +243,103 @@ namespace OpenPSTD
             bool changed;
             boost::recursive_mutex backendMutex;
 
+            /**
+             * The decoded scene configurations by key, so that they are only read from the backend once
+             */
+            std::map<std::vector<char>, std::shared_ptr<Kernel::PSTDConfiguration>> sceneConfCache;
+
+            /**
+             * Store of the result frames, in a file next to the database
+             */
+            std::unique_ptr<ResultsStore> resultsStore;
+
+            /**
+             * The location of the frames in the results store by domain, read from the database when first used
+             */
+            std::map<unsigned int, std::vector<ResultsStoreEntry>> frameIndex;
+
+            /**
+             * The statistics of the frames by domain, read from the database when first used
+             */
+            std::map<unsigned int, std::vector<ResultsFrameStatistics>> frameStatistics;
+
+            /**
+             * The codecs of the frames by domain, read from the database when first used
+             */
+            std::map<unsigned int, std::vector<PSTD_FRAME_CODEC>> frameCodecs;
+
+            /**
+             * The metadata of the results, read from the database when first used
+             */
+            std::shared_ptr<const Kernel::SimulationMetadata> resultsMetadata;
+
+            /**
+             * The location of the time series tiles in the results store by domain, read from the database when
+             * first used
+             */
+            std::map<unsigned int, std::vector<ResultsStoreEntry>> timeSeriesIndex;
+
+            /**
+             * The filename of the database
+             */
+            boost::filesystem::path filename;
+
+            /**
+             * The generation of the results, the keys of the results contain their generation, so that deleting the
+             * results only starts a new generation
+             */
+            unsigned int resultsGeneration;
+
+            /**
+             * Reads the generation of the results from the database
+             * @throw PSTDFileIOException when the generation does not fit in the keys
+             */
+            void ReadResultsGeneration();
+
+            /**
+             * Deletes the results of all generations from the database
+             */
+            void RemoveResultsGenerations();
+
+            /**
+             * Opens the results store that belongs to the database
+             * @param filename the filename of the database
+             */
+            void OpenResultsStore(const boost::filesystem::path &filename);
+
+            /**
+             * Gets the location of the frames of a domain in the results store
+             */
+            std::vector<ResultsStoreEntry> &GetFrameIndex(unsigned int domain);
+
+            /**
+             * Gets the statistics of the frames of a domain, frames without statistics have a Count of 0
+             */
+            std::vector<ResultsFrameStatistics> &GetFrameStatistics(unsigned int domain);
+
+            /**
+             * Gets the codecs of the frames of a domain, frames without a codec are raw
+             */
+            std::vector<PSTD_FRAME_CODEC> &GetFrameCodecs(unsigned int domain);
+
+            /**
+             * Gets the location of the time series tiles of a domain in the results store, ordered by time block and
+             * then by tile
+             */
+            std::vector<ResultsStoreEntry> &GetTimeSeriesIndex(unsigned int domain);
+
+            /**
+             * Gets the number of grid points of the frames of a domain in x and y direction
+             */
+            void GetResultsFrameGrid(unsigned int domain, int &width, int &height);
+
+            /**
+             * Gets a per domain array from a cache, reads it from the database when it is not cached yet
+             */
+            template<typename T>
+            std::vector<T> &GetCachedArray(std::map<unsigned int, std::vector<T>> &cache, PSTDFile_Key_t key,
+                                           unsigned int domain);
+
             /**
              * Get a value by key as a string
              */
@@ -178,6 +350,11 @@ namespace OpenPSTD
              */
             char *GetRawValue(PSTDFile_Key_t key, unqlite_int64 *nBytes);
 
+            /**
+             * Gets a value by key as a view of floats, the view owns the buffer of the value
+             */
+            PSTDFileDataView GetValueView(PSTDFile_Key_t key);
+
             /**
              * Sets a string value by key
              */
@@ -194,20 +371,25 @@ namespace OpenPSTD
             void AppendRawValue(PSTDFile_Key_t key, unqlite_int64 nBytes, const void *value);
 
             /**
-             * Delete a certain value
+             * Whether a value exists for the key
              */
-            void DeleteValue(PSTDFile_Key_t key);
+            bool HasValue(PSTDFile_Key_t key);
 
             /**
-             * Increment framecount
+             * Delete a certain value
              */
-            unsigned int IncrementFrameCount(unsigned int domain);
+            void DeleteValue(PSTDFile_Key_t key);
 
             /**
              * Create key based on a prefix and multiple integer value
              */
             static PSTDFile_Key_t CreateKey(unsigned int prefix, std::initializer_list<unsigned int> list);
 
+            /**
+             * Create key of the current generation of the results based on a prefix and multiple integer values
+             */
+            PSTDFile_Key_t CreateResultsKey(unsigned int prefix, std::initializer_list<unsigned int> list);
+
             /**
              * Create key based on raw data
              */
@@ -299,13 +481,13 @@ namespace OpenPSTD
             }
 
             /**
-             * Reads the scene config out of the file
+             * Reads the scene config out of the file, the decoded config is cached until it is written again
              * @return a shared ptr to a new object of scene configuration
              */
             std::shared_ptr<Kernel::PSTDConfiguration> GetSceneConf(PSTDFile_Key_t key);
 
             /**
-             * Writes the scene config to the file
+             * Writes the scene config to the file, as a binary archive
              * @param scene a shared ptr to an object of scene configuration
              */
             void SetSceneConf(PSTDFile_Key_t key, std::shared_ptr<Kernel::PSTDConfiguration> scene);
@@ -331,10 +513,12 @@ namespace OpenPSTD
             OPENPSTD_SHARED_EXPORT PSTDFile();
 
             /**
-             * Compresses the file that so that the file is smaller. This also deletes the data results.
+             * Rewrites the file and its results store with only the data that is still used, so that they are
+             * smaller. The results of earlier generations and the discarded frames are dropped. The file is
+             * committed first. A compaction that is interrupted while the files are replaced is finished when the
+             * file is opened.
              */
-            //todo implement
-            //void Compress();
+            OPENPSTD_SHARED_EXPORT void Compact();
 
 
             OPENPSTD_SHARED_EXPORT void Commit();
@@ -357,8 +541,15 @@ namespace OpenPSTD
 
             /**
              * initializes the results(creates domains)
+             * @param metadata: the metadata of the kernel that creates the results, stored with the results
              */
-            OPENPSTD_SHARED_EXPORT void InitializeResults();
+            OPENPSTD_SHARED_EXPORT void InitializeResults(const Kernel::SimulationMetadata &metadata);
+
+            /**
+             * Gets the metadata (sizes and positions of the domains) of the results. The metadata is cached, for
+             * results of older versions it is derived from the results scene config.
+             */
+            OPENPSTD_SHARED_EXPORT std::shared_ptr<const Kernel::SimulationMetadata> GetResultsMetadata();
 
             /**
              * Reads the scene config out of the file. This scene config is for the results, this config can differs from
@@ -383,16 +574,109 @@ namespace OpenPSTD
              */
             OPENPSTD_SHARED_EXPORT Kernel::PSTD_FRAME_PTR GetResultsFrame(unsigned int frame, unsigned int domain);
 
+            /**
+             * Gets the data from the frame without copying it
+             */
+            OPENPSTD_SHARED_EXPORT PSTDFileDataView GetResultsFrameView(unsigned int frame, unsigned int domain);
+
+            /**
+             * Gets the minimum, maximum, mean and RMS of a frame without reading the frame (except for frames
+             * written by older versions)
+             */
+            OPENPSTD_SHARED_EXPORT ResultsFrameStatistics GetResultsFrameStatistics(unsigned int frame,
+                                                                                    unsigned int domain);
+
+            /**
+             * Gets the statistics of a range of frames of a domain together
+             * @param startFrame: first frame of the range
+             * @param endFrame: last frame of the range (inclusive), -1 for the last frame of the domain
+             */
+            OPENPSTD_SHARED_EXPORT ResultsFrameStatistics GetResultsStatistics(unsigned int domain, int startFrame = 0,
+                                                                               int endFrame = -1);
+
+            /**
+             * Sets the codec with which the frames that are saved next are encoded, stored in the file
+             * @param maxError: the maximum absolute error of the values of the lossy codecs (FLOAT16 and QUANTIZED)
+             * @throw std::invalid_argument when maxError is negative, or not positive for QUANTIZED
+             */
+            OPENPSTD_SHARED_EXPORT void SetResultsFrameCodec(PSTD_FRAME_CODEC codec, float maxError = 0);
+
+            /**
+             * Gets the codec with which the frames are encoded, RAW when it was never set
+             */
+            OPENPSTD_SHARED_EXPORT PSTD_FRAME_CODEC GetResultsFrameCodec();
+
+            /**
+             * Gets the maximum absolute error of the values of the lossy codecs
+             */
+            OPENPSTD_SHARED_EXPORT float GetResultsFrameMaxError();
+
+            /**
+             * Number of frames in a time block of the time series
+             */
+            static const unsigned int TIME_SERIES_BLOCK_FRAMES = 64;
+
+            /**
+             * Width and height in grid points of a tile of the time series
+             */
+            static const unsigned int TIME_SERIES_TILE_SIZE = 32;
+
+            /**
+             * Organizes the frames of a domain that are complete time blocks as time series, next to the frames.
+             *
+             * The frames of a time block are split in tiles of grid points and every tile is stored with the values
+             * of a grid point in consecutive frames next to each other, so that the time series of a grid point is
+             * read from a single place per time block. Only the time blocks that are not organized yet are written,
+             * so this can be called during a simulation from another thread. The lock of the file is not held while
+             * a time block is reordered.
+             * @return the number of time blocks that were written
+             * @throw std::invalid_argument when the frames are not complete domains
+             */
+            OPENPSTD_SHARED_EXPORT int UpdateResultsTimeSeries(unsigned int domain);
+
+            /**
+             * Number of frames of a domain that are organized as time series
+             */
+            OPENPSTD_SHARED_EXPORT int GetResultsTimeSeriesFrameCount(unsigned int domain);
+
+            /**
+             * Gets the values of grid points in all frames of a domain. The organized frames are read from the time
+             * series tiles of the points, only the frames after them are read as frames.
+             * @param points: the grid points as {x, y}
+             * @return the time series of every point
+             * @throw std::out_of_range when a point lies outside the domain
+             */
+            OPENPSTD_SHARED_EXPORT std::vector<Kernel::PSTD_RECEIVER_DATA> GetResultsTimeSeries(
+                    unsigned int domain, const std::vector<std::pair<int, int>> &points);
+
             /**
              * Saves the next frame for a certain domain in the file
              */
             OPENPSTD_SHARED_EXPORT void SaveNextResultsFrame(unsigned int domain, Kernel::PSTD_FRAME_PTR frame);
 
             /**
-             * Delete all the simulation results
+             * Saves the frames and samples of a batch under a single lock, every frame is the next frame of its
+             * domain. The frame counters, frame index and receiver data are updated once per domain or receiver.
+             * The batch is cleared afterwards.
+             */
+            OPENPSTD_SHARED_EXPORT void WriteBatch(PSTDFileWriteBatch &batch);
+
+            /**
+             * Delete all the simulation results. This starts a new generation of the results and does not depend on
+             * the size of the results, the space of the old results in the database is reclaimed by Compact. The
+             * results store is emptied by the next commit, unless new frames are written before it. When the
+             * generations run out, the results of all generations are deleted and the generations start again.
              */
             OPENPSTD_SHARED_EXPORT void DeleteResults();
 
+            /**
+             * Removes the results that were written after a checkpoint, so a resumed simulation can continue them
+             * @param domainFrames number of frames to keep per domain, domains without an entry keep none
+             * @param receiverSamples number of samples to keep per receiver, receivers without an entry keep none
+             */
+            OPENPSTD_SHARED_EXPORT void TruncateResults(const std::map<int, int> &domainFrames,
+                                                        const std::map<int, int> &receiverSamples);
+
             /**
              * Saves a couple of new samples to the receiver data
              */
@@ -403,11 +687,52 @@ namespace OpenPSTD
              */
             OPENPSTD_SHARED_EXPORT Kernel::PSTD_RECEIVER_DATA_PTR GetReceiverData(unsigned int receiver);
 
+            /**
+             * Gets the receivers data from file, without an intermediate copy
+             */
+            OPENPSTD_SHARED_EXPORT PSTDFileDataView GetReceiverDataView(unsigned int receiver);
+
             /**
              * Gets the number of receivers in the results
              */
             OPENPSTD_SHARED_EXPORT int GetResultsReceiverCount();
 
+            /**
+             * Saves a per-cell reduction of the pressure of a domain, replacing a previous one
+             */
+            OPENPSTD_SHARED_EXPORT void SaveResultsReduction(unsigned int domain, Kernel::FIELD_REDUCTION reduction,
+                                                             Kernel::PSTD_FRAME_PTR data);
+
+            /**
+             * Whether the results contain a reduction for the domain
+             */
+            OPENPSTD_SHARED_EXPORT bool HasResultsReduction(unsigned int domain, Kernel::FIELD_REDUCTION reduction);
+
+            /**
+             * Gets a per-cell reduction of the pressure of a domain, with the layout of the frames
+             */
+            OPENPSTD_SHARED_EXPORT Kernel::PSTD_FRAME_PTR GetResultsReduction(unsigned int domain,
+                                                                             Kernel::FIELD_REDUCTION reduction);
+
+            /**
+             * Saves the DFT of the pressure of a domain at a frequency, replacing a previous one
+             * @param frequencyIndex index of the frequency in the frequencies of the simulation
+             * @param frequency the frequency in Hz
+             * @param data interleaved real and imaginary parts, with the layout of the frames
+             */
+            OPENPSTD_SHARED_EXPORT void SaveResultsDFT(unsigned int domain, unsigned int frequencyIndex, float frequency,
+                                                       Kernel::PSTD_FRAME_PTR data);
+
+            /**
+             * Gets the frequencies (in Hz) of the DFT results, in the order of their index
+             */
+            OPENPSTD_SHARED_EXPORT std::vector<float> GetResultsDFTFrequencies();
+
+            /**
+             * Gets the DFT of the pressure of a domain, as interleaved real and imaginary parts
+             */
+            OPENPSTD_SHARED_EXPORT Kernel::PSTD_FRAME_PTR GetResultsDFT(unsigned int domain, unsigned int frequencyIndex);
+
 
             /**
              * outputs debug info, only for debug purposes.
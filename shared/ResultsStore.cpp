@@ -0,0 +1,227 @@
+//////////////////////////////////////////////////////////////////////////
+// This file is part of openPSTD.                                       //
+//                                                                      //
+// openPSTD is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU General Public License as published by //
+// the Free Software Foundation, either version 3 of the License, or    //
+// (at your option) any later version.                                  //
+//                                                                      //
+// openPSTD is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of       //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        //
+// GNU General Public License for more details.                         //
+//                                                                      //
+// You should have received a copy of the GNU General Public License    //
+// along with openPSTD.  If not, see <http://www.gnu.org/licenses/>.    //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Date:
+//      18-10-2026
+//
+//////////////////////////////////////////////////////////////////////////
+
+#include "ResultsStore.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <Eigen/Dense>
+
+namespace OpenPSTD
+{
+    namespace Shared
+    {
+        using namespace boost::interprocess;
+
+        const uint64_t ResultsStore::CHUNK_SIZE;
+
+        /**
+         * Computes the statistics of values while they are copied (when destination is not null). The values are
+         * processed in blocks that fit in the cache, a block is copied and then reduced with vectorized operations.
+         */
+        static ResultsFrameStatistics copy_statistics(const float *values, float *destination, uint64_t count)
+        {
+            const uint64_t block_size = 4096;
+            float min = std::numeric_limits<float>::infinity();
+            float max = -std::numeric_limits<float>::infinity();
+            double sum = 0, squares = 0;
+            for (uint64_t start = 0; start < count; start += block_size)
+            {
+                Eigen::Index n = (Eigen::Index) std::min(block_size, count - start);
+                Eigen::Map<const Eigen::ArrayXf> block(values + start, n);
+                if (destination != nullptr)
+                {
+                    Eigen::Map<Eigen::ArrayXf>(destination + start, n) = block;
+                }
+                min = std::min(min, block.minCoeff());
+                max = std::max(max, block.maxCoeff());
+                sum += block.sum();
+                squares += block.square().sum();
+            }
+
+            ResultsFrameStatistics statistics;
+            statistics.Count = count;
+            statistics.Min = min;
+            statistics.Max = max;
+            statistics.Mean = count > 0 ? (float) (sum / count) : 0;
+            statistics.RMS = count > 0 ? (float) std::sqrt(squares / count) : 0;
+            return statistics;
+        }
+
+        OPENPSTD_SHARED_EXPORT ResultsFrameStatistics ResultsFrameStatistics::Compute(const float *values,
+                                                                                      uint64_t count)
+        {
+            return copy_statistics(values, nullptr, count);
+        }
+
+        OPENPSTD_SHARED_EXPORT ResultsFrameStatistics ResultsFrameStatistics::Combine(
+                const ResultsFrameStatistics &first, const ResultsFrameStatistics &second)
+        {
+            if (first.Count == 0)
+            {
+                return second;
+            }
+            if (second.Count == 0)
+            {
+                return first;
+            }
+            ResultsFrameStatistics result;
+            result.Count = first.Count + second.Count;
+            result.Min = std::min(first.Min, second.Min);
+            result.Max = std::max(first.Max, second.Max);
+            double firstWeight = (double) first.Count / result.Count;
+            double secondWeight = (double) second.Count / result.Count;
+            result.Mean = (float) (firstWeight * first.Mean + secondWeight * second.Mean);
+            result.RMS = (float) std::sqrt(firstWeight * first.RMS * first.RMS +
+                                           secondWeight * second.RMS * second.RMS);
+            return result;
+        }
+
+        ResultsStore::ResultsStore(const boost::filesystem::path &path, uint64_t end) : path(path), end(0)
+        {
+            if (!boost::filesystem::exists(path))
+            {
+                std::ofstream create(path.string(), std::ios::binary);
+            }
+            this->Truncate(end);
+        }
+
+        char *ResultsStore::GetPointer(uint64_t offset, uint64_t size)
+        {
+            uint64_t chunk = offset / CHUNK_SIZE;
+            uint64_t start = chunk * CHUNK_SIZE;
+            uint64_t length = (offset + size - start + CHUNK_SIZE - 1) / CHUNK_SIZE * CHUNK_SIZE;
+
+            auto region = this->regions.find(chunk);
+            if (region == this->regions.end() || region->second->get_size() < length)
+            {
+                this->regions[chunk] = std::make_shared<mapped_region>(*this->file, read_write, (offset_t) start,
+                                                                       (std::size_t) length);
+                region = this->regions.find(chunk);
+            }
+            return (char *) region->second->get_address() + (offset - start);
+        }
+
+        void ResultsStore::Resize(uint64_t size)
+        {
+            bool inUse = false;
+            for (auto &region : this->regions)
+            {
+                inUse = inUse || region.second.use_count() > 1;
+            }
+            this->regions.clear();
+            this->file = nullptr;
+
+            uint64_t fileSize = (size + CHUNK_SIZE - 1) / CHUNK_SIZE * CHUNK_SIZE;
+            // accessing a mapping beyond the end of its file is an error, the file is shrunk by a later resize
+            if (!inUse || fileSize > boost::filesystem::file_size(this->path))
+            {
+                boost::filesystem::resize_file(this->path, fileSize);
+            }
+            this->file = std::unique_ptr<file_mapping>(new file_mapping(this->path.string().c_str(), read_write));
+        }
+
+        char *ResultsStore::Reserve(uint64_t size, ResultsStoreEntry &entry)
+        {
+            uint64_t offset = this->end;
+            uint64_t used = offset % CHUNK_SIZE;
+            if (used > 0 && used + size > CHUNK_SIZE)
+            {
+                // start a new chunk, so that the frame is contiguous in a single mapping
+                offset += CHUNK_SIZE - used;
+            }
+
+            entry = {offset, size};
+            this->end = offset + size;
+            if (size == 0)
+            {
+                return nullptr;
+            }
+            uint64_t file_size = (offset + size + CHUNK_SIZE - 1) / CHUNK_SIZE * CHUNK_SIZE;
+            if (file_size > boost::filesystem::file_size(this->path))
+            {
+                // the existing mappings stay valid when the file grows
+                boost::filesystem::resize_file(this->path, file_size);
+            }
+            return this->GetPointer(offset, size);
+        }
+
+        ResultsStoreEntry ResultsStore::Append(const void *data, uint64_t size)
+        {
+            ResultsStoreEntry entry;
+            char *destination = this->Reserve(size, entry);
+            if (size > 0)
+            {
+                std::memcpy(destination, data, size);
+            }
+            return entry;
+        }
+
+        ResultsStoreEntry ResultsStore::AppendFrame(const float *values, uint64_t count,
+                                                    ResultsFrameStatistics &statistics)
+        {
+            ResultsStoreEntry entry;
+            char *destination = this->Reserve(count * sizeof(float), entry);
+            statistics = copy_statistics(values, (float *) destination, count);
+            return entry;
+        }
+
+        std::shared_ptr<const char> ResultsStore::Get(ResultsStoreEntry entry)
+        {
+            if (entry.Offset + entry.Size > this->end)
+            {
+                throw std::out_of_range("The frame lies beyond the end of the results store");
+            }
+            if (entry.Size == 0)
+            {
+                return nullptr;
+            }
+            const char *pointer = this->GetPointer(entry.Offset, entry.Size);
+            return std::shared_ptr<const char>(this->regions.at(entry.Offset / CHUNK_SIZE), pointer);
+        }
+
+        uint64_t ResultsStore::GetEnd() const
+        {
+            return this->end;
+        }
+
+        void ResultsStore::Truncate(uint64_t end)
+        {
+            this->Resize(end);
+            this->end = end;
+        }
+
+        void ResultsStore::Flush()
+        {
+            for (auto &region : this->regions)
+            {
+                region.second->flush();
+            }
+        }
+    }
+}
@@ -0,0 +1,166 @@
+//////////////////////////////////////////////////////////////////////////
+// This file is part of openPSTD.                                       //
+//                                                                      //
+// openPSTD is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU General Public License as published by //
+// the Free Software Foundation, either version 3 of the License, or    //
+// (at your option) any later version.                                  //
+//                                                                      //
+// openPSTD is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of       //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        //
+// GNU General Public License for more details.                         //
+//                                                                      //
+// You should have received a copy of the GNU General Public License    //
+// along with openPSTD.  If not, see <http://www.gnu.org/licenses/>.    //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Date:
+//      18-10-2026
+//
+// Purpose:
+//      Append-only, memory mapped storage of the result frames, next to
+//      the scene database.
+//
+//////////////////////////////////////////////////////////////////////////
+
+#ifndef OPENPSTD_RESULTSSTORE_H
+#define OPENPSTD_RESULTSSTORE_H
+
+#include "openpstd-shared_export.h"
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+namespace OpenPSTD
+{
+    namespace Shared
+    {
+        /**
+         * Location of a frame in the results store
+         */
+        struct ResultsStoreEntry
+        {
+            /// Offset of the frame in the store in bytes
+            uint64_t Offset;
+            /// Size of the frame in bytes
+            uint64_t Size;
+        };
+
+        /**
+         * Statistics of the values of a frame
+         */
+        struct ResultsFrameStatistics
+        {
+            /// Number of values, 0 when the statistics are unknown
+            uint64_t Count;
+            float Min;
+            float Max;
+            float Mean;
+            float RMS;
+
+            /**
+             * Computes the statistics of values
+             */
+            OPENPSTD_SHARED_EXPORT static ResultsFrameStatistics Compute(const float *values, uint64_t count);
+
+            /**
+             * The statistics of the values of two frames together
+             */
+            OPENPSTD_SHARED_EXPORT static ResultsFrameStatistics Combine(const ResultsFrameStatistics &first,
+                                                                         const ResultsFrameStatistics &second);
+        };
+
+        /**
+         * Append-only store for the result frames.
+         *
+         * The file grows in chunks of a fixed size that are memory mapped. A frame never crosses the boundary of a
+         * chunk, unless it is larger than a chunk (then it starts a chunk of its own), so reading a frame is a lookup
+         * in the mapping of its chunk. The index of the frames is kept by the caller.
+         */
+        class ResultsStore
+        {
+        private:
+            boost::filesystem::path path;
+            std::unique_ptr<boost::interprocess::file_mapping> file;
+            /// Mapped regions by their first chunk, shared with the pointers handed out by Get
+            std::map<uint64_t, std::shared_ptr<boost::interprocess::mapped_region>> regions;
+            /// End of the stored data in bytes
+            uint64_t end;
+
+            /**
+             * Pointer to a position in the store, maps the chunk of the position when needed
+             * @param offset: position in bytes
+             * @param size: number of bytes after offset that have to be mapped
+             */
+            char *GetPointer(uint64_t offset, uint64_t size);
+
+            /**
+             * Reserves space for new data at the end of the store
+             * @return pointer to the reserved space
+             */
+            char *Reserve(uint64_t size, ResultsStoreEntry &entry);
+
+            /**
+             * Drops all mappings and resizes the file to a whole number of chunks. The file does not shrink while
+             * pointers into the mappings are still held.
+             */
+            void Resize(uint64_t size);
+
+        public:
+            /// Size of the chunks in bytes
+            static const uint64_t CHUNK_SIZE = 64 * 1024 * 1024;
+
+            /**
+             * Opens the store, the file is created when it does not exist
+             * @param path: the file of the store
+             * @param end: end of the stored data, the data after it is discarded
+             */
+            ResultsStore(const boost::filesystem::path &path, uint64_t end);
+
+            /**
+             * Appends data to the store
+             * @return location of the data
+             */
+            ResultsStoreEntry Append(const void *data, uint64_t size);
+
+            /**
+             * Appends a frame to the store and computes its statistics while it is copied
+             * @param values: the values of the frame
+             * @param count: number of values
+             * @param statistics: receives the statistics of the frame
+             * @return location of the frame
+             */
+            ResultsStoreEntry AppendFrame(const float *values, uint64_t count, ResultsFrameStatistics &statistics);
+
+            /**
+             * Pointer to stored data, the pointer holds the mapping of the data, so it stays valid when the store
+             * is truncated or destroyed. A pointer to data that is discarded can see the data that is appended later.
+             */
+            std::shared_ptr<const char> Get(ResultsStoreEntry entry);
+
+            /**
+             * End of the stored data in bytes
+             */
+            uint64_t GetEnd() const;
+
+            /**
+             * Discards the data after a position
+             */
+            void Truncate(uint64_t end);
+
+            /**
+             * Writes the mapped chunks to the file
+             */
+            void Flush();
+        };
+    }
+}
+
+#endif //OPENPSTD_RESULTSSTORE_H
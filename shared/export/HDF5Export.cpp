@@ -3,7 +3,6 @@
 //
 
 #include "HDF5Export.h"
-#include "kernel/MockKernel.h"
 
 #include <hdf5.h>
 #include <hdf5_hl.h>
@@ -18,15 +17,13 @@ namespace OpenPSTD
                               std::vector<int> domains, int startFrame, int endFrame)
         {
             hid_t file_id;
-            Kernel::MockKernel k;
 
             file_id = H5Fcreate(output.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
 
             hid_t frame_dir_id = H5Gcreate2(file_id, "/frame", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
             hid_t receiver_dir_id = H5Gcreate2(file_id, "/receiver", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
 
-            k.initialize_kernel(file->GetSceneConf(), std::make_shared<OpenPSTD::Kernel::KernelCallbackLog>());
-            auto metadata = k.get_metadata();
+            auto metadata = file->GetResultsMetadata();
 
             if (domains.size() == 0)
             {
@@ -49,13 +46,15 @@ namespace OpenPSTD
                 {
                     std::string location = domainLoc + "/" + boost::lexical_cast<std::string>(f);
 
+                    //the frames may contain a region or a decimated grid of the domain
+                    std::vector<int> grid = metadata->GetFrameGrid(d);
                     std::vector<hsize_t> size;
-                    size.push_back(metadata.DomainMetadata[d][0]);
-                    size.push_back(metadata.DomainMetadata[d][1]);
+                    size.push_back(grid[0]);
+                    size.push_back(grid[1]);
 
                     //get data and write to file
-                    auto data = file->GetResultsFrame(f, d);
-                    H5LTmake_dataset(file_id, location.c_str(), 2, size.data(), H5T_NATIVE_FLOAT, data->data());
+                    auto data = file->GetResultsFrameView(f, d);
+                    H5LTmake_dataset(file_id, location.c_str(), 2, size.data(), H5T_NATIVE_FLOAT, data.data());
                 }
 
                 H5Gclose(frame_index_id);
@@ -65,12 +64,12 @@ namespace OpenPSTD
             for(int r = 0; r < receiverCount; r++)
             {
                 std::string receiverLoc = "/receiver/" + boost::lexical_cast<std::string>(r);
-                auto data = file->GetReceiverData(r);
+                auto data = file->GetReceiverDataView(r);
 
                 std::vector<hsize_t> size;
-                size.push_back(data->size());
+                size.push_back(data.size());
 
-                H5LTmake_dataset(file_id, receiverLoc.c_str(), 1, size.data(), H5T_NATIVE_FLOAT, data->data());
+                H5LTmake_dataset(file_id, receiverLoc.c_str(), 1, size.data(), H5T_NATIVE_FLOAT, data.data());
             }
 
             /* close file */
@@ -5,7 +5,6 @@
 #include "Image.h"
 #include <boost/lexical_cast.hpp>
 #include <shared/Colors.h>
-#include "kernel/MockKernel.h"
 
 namespace OpenPSTD
 {
@@ -34,9 +33,7 @@ namespace OpenPSTD
                                      std::string name, std::vector<int> domains, int startFrame,
                                      int endFrame)
         {
-            Kernel::MockKernel k;
-            k.initialize_kernel(file->GetResultsSceneConf(), std::make_shared<OpenPSTD::Kernel::KernelCallbackLog>());
-            auto metadata = k.get_metadata();
+            auto metadata = file->GetResultsMetadata();
 
             if (domains.size() == 0)
             {
@@ -47,22 +44,23 @@ namespace OpenPSTD
                     domains.push_back(d);
                 }
             }
-            float min = std::numeric_limits<float>::infinity();
-            float max = -std::numeric_limits<float>::infinity();
-
+            //the range of the colormap follows from the statistics of the frames, without reading them
+            ResultsFrameStatistics statistics = ResultsFrameStatistics::Compute(nullptr, 0);
             for (int d = 0; d < domains.size(); ++d)
             {
                 if (startFrame == -1) startFrame = 0;
                 if (endFrame == -1) endFrame = file->GetResultsFrameCount(domains[d]) - 1;
-                for (int f = startFrame; f <= endFrame; ++f)
-                {
-                    Kernel::PSTD_FRAME_PTR frame = file->GetResultsFrame(f, domains[d]);
-                    for (int i = 0; i < frame->size(); ++i)
-                    {
-                        min = std::min((*frame)[i], min);
-                        max = std::max((*frame)[i], max);
-                    }
-                }
+                statistics = ResultsFrameStatistics::Combine(
+                        statistics, file->GetResultsStatistics(domains[d], startFrame, endFrame));
+            }
+            float min = statistics.Min;
+            float max = statistics.Max;
+
+            //the frames may contain a region or a decimated grid of the domains
+            std::vector<std::vector<int>> grids;
+            for (int d = 0; d < metadata->DomainMetadata.size(); ++d)
+            {
+                grids.push_back(metadata->GetFrameGrid(d));
             }
 
             if(this->_fullView)
@@ -72,7 +70,8 @@ namespace OpenPSTD
                 for (int f = startFrame; f <= endFrame; ++f)
                 {
                     this->saveFullImage(format, file, directory + "/" + name + "-" + boost::lexical_cast<std::string>(f),
-                                        domains, f, metadata.DomainPositions, metadata.DomainMetadata, min, max);
+                                        domains, f, metadata->DomainPositions, metadata->DomainMetadata, grids,
+                                        min, max);
                 }
             }
             else
@@ -86,24 +85,33 @@ namespace OpenPSTD
                         this->saveImage(format, file,
                                         directory + "/" + name + "-" + boost::lexical_cast<std::string>(d) + "-" +
                                         boost::lexical_cast<std::string>(f),
-                                        d, f, metadata.DomainMetadata[d], min, max);
+                                        d, f, grids[d], min, max);
                     }
                 }
             }
 
         }
 
-        OPENPSTD_SHARED_NO_EXPORT void ExportImage::drawData(std::shared_ptr<QImage> image, Kernel::PSTD_FRAME_PTR frame, float min, float max,
-                                   int colormapSize, std::vector<int> position, std::vector<int> size)
+        OPENPSTD_SHARED_NO_EXPORT void ExportImage::drawData(std::shared_ptr<QImage> image, const PSTDFileDataView &frame, float min, float max,
+                                   int colormapSize, std::vector<int> position, std::vector<int> size, int step)
         {
-            //draw on image
-            auto it = frame->begin();
+            //draw on image, every value covers step by step pixels
+            auto it = frame.begin();
             for (int i = 0; i < size[0]; ++i)
             {
                 for (int j = 0; j < size[1]; ++j)
                 {
                     int color = (int) roundf(((*it) - min) / (max - min) * (colormapSize - 1));
-                    image->setPixel(position[0] + i, position[1] + j, color);
+                    for (int x = position[0] + i * step; x < position[0] + (i + 1) * step; ++x)
+                    {
+                        for (int y = position[1] + j * step; y < position[1] + (j + 1) * step; ++y)
+                        {
+                            if (image->valid(x, y))
+                            {
+                                image->setPixel(x, y, color);
+                            }
+                        }
+                    }
                     it++;
                 }
             }
@@ -136,7 +144,7 @@ namespace OpenPSTD
             }
 
             //get data
-            auto data = file->GetResultsFrame(frame, domain);
+            auto data = file->GetResultsFrameView(frame, domain);
 
             //position
             std::vector<int> position = {0, 0};
@@ -165,7 +173,8 @@ namespace OpenPSTD
 
         OPENPSTD_SHARED_NO_EXPORT void ExportImage::saveFullImage(std::string format, std::shared_ptr<PSTDFile> file, std::string output,
                                         std::vector<int> domains, int frame, std::vector<std::vector<int>> positions,
-                                        std::vector<std::vector<int>> sizes, float min, float max)
+                                        std::vector<std::vector<int>> sizes, std::vector<std::vector<int>> grids,
+                                        float min, float max)
         {
             //gets the maximal values of the frame
             int minX = std::numeric_limits<int>::max(), minY = std::numeric_limits<int>::max();
@@ -226,10 +235,11 @@ namespace OpenPSTD
             for (int d : domains)
             {
                 //get data
-                auto data = file->GetResultsFrame(frame, d);
+                auto data = file->GetResultsFrameView(frame, d);
 
-                //draw on image
-                drawData(result, data, min, max, colorMap.size(), positions[d], sizes[d]);
+                //draw on image, at the region of the domain that the frame contains
+                std::vector<int> position = {positions[d][0] + grids[d][2], positions[d][1] + grids[d][3]};
+                drawData(result, data, min, max, colorMap.size(), position, grids[d], grids[d][4]);
             }
 
             //save image
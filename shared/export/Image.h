@@ -26,10 +26,11 @@ namespace OpenPSTD
 
             OPENPSTD_SHARED_NO_EXPORT void saveFullImage(std::string format, std::shared_ptr<PSTDFile> file, std::string output,
                                std::vector<int> domains, int frame, std::vector<std::vector<int>> positions,
-                               std::vector<std::vector<int>> sizes, float min, float max);
+                               std::vector<std::vector<int>> sizes, std::vector<std::vector<int>> grids,
+                               float min, float max);
 
-            OPENPSTD_SHARED_NO_EXPORT void drawData(std::shared_ptr<QImage> image, Kernel::PSTD_FRAME_PTR frame, float min, float max,
-                          int colormapSize, std::vector<int> position, std::vector<int> size);
+            OPENPSTD_SHARED_NO_EXPORT void drawData(std::shared_ptr<QImage> image, const PSTDFileDataView &frame, float min, float max,
+                          int colormapSize, std::vector<int> position, std::vector<int> size, int step = 1);
 
         public:
             /**
@@ -44,7 +44,7 @@ using namespace std;
 using namespace Eigen;
 BOOST_AUTO_TEST_SUITE(domain)
 
-    shared_ptr<Kernel::Scene> create_a_scene() {
+    shared_ptr<Kernel::Scene<float>> create_a_scene() {
         shared_ptr<Kernel::PSTDConfiguration> config = Kernel::PSTDConfiguration::CreateDefaultConf();
         Kernel::DomainConf domain1;
         domain1.TopLeft = QVector2D(0, 0);
@@ -63,17 +63,17 @@ BOOST_AUTO_TEST_SUITE(domain)
         config->Speakers.clear();
         config->Speakers.push_back(QVector3D(4.1, 5.1, 0));
         BOOST_CHECK(config->Domains.size() == 1);
-        Kernel::PSTDKernel kernel = Kernel::PSTDKernel(false, false);
+        Kernel::PSTDKernel<float> kernel = Kernel::PSTDKernel<float>(false, false);
         kernel.initialize_kernel(config, std::make_shared<OpenPSTD::Kernel::KernelCallbackLog>());
         auto scene = kernel.get_scene();
         return scene;
     }
 
-    shared_ptr<Kernel::Domain> create_a_domain(int point_x, int point_y, int size_x, int size_y) {
+    shared_ptr<Kernel::Domain<float>> create_a_domain(int point_x, int point_y, int size_x, int size_y) {
         using namespace Kernel;
         Point top_left(point_x, point_y);
         Point size(size_x, size_y);
-        shared_ptr<WisdomCache> wnd(new WisdomCache());
+        shared_ptr<WisdomCache<float>> wnd(new WisdomCache<float>());
         EdgeParameters standard = {};
         standard.locally_reacting = true;
         standard.alpha = 1;
@@ -83,8 +83,8 @@ BOOST_AUTO_TEST_SUITE(domain)
                                                          {Direction::RIGHT,  standard},
                                                          {Direction::TOP,    standard},
                                                          {Direction::BOTTOM, standard}};
-        shared_ptr<Kernel::Domain> test_domain(
-                new Kernel::Domain(settings, 1, 1, top_left, size, false, wnd,
+        shared_ptr<Kernel::Domain<float>> test_domain(
+                new Kernel::Domain<float>(settings, 1, 1, top_left, size, false, wnd,
                                    edge_param_map, nullptr));
         return test_domain;
     }
@@ -160,9 +160,25 @@ BOOST_AUTO_TEST_SUITE(domain)
     }
 
     BOOST_AUTO_TEST_CASE(apply_pml_matrices) {
-        auto domain = create_a_domain(0, 0, 50, 60);
-        domain->compute_pml_matrices(); // Finish
-        BOOST_CHECK(true);
+        auto scene = create_a_scene();
+        for (auto domain:scene->domain_list) {
+            if (!domain->is_pml) {
+                continue;
+            }
+            auto &values = domain->current_values;
+            values.px0.setOnes();
+            values.py0.setOnes();
+            values.vx0.setOnes();
+            values.vy0.setOnes();
+            domain->apply_pml_matrices();
+            // The attenuation only varies along the direction of attenuation
+            BOOST_CHECK(values.px0.isApprox(values.px0.row(0).replicate(values.px0.rows(), 1)));
+            BOOST_CHECK(values.vx0.isApprox(values.vx0.row(0).replicate(values.vx0.rows(), 1)));
+            BOOST_CHECK(values.py0.isApprox(values.py0.col(0).replicate(1, values.py0.cols())));
+            BOOST_CHECK(values.vy0.isApprox(values.vy0.col(0).replicate(1, values.vy0.cols())));
+            BOOST_CHECK(values.px0.minCoeff() < 1 or values.py0.minCoeff() < 1);
+            BOOST_CHECK(values.px0.maxCoeff() <= 1 and values.py0.maxCoeff() <= 1);
+        }
     }
 
     BOOST_AUTO_TEST_CASE(domain_neighbours) {
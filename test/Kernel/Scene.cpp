@@ -46,7 +46,7 @@ using namespace Eigen;
 
 BOOST_AUTO_TEST_SUITE(scene)
 
-    shared_ptr<Kernel::Scene> create_a_reflecting_scene(int pml_size) {
+    shared_ptr<Kernel::Scene<float>> create_a_reflecting_scene(int pml_size) {
         shared_ptr<Kernel::PSTDConfiguration> config = Kernel::PSTDConfiguration::CreateDefaultConf();
         Kernel::DomainConf domain1;
         domain1.TopLeft = QVector2D(0, 0);
@@ -66,7 +66,7 @@ BOOST_AUTO_TEST_SUITE(scene)
         config->Speakers.clear();
         config->Speakers.push_back(QVector3D(4.1, 5.1, 0));
         BOOST_CHECK(config->Domains.size() == 1);
-        Kernel::PSTDKernel kernel = Kernel::PSTDKernel(false, false);
+        Kernel::PSTDKernel<float> kernel = Kernel::PSTDKernel<float>(false, false);
         kernel.initialize_kernel(config, std::make_shared<OpenPSTD::Kernel::KernelCallbackLog>());
         auto scene = kernel.get_scene();
         return scene;
@@ -0,0 +1,614 @@
+//////////////////////////////////////////////////////////////////////////
+// This file is part of openPSTD.                                       //
+//                                                                      //
+// openPSTD is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU General Public License as published by //
+// the Free Software Foundation, either version 3 of the License, or    //
+// (at your option) any later version.                                  //
+//                                                                      //
+// openPSTD is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of       //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        //
+// GNU General Public License for more details.                         //
+//                                                                      //
+// You should have received a copy of the GNU General Public License    //
+// along with openPSTD.  If not, see <http://www.gnu.org/licenses/>.    //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Date: 18-10-2026
+//
+//
+// Purpose: Test suite for the solvers
+//
+//
+//////////////////////////////////////////////////////////////////////////
+
+
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE Main
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <kernel/PSTDKernel.h>
+#include <cmath>
+#include <cstdio>
+
+using namespace OpenPSTD;
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(solver)
+
+    /**
+     * Callback that keeps the receiver samples in memory
+     */
+    class RecordingCallback : public Kernel::KernelCallback {
+    public:
+        vector<float> samples;
+
+        void Callback(Kernel::CALLBACKSTATUS, string, int) override { }
+
+        vector<unsigned long> frame_sizes;
+
+        vector<Kernel::PSTD_FRAME_PTR> frames;
+
+        /// Frame at which the callback simulates a crash of the simulation, -1 for none
+        int interrupt_frame = -1;
+
+        void WriteFrame(int frame, int, Kernel::PSTD_FRAME_PTR data) override {
+            if (frame == interrupt_frame) {
+                throw runtime_error("interrupted");
+            }
+            frame_sizes.push_back(data->size());
+            frames.push_back(data);
+        }
+
+        void WriteSample(int, int, vector<float> data) override {
+            samples.insert(samples.end(), data.begin(), data.end());
+        }
+
+        vector<float> energy;
+
+        void WriteEnergy(int, float frame_energy) override {
+            energy.push_back(frame_energy);
+        }
+
+        map<Kernel::FIELD_REDUCTION, Kernel::PSTD_FRAME_PTR> reductions;
+
+        void WriteReduction(int, Kernel::FIELD_REDUCTION reduction, Kernel::PSTD_FRAME_PTR data) override {
+            reductions[reduction] = data;
+        }
+
+        map<int, Kernel::PSTD_FRAME_PTR> dft;
+
+        void WriteDFT(int, int index, float, Kernel::PSTD_FRAME_PTR data) override {
+            dft[index] = data;
+        }
+
+        /// The finished time steps, with the number of frames and samples written when they were finished
+        vector<int> finished_frames;
+        vector<unsigned long> finished_frame_counts, finished_sample_counts;
+
+        void FinishFrame(int frame) override {
+            finished_frames.push_back(frame);
+            finished_frame_counts.push_back(frames.size());
+            finished_sample_counts.push_back(samples.size());
+        }
+    };
+
+    shared_ptr<Kernel::PSTDConfiguration> create_short_simulation(bool low_storage) {
+        shared_ptr<Kernel::PSTDConfiguration> config = Kernel::PSTDConfiguration::CreateDefaultConf();
+        Kernel::DomainConf domain = config->Domains.at(0);
+        domain.Size = QVector2D(8, 8);
+        config->Domains.clear();
+        config->Domains.push_back(domain);
+        config->Speakers.clear();
+        config->Speakers.push_back(QVector3D(4, 4, 0));
+        config->Receivers.clear();
+        config->Receivers.push_back(QVector3D(4.6, 4.2, 0));
+        config->Settings.SetRenderTime(0.005);
+        config->Settings.SetLowStorageRK(low_storage);
+        return config;
+    }
+
+    unsigned long run_short_simulation(bool low_storage, shared_ptr<RecordingCallback> callback) {
+        Kernel::PSTDKernel<float> kernel(false, false);
+        kernel.initialize_kernel(create_short_simulation(low_storage), callback);
+        kernel.run(callback);
+        unsigned long bytes = 0;
+        for (auto domain: kernel.get_scene()->domain_list) {
+            bytes += domain->get_field_memory();
+        }
+        return bytes;
+    }
+
+    BOOST_AUTO_TEST_CASE(low_storage_rk_matches_six_stage_rk) {
+        auto classic = make_shared<RecordingCallback>();
+        auto low_storage = make_shared<RecordingCallback>();
+        unsigned long classic_memory = run_short_simulation(false, classic);
+        unsigned long low_storage_memory = run_short_simulation(true, low_storage);
+
+        // previous_values are not needed: 13 instead of 18 arrays per domain
+        BOOST_CHECK(low_storage_memory < classic_memory * 0.75);
+
+        BOOST_REQUIRE_EQUAL(classic->samples.size(), low_storage->samples.size());
+        float max_pressure = 0, max_difference = 0;
+        for (unsigned long i = 0; i < classic->samples.size(); i++) {
+            max_pressure = max(max_pressure, abs(classic->samples[i]));
+            max_difference = max(max_difference, abs(classic->samples[i] - low_storage->samples[i]));
+        }
+        BOOST_CHECK(max_pressure > 0);
+        BOOST_CHECK(max_difference < 1e-2 * max_pressure);
+    }
+
+    BOOST_AUTO_TEST_CASE(time_steps_are_finished_after_their_results) {
+        auto callback = make_shared<RecordingCallback>();
+        run_short_simulation(false, callback);
+
+        BOOST_REQUIRE(callback->finished_frames.size() > 1);
+        BOOST_CHECK_EQUAL(callback->finished_frames.size(), callback->samples.size());
+        for (unsigned long i = 0; i < callback->finished_frames.size(); i++) {
+            BOOST_CHECK_EQUAL(callback->finished_frames[i], (int) i);
+            // every time step writes a frame of the single domain and a sample of the single receiver
+            BOOST_CHECK_EQUAL(callback->finished_frame_counts[i], i + 1);
+            BOOST_CHECK_EQUAL(callback->finished_sample_counts[i], i + 1);
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(activity_tracking_skips_silent_domains) {
+        auto config = create_short_simulation(false);
+        Kernel::DomainConf far_domain = config->Domains.at(0);
+        far_domain.TopLeft = QVector2D(8, 0);
+        config->Domains.push_back(far_domain);
+        config->Speakers.at(0) = QVector3D(2, 4, 0);
+        config->Receivers.at(0) = QVector3D(3, 4.2, 0);
+
+        config->Settings.SetActivityThreshold(1E-6f);
+
+        auto tracked = make_shared<RecordingCallback>();
+        auto untracked = make_shared<RecordingCallback>();
+        Kernel::PSTDKernel<float> tracked_kernel(false, false);
+        tracked_kernel.initialize_kernel(config, tracked);
+        tracked_kernel.run(tracked);
+        config->Settings.SetActivityThreshold(0);
+        Kernel::PSTDKernel<float> untracked_kernel(false, false);
+        untracked_kernel.initialize_kernel(config, untracked);
+        untracked_kernel.run(untracked);
+
+        int inactive_domains = 0;
+        for (auto domain: tracked_kernel.get_scene()->domain_list) {
+            if (!domain->active) {
+                inactive_domains++;
+                BOOST_CHECK(domain->get_amplitude() < 1e-5);
+            }
+        }
+        for (auto domain: untracked_kernel.get_scene()->domain_list) {
+            BOOST_CHECK(domain->active);
+        }
+        BOOST_CHECK(inactive_domains > 0);
+
+        BOOST_REQUIRE_EQUAL(tracked->samples.size(), untracked->samples.size());
+        float max_pressure = 0, max_difference = 0;
+        for (unsigned long i = 0; i < tracked->samples.size(); i++) {
+            max_pressure = max(max_pressure, abs(untracked->samples[i]));
+            max_difference = max(max_difference, abs(tracked->samples[i] - untracked->samples[i]));
+        }
+        BOOST_CHECK(max_pressure > 0);
+        BOOST_CHECK(max_difference < 1e-4 * max_pressure);
+    }
+
+    BOOST_AUTO_TEST_CASE(stop_after_energy_decay) {
+        auto config = create_short_simulation(false);
+        Kernel::DomainConf &domain = config->Domains.at(0);
+        domain.SetAbsorption(Kernel::PSTD_DOMAIN_SIDE_ALL, 1);
+        config->Settings.SetRenderTime(0.1);
+        config->Settings.SetStopDecay(3);
+        config->Settings.SetStopDecayFrames(2);
+
+        auto callback = make_shared<RecordingCallback>();
+        Kernel::PSTDKernel<float> kernel(false, false);
+        kernel.initialize_kernel(config, callback);
+        kernel.run(callback);
+
+        unsigned long render_frames = (unsigned long) (config->Settings.GetRenderTime() / config->Settings.GetTimeStep());
+        BOOST_CHECK(callback->energy.size() < render_frames);
+        BOOST_REQUIRE(callback->energy.size() > 10);
+        // The energy is conserved until the sound reaches the absorbing edges
+        BOOST_CHECK_CLOSE(callback->energy.at(10), callback->energy.at(0), 5);
+        float peak = *max_element(callback->energy.begin(), callback->energy.end());
+        BOOST_CHECK(callback->energy.back() < peak / 2);
+        BOOST_CHECK(callback->energy.at(callback->energy.size() - 2) < peak / 2);
+    }
+
+    BOOST_AUTO_TEST_CASE(output_plan_limits_results) {
+        auto config = create_short_simulation(false);
+        config->Settings.SetRenderTime(0.002);
+        unsigned long render_frames = (unsigned long) (config->Settings.GetRenderTime() / config->Settings.GetTimeStep());
+
+        auto plan = Kernel::OutputPlan::CreateReceiversOnlyPlan(config->Settings);
+        Kernel::DomainOutputPlan region = plan->DefaultDomainOutput;
+        region.SaveNth = 2;
+        region.Decimation = 4;
+        region.RegionWidth = 20;
+        region.RegionHeight = 10;
+        plan->DomainOutput[0] = region;
+        plan->Receivers = {5};
+
+        auto callback = make_shared<RecordingCallback>();
+        Kernel::PSTDKernel<float> kernel(false, false);
+        kernel.initialize_kernel(config, callback);
+        kernel.run(callback, plan);
+
+        BOOST_CHECK_EQUAL(callback->frame_sizes.size(), (render_frames + 1) / 2);
+        for (auto size: callback->frame_sizes) {
+            BOOST_CHECK_EQUAL(size, 5 * 3);
+        }
+        BOOST_CHECK(callback->samples.empty());
+
+        // The metadata that is stored with the results describes the grid of the frames
+        Kernel::SimulationMetadata metadata = kernel.get_metadata();
+        vector<int> full_grid = {metadata.DomainMetadata.at(0).at(0), metadata.DomainMetadata.at(0).at(1), 0, 0, 1};
+        BOOST_CHECK(metadata.GetFrameGrid(0) == full_grid);
+        metadata.SetOutputPlan(*plan);
+        BOOST_CHECK((metadata.GetFrameGrid(0) == vector<int>{5, 3, 0, 0, 4}));
+    }
+
+    BOOST_AUTO_TEST_CASE(reductions_match_frames) {
+        auto config = create_short_simulation(false);
+        config->Settings.SetRenderTime(0.003);
+        float dt = config->Settings.GetTimeStep();
+
+        auto plan = Kernel::OutputPlan::CreateDefaultPlan(config->Settings);
+        plan->DefaultDomainOutput.SaveNth = 1;
+        plan->Reductions = true;
+
+        auto callback = make_shared<RecordingCallback>();
+        Kernel::PSTDKernel<float> kernel(false, false);
+        kernel.initialize_kernel(config, callback);
+        kernel.run(callback, plan);
+
+        BOOST_REQUIRE_EQUAL(callback->reductions.size(), 3);
+        BOOST_REQUIRE(!callback->frames.empty());
+        auto peak = callback->reductions[Kernel::FIELD_REDUCTION::PEAK];
+        auto rms = callback->reductions[Kernel::FIELD_REDUCTION::RMS];
+        auto arrival = callback->reductions[Kernel::FIELD_REDUCTION::ARRIVAL];
+        unsigned long cells = callback->frames.at(0)->size();
+        BOOST_REQUIRE_EQUAL(peak->size(), cells);
+        BOOST_REQUIRE_EQUAL(rms->size(), cells);
+        BOOST_REQUIRE_EQUAL(arrival->size(), cells);
+
+        float max_peak = *max_element(peak->begin(), peak->end());
+        BOOST_REQUIRE(max_peak > 0);
+        unsigned long arrived = 0;
+        for (unsigned long i = 0; i < cells; i++) {
+            float frame_peak = 0, squares = 0;
+            for (auto frame: callback->frames) {
+                frame_peak = max(frame_peak, abs(frame->at(i)));
+                squares += frame->at(i) * frame->at(i);
+            }
+            BOOST_CHECK_SMALL(peak->at(i) - frame_peak, 1e-6f * max_peak);
+            BOOST_CHECK_SMALL(rms->at(i) - sqrt(squares / callback->frames.size()), 1e-4f * max_peak);
+            if (arrival->at(i) >= 0) {
+                arrived++;
+                // the pressure at the arrival time exceeds the threshold, which is below the peak of the cell
+                unsigned long frame = (unsigned long) lround(arrival->at(i) / dt);
+                BOOST_REQUIRE(frame < callback->frames.size());
+                BOOST_CHECK(abs(callback->frames.at(frame)->at(i)) <= peak->at(i));
+                BOOST_CHECK(abs(callback->frames.at(frame)->at(i)) > 0);
+            } else {
+                BOOST_CHECK_EQUAL(arrival->at(i), -1);
+            }
+        }
+        // the sound has not reached the complete domain yet
+        BOOST_CHECK(arrived > 0);
+        BOOST_CHECK(arrived < cells);
+    }
+
+    BOOST_AUTO_TEST_CASE(running_dft_matches_frames) {
+        auto config = create_short_simulation(false);
+        config->Settings.SetRenderTime(0.003);
+        double dt = config->Settings.GetTimeStep();
+
+        auto plan = Kernel::OutputPlan::CreateDefaultPlan(config->Settings);
+        plan->DefaultDomainOutput.SaveNth = 1;
+        plan->DFTFrequencies = {100, 700};
+
+        auto callback = make_shared<RecordingCallback>();
+        Kernel::PSTDKernel<float> kernel(false, false);
+        kernel.initialize_kernel(config, callback);
+        kernel.run(callback, plan);
+
+        BOOST_REQUIRE_EQUAL(callback->dft.size(), 2);
+        unsigned long cells = callback->frames.at(0)->size();
+        for (int k = 0; k < 2; k++) {
+            auto data = callback->dft[k];
+            BOOST_REQUIRE_EQUAL(data->size(), 2 * cells);
+            double max_magnitude = 0, max_difference = 0;
+            for (unsigned long i = 0; i < cells; i += 7) {
+                double real = 0, imag = 0;
+                for (unsigned long n = 0; n < callback->frames.size(); n++) {
+                    double phase = 2 * M_PI * plan->DFTFrequencies[k] * n * dt;
+                    real += callback->frames[n]->at(i) * cos(phase) * dt;
+                    imag -= callback->frames[n]->at(i) * sin(phase) * dt;
+                }
+                max_magnitude = max(max_magnitude, sqrt(real * real + imag * imag));
+                max_difference = max(max_difference, abs(real - data->at(2 * i)));
+                max_difference = max(max_difference, abs(imag - data->at(2 * i + 1)));
+            }
+            BOOST_CHECK(max_magnitude > 0);
+            BOOST_CHECK(max_difference < 1e-4 * max_magnitude);
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(resume_from_checkpoint_matches_uninterrupted_run) {
+        auto config = create_short_simulation(true);
+        config->Settings.SetRenderTime(0.005);
+        string checkpoint = "solver-test.checkpoint";
+
+        auto plan = Kernel::OutputPlan::CreateDefaultPlan(config->Settings);
+        plan->DefaultDomainOutput.SaveNth = 1;
+        plan->Reductions = true;
+        plan->CheckpointFile = checkpoint;
+        plan->CheckpointNth = 4;
+
+        auto uninterrupted = make_shared<RecordingCallback>();
+        Kernel::PSTDKernel<float> kernel(false, false);
+        kernel.initialize_kernel(config, uninterrupted);
+        kernel.run(uninterrupted, plan);
+
+        auto resumed = make_shared<RecordingCallback>();
+        resumed->interrupt_frame = 14;
+        Kernel::PSTDKernel<float> interrupted_kernel(false, false);
+        interrupted_kernel.initialize_kernel(config, resumed);
+        BOOST_CHECK_THROW(interrupted_kernel.run(resumed, plan), runtime_error);
+
+        // the results after the checkpoint are discarded, as the CLI does with the PSTD file
+        Kernel::CheckpointPosition position = Kernel::CheckpointPosition::Read(checkpoint);
+        BOOST_CHECK_EQUAL(position.Frame, 11);
+        resumed->frames.resize(position.DomainFrames[0]);
+        resumed->samples.resize(position.ReceiverSamples[0]);
+        resumed->interrupt_frame = -1;
+
+        plan->Resume = true;
+        Kernel::PSTDKernel<float> resumed_kernel(false, false);
+        resumed_kernel.initialize_kernel(config, resumed);
+        resumed_kernel.run(resumed, plan);
+        remove(checkpoint.c_str());
+
+        BOOST_REQUIRE_EQUAL(resumed->frames.size(), uninterrupted->frames.size());
+        for (unsigned long i = 0; i < resumed->frames.size(); i++) {
+            BOOST_CHECK(*resumed->frames[i] == *uninterrupted->frames[i]);
+        }
+        BOOST_CHECK(resumed->samples == uninterrupted->samples);
+        BOOST_CHECK(*resumed->reductions[Kernel::FIELD_REDUCTION::RMS] ==
+                    *uninterrupted->reductions[Kernel::FIELD_REDUCTION::RMS]);
+    }
+
+    BOOST_AUTO_TEST_CASE(separate_speakers_match_single_speaker_runs) {
+        auto config = create_short_simulation(true);
+        config->Speakers.push_back(QVector3D(2.6, 5.4, 0));
+        auto plan = Kernel::OutputPlan::CreateReceiversOnlyPlan(config->Settings);
+
+        vector<shared_ptr<RecordingCallback>> batched = {make_shared<RecordingCallback>(),
+                                                         make_shared<RecordingCallback>()};
+        Kernel::PSTDKernel<float> kernel(false, false, Kernel::FFTLengthPolicy::SMOOTH, true);
+        kernel.initialize_kernel(config, batched[0]);
+        BOOST_CHECK_EQUAL(kernel.get_source_count(), 2);
+        BOOST_CHECK_THROW(kernel.run(batched[0], plan), invalid_argument);
+        kernel.run_sources({batched[0], batched[1]}, plan);
+
+        for (unsigned long s = 0; s < batched.size(); s++) {
+            auto single_config = create_short_simulation(true);
+            single_config->Speakers = {config->Speakers.at(s)};
+            auto single = make_shared<RecordingCallback>();
+            Kernel::PSTDKernel<float> single_kernel(false, false);
+            single_kernel.initialize_kernel(single_config, single);
+            single_kernel.run(single, plan);
+
+            BOOST_REQUIRE_EQUAL(batched[s]->samples.size(), single->samples.size());
+            float max_amplitude = 0, max_difference = 0;
+            for (unsigned long i = 0; i < single->samples.size(); i++) {
+                max_amplitude = max(max_amplitude, abs(single->samples[i]));
+                max_difference = max(max_difference, abs(batched[s]->samples[i] - single->samples[i]));
+            }
+            BOOST_CHECK(max_amplitude > 0);
+            BOOST_CHECK(max_difference < 1e-5 * max_amplitude);
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(symmetric_scene_matches_full_scene) {
+        auto config = create_short_simulation(true);
+        config->Domains.at(0).Size = QVector2D(16, 8);
+        config->Domains.at(0).L.Absorption = 1;
+        config->Domains.at(0).R.Absorption = 1;
+        config->Speakers = {QVector3D(6.6, 4.4, 0), QVector3D(9.4, 4.4, 0)};
+        config->Receivers = {QVector3D(7.4, 4.2, 0), QVector3D(8.6, 4.2, 0)};
+        auto plan = Kernel::OutputPlan::CreateDefaultPlan(config->Settings);
+
+        auto full = make_shared<RecordingCallback>();
+        Kernel::PSTDKernel<float> full_kernel(false, false);
+        full_kernel.initialize_kernel(config, full);
+        full_kernel.run(full, plan);
+
+        BOOST_REQUIRE(config->DetectSymmetry());
+        BOOST_CHECK(config->Symmetry == Kernel::PSTD_SYMMETRY::X);
+        BOOST_CHECK_CLOSE(config->SymmetryPlane, 8, 1e-4);
+        auto mirrored = make_shared<RecordingCallback>();
+        Kernel::PSTDKernel<float> half_kernel(false, false);
+        half_kernel.initialize_kernel(config, mirrored);
+        BOOST_CHECK_EQUAL(half_kernel.get_scene()->domain_list.at(0)->size.x, 40);
+        half_kernel.run(mirrored, plan);
+
+        BOOST_REQUIRE_EQUAL(mirrored->frames.size(), full->frames.size());
+        BOOST_REQUIRE_EQUAL(mirrored->samples.size(), full->samples.size());
+        float max_amplitude = 0, max_difference = 0;
+        for (unsigned long i = 0; i < full->frames.size(); i++) {
+            BOOST_REQUIRE_EQUAL(mirrored->frames[i]->size(), full->frames[i]->size());
+            for (unsigned long j = 0; j < full->frames[i]->size(); j++) {
+                max_amplitude = max(max_amplitude, abs(full->frames[i]->at(j)));
+                max_difference = max(max_difference, abs(mirrored->frames[i]->at(j) - full->frames[i]->at(j)));
+            }
+        }
+        for (unsigned long i = 0; i < full->samples.size(); i++) {
+            max_difference = max(max_difference, abs(mirrored->samples[i] - full->samples[i]));
+        }
+        BOOST_CHECK(max_amplitude > 0);
+        BOOST_CHECK(max_difference < 1e-5 * max_amplitude);
+    }
+
+    BOOST_AUTO_TEST_CASE(refined_domain_matches_uniform_fine_grid) {
+        // A fine domain with the speaker next to a coarse domain, with rigid outer edges (no PML)
+        auto config = create_short_simulation(false);
+        config->Settings.SetRenderTime(0.008);
+        // A pulse that the coarse grid resolves with a few cells over its width
+        config->Settings.SetBandWidth(config->Settings.GetBandWidth() / 4);
+        Kernel::DomainConf fine = config->Domains.at(0);
+        fine.T.Absorption = fine.B.Absorption = fine.L.Absorption = fine.R.Absorption = 0;
+        Kernel::DomainConf coarse = fine;
+        coarse.TopLeft = QVector2D(8, 0);
+        config->Domains = {fine, coarse};
+        config->Speakers = {QVector3D(6.6, 4.4, 0)};
+        config->Receivers = {QVector3D(7.4, 4.2, 0)};
+        auto plan = Kernel::OutputPlan::CreateDefaultPlan(config->Settings);
+        plan->DomainOutput[1] = plan->DefaultDomainOutput;
+        plan->DomainOutput[1].SaveNth = 0;
+
+        // The same scene on the fine grid everywhere, which takes two time steps per step of the coarse domain
+        auto uniform_config = make_shared<Kernel::PSTDConfiguration>(*config);
+        uniform_config->Settings.SetGridSpacing(config->Settings.GetGridSpacing() / 2);
+        auto uniform = make_shared<RecordingCallback>();
+        Kernel::PSTDKernel<float> uniform_kernel(false, false);
+        uniform_kernel.initialize_kernel(uniform_config, uniform);
+        uniform_kernel.run(uniform, plan);
+
+        config->Domains.at(0).Refinement = 2;
+        auto refined = make_shared<RecordingCallback>();
+        Kernel::PSTDKernel<float> refined_kernel(false, false);
+        refined_kernel.initialize_kernel(config, refined);
+        BOOST_CHECK_EQUAL(refined_kernel.get_metadata().DomainMetadata.at(0).at(0), 80);
+        BOOST_CHECK_EQUAL(refined_kernel.get_metadata().DomainMetadata.at(1).at(0), 40);
+        // The positions are in grid points of the base grid
+        BOOST_CHECK_EQUAL(refined_kernel.get_metadata().DomainPositions.at(0).at(0), 0);
+        BOOST_CHECK_EQUAL(refined_kernel.get_metadata().DomainPositions.at(1).at(0), 40);
+        // The refined domain sub-steps, so the scene keeps the time step of the coarse grid
+        BOOST_CHECK(abs(2 * refined_kernel.get_metadata().Framecount - uniform_kernel.get_metadata().Framecount) <= 1);
+        refined_kernel.run(refined, plan);
+
+        // Frame i of the refined run ends at the same time as frame 2i+1 of the uniform run
+        BOOST_REQUIRE(!refined->frames.empty());
+        BOOST_REQUIRE(2 * refined->frames.size() <= uniform->frames.size());
+        BOOST_REQUIRE(2 * refined->samples.size() <= uniform->samples.size());
+        float max_amplitude = 0, max_difference = 0, max_sample_difference = 0;
+        for (unsigned long i = 0; i < refined->frames.size(); i++) {
+            const vector<float> &uniform_frame = *uniform->frames[2 * i + 1];
+            BOOST_REQUIRE_EQUAL(refined->frames[i]->size(), uniform_frame.size());
+            for (unsigned long j = 0; j < uniform_frame.size(); j++) {
+                max_amplitude = max(max_amplitude, abs(uniform_frame[j]));
+                max_difference = max(max_difference, abs(refined->frames[i]->at(j) - uniform_frame[j]));
+            }
+        }
+        for (unsigned long i = 0; i < refined->samples.size(); i++) {
+            max_sample_difference = max(max_sample_difference, abs(refined->samples[i] - uniform->samples[2 * i + 1]));
+        }
+        BOOST_CHECK(max_amplitude > 0);
+        BOOST_CHECK(max_difference < 5e-3 * max_amplitude);
+        BOOST_CHECK(max_sample_difference < 5e-3 * max_amplitude);
+    }
+
+    BOOST_AUTO_TEST_CASE(resume_refined_scene_matches_uninterrupted_run) {
+        // The coarse domain interpolates the snapshots of the refined domain of the previous time steps
+        auto config = create_short_simulation(false);
+        Kernel::DomainConf fine = config->Domains.at(0);
+        fine.Refinement = 2;
+        Kernel::DomainConf coarse = config->Domains.at(0);
+        coarse.TopLeft = QVector2D(8, 0);
+        config->Domains = {fine, coarse};
+        config->Speakers = {QVector3D(6.6, 4.4, 0)};
+        config->Receivers = {QVector3D(9.4, 4.2, 0)};
+        string checkpoint = "solver-refined-test.checkpoint";
+
+        auto plan = Kernel::OutputPlan::CreateDefaultPlan(config->Settings);
+        plan->DefaultDomainOutput.SaveNth = 1;
+        plan->DomainOutput[0] = plan->DefaultDomainOutput;
+        plan->DomainOutput[0].SaveNth = 0;
+        plan->CheckpointFile = checkpoint;
+        plan->CheckpointNth = 4;
+
+        auto uninterrupted = make_shared<RecordingCallback>();
+        Kernel::PSTDKernel<float> kernel(false, false);
+        kernel.initialize_kernel(config, uninterrupted);
+        kernel.run(uninterrupted, plan);
+
+        auto resumed = make_shared<RecordingCallback>();
+        resumed->interrupt_frame = 10;
+        Kernel::PSTDKernel<float> interrupted_kernel(false, false);
+        interrupted_kernel.initialize_kernel(config, resumed);
+        BOOST_CHECK_THROW(interrupted_kernel.run(resumed, plan), runtime_error);
+
+        Kernel::CheckpointPosition position = Kernel::CheckpointPosition::Read(checkpoint);
+        BOOST_CHECK_EQUAL(position.Frame, 7);
+        resumed->frames.resize(position.DomainFrames[1]);
+        resumed->samples.resize(position.ReceiverSamples[0]);
+        resumed->interrupt_frame = -1;
+
+        plan->Resume = true;
+        Kernel::PSTDKernel<float> resumed_kernel(false, false);
+        resumed_kernel.initialize_kernel(config, resumed);
+        resumed_kernel.run(resumed, plan);
+        remove(checkpoint.c_str());
+
+        BOOST_REQUIRE(!uninterrupted->frames.empty());
+        BOOST_REQUIRE_EQUAL(resumed->frames.size(), uninterrupted->frames.size());
+        for (unsigned long i = 0; i < resumed->frames.size(); i++) {
+            BOOST_CHECK(*resumed->frames[i] == *uninterrupted->frames[i]);
+        }
+        BOOST_CHECK(resumed->samples == uninterrupted->samples);
+    }
+
+    BOOST_AUTO_TEST_CASE(reflecting_derivative_matches_windowed_derivative) {
+        auto config = create_short_simulation(false);
+        Kernel::DomainConf &domain_conf = config->Domains.at(0);
+        domain_conf.T.Absorption = domain_conf.B.Absorption = domain_conf.L.Absorption = domain_conf.R.Absorption = 0;
+        Kernel::PSTDKernel<float> kernel(false, false);
+        kernel.initialize_kernel(config, make_shared<RecordingCallback>());
+        auto domain = kernel.get_scene()->domain_list.at(0);
+        BOOST_REQUIRE(!domain->is_pml);
+
+        // The rigid PML neighbours and the bare rigid edges both select the reflecting derivative
+        BOOST_CHECK(domain->is_reflecting(domain->get_neighbours_at(Kernel::Direction::LEFT).at(0),
+                                          domain->get_neighbours_at(Kernel::Direction::RIGHT).at(0),
+                                          Kernel::CalcDirection::X));
+        BOOST_CHECK(domain->is_reflecting(domain->get_neighbours_at(Kernel::Direction::BOTTOM).at(0),
+                                          domain->get_neighbours_at(Kernel::Direction::TOP).at(0),
+                                          Kernel::CalcDirection::Y));
+        BOOST_CHECK(domain->is_reflecting(nullptr, nullptr, Kernel::CalcDirection::X));
+        domain->edge_param_map[Kernel::Direction::RIGHT].alpha = 0.5;
+        BOOST_CHECK(!domain->is_reflecting(nullptr, nullptr, Kernel::CalcDirection::X));
+        domain->edge_param_map[Kernel::Direction::RIGHT].alpha = 0;
+
+        // A smooth field with a vanishing normal derivative on the walls
+        float dx = domain->get_grid_spacing();
+        int cols = domain->cells.x, rows = domain->cells.y;
+        float kx = 3 * M_PI / (cols * dx), ky = 2 * M_PI / (rows * dx);
+        Eigen::ArrayXf x = Eigen::ArrayXf::LinSpaced(cols, 0.5f * dx, (cols - 0.5f) * dx);
+        Eigen::ArrayXf y = Eigen::ArrayXf::LinSpaced(rows, 0.5f * dx, (rows - 0.5f) * dx);
+        domain->current_values.p0 = ((y * ky).cos().matrix() * (x * kx).cos().matrix().transpose()).array();
+
+        domain->calc(Kernel::CalcDirection::X, Kernel::CalculationType::PRESSURE);
+        Kernel::ArrayXXT<float> reflecting = domain->l_values.Lpx;
+
+        // Passing the derivative factors explicitly always takes the windowed path
+        int fft_length = domain->wnd->get_fft_length(2 * config->Settings.GetWindowSize() + cols);
+        auto derfact = domain->wnd->get_discretization(dx, fft_length).pressure_deriv_factors;
+        Kernel::ArrayXXT<float> windowed = domain->calc(Kernel::CalcDirection::X, Kernel::CalculationType::PRESSURE,
+                                                        derfact);
+
+        BOOST_REQUIRE_EQUAL(reflecting.rows(), windowed.rows());
+        BOOST_REQUIRE_EQUAL(reflecting.cols(), windowed.cols());
+        BOOST_CHECK(reflecting.abs().maxCoeff() > 0.5 * kx);
+        BOOST_CHECK((reflecting - windowed).abs().maxCoeff() < 1e-4 * kx);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -50,10 +50,10 @@ BOOST_AUTO_TEST_SUITE(wave_numbers)
         int size2 = 178;
         int size3 = 227;
         float dx = 0.2;
-        WisdomCache wnd = WisdomCache();
-        WisdomCache::Discretization discr1 = wnd.get_discretization(dx, size1);
-        WisdomCache::Discretization discr2 = wnd.get_discretization(dx, size2);
-        WisdomCache::Discretization discr3 = wnd.get_discretization(dx, size3);
+        WisdomCache<float> wnd(FFTLengthPolicy::POWER_OF_TWO);
+        WisdomCache<float>::Discretization discr1 = wnd.get_discretization(dx, size1);
+        WisdomCache<float>::Discretization discr2 = wnd.get_discretization(dx, size2);
+        WisdomCache<float>::Discretization discr3 = wnd.get_discretization(dx, size3);
 
         BOOST_CHECK_EQUAL(discr2.wave_numbers.size(), discr3.wave_numbers.size());
         BOOST_CHECK_EQUAL(discr2.wave_numbers.size(), 2 * discr1.wave_numbers.size());
@@ -63,11 +63,27 @@ BOOST_AUTO_TEST_SUITE(wave_numbers)
 
     }
 
+    BOOST_AUTO_TEST_CASE(test_matching_smooth) {
+        float dx = 0.2;
+        WisdomCache<float> wnd(FFTLengthPolicy::SMOOTH);
+        BOOST_CHECK_EQUAL(wnd.get_discretization(dx, 115).wave_numbers.size(), 120);
+        BOOST_CHECK_EQUAL(wnd.get_discretization(dx, 178).wave_numbers.size(), 180);
+        BOOST_CHECK_EQUAL(wnd.get_discretization(dx, 119).wave_numbers.size(), 120);
+        BOOST_CHECK_EQUAL(wnd.computed_discretization.size(), 2);
+
+        WisdomCache<float>::Discretization discr = wnd.get_discretization(dx, 115);
+        BOOST_CHECK(is_approx(discr.wave_numbers.maxCoeff(), (float) M_PI / dx));
+        BOOST_CHECK(is_approx(discr.wave_numbers.coeff(60), (float) M_PI / dx));
+        BOOST_CHECK(is_approx(discr.wave_numbers.coeff(61), discr.wave_numbers.coeff(59)));
+        BOOST_CHECK(is_approx(discr.complex_factors.imag().coeff(60), 1));
+        BOOST_CHECK(is_approx(discr.complex_factors.imag().coeff(61), -1));
+    }
+
     BOOST_AUTO_TEST_CASE(test_wavenumber_bounds) {
         int size1 = 115;
         float dx = 0.2;
-        WisdomCache wnd = WisdomCache();
-        WisdomCache::Discretization discr1 = wnd.get_discretization(dx, size1);
+        WisdomCache<float> wnd(FFTLengthPolicy::POWER_OF_TWO);
+        WisdomCache<float>::Discretization discr1 = wnd.get_discretization(dx, size1);
         BOOST_CHECK(discr1.wave_numbers.maxCoeff() <= 15.8);
         BOOST_CHECK(discr1.wave_numbers.minCoeff() >= 0);
         // Value from default python run.
@@ -78,8 +94,8 @@ BOOST_AUTO_TEST_SUITE(wave_numbers)
     BOOST_AUTO_TEST_CASE(test_discretized_values) {
         int size1 = 115;
         float dx = 0.2;
-        WisdomCache wnd = WisdomCache();
-        WisdomCache::Discretization discr1 = wnd.get_discretization(dx, size1);
+        WisdomCache<float> wnd(FFTLengthPolicy::POWER_OF_TWO);
+        WisdomCache<float>::Discretization discr1 = wnd.get_discretization(dx, size1);
         BOOST_CHECK(is_approx(discr1.wave_numbers.coeff(1), 0.245437));
         BOOST_CHECK(is_approx(discr1.wave_numbers.coeff(99), 7.1176707));
 
@@ -50,6 +50,16 @@ BOOST_AUTO_TEST_SUITE(kernel_functions)
         BOOST_CHECK_EQUAL(next_2_power(0.1), 1);
     }
 
+    BOOST_AUTO_TEST_CASE(test_next_smooth_length) {
+        BOOST_CHECK_EQUAL(next_smooth_length(1), 2);
+        BOOST_CHECK_EQUAL(next_smooth_length(64), 64);
+        BOOST_CHECK_EQUAL(next_smooth_length(115), 120);
+        BOOST_CHECK_EQUAL(next_smooth_length(121), 126);
+        BOOST_CHECK_EQUAL(next_smooth_length(1164), 1176);
+        BOOST_CHECK_EQUAL(get_fft_length(1164, FFTLengthPolicy::POWER_OF_TWO), 2048);
+        BOOST_CHECK_EQUAL(get_fft_length(1164, FFTLengthPolicy::SMOOTH), 1176);
+    }
+
     BOOST_AUTO_TEST_CASE(test_rho_array_one_neighbour) {
         float air_dens = 1.2;
         float max_rho = 1E10;
@@ -57,7 +67,7 @@ BOOST_AUTO_TEST_SUITE(kernel_functions)
         Array<float, 4, 2> pressure;
         velocity << -1, 1, 0, 0, 0, 2, 1, 1;
         pressure << 1, -1, 0, 0, 2, 0, 1, 1;
-        RhoArray rhoArray = get_rho_array(max_rho, air_dens, air_dens);
+        RhoArray<float> rhoArray = get_rho_array<float>(max_rho, air_dens, air_dens);
         BOOST_CHECK(rhoArray.pressure.isApprox(pressure));
         BOOST_CHECK(rhoArray.velocity.isApprox(velocity));
     }
@@ -68,7 +78,7 @@ BOOST_AUTO_TEST_SUITE(kernel_functions)
         Array<float, 4, 2> pressure;
         velocity << 0, 0, 0, 0, 1, 1, 1, 1;
         pressure << 0, 0, 0, 0, 1, 1, 1, 1;
-        RhoArray rhoArray = get_rho_array(air_dens, air_dens, air_dens);
+        RhoArray<float> rhoArray = get_rho_array<float>(air_dens, air_dens, air_dens);
         BOOST_CHECK(rhoArray.pressure.isApprox(pressure));
         BOOST_CHECK(rhoArray.velocity.isApprox(velocity));
     }
@@ -89,6 +99,33 @@ BOOST_AUTO_TEST_SUITE(kernel_functions)
         BOOST_CHECK(get_grid_spacing(settings) <= 8.5);
     }
 
+    BOOST_AUTO_TEST_CASE(test_get_grid_spacing_margin) {
+        PSTDSettings settings;
+        settings.SetSoundSpeed(340);
+        settings.SetMaxFrequency(20000);
+        // Continuous: close to the Nyquist limit instead of the next entry of a fixed list
+        BOOST_CHECK_CLOSE(get_grid_spacing(settings), 0.0085, 0.01);
+        settings.SetPointsPerWavelength(4);
+        BOOST_CHECK_CLOSE(get_grid_spacing(settings), 0.0042, 0.01);
+        settings.SetPointsPerWavelength(1);
+        BOOST_CHECK_THROW(get_grid_spacing(settings), std::invalid_argument);
+    }
+
+    BOOST_AUTO_TEST_CASE(test_get_grid_spacing_domain_edges) {
+        auto conf = PSTDConfiguration::CreateDefaultConf();
+        conf->Settings.SetMaxFrequency(20000);
+        float dx = get_grid_spacing(*conf);
+        BOOST_CHECK(dx <= 0.0085);
+        BOOST_CHECK(dx > 0.0084);
+        for (auto domain: conf->Domains) {
+            for (float edge: {domain.TopLeft.x(), domain.TopLeft.y(), domain.Size.x(), domain.Size.y()}) {
+                BOOST_CHECK_SMALL(edge / dx - round(edge / dx), 1e-2f);
+            }
+        }
+        // The old fixed list would have chosen 0.005
+        BOOST_CHECK(get_number_of_cells(*conf, dx) < get_number_of_cells(*conf, 0.005) / 2.5);
+    }
+
     BOOST_AUTO_TEST_CASE(test_spatderp3) {
         Eigen::ArrayXXf d1v(1,51), d1p(1,50), d2p(1,50), d2v(1,51), d3v(1,51), d3p(1,50);
         Eigen::ArrayXcf derfact_p(128), derfact_v(128);
@@ -115,8 +152,8 @@ BOOST_AUTO_TEST_SUITE(kernel_functions)
         derfact_v.imag() = imag_v;
 
         //debug check if derfact is correct
-        WisdomCache wnd = WisdomCache();
-        WisdomCache::Discretization discr1 = wnd.get_discretization(0.4, 128);
+        WisdomCache<float> wnd;
+        WisdomCache<float>::Discretization discr1 = wnd.get_discretization(0.4, 128);
 //        for(int i=0;i<128;i++){
 //            std::cout << discr1.pressure_deriv_factors(i) <<"\n";
 //        }
@@ -127,11 +164,11 @@ BOOST_AUTO_TEST_SUITE(kernel_functions)
         Eigen::ArrayXf window(65);
         window << 0.00316228,0.00858261,0.02007542,0.0412163 ,0.07551126,0.12530442,0.19087516,0.27012564,0.35896633,0.45219639,0.54452377,0.63140816,0.7095588 ,0.77707471,0.83331485,0.8786185 ,0.9139817 ,0.94076063,0.96043711,0.97445482,0.98411922,0.9905474 ,0.99465322,0.99715493,0.9985956 ,0.99936947,0.9997499 ,0.99991624,0.99997804,0.99999609,0.99999966,0.99999999,1.        ,0.99999999,0.99999966,0.99999609,0.99997804,0.99991624,0.9997499 ,0.99936947,0.9985956 ,0.99715493,0.99465322,0.9905474 ,0.98411922,0.97445482,0.96043711,0.94076063,0.9139817 ,0.8786185 ,0.83331485,0.77707471,0.7095588 ,0.63140816,0.54452377,0.45219639,0.35896633,0.27012564,0.19087516,0.12530442,0.07551126,0.0412163 ,0.02007542,0.00858261,0.00316228;
 
-        RhoArray rho_array = get_rho_array(1.2, 1.2, 1.2);
+        RhoArray<float> rho_array = get_rho_array<float>(1.2, 1.2, 1.2);
 
-        Eigen::ArrayXXf spatresult_pressin = spatderp3(d1p.sin(), d2p.sin(), d3p.sin(), derfact_p, rho_array, window, wlen,
+        Eigen::ArrayXXf spatresult_pressin = spatderp3<float>(d1p.sin(), d2p.sin(), d3p.sin(), derfact_p, rho_array, window, wlen,
                                                     CalculationType::PRESSURE, CalcDirection::X);
-        Eigen::ArrayXXf spatresult_velosin = spatderp3(d1v.sin(), d2v.sin(), d3v.sin(), derfact_v, rho_array, window, wlen,
+        Eigen::ArrayXXf spatresult_velosin = spatderp3<float>(d1v.sin(), d2v.sin(), d3v.sin(), derfact_v, rho_array, window, wlen,
                                                     CalculationType::VELOCITY, CalcDirection::X);
 
         Eigen::ArrayXXf spatexpectation_pressin(4, 51), spatexpectation_velosin(4, 50);
@@ -142,10 +179,93 @@ BOOST_AUTO_TEST_SUITE(kernel_functions)
         BOOST_CHECK(spatexpectation_velosin.isApprox(spatresult_velosin));
     }
 
+    BOOST_AUTO_TEST_CASE(test_spatderp3_double) {
+        Eigen::ArrayXXd d1v(1,51), d1p(1,50), d2p(1,50), d2v(1,51), d3v(1,51), d3p(1,50);
+
+        d1p.row(0).setLinSpaced(-19.8, -0.2);
+        d1v.row(0).setLinSpaced(-20, 0);
+        d3p.row(0).setLinSpaced(20.2, 39.8);
+        d3v.row(0).setLinSpaced(20, 40);
+
+        d2p.row(0).setLinSpaced(0.2, 19.8);
+        d2v.row(0).setLinSpaced(0, 20);
+
+        WisdomCache<double> wnd;
+        WisdomCache<double>::Discretization discr1 = wnd.get_discretization(0.4, 128);
+
+        int wlen = 32;
+        Eigen::ArrayXd window = get_window_coefficients<double>(wlen, 70);
+        RhoArray<double> rho_array = get_rho_array<double>(1.2, 1.2, 1.2);
+
+        Eigen::ArrayXXd spatresult_pressin = spatderp3<double>(d1p.sin(), d2p.sin(), d3p.sin(),
+                                                               discr1.pressure_deriv_factors, rho_array, window, wlen,
+                                                               CalculationType::PRESSURE, CalcDirection::X);
+        Eigen::ArrayXXd spatresult_velosin = spatderp3<double>(d1v.sin(), d2v.sin(), d3v.sin(),
+                                                               discr1.velocity_deriv_factors, rho_array, window, wlen,
+                                                               CalculationType::VELOCITY, CalcDirection::X);
+
+        BOOST_CHECK(d2v.cos().isApprox(spatresult_pressin, 1e-4));
+        BOOST_CHECK(d2p.cos().isApprox(spatresult_velosin, 1e-4));
+    }
+
+    BOOST_AUTO_TEST_CASE(test_spatderp3_reflecting) {
+        int N = 50;
+        float dx = 0.2;
+        float wave_number = 3 * M_PI / (N * dx);
+        // pressure at the cell centres, velocity at the cell edges; both satisfy the rigid wall conditions
+        Eigen::ArrayXXf centres(2, N), edges(2, N + 1);
+        centres.row(0).setLinSpaced(0.5 * dx, (N - 0.5) * dx);
+        centres.row(1) = centres.row(0);
+        edges.row(0).setLinSpaced(0, N * dx);
+        edges.row(1) = edges.row(0);
+
+        Eigen::ArrayXXf pressure = (centres * wave_number).cos();
+        Eigen::ArrayXXf velocity = (edges * wave_number).sin();
+
+        Eigen::ArrayXXf dpressure = spatderp3_reflecting<float>(pressure, dx, CalculationType::PRESSURE,
+                                                                CalcDirection::X);
+        Eigen::ArrayXXf dvelocity = spatderp3_reflecting<float>(velocity, dx, CalculationType::VELOCITY,
+                                                                CalcDirection::X);
+        BOOST_CHECK_EQUAL(dpressure.cols(), N + 1);
+        BOOST_CHECK_EQUAL(dvelocity.cols(), N);
+        BOOST_CHECK(((edges * wave_number).sin() * -wave_number - dpressure).abs().maxCoeff() < 1e-4);
+        BOOST_CHECK(((centres * wave_number).cos() * wave_number - dvelocity).abs().maxCoeff() < 1e-4);
+
+        Eigen::ArrayXXf dpressure_y = spatderp3_reflecting<float>(pressure.transpose(), dx, CalculationType::PRESSURE,
+                                                                  CalcDirection::Y);
+        BOOST_CHECK(dpressure_y.isApprox(dpressure.transpose()));
+    }
+
+    BOOST_AUTO_TEST_CASE(test_resampling_matrix) {
+        int N = 40;
+        // a smooth function with non-zero derivatives at both ends of the grid
+        auto f = [](double x) { return sin(3 * x + 0.5); };
+        for (bool faces: {false, true}) {
+            for (int from: {1, 2}) {
+                int to = 3 - from;
+                int points = faces ? N + 1 : N;
+                int new_points = (faces ? 1 : 0) + N / from * to;
+                Eigen::ArrayXd samples(points), expected(new_points);
+                for (int j = 0; j < points; j++) {
+                    samples(j) = f((faces ? j : j + 0.5) / N);
+                }
+                for (int i = 0; i < new_points; i++) {
+                    expected(i) = f((faces ? i : i + 0.5) / (new_points - (faces ? 1 : 0)));
+                }
+                Eigen::ArrayXXd resampling = get_resampling_matrix<double>(N, from, to, faces);
+                BOOST_CHECK_EQUAL(resampling.rows(), new_points);
+                BOOST_CHECK_EQUAL(resampling.cols(), points);
+                Eigen::ArrayXd resampled = (resampling.matrix() * samples.matrix()).array();
+                BOOST_CHECK((resampled - expected).abs().maxCoeff() < 1e-4);
+            }
+        }
+        BOOST_CHECK(get_resampling_matrix<float>(N, 2, 2, false).matrix().isIdentity());
+    }
+
     BOOST_AUTO_TEST_CASE(window_generator) {
         Eigen::ArrayXf window_verify(65), wind_gen(65);
         window_verify << 0.00316228,0.00858261,0.02007542,0.0412163 ,0.07551126,0.12530442,0.19087516,0.27012564,0.35896633,0.45219639,0.54452377,0.63140816,0.7095588 ,0.77707471,0.83331485,0.8786185 ,0.9139817 ,0.94076063,0.96043711,0.97445482,0.98411922,0.9905474 ,0.99465322,0.99715493,0.9985956 ,0.99936947,0.9997499 ,0.99991624,0.99997804,0.99999609,0.99999966,0.99999999,1.        ,0.99999999,0.99999966,0.99999609,0.99997804,0.99991624,0.9997499 ,0.99936947,0.9985956 ,0.99715493,0.99465322,0.9905474 ,0.98411922,0.97445482,0.96043711,0.94076063,0.9139817 ,0.8786185 ,0.83331485,0.77707471,0.7095588 ,0.63140816,0.54452377,0.45219639,0.35896633,0.27012564,0.19087516,0.12530442,0.07551126,0.0412163 ,0.02007542,0.00858261,0.00316228;
-        wind_gen = get_window_coefficients(32,70);
+        wind_gen = get_window_coefficients<float>(32,70);
         BOOST_CHECK(window_verify.isApprox(wind_gen));
     }
 
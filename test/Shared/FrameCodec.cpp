@@ -0,0 +1,183 @@
+//////////////////////////////////////////////////////////////////////////
+// This file is part of openPSTD.                                       //
+//                                                                      //
+// openPSTD is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU General Public License as published by //
+// the Free Software Foundation, either version 3 of the License, or    //
+// (at your option) any later version.                                  //
+//                                                                      //
+// openPSTD is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of       //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        //
+// GNU General Public License for more details.                         //
+//                                                                      //
+// You should have received a copy of the GNU General Public License    //
+// along with openPSTD.  If not, see <http://www.gnu.org/licenses/>.    //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Date: 19-10-2026
+//
+//
+// Purpose: Test suite for the codecs of the stored frames
+//
+//
+//////////////////////////////////////////////////////////////////////////
+
+
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE Main
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <shared/FrameCodec.h>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+using namespace OpenPSTD::Shared;
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(frame_codec)
+
+    /**
+     * A smooth field with an amplitude, like a pressure frame
+     */
+    vector<float> create_field(uint64_t count, float amplitude) {
+        vector<float> values(count);
+        for (uint64_t i = 0; i < count; i++) {
+            values[i] = amplitude * (float) (sin(i * 0.01) * cos(i * 0.0003));
+        }
+        return values;
+    }
+
+    /**
+     * Encodes and decodes values
+     */
+    vector<float> round_trip(const FrameCodec &codec, const vector<float> &values, vector<char> &encoded) {
+        codec.Encode(values.data(), values.size(), encoded);
+        BOOST_REQUIRE_EQUAL(codec.GetCount(encoded.data(), encoded.size()), values.size());
+        vector<float> decoded(values.size());
+        codec.Decode(encoded.data(), encoded.size(), decoded.data());
+        return decoded;
+    }
+
+    BOOST_AUTO_TEST_CASE(lossless_codecs_are_bit_exact) {
+        // more than one block of the compression, with special values
+        vector<float> values = create_field(ShuffleZlibFrameCodec::BLOCK_SIZE + 1000, 3.5f);
+        values[0] = -0.0f;
+        values[1] = numeric_limits<float>::denorm_min();
+        values[2] = numeric_limits<float>::infinity();
+        values[3] = numeric_limits<float>::quiet_NaN();
+        values[4] = -numeric_limits<float>::max();
+        for (PSTD_FRAME_CODEC type : {PSTD_FRAME_CODEC::RAW, PSTD_FRAME_CODEC::SHUFFLE_ZLIB}) {
+            vector<char> encoded;
+            vector<float> decoded = round_trip(*FrameCodec::Create(type), values, encoded);
+            BOOST_CHECK(memcmp(decoded.data(), values.data(), values.size() * sizeof(float)) == 0);
+        }
+
+        // a field that is mostly zero compresses well
+        vector<float> quiet(100000, 0.0f);
+        quiet[500] = 1.0f;
+        vector<char> encoded;
+        vector<float> decoded = round_trip(*FrameCodec::Create(PSTD_FRAME_CODEC::SHUFFLE_ZLIB), quiet, encoded);
+        BOOST_CHECK(decoded == quiet);
+        BOOST_CHECK(encoded.size() < quiet.size() * sizeof(float) / 20);
+
+        // empty frames and corrupt data
+        vector<float> empty;
+        BOOST_CHECK(round_trip(*FrameCodec::Create(PSTD_FRAME_CODEC::SHUFFLE_ZLIB), empty, encoded).empty());
+        vector<char> corrupt(encoded.begin(), encoded.begin() + 4);
+        BOOST_CHECK_THROW(FrameCodec::Create(PSTD_FRAME_CODEC::SHUFFLE_ZLIB)->GetCount(corrupt.data(), corrupt.size()),
+                          std::runtime_error);
+    }
+
+    BOOST_AUTO_TEST_CASE(reduced_precision_codecs_meet_the_maximum_error) {
+        vector<float> values = create_field(100000, 3.5f);
+        for (PSTD_FRAME_CODEC type : {PSTD_FRAME_CODEC::FLOAT16, PSTD_FRAME_CODEC::QUANTIZED}) {
+            for (float max_error : {1e-2f, 1e-3f}) {
+                vector<char> encoded;
+                vector<float> decoded = round_trip(*FrameCodec::Create(type, max_error), values, encoded);
+                float error = 0;
+                for (unsigned long i = 0; i < values.size(); i++) {
+                    error = max(error, abs(decoded[i] - values[i]));
+                }
+                BOOST_CHECK(error <= max_error);
+                BOOST_CHECK(encoded.size() < values.size() * sizeof(float));
+            }
+        }
+        BOOST_CHECK_THROW(FrameCodec::Create(PSTD_FRAME_CODEC::FLOAT16, -1), std::invalid_argument);
+        vector<char> encoded;
+        BOOST_CHECK_THROW(FrameCodec::Create(PSTD_FRAME_CODEC::QUANTIZED, 0)->Encode(values.data(), values.size(),
+                                                                                     encoded), std::invalid_argument);
+    }
+
+    BOOST_AUTO_TEST_CASE(reduced_precision_codecs_select_the_number_of_bits) {
+        // the encoded data is a header of 24 bytes followed by the values
+        uint64_t count = 10000;
+        auto encoded_bits = [count](const vector<char> &encoded) {
+            return (int) ((encoded.size() - 24) * 8 / count);
+        };
+        vector<char> encoded;
+        auto quantized = FrameCodec::Create(PSTD_FRAME_CODEC::QUANTIZED, 1e-3f);
+
+        // 101 levels fit in 8 bits, 3501 levels in 16 bits
+        round_trip(*quantized, create_field(count, 0.1f), encoded);
+        BOOST_CHECK_EQUAL(encoded_bits(encoded), 8);
+        round_trip(*quantized, create_field(count, 3.5f), encoded);
+        BOOST_CHECK_EQUAL(encoded_bits(encoded), 16);
+
+        // too many levels for 16 bits and values that are not finite are stored as they are
+        vector<float> loud = create_field(count, 1000);
+        BOOST_CHECK(round_trip(*quantized, loud, encoded) == loud);
+        BOOST_CHECK_EQUAL(encoded_bits(encoded), 32);
+        vector<float> invalid = create_field(count, 1);
+        invalid[10] = numeric_limits<float>::quiet_NaN();
+        vector<float> decoded = round_trip(*quantized, invalid, encoded);
+        BOOST_CHECK(memcmp(decoded.data(), invalid.data(), count * sizeof(float)) == 0);
+        BOOST_CHECK_EQUAL(encoded_bits(encoded), 32);
+
+        // half precision floats, unless they can not meet the maximum error
+        vector<float> values = create_field(count, 3.5f);
+        round_trip(*FrameCodec::Create(PSTD_FRAME_CODEC::FLOAT16, 1e-2f), values, encoded);
+        BOOST_CHECK_EQUAL(encoded_bits(encoded), 16);
+        round_trip(*FrameCodec::Create(PSTD_FRAME_CODEC::FLOAT16), values, encoded);
+        BOOST_CHECK_EQUAL(encoded_bits(encoded), 16);
+        BOOST_CHECK(round_trip(*FrameCodec::Create(PSTD_FRAME_CODEC::FLOAT16, 1e-6f), values, encoded) == values);
+        BOOST_CHECK_EQUAL(encoded_bits(encoded), 32);
+    }
+
+    BOOST_AUTO_TEST_CASE(half_precision_keeps_large_magnitudes) {
+        // the scale of these frames is 2^16 or more, half precision has a relative error of at most 2^-11
+        for (float amplitude : {3e9f, 1e20f, 1e30f}) {
+            vector<float> values = create_field(10000, amplitude);
+            values[0] = amplitude;
+            values[1] = -amplitude;
+            for (float max_error : {0.0f, amplitude * 1e-3f}) {
+                vector<char> encoded;
+                vector<float> decoded = round_trip(*FrameCodec::Create(PSTD_FRAME_CODEC::FLOAT16, max_error),
+                                                   values, encoded);
+                BOOST_CHECK_EQUAL(encoded.size(), 24 + values.size() * sizeof(uint16_t));
+                float error = 0;
+                for (unsigned long i = 0; i < values.size(); i++) {
+                    BOOST_REQUIRE(isfinite(decoded[i]));
+                    error = max(error, abs(decoded[i] - values[i]));
+                }
+                BOOST_CHECK(error <= ldexp(amplitude, -11));
+            }
+        }
+    }
+
+    BOOST_AUTO_TEST_CASE(codec_names) {
+        PSTD_FRAME_CODEC codec;
+        BOOST_CHECK(FrameCodec::Parse("raw", codec) && codec == PSTD_FRAME_CODEC::RAW);
+        BOOST_CHECK(FrameCodec::Parse("shuffle-zlib", codec) && codec == PSTD_FRAME_CODEC::SHUFFLE_ZLIB);
+        BOOST_CHECK(FrameCodec::Parse("float16", codec) && codec == PSTD_FRAME_CODEC::FLOAT16);
+        BOOST_CHECK(FrameCodec::Parse("quantized", codec) && codec == PSTD_FRAME_CODEC::QUANTIZED);
+        BOOST_CHECK(!FrameCodec::Parse("gzip", codec));
+        BOOST_CHECK_THROW(FrameCodec::Create((PSTD_FRAME_CODEC) 100), std::invalid_argument);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,307 @@
+//////////////////////////////////////////////////////////////////////////
+// This file is part of openPSTD.                                       //
+//                                                                      //
+// openPSTD is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU General Public License as published by //
+// the Free Software Foundation, either version 3 of the License, or    //
+// (at your option) any later version.                                  //
+//                                                                      //
+// openPSTD is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of       //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        //
+// GNU General Public License for more details.                         //
+//                                                                      //
+// You should have received a copy of the GNU General Public License    //
+// along with openPSTD.  If not, see <http://www.gnu.org/licenses/>.    //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Date: 19-10-2026
+//
+//
+// Purpose: Test suite for the results in the PSTD file
+//
+//
+//////////////////////////////////////////////////////////////////////////
+
+
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE Main
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <shared/PSTDFile.h>
+#include <cmath>
+#include <fstream>
+
+using namespace OpenPSTD;
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(pstd_file)
+
+    /**
+     * A new file with the results of the two domains of the default scene, removed when the test ends
+     */
+    struct ResultsFile {
+        static const int WIDTH = 70;
+        static const int HEIGHT = 45;
+
+        boost::filesystem::path path;
+        unique_ptr<Shared::PSTDFile> file;
+
+        ResultsFile() {
+            path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("openpstd-%%%%-%%%%.pstd");
+            file = Shared::PSTDFile::New(path);
+            Kernel::SimulationMetadata metadata;
+            metadata.Framecount = 0;
+            metadata.DomainMetadata = {{WIDTH, HEIGHT, 1}, {WIDTH, HEIGHT, 1}};
+            metadata.DomainPositions = {{0, 0, 0}, {WIDTH, 0, 0}};
+            file->InitializeResults(metadata);
+        }
+
+        ~ResultsFile() {
+            file = nullptr;
+            boost::filesystem::remove(path);
+            boost::filesystem::remove(path.string() + ".results");
+        }
+
+        /**
+         * Commits the results and opens the file again
+         */
+        void Reopen() {
+            file->Commit();
+            file = nullptr;
+            file = Shared::PSTDFile::Open(path);
+        }
+
+        /**
+         * A frame of which every value differs, per domain and time step
+         */
+        static Kernel::PSTD_FRAME_PTR CreateFrame(int frame, unsigned int domain) {
+            auto result = make_shared<Kernel::PSTD_FRAME>(WIDTH * HEIGHT);
+            for (int i = 0; i < WIDTH * HEIGHT; i++) {
+                (*result)[i] = domain * 1e6f + frame * 1e4f + i;
+            }
+            return result;
+        }
+
+        /**
+         * Writes frames of both domains and a sample of the receiver per time step
+         */
+        void WriteFrames(int start, int end) {
+            for (int f = start; f < end; f++) {
+                Shared::PSTDFileWriteBatch batch;
+                batch.AddFrame(0, CreateFrame(f, 0));
+                batch.AddFrame(1, CreateFrame(f, 1));
+                batch.AddSamples(0, make_shared<Kernel::PSTD_RECEIVER_DATA>(1, (float) f));
+                file->WriteBatch(batch);
+            }
+        }
+    };
+
+    const int ResultsFile::WIDTH;
+    const int ResultsFile::HEIGHT;
+
+    BOOST_AUTO_TEST_CASE(truncated_results_continue_after_the_kept_frames) {
+        ResultsFile results;
+        results.WriteFrames(0, 10);
+        results.file->TruncateResults({{0, 4}, {1, 6}}, {{0, 5}});
+        BOOST_CHECK_EQUAL(results.file->GetResultsFrameCount(0), 4);
+        BOOST_CHECK_EQUAL(results.file->GetResultsFrameCount(1), 6);
+        BOOST_CHECK_EQUAL(results.file->GetReceiverData(0)->size(), 5);
+
+        // a resumed simulation writes the frames after the kept ones again, the kept frames are unchanged
+        results.file->SaveNextResultsFrame(0, ResultsFile::CreateFrame(20, 0));
+        results.file->SaveNextResultsFrame(1, ResultsFile::CreateFrame(20, 1));
+        results.Reopen();
+        BOOST_REQUIRE_EQUAL(results.file->GetResultsFrameCount(0), 5);
+        BOOST_REQUIRE_EQUAL(results.file->GetResultsFrameCount(1), 7);
+        for (int f = 0; f < 4; f++) {
+            BOOST_CHECK(*results.file->GetResultsFrame(f, 0) == *ResultsFile::CreateFrame(f, 0));
+        }
+        for (int f = 0; f < 6; f++) {
+            BOOST_CHECK(*results.file->GetResultsFrame(f, 1) == *ResultsFile::CreateFrame(f, 1));
+        }
+        BOOST_CHECK(*results.file->GetResultsFrame(4, 0) == *ResultsFile::CreateFrame(20, 0));
+        BOOST_CHECK(*results.file->GetResultsFrame(6, 1) == *ResultsFile::CreateFrame(20, 1));
+        Kernel::PSTD_RECEIVER_DATA_PTR samples = results.file->GetReceiverData(0);
+        BOOST_REQUIRE_EQUAL(samples->size(), 5);
+        for (unsigned long s = 0; s < samples->size(); s++) {
+            BOOST_CHECK_EQUAL(samples->at(s), (float) s);
+        }
+
+        // nothing is kept of the domains without an entry
+        results.file->TruncateResults({}, {});
+        BOOST_CHECK_EQUAL(results.file->GetResultsFrameCount(0), 0);
+        BOOST_CHECK_EQUAL(results.file->GetResultsFrameCount(1), 0);
+        BOOST_CHECK_EQUAL(results.file->GetReceiverData(0)->size(), 0);
+    }
+
+    BOOST_AUTO_TEST_CASE(frame_statistics_are_stored_with_the_frames) {
+        ResultsFile results;
+        results.WriteFrames(0, 3);
+        results.file->SaveNextResultsFrame(0, ResultsFile::CreateFrame(3, 0));
+        results.Reopen();
+
+        int count = ResultsFile::WIDTH * ResultsFile::HEIGHT;
+        for (int f = 0; f < 4; f++) {
+            Kernel::PSTD_FRAME_PTR frame = ResultsFile::CreateFrame(f, 0);
+            double squares = 0;
+            for (float value : *frame) {
+                squares += (double) value * value;
+            }
+            Shared::ResultsFrameStatistics statistics = results.file->GetResultsFrameStatistics(f, 0);
+            BOOST_CHECK_EQUAL(statistics.Count, count);
+            BOOST_CHECK_EQUAL(statistics.Min, frame->front());
+            BOOST_CHECK_EQUAL(statistics.Max, frame->back());
+            BOOST_CHECK_CLOSE(statistics.Mean, (frame->front() + frame->back()) / 2, 1e-3);
+            BOOST_CHECK_CLOSE(statistics.RMS, sqrt(squares / count), 1e-3);
+        }
+
+        // the statistics of a range of frames combine those of the frames
+        Shared::ResultsFrameStatistics range = results.file->GetResultsStatistics(0, 1, 2);
+        BOOST_CHECK_EQUAL(range.Count, 2 * count);
+        BOOST_CHECK_EQUAL(range.Min, ResultsFile::CreateFrame(1, 0)->front());
+        BOOST_CHECK_EQUAL(range.Max, ResultsFile::CreateFrame(2, 0)->back());
+        BOOST_CHECK_CLOSE(range.Mean, (ResultsFile::CreateFrame(1, 0)->front() +
+                                       ResultsFile::CreateFrame(2, 0)->back()) / 2, 1e-3);
+        BOOST_CHECK_EQUAL(results.file->GetResultsStatistics(1).Count, 3 * count);
+
+        // the statistics of discarded frames are discarded with them
+        results.file->TruncateResults({{0, 1}}, {});
+        results.file->SaveNextResultsFrame(0, ResultsFile::CreateFrame(10, 0));
+        results.Reopen();
+        BOOST_CHECK_EQUAL(results.file->GetResultsFrameStatistics(1, 0).Min, ResultsFile::CreateFrame(10, 0)->front());
+        BOOST_CHECK_EQUAL(results.file->GetResultsStatistics(0).Count, 2 * count);
+    }
+
+    BOOST_AUTO_TEST_CASE(time_series_tiles_match_the_frames) {
+        ResultsFile results;
+        int frames = 2 * Shared::PSTDFile::TIME_SERIES_BLOCK_FRAMES + 22;
+        for (int f = 0; f < frames; f++) {
+            results.file->SaveNextResultsFrame(0, ResultsFile::CreateFrame(f, 0));
+        }
+        // the corners, the edges of the tiles and the partial tiles at the end of the rows and columns
+        vector<pair<int, int>> points = {{0, 0}, {69, 44}, {31, 31}, {32, 32}, {33, 40}, {5, 44}, {64, 0}};
+        auto check_series = [&](const vector<Kernel::PSTD_RECEIVER_DATA> &series) {
+            BOOST_REQUIRE_EQUAL(series.size(), points.size());
+            for (unsigned long p = 0; p < points.size(); p++) {
+                BOOST_REQUIRE_EQUAL(series[p].size(), frames);
+                for (int f = 0; f < frames; f++) {
+                    BOOST_CHECK_EQUAL(series[p][f], ResultsFile::CreateFrame(f, 0)->at(
+                            points[p].second * ResultsFile::WIDTH + points[p].first));
+                }
+            }
+        };
+
+        // without tiles all values are read from the frames
+        BOOST_CHECK_EQUAL(results.file->GetResultsTimeSeriesFrameCount(0), 0);
+        vector<Kernel::PSTD_RECEIVER_DATA> from_frames = results.file->GetResultsTimeSeries(0, points);
+        check_series(from_frames);
+
+        // the complete time blocks are read from the tiles, the frames after them from the frames
+        BOOST_CHECK_EQUAL(results.file->UpdateResultsTimeSeries(0), 2);
+        BOOST_CHECK_EQUAL(results.file->UpdateResultsTimeSeries(0), 0);
+        BOOST_CHECK_EQUAL(results.file->GetResultsTimeSeriesFrameCount(0), 2 * Shared::PSTDFile::TIME_SERIES_BLOCK_FRAMES);
+        vector<Kernel::PSTD_RECEIVER_DATA> from_tiles = results.file->GetResultsTimeSeries(0, points);
+        check_series(from_tiles);
+        BOOST_CHECK(from_tiles == from_frames);
+
+        results.Reopen();
+        BOOST_CHECK_EQUAL(results.file->GetResultsTimeSeriesFrameCount(0), 2 * Shared::PSTDFile::TIME_SERIES_BLOCK_FRAMES);
+        check_series(results.file->GetResultsTimeSeries(0, points));
+        BOOST_CHECK_THROW(results.file->GetResultsTimeSeries(0, {{ResultsFile::WIDTH, 0}}), std::out_of_range);
+
+        // a truncation keeps only the time blocks of which all frames are kept
+        results.file->TruncateResults({{0, Shared::PSTDFile::TIME_SERIES_BLOCK_FRAMES + 10}}, {});
+        BOOST_CHECK_EQUAL(results.file->GetResultsTimeSeriesFrameCount(0), Shared::PSTDFile::TIME_SERIES_BLOCK_FRAMES);
+        frames = Shared::PSTDFile::TIME_SERIES_BLOCK_FRAMES + 10;
+        check_series(results.file->GetResultsTimeSeries(0, points));
+    }
+
+    BOOST_AUTO_TEST_CASE(frames_of_earlier_codecs_still_decode) {
+        ResultsFile results;
+        BOOST_CHECK(results.file->GetResultsFrameCodec() == Shared::PSTD_FRAME_CODEC::RAW);
+        results.WriteFrames(0, 2);
+        results.file->SetResultsFrameCodec(Shared::PSTD_FRAME_CODEC::SHUFFLE_ZLIB);
+        results.WriteFrames(2, 4);
+        results.file->SetResultsFrameCodec(Shared::PSTD_FRAME_CODEC::QUANTIZED, 0.5f);
+        results.WriteFrames(4, 6);
+        results.file->SetResultsFrameCodec(Shared::PSTD_FRAME_CODEC::FLOAT16, 1.0f);
+        results.WriteFrames(6, 8);
+        results.Reopen();
+        BOOST_CHECK(results.file->GetResultsFrameCodec() == Shared::PSTD_FRAME_CODEC::FLOAT16);
+        BOOST_CHECK_EQUAL(results.file->GetResultsFrameMaxError(), 1.0f);
+
+        // every frame is decoded with the codec it was written with
+        for (unsigned int d = 0; d < 2; d++) {
+            for (int f = 0; f < 8; f++) {
+                Kernel::PSTD_FRAME_PTR frame = results.file->GetResultsFrame(f, d);
+                Kernel::PSTD_FRAME_PTR expected = ResultsFile::CreateFrame(f, d);
+                BOOST_REQUIRE_EQUAL(frame->size(), expected->size());
+                float error = 0;
+                for (unsigned long i = 0; i < frame->size(); i++) {
+                    error = max(error, abs(frame->at(i) - expected->at(i)));
+                }
+                BOOST_CHECK(f < 4 ? error == 0 : error <= (f < 6 ? 0.5f : 1.0f));
+            }
+        }
+        BOOST_CHECK_THROW(results.file->SetResultsFrameCodec(Shared::PSTD_FRAME_CODEC::QUANTIZED, 0),
+                          std::invalid_argument);
+    }
+
+    BOOST_AUTO_TEST_CASE(deleted_results_stay_readable_until_the_commit) {
+        ResultsFile results;
+        results.WriteFrames(0, 3);
+        results.file->Commit();
+        results.file->DeleteResults();
+        results.file->Rollback();
+        BOOST_REQUIRE_EQUAL(results.file->GetResultsFrameCount(0), 3);
+        for (int f = 0; f < 3; f++) {
+            BOOST_CHECK(*results.file->GetResultsFrame(f, 0) == *ResultsFile::CreateFrame(f, 0));
+        }
+
+        // the store is emptied by the commit
+        results.file->DeleteResults();
+        BOOST_CHECK(boost::filesystem::file_size(results.path.string() + ".results") > 0);
+        results.file->Commit();
+        BOOST_CHECK_EQUAL(boost::filesystem::file_size(results.path.string() + ".results"), 0);
+        BOOST_CHECK_EQUAL(results.file->GetResultsDomainCount(), 0);
+    }
+
+    BOOST_AUTO_TEST_CASE(interrupted_compaction_is_finished_when_opened) {
+        ResultsFile results;
+        results.WriteFrames(0, 3);
+        results.file->Commit();
+        results.file->DeleteResults();
+        Kernel::SimulationMetadata metadata;
+        metadata.Framecount = 0;
+        metadata.DomainMetadata = {{ResultsFile::WIDTH, ResultsFile::HEIGHT, 1}, {ResultsFile::WIDTH, ResultsFile::HEIGHT, 1}};
+        results.file->InitializeResults(metadata);
+        results.WriteFrames(5, 7);
+        results.file->Commit();
+        results.file = nullptr;
+        string path = results.path.string();
+        boost::filesystem::copy_file(path, path + ".original");
+
+        // the compaction is interrupted after the store is replaced and before the file is replaced
+        results.file = Shared::PSTDFile::Open(results.path);
+        results.file->Compact();
+        results.file = nullptr;
+        boost::filesystem::rename(path, path + ".compact");
+        boost::filesystem::rename(path + ".original", path);
+        ofstream(path + ".compact.done").close();
+
+        results.file = Shared::PSTDFile::Open(results.path);
+        BOOST_CHECK(!boost::filesystem::exists(path + ".compact"));
+        BOOST_CHECK(!boost::filesystem::exists(path + ".compact.done"));
+        BOOST_REQUIRE_EQUAL(results.file->GetResultsFrameCount(0), 2);
+        for (int f = 0; f < 2; f++) {
+            BOOST_CHECK(*results.file->GetResultsFrame(f, 0) == *ResultsFile::CreateFrame(f + 5, 0));
+            BOOST_CHECK(*results.file->GetResultsFrame(f, 1) == *ResultsFile::CreateFrame(f + 5, 1));
+        }
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
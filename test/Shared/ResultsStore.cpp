@@ -0,0 +1,102 @@
+//////////////////////////////////////////////////////////////////////////
+// This file is part of openPSTD.                                       //
+//                                                                      //
+// openPSTD is free software: you can redistribute it and/or modify     //
+// it under the terms of the GNU General Public License as published by //
+// the Free Software Foundation, either version 3 of the License, or    //
+// (at your option) any later version.                                  //
+//                                                                      //
+// openPSTD is distributed in the hope that it will be useful,          //
+// but WITHOUT ANY WARRANTY; without even the implied warranty of       //
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the        //
+// GNU General Public License for more details.                         //
+//                                                                      //
+// You should have received a copy of the GNU General Public License    //
+// along with openPSTD.  If not, see <http://www.gnu.org/licenses/>.    //
+//                                                                      //
+//////////////////////////////////////////////////////////////////////////
+
+//////////////////////////////////////////////////////////////////////////
+//
+// Date: 19-10-2026
+//
+//
+// Purpose: Test suite for the results store
+//
+//
+//////////////////////////////////////////////////////////////////////////
+
+
+#ifdef STAND_ALONE
+#   define BOOST_TEST_MODULE Main
+#endif
+
+#include <boost/test/unit_test.hpp>
+#include <shared/ResultsStore.h>
+#include <cstring>
+#include <vector>
+
+using namespace OpenPSTD::Shared;
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(results_store)
+
+    /**
+     * Data of a frame that differs per frame and per byte
+     */
+    vector<char> create_data(int frame, uint64_t size) {
+        vector<char> data(size);
+        for (uint64_t i = 0; i < size; i++) {
+            data[i] = (char) ((i * 31 + frame * 7) % 251);
+        }
+        return data;
+    }
+
+    BOOST_AUTO_TEST_CASE(frames_across_chunks_survive_reopen) {
+        boost::filesystem::path path = boost::filesystem::temp_directory_path() /
+                                       boost::filesystem::unique_path("openpstd-%%%%-%%%%.results");
+        // seven frames of 10 MB do not fit in the first chunk
+        uint64_t size = 10 * 1024 * 1024;
+        vector<ResultsStoreEntry> entries;
+        {
+            ResultsStore store(path, 0);
+            for (int f = 0; f < 7; f++) {
+                vector<char> data = create_data(f, size);
+                entries.push_back(store.Append(data.data(), size));
+            }
+            // a frame larger than a chunk starts a chunk of its own
+            vector<char> large = create_data(7, ResultsStore::CHUNK_SIZE + size);
+            entries.push_back(store.Append(large.data(), large.size()));
+            store.Flush();
+            BOOST_CHECK_EQUAL(store.GetEnd(), entries.back().Offset + entries.back().Size);
+        }
+
+        // no frame crosses the boundary of a chunk, except the one that is larger than a chunk
+        BOOST_CHECK_EQUAL(entries[6].Offset, ResultsStore::CHUNK_SIZE);
+        BOOST_CHECK_EQUAL(entries[7].Offset, 2 * ResultsStore::CHUNK_SIZE);
+        for (unsigned long f = 0; f < 7; f++) {
+            BOOST_CHECK_EQUAL(entries[f].Offset / ResultsStore::CHUNK_SIZE,
+                              (entries[f].Offset + entries[f].Size - 1) / ResultsStore::CHUNK_SIZE);
+        }
+
+        {
+            ResultsStore store(path, entries.back().Offset + entries.back().Size);
+            for (unsigned long f = 0; f < entries.size(); f++) {
+                vector<char> expected = create_data((int) f, entries[f].Size);
+                shared_ptr<const char> data = store.Get(entries[f]);
+                BOOST_CHECK(memcmp(data.get(), expected.data(), expected.size()) == 0);
+            }
+
+            // truncating discards the frames after the end, the next frame is appended there
+            store.Truncate(entries[6].Offset);
+            vector<char> data = create_data(8, size);
+            ResultsStoreEntry entry = store.Append(data.data(), size);
+            BOOST_CHECK_EQUAL(entry.Offset, entries[6].Offset);
+            BOOST_CHECK(memcmp(store.Get(entry).get(), data.data(), size) == 0);
+            vector<char> expected = create_data(5, size);
+            BOOST_CHECK(memcmp(store.Get(entries[5]).get(), expected.data(), size) == 0);
+        }
+        boost::filesystem::remove(path);
+    }
+
+BOOST_AUTO_TEST_SUITE_END()
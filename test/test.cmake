@@ -49,7 +49,13 @@ else()
                 test/Kernel/Scene.cpp
                 test/Kernel/Geometry.cpp
                 test/Kernel/Domain.cpp
+                test/Kernel/Solver.cpp
                 test/Kernel/WisdomCache.cpp)
+        # Shared test files
+        set(SOURCE_FILES_TEST ${SOURCE_FILES_TEST}
+                test/Shared/ResultsStore.cpp
+                test/Shared/PSTDFile.cpp
+                test/Shared/FrameCodec.cpp)
         # DG test files
         set(SOURCE_FILES_TEST ${SOURCE_FILES_TEST} ${SOURCE_FILES_TEST_DG})
     endif()